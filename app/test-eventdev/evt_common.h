@@ -39,6 +39,7 @@ enum evt_prod_type {
 	EVT_PROD_TYPE_SYNT,          /* Producer type Synthetic i.e. CPU. */
 	EVT_PROD_TYPE_ETH_RX_ADPTR,  /* Producer type Eth Rx Adapter. */
 	EVT_PROD_TYPE_EVENT_TIMER_ADPTR,  /* Producer type Timer Adapter. */
+	EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR,  /* Producer type Crypto Adapter. */
 	EVT_PROD_TYPE_MAX,
 };
 
@@ -54,7 +55,14 @@ struct evt_options {
 	uint8_t dev_id;
 	uint8_t timdev_cnt;
 	uint8_t nb_timer_adptrs;
+	uint8_t nb_sched_lcores;
 	uint8_t timdev_use_burst;
+	uint8_t timdev_use_wheel;
+	uint8_t timdev_cancel;
+	uint8_t crypto_adptr_mode;
+	uint8_t crypto_batch_conf;
+	uint16_t crypto_max_burst;
+	uint32_t crypto_max_latency_us;
 	uint8_t sched_type_list[EVT_MAX_STAGES];
 	uint16_t mbuf_sz;
 	uint16_t wkr_deq_dep;
@@ -138,6 +146,33 @@ evt_service_setup(uint32_t service_id)
 	return 0;
 }
 
+/*
+ * Map an MT safe service to up to nb_lcores service lcores, fall back
+ * to a single lcore for services that are not MT safe.
+ */
+static inline int
+evt_service_setup_multi(uint32_t service_id, uint8_t nb_lcores)
+{
+	int32_t core_cnt, i;
+	uint32_t core_array[RTE_MAX_LCORE];
+
+	if (nb_lcores <= 1 || rte_service_probe_capability(service_id,
+			RTE_SERVICE_CAP_MT_SAFE) == 0)
+		return evt_service_setup(service_id);
+
+	core_cnt = rte_service_lcore_list(core_array, RTE_MAX_LCORE);
+	if (core_cnt <= 0)
+		return -ENOENT;
+
+	for (i = 0; i != core_cnt; i++) {
+		if (rte_service_map_lcore_set(service_id, core_array[i],
+				i < nb_lcores))
+			return -ENOENT;
+	}
+
+	return 0;
+}
+
 static inline int
 evt_configure_eventdev(struct evt_options *opt, uint8_t nb_queues,
 		uint8_t nb_ports)
@@ -10,6 +10,7 @@
 #include <rte_string_fns.h>
 #include <rte_common.h>
 #include <rte_eventdev.h>
+#include <rte_event_crypto_adapter.h>
 #include <rte_lcore.h>
 
 #include "evt_options.h"
@@ -30,6 +31,7 @@ evt_options_default(struct evt_options *opt)
 	opt->nb_pkts = (1ULL << 26); /* do ~64M packets */
 	opt->nb_timers = 1E8;
 	opt->nb_timer_adptrs = 1;
+	opt->nb_sched_lcores = 1;
 	opt->timer_tick_nsec = 1E3; /* 1000ns ~ 1us */
 	opt->max_tmo_nsec = 1E5;  /* 100000ns ~100us */
 	opt->expiry_nsec = 1E4;   /* 10000ns ~10us */
@@ -118,6 +120,65 @@ evt_parse_timer_prod_type_burst(struct evt_options *opt,
 	return 0;
 }
 
+static int
+evt_parse_timer_wheel(struct evt_options *opt, const char *arg __rte_unused)
+{
+	opt->timdev_use_wheel = 1;
+	return 0;
+}
+
+static int
+evt_parse_timer_cancel(struct evt_options *opt, const char *arg __rte_unused)
+{
+	opt->timdev_cancel = 1;
+	return 0;
+}
+
+static int
+evt_parse_crypto_prod_type(struct evt_options *opt,
+		const char *arg __rte_unused)
+{
+	opt->prod_type = EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR;
+	return 0;
+}
+
+static int
+evt_parse_crypto_adptr_mode(struct evt_options *opt, const char *arg)
+{
+	uint8_t mode;
+	int ret;
+
+	ret = parser_read_uint8(&mode, arg);
+	if (ret || mode > RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD) {
+		evt_err("invalid crypto adapter mode, must be 0 or 1");
+		return -EINVAL;
+	}
+	opt->crypto_adptr_mode = mode;
+	return 0;
+}
+
+static int
+evt_parse_crypto_max_burst(struct evt_options *opt, const char *arg)
+{
+	int ret;
+
+	ret = parser_read_uint16(&(opt->crypto_max_burst), arg);
+	opt->crypto_batch_conf = 1;
+
+	return ret;
+}
+
+static int
+evt_parse_crypto_max_latency(struct evt_options *opt, const char *arg)
+{
+	int ret;
+
+	ret = parser_read_uint32(&(opt->crypto_max_latency_us), arg);
+	opt->crypto_batch_conf = 1;
+
+	return ret;
+}
+
 static int
 evt_parse_test_name(struct evt_options *opt, const char *arg)
 {
@@ -201,6 +262,16 @@ evt_parse_nb_timer_adptrs(struct evt_options *opt, const char *arg)
 	return ret;
 }
 
+static int
+evt_parse_nb_sched_lcores(struct evt_options *opt, const char *arg)
+{
+	int ret;
+
+	ret = parser_read_uint8(&(opt->nb_sched_lcores), arg);
+
+	return ret;
+}
+
 static int
 evt_parse_pool_sz(struct evt_options *opt, const char *arg)
 {
@@ -278,13 +349,25 @@ usage(char *program)
 		"\t                     in ns.\n"
 		"\t--prod_type_timerdev_burst : use timer device as producer\n"
 		"\t                             burst mode.\n"
+		"\t--prod_type_cryptodev : use crypto device as producer.\n"
+		"\t--crypto_adptr_mode : 0 for OP_NEW mode (default) and\n"
+		"\t                      1 for OP_FORWARD mode.\n"
+		"\t--crypto_max_burst : crypto adapter enqueue burst size.\n"
+		"\t--crypto_max_latency_us : max time a crypto op is held\n"
+		"\t                          back by the crypto adapter.\n"
 		"\t--nb_timers        : number of timers to arm.\n"
 		"\t--nb_timer_adptrs  : number of timer adapters to use.\n"
 		"\t--timer_tick_nsec  : timer tick interval in ns.\n"
 		"\t--max_tmo_nsec     : max timeout interval in ns.\n"
 		"\t--expiry_nsec      : event timer expiry ns.\n"
+		"\t--timer_wheel      : use the timing wheel mode of the\n"
+		"\t                     software timer adapter.\n"
+		"\t--timer_cancel     : cancel and rearm every armed timer\n"
+		"\t                     to measure the cancel cost.\n"
 		"\t--mbuf_sz          : packet mbuf size.\n"
 		"\t--max_pkt_sz       : max packet size.\n"
+		"\t--nb_sched_lcores  : number of service lcores to run\n"
+		"\t                     the event device scheduler on.\n"
 		);
 	printf("available tests:\n");
 	evt_test_dump_names();
@@ -349,13 +432,20 @@ static struct option lgopts[] = {
 	{ EVT_PROD_ETHDEV,         0, 0, 0 },
 	{ EVT_PROD_TIMERDEV,       0, 0, 0 },
 	{ EVT_PROD_TIMERDEV_BURST, 0, 0, 0 },
+	{ EVT_PROD_CRYPTODEV,      0, 0, 0 },
+	{ EVT_CRYPTO_ADPTR_MODE,   1, 0, 0 },
+	{ EVT_CRYPTO_MAX_BURST,    1, 0, 0 },
+	{ EVT_CRYPTO_MAX_LATENCY,  1, 0, 0 },
 	{ EVT_NB_TIMERS,           1, 0, 0 },
 	{ EVT_NB_TIMER_ADPTRS,     1, 0, 0 },
 	{ EVT_TIMER_TICK_NSEC,     1, 0, 0 },
 	{ EVT_MAX_TMO_NSEC,        1, 0, 0 },
 	{ EVT_EXPIRY_NSEC,         1, 0, 0 },
+	{ EVT_TIMER_WHEEL,         0, 0, 0 },
+	{ EVT_TIMER_CANCEL,        0, 0, 0 },
 	{ EVT_MBUF_SZ,             1, 0, 0 },
 	{ EVT_MAX_PKT_SZ,          1, 0, 0 },
+	{ EVT_NB_SCHED_LCORES,     1, 0, 0 },
 	{ EVT_HELP,                0, 0, 0 },
 	{ NULL,                    0, 0, 0 }
 };
@@ -383,13 +473,20 @@ evt_opts_parse_long(int opt_idx, struct evt_options *opt)
 		{ EVT_PROD_ETHDEV, evt_parse_eth_prod_type},
 		{ EVT_PROD_TIMERDEV, evt_parse_timer_prod_type},
 		{ EVT_PROD_TIMERDEV_BURST, evt_parse_timer_prod_type_burst},
+		{ EVT_PROD_CRYPTODEV, evt_parse_crypto_prod_type},
+		{ EVT_CRYPTO_ADPTR_MODE, evt_parse_crypto_adptr_mode},
+		{ EVT_CRYPTO_MAX_BURST, evt_parse_crypto_max_burst},
+		{ EVT_CRYPTO_MAX_LATENCY, evt_parse_crypto_max_latency},
 		{ EVT_NB_TIMERS, evt_parse_nb_timers},
 		{ EVT_NB_TIMER_ADPTRS, evt_parse_nb_timer_adptrs},
 		{ EVT_TIMER_TICK_NSEC, evt_parse_timer_tick_nsec},
 		{ EVT_MAX_TMO_NSEC, evt_parse_max_tmo_nsec},
 		{ EVT_EXPIRY_NSEC, evt_parse_expiry_nsec},
+		{ EVT_TIMER_WHEEL, evt_parse_timer_wheel},
+		{ EVT_TIMER_CANCEL, evt_parse_timer_cancel},
 		{ EVT_MBUF_SZ, evt_parse_mbuf_sz},
 		{ EVT_MAX_PKT_SZ, evt_parse_max_pkt_sz},
+		{ EVT_NB_SCHED_LCORES, evt_parse_nb_sched_lcores},
 	};
 
 	for (i = 0; i < RTE_DIM(parsermap); i++) {
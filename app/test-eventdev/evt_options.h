@@ -35,11 +35,18 @@
 #define EVT_PROD_ETHDEV          ("prod_type_ethdev")
 #define EVT_PROD_TIMERDEV        ("prod_type_timerdev")
 #define EVT_PROD_TIMERDEV_BURST  ("prod_type_timerdev_burst")
+#define EVT_PROD_CRYPTODEV       ("prod_type_cryptodev")
+#define EVT_CRYPTO_ADPTR_MODE    ("crypto_adptr_mode")
+#define EVT_CRYPTO_MAX_BURST     ("crypto_max_burst")
+#define EVT_CRYPTO_MAX_LATENCY   ("crypto_max_latency_us")
 #define EVT_NB_TIMERS            ("nb_timers")
 #define EVT_NB_TIMER_ADPTRS      ("nb_timer_adptrs")
+#define EVT_NB_SCHED_LCORES      ("nb_sched_lcores")
 #define EVT_TIMER_TICK_NSEC      ("timer_tick_nsec")
 #define EVT_MAX_TMO_NSEC         ("max_tmo_nsec")
 #define EVT_EXPIRY_NSEC          ("expiry_nsec")
+#define EVT_TIMER_WHEEL          ("timer_wheel")
+#define EVT_TIMER_CANCEL         ("timer_cancel")
 #define EVT_MBUF_SZ              ("mbuf_sz")
 #define EVT_MAX_PKT_SZ           ("max_pkt_sz")
 #define EVT_HELP                 ("help")
@@ -243,6 +250,8 @@ evt_prod_id_to_name(enum evt_prod_type prod_type)
 		return "Ethdev Rx Adapter";
 	case EVT_PROD_TYPE_EVENT_TIMER_ADPTR:
 		return "Event timer adapter";
+	case EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR:
+		return "Event crypto adapter";
 	}
 
 	return "";
@@ -275,6 +284,10 @@ evt_dump_producer_type(struct evt_options *opt)
 		evt_dump("nb_timer_adapters", "%d", opt->nb_timer_adptrs);
 		evt_dump("max_tmo_nsec", "%"PRIu64"", opt->max_tmo_nsec);
 		evt_dump("expiry_nsec", "%"PRIu64"", opt->expiry_nsec);
+		evt_dump("timer_wheel", "%s",
+				EVT_BOOL_FMT(opt->timdev_use_wheel));
+		evt_dump("timer_cancel", "%s",
+				EVT_BOOL_FMT(opt->timdev_cancel));
 		if (opt->optm_timer_tick_nsec)
 			evt_dump("optm_timer_tick_nsec", "%"PRIu64"",
 					opt->optm_timer_tick_nsec);
@@ -282,6 +295,19 @@ evt_dump_producer_type(struct evt_options *opt)
 			evt_dump("timer_tick_nsec", "%"PRIu64"",
 					opt->timer_tick_nsec);
 		break;
+	case EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR:
+		snprintf(name, EVT_PROD_MAX_NAME_LEN,
+				"Event crypto adapter producers");
+		evt_dump("crypto_adapter_mode", "%s",
+				opt->crypto_adptr_mode ?
+				"OP_FORWARD" : "OP_NEW");
+		if (opt->crypto_batch_conf) {
+			evt_dump("crypto_max_burst", "%d",
+					opt->crypto_max_burst);
+			evt_dump("crypto_max_latency_us", "%"PRIu32"",
+					opt->crypto_max_latency_us);
+		}
+		break;
 	}
 	evt_dump("prod_type", "%s", name);
 }
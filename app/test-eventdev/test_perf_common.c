@@ -75,6 +75,31 @@ perf_producer(void *arg)
 	return 0;
 }
 
+/* Cancel just armed timers and arm them again, so that the adapter cancel cost
+ * is measured without changing the number of expiries.
+ */
+static inline uint64_t
+perf_event_timer_cancel_rearm(struct rte_event_timer_adapter *adptr,
+		struct perf_elt **m, uint64_t timeout_ticks, uint16_t nb_timers,
+		uint64_t *count)
+{
+	uint64_t cycles;
+	uint16_t i, n;
+
+	cycles = rte_get_timer_cycles();
+	n = rte_event_timer_cancel_burst(adptr,
+			(struct rte_event_timer **)m, nb_timers);
+	cycles = rte_get_timer_cycles() - cycles;
+
+	for (i = 0; i < n; i++)
+		m[i]->timestamp = rte_get_timer_cycles();
+	rte_event_timer_arm_tmo_tick_burst(adptr,
+			(struct rte_event_timer **)m, timeout_ticks, n);
+
+	*count += n;
+	return cycles;
+}
+
 static inline int
 perf_event_timer_producer(void *arg)
 {
@@ -85,12 +110,15 @@ perf_event_timer_producer(void *arg)
 	uint32_t flow_counter = 0;
 	uint64_t count = 0;
 	uint64_t arm_latency = 0;
+	uint64_t cancel_count = 0;
+	uint64_t cancel_latency = 0;
 	const uint8_t nb_timer_adptrs = opt->nb_timer_adptrs;
 	const uint32_t nb_flows = t->nb_flows;
 	const uint64_t nb_timers = opt->nb_timers;
 	struct rte_mempool *pool = t->pool;
 	struct perf_elt *m[BURST_SIZE + 1] = {NULL};
 	struct rte_event_timer_adapter **adptr = t->timer_adptr;
+	struct rte_event_timer_adapter *ad;
 	struct rte_event_timer tim;
 	uint64_t timeout_ticks = opt->expiry_nsec / opt->timer_tick_nsec;
 
@@ -119,14 +147,18 @@ perf_event_timer_producer(void *arg)
 			m[i]->tim.ev.flow_id = flow_counter++ % nb_flows;
 			m[i]->tim.ev.event_ptr = m[i];
 			m[i]->timestamp = rte_get_timer_cycles();
-			while (rte_event_timer_arm_burst(
-			       adptr[flow_counter % nb_timer_adptrs],
+			ad = adptr[flow_counter % nb_timer_adptrs];
+			while (rte_event_timer_arm_burst(ad,
 			       (struct rte_event_timer **)&m[i], 1) != 1) {
 				if (t->done)
 					break;
 				m[i]->timestamp = rte_get_timer_cycles();
 			}
 			arm_latency += rte_get_timer_cycles() - m[i]->timestamp;
+			if (opt->timdev_cancel)
+				cancel_latency += perf_event_timer_cancel_rearm(
+						ad, &m[i], timeout_ticks, 1,
+						&cancel_count);
 		}
 		count += BURST_SIZE;
 	}
@@ -136,6 +168,12 @@ perf_event_timer_producer(void *arg)
 			__func__, rte_lcore_id(),
 			count ? (float)(arm_latency / count) /
 			(rte_get_timer_hz() / 1000000) : 0);
+	if (opt->timdev_cancel)
+		printf("%s(): lcore %d Average event timer cancel latency = %.3f us\n",
+				__func__, rte_lcore_id(),
+				cancel_count ? (float)cancel_latency /
+				cancel_count / (rte_get_timer_hz() / 1000000) :
+				0);
 	return 0;
 }
 
@@ -143,18 +181,22 @@ static inline int
 perf_event_timer_producer_burst(void *arg)
 {
 	int i;
+	uint16_t n;
 	struct prod_data *p  = arg;
 	struct test_perf *t = p->t;
 	struct evt_options *opt = t->opt;
 	uint32_t flow_counter = 0;
 	uint64_t count = 0;
 	uint64_t arm_latency = 0;
+	uint64_t cancel_count = 0;
+	uint64_t cancel_latency = 0;
 	const uint8_t nb_timer_adptrs = opt->nb_timer_adptrs;
 	const uint32_t nb_flows = t->nb_flows;
 	const uint64_t nb_timers = opt->nb_timers;
 	struct rte_mempool *pool = t->pool;
 	struct perf_elt *m[BURST_SIZE + 1] = {NULL};
 	struct rte_event_timer_adapter **adptr = t->timer_adptr;
+	struct rte_event_timer_adapter *ad;
 	struct rte_event_timer tim;
 	uint64_t timeout_ticks = opt->expiry_nsec / opt->timer_tick_nsec;
 
@@ -184,12 +226,15 @@ perf_event_timer_producer_burst(void *arg)
 			m[i]->tim.ev.event_ptr = m[i];
 			m[i]->timestamp = rte_get_timer_cycles();
 		}
-		rte_event_timer_arm_tmo_tick_burst(
-				adptr[flow_counter % nb_timer_adptrs],
+		ad = adptr[flow_counter % nb_timer_adptrs];
+		n = rte_event_timer_arm_tmo_tick_burst(ad,
 				(struct rte_event_timer **)m,
 				tim.timeout_ticks,
 				BURST_SIZE);
 		arm_latency += rte_get_timer_cycles() - m[i - 1]->timestamp;
+		if (opt->timdev_cancel)
+			cancel_latency += perf_event_timer_cancel_rearm(ad, m,
+					tim.timeout_ticks, n, &cancel_count);
 		count += BURST_SIZE;
 	}
 	fflush(stdout);
@@ -198,6 +243,85 @@ perf_event_timer_producer_burst(void *arg)
 			__func__, rte_lcore_id(),
 			count ? (float)(arm_latency / count) /
 			(rte_get_timer_hz() / 1000000) : 0);
+	if (opt->timdev_cancel)
+		printf("%s(): lcore %d Average event timer cancel latency = %.3f us\n",
+				__func__, rte_lcore_id(),
+				cancel_count ? (float)cancel_latency /
+				cancel_count / (rte_get_timer_hz() / 1000000) :
+				0);
+	return 0;
+}
+
+static inline int
+perf_event_crypto_producer(void *arg)
+{
+	struct prod_data *p  = arg;
+	struct test_perf *t = p->t;
+	struct evt_options *opt = t->opt;
+	const uint8_t dev_id = p->dev_id;
+	const uint8_t port = p->port_id;
+	const uint8_t cdev_id = p->ca.cdev_id;
+	const uint16_t qp_id = p->ca.cdev_qp_id;
+	struct rte_cryptodev_sym_session *sess = p->ca.crypto_sess;
+	struct rte_mempool *pool = t->pool;
+	const uint64_t nb_pkts = t->nb_pkts;
+	const uint32_t nb_flows = t->nb_flows;
+	uint32_t flow_counter = 0;
+	uint64_t count = 0;
+	struct rte_crypto_op *op;
+	struct rte_mbuf *m;
+	struct rte_event ev;
+
+	if (opt->verbose_level > 1)
+		printf("%s(): lcore %d cdev_id %d queue pair %d\n", __func__,
+				rte_lcore_id(), cdev_id, qp_id);
+
+	ev.event = 0;
+	ev.op = RTE_EVENT_OP_NEW;
+	ev.queue_id = p->ca.ev_queue_id;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+	ev.event_type = RTE_EVENT_TYPE_CPU;
+
+	while (count < nb_pkts && t->done == false) {
+		m = rte_pktmbuf_alloc(pool);
+		if (m == NULL)
+			continue;
+		op = rte_crypto_op_alloc(t->ca_op_pool,
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+		if (op == NULL) {
+			rte_pktmbuf_free(m);
+			continue;
+		}
+
+		rte_pktmbuf_append(m, PERF_CRYPTO_DATA_LEN);
+		rte_crypto_op_attach_sym_session(op, sess);
+		op->sym->m_src = m;
+		op->sym->cipher.data.offset = 0;
+		op->sym->cipher.data.length = PERF_CRYPTO_DATA_LEN;
+		*rte_crypto_op_ctod_offset(op, uint64_t *,
+				PERF_CRYPTO_TS_OFFSET) = rte_get_timer_cycles();
+
+		if (opt->crypto_adptr_mode == RTE_EVENT_CRYPTO_ADAPTER_OP_NEW) {
+			while (rte_cryptodev_enqueue_burst(cdev_id, qp_id,
+						&op, 1) != 1) {
+				if (t->done)
+					break;
+				rte_pause();
+			}
+		} else {
+			ev.flow_id = flow_counter++ % nb_flows;
+			ev.event_ptr = op;
+			while (rte_event_enqueue_burst(dev_id, port,
+						&ev, 1) != 1) {
+				if (t->done)
+					break;
+				rte_pause();
+			}
+		}
+		count++;
+	}
+
 	return 0;
 }
 
@@ -215,6 +339,8 @@ perf_producer_wrapper(void *arg)
 	else if (t->opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR &&
 			t->opt->timdev_use_burst)
 		return perf_event_timer_producer_burst(arg);
+	else if (t->opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		return perf_event_crypto_producer(arg);
 	return 0;
 }
 
@@ -244,6 +370,20 @@ total_latency(struct test_perf *t)
 	return total;
 }
 
+static inline void
+crypto_latency(struct test_perf *t, uint64_t *latency, uint64_t *pkts)
+{
+	uint8_t i;
+
+	*latency = 0;
+	*pkts = 0;
+	rte_smp_rmb();
+	for (i = 0; i < t->nb_workers; i++) {
+		*latency += t->worker[i].crypto_latency;
+		*pkts += t->worker[i].crypto_pkts;
+	}
+}
+
 
 int
 perf_launch_lcores(struct evt_test *test, struct evt_options *opt,
@@ -315,17 +455,35 @@ perf_launch_lcores(struct evt_test *test, struct evt_options *opt,
 				printf(CLGRN"\r%.3f mpps avg %.3f mpps [avg fwd latency %.3f us] "CLNRM,
 					mpps, total_mpps/samples,
 					(float)(latency/pkts)/freq_mhz);
+				/* expiry events carry their arm time */
+				if (opt->prod_type ==
+						EVT_PROD_TYPE_EVENT_TIMER_ADPTR)
+					printf(CLGRN"[avg expiry error %.3f us] "CLNRM,
+						(float)(latency/pkts)/freq_mhz -
+						(float)opt->expiry_nsec / 1000);
 			} else {
 				printf(CLGRN"\r%.3f mpps avg %.3f mpps"CLNRM,
 					mpps, total_mpps/samples);
 			}
+			if (opt->prod_type ==
+					EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
+				uint64_t ca_latency, ca_pkts;
+
+				crypto_latency(t, &ca_latency, &ca_pkts);
+				if (ca_pkts > 0)
+					printf(CLGRN" [avg crypto adapter latency %.3f us] "CLNRM,
+						(float)(ca_latency/ca_pkts)/
+						freq_mhz);
+			}
 			fflush(stdout);
 
 			if (remaining <= 0) {
 				t->result = EVT_TEST_SUCCESS;
 				if (opt->prod_type == EVT_PROD_TYPE_SYNT ||
 					opt->prod_type ==
-					EVT_PROD_TYPE_EVENT_TIMER_ADPTR) {
+					EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+					opt->prod_type ==
+					EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
 					t->done = true;
 					rte_smp_wmb();
 					break;
@@ -335,7 +493,8 @@ perf_launch_lcores(struct evt_test *test, struct evt_options *opt,
 
 		if (new_cycles - dead_lock_cycles > dead_lock_sample &&
 		    (opt->prod_type == EVT_PROD_TYPE_SYNT ||
-		     opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR)) {
+		     opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+		     opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)) {
 			remaining = t->outstand_pkts - processed_pkts(t);
 			if (dead_lock_remaining == remaining) {
 				rte_event_dev_dump(opt->dev_id, stdout);
@@ -417,6 +576,8 @@ perf_event_timer_adapter_setup(struct test_perf *t)
 
 	if (nb_producers == 1)
 		flags |= RTE_EVENT_TIMER_ADAPTER_F_SP_PUT;
+	if (t->opt->timdev_use_wheel)
+		flags |= RTE_EVENT_TIMER_ADAPTER_F_TIMER_WHEEL;
 
 	for (i = 0; i < t->opt->nb_timer_adptrs; i++) {
 		struct rte_event_timer_adapter_conf config = {
@@ -458,15 +619,158 @@ perf_event_timer_adapter_setup(struct test_perf *t)
 	return 0;
 }
 
+static int
+perf_event_crypto_adapter_setup(struct test_perf *t, uint8_t ev_queue_id,
+		struct rte_event_port_conf port_conf)
+{
+	struct evt_options *opt = t->opt;
+	union rte_event_crypto_metadata m_data;
+	struct rte_crypto_sym_xform xform;
+	uint8_t cdev_id = 0;
+	uint16_t port, qp;
+	bool qp_ev_bind;
+	uint32_t cap;
+	int ret;
+
+	ret = rte_event_crypto_adapter_caps_get(opt->dev_id, cdev_id, &cap);
+	if (ret) {
+		evt_err("failed to get event crypto adapter capabilities");
+		return ret;
+	}
+
+	if (opt->crypto_adptr_mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD &&
+	    (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD)) {
+		evt_err("crypto adapter OP_FORWARD mode is not supported");
+		return -ENOTSUP;
+	}
+
+	ret = rte_event_crypto_adapter_create(TEST_PERF_CA_ID, opt->dev_id,
+			&port_conf, opt->crypto_adptr_mode);
+	if (ret) {
+		evt_err("failed to create crypto adapter");
+		return ret;
+	}
+
+	memset(&xform, 0, sizeof(xform));
+	xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	qp_ev_bind = !!(cap &
+			RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_QP_EV_BIND);
+
+	/* one queue pair and session per producer */
+	qp = 0;
+	for (port = t->nb_workers; port < perf_nb_event_ports(opt); port++) {
+		struct prod_data *p = &t->prod[port];
+		struct rte_cryptodev_sym_session *sess;
+
+		sess = rte_cryptodev_sym_session_create(t->ca_sess_pool);
+		if (sess == NULL) {
+			evt_err("failed to create crypto session");
+			return -ENOMEM;
+		}
+		p->ca.crypto_sess = sess;
+
+		ret = rte_cryptodev_sym_session_init(cdev_id, sess, &xform,
+				t->ca_sess_priv_pool);
+		if (ret) {
+			evt_err("failed to init crypto session");
+			return ret;
+		}
+
+		memset(&m_data, 0, sizeof(m_data));
+		m_data.response_info.queue_id = p->queue_id;
+		m_data.response_info.sched_type = opt->sched_type_list[0];
+		m_data.response_info.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+		m_data.response_info.event_type = RTE_EVENT_TYPE_CRYPTODEV;
+		m_data.response_info.flow_id = qp;
+		m_data.request_info.cdev_id = cdev_id;
+		m_data.request_info.queue_pair_id = qp;
+		rte_cryptodev_sym_session_set_user_data(sess, &m_data,
+				sizeof(m_data));
+
+		ret = rte_event_crypto_adapter_queue_pair_add(TEST_PERF_CA_ID,
+				cdev_id, qp, qp_ev_bind ?
+				&m_data.response_info : NULL);
+		if (ret) {
+			evt_err("failed to add queue pair %d to crypto adapter",
+					qp);
+			return ret;
+		}
+
+		p->ca.cdev_id = cdev_id;
+		p->ca.cdev_qp_id = qp;
+		p->ca.ev_queue_id = ev_queue_id;
+		qp++;
+	}
+
+	if (perf_crypto_fwd_queue(opt)) {
+		uint8_t adptr_port;
+
+		rte_event_crypto_adapter_event_port_get(TEST_PERF_CA_ID,
+				&adptr_port);
+		ret = rte_event_port_link(opt->dev_id, adptr_port,
+				&ev_queue_id, NULL, 1);
+		if (ret != 1) {
+			evt_err("failed to link queue %d to crypto adapter",
+					ev_queue_id);
+			return -EINVAL;
+		}
+	}
+
+	if (opt->crypto_batch_conf) {
+		struct rte_event_crypto_adapter_batch_conf batch_conf = {
+			.max_burst = opt->crypto_max_burst,
+			.max_latency_us = opt->crypto_max_latency_us,
+		};
+
+		ret = rte_event_crypto_adapter_batch_conf_set(TEST_PERF_CA_ID,
+				&batch_conf);
+		if (ret) {
+			evt_err("failed to set crypto adapter batching policy");
+			return ret;
+		}
+	}
+
+	if (!(cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_NEW) ||
+	    opt->crypto_adptr_mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD) {
+		uint32_t service_id;
+
+		rte_event_crypto_adapter_service_id_get(TEST_PERF_CA_ID,
+				&service_id);
+		ret = evt_service_setup(service_id);
+		if (ret) {
+			evt_err("Failed to setup service core"
+					" for crypto adapter\n");
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
 int
 perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 				uint8_t stride, uint8_t nb_queues,
 				const struct rte_event_port_conf *port_conf)
 {
 	struct test_perf *t = evt_test_priv(test);
-	uint16_t port, prod;
+	uint8_t queues[EVT_MAX_QUEUES];
+	const uint8_t *link_queues = NULL;
+	uint16_t port, prod, nb_links;
+	uint8_t nb_wrk_queues;
 	int ret = -1;
 
+	/* the crypto adapter queue, if any, is the last one */
+	nb_wrk_queues = nb_queues - perf_crypto_fwd_queue(opt);
+	nb_links = 0;
+	if (nb_wrk_queues != nb_queues) {
+		for (prod = 0; prod < nb_wrk_queues; prod++)
+			queues[prod] = prod;
+		link_queues = queues;
+		nb_links = nb_wrk_queues;
+	}
+
 	/* setup one port per worker, linking to all queues */
 	for (port = 0; port < evt_nr_active_lcores(opt->wlcores);
 				port++) {
@@ -484,8 +788,9 @@ perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 			return ret;
 		}
 
-		ret = rte_event_port_link(opt->dev_id, port, NULL, NULL, 0);
-		if (ret != nb_queues) {
+		ret = rte_event_port_link(opt->dev_id, port, link_queues,
+				NULL, nb_links);
+		if (ret != nb_wrk_queues) {
 			evt_err("failed to link all queues to port %d", port);
 			return -EINVAL;
 		}
@@ -531,6 +836,10 @@ perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 			}
 			prod++;
 		}
+
+		if (opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+			ret = perf_event_crypto_adapter_setup(t,
+					nb_queues - 1, *port_conf);
 	}
 
 	return ret;
@@ -544,7 +853,8 @@ perf_opt_check(struct evt_options *opt, uint64_t nb_queues)
 	/* N producer + N worker + 1 master when producer cores are used
 	 * Else N worker + 1 master when Rx adapter is used
 	 */
-	lcores = opt->prod_type == EVT_PROD_TYPE_SYNT ? 3 : 2;
+	lcores = (opt->prod_type == EVT_PROD_TYPE_SYNT ||
+		  opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) ? 3 : 2;
 
 	if (rte_lcore_count() < lcores) {
 		evt_err("test need minimum %d lcores", lcores);
@@ -570,7 +880,8 @@ perf_opt_check(struct evt_options *opt, uint64_t nb_queues)
 	}
 
 	if (opt->prod_type == EVT_PROD_TYPE_SYNT ||
-			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR) {
+			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+			opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
 		/* Validate producer lcores */
 		if (evt_lcores_has_overlap(opt->plcores,
 					rte_get_master_lcore())) {
@@ -644,6 +955,10 @@ perf_eventdev_destroy(struct evt_test *test, struct evt_options *opt)
 	if (opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR) {
 		for (i = 0; i < opt->nb_timer_adptrs; i++)
 			rte_event_timer_adapter_stop(t->timer_adptr[i]);
+	} else if (opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
+		rte_event_crypto_adapter_stop(TEST_PERF_CA_ID);
+		rte_event_crypto_adapter_queue_pair_del(TEST_PERF_CA_ID, 0, -1);
+		rte_event_crypto_adapter_free(TEST_PERF_CA_ID);
 	}
 	rte_event_dev_stop(opt->dev_id);
 	rte_event_dev_close(opt->dev_id);
@@ -679,7 +994,8 @@ perf_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 	};
 
 	if (opt->prod_type == EVT_PROD_TYPE_SYNT ||
-			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR)
+			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+			opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
 		return 0;
 
 	if (!rte_eth_dev_count_avail()) {
@@ -752,6 +1068,127 @@ void perf_ethdev_destroy(struct evt_test *test, struct evt_options *opt)
 	}
 }
 
+#define NB_CRYPTODEV_DESCRIPTORS	1024
+int
+perf_cryptodev_setup(struct evt_test *test, struct evt_options *opt)
+{
+	struct test_perf *t = evt_test_priv(test);
+	struct rte_cryptodev_qp_conf qp_conf;
+	struct rte_cryptodev_config conf;
+	struct rte_event_dev_info dev_info;
+	struct rte_cryptodev_info info;
+	uint32_t nb_ops, cache;
+	uint8_t cdev_id = 0;
+	uint16_t nb_qps, qp;
+	int ret;
+
+	if (opt->prod_type != EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		return 0;
+
+	if (!rte_cryptodev_count()) {
+		evt_err("No crypto devices found.");
+		return -ENODEV;
+	}
+
+	nb_qps = evt_nr_active_lcores(opt->plcores);
+	rte_cryptodev_info_get(cdev_id, &info);
+	if (nb_qps > info.max_nb_queue_pairs) {
+		evt_err("not enough crypto queue pairs %d/%d", nb_qps,
+				info.max_nb_queue_pairs);
+		return -EINVAL;
+	}
+
+	/* the adapter drops completions the event device has no room for,
+	 * keep the crypto ops in flight within the event device limit
+	 */
+	ret = rte_event_dev_info_get(opt->dev_id, &dev_info);
+	if (ret) {
+		evt_err("failed to get eventdev info %d", opt->dev_id);
+		return ret;
+	}
+	nb_ops = RTE_MIN(opt->pool_sz, dev_info.max_num_events / 2);
+	cache = RTE_MIN(512U, nb_ops / 2);
+
+	t->ca_op_pool = rte_crypto_op_pool_create("perf_ca_op_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, nb_ops, cache,
+			sizeof(uint64_t), opt->socket_id);
+	t->ca_sess_pool = rte_cryptodev_sym_session_pool_create(
+			"perf_ca_sess_pool", nb_qps, 0, 0,
+			sizeof(union rte_event_crypto_metadata),
+			opt->socket_id);
+	t->ca_sess_priv_pool = rte_mempool_create("perf_ca_sess_priv_pool",
+			nb_qps, rte_cryptodev_sym_get_private_session_size(
+				cdev_id), 0, 0, NULL, NULL, NULL, NULL,
+			opt->socket_id, 0);
+	if (t->ca_op_pool == NULL || t->ca_sess_pool == NULL ||
+			t->ca_sess_priv_pool == NULL) {
+		evt_err("failed to create crypto mempools");
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	memset(&conf, 0, sizeof(conf));
+	conf.socket_id = rte_cryptodev_socket_id(cdev_id);
+	conf.nb_queue_pairs = nb_qps;
+	ret = rte_cryptodev_configure(cdev_id, &conf);
+	if (ret) {
+		evt_err("failed to configure crypto dev %d", cdev_id);
+		goto err;
+	}
+
+	memset(&qp_conf, 0, sizeof(qp_conf));
+	qp_conf.nb_descriptors = NB_CRYPTODEV_DESCRIPTORS;
+	qp_conf.mp_session = t->ca_sess_pool;
+	qp_conf.mp_session_private = t->ca_sess_priv_pool;
+	for (qp = 0; qp < nb_qps; qp++) {
+		ret = rte_cryptodev_queue_pair_setup(cdev_id, qp, &qp_conf,
+				conf.socket_id);
+		if (ret) {
+			evt_err("failed to setup crypto queue pair %d", qp);
+			goto err;
+		}
+	}
+
+	ret = rte_cryptodev_start(cdev_id);
+	if (ret) {
+		evt_err("failed to start crypto dev %d", cdev_id);
+		goto err;
+	}
+
+	return 0;
+err:
+	rte_mempool_free(t->ca_op_pool);
+	rte_mempool_free(t->ca_sess_pool);
+	rte_mempool_free(t->ca_sess_priv_pool);
+	return ret;
+}
+
+void
+perf_cryptodev_destroy(struct evt_test *test, struct evt_options *opt)
+{
+	struct test_perf *t = evt_test_priv(test);
+	uint16_t port;
+
+	if (opt->prod_type != EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		return;
+
+	for (port = t->nb_workers; port < perf_nb_event_ports(opt); port++) {
+		struct rte_cryptodev_sym_session *sess;
+
+		sess = t->prod[port].ca.crypto_sess;
+		if (sess == NULL)
+			continue;
+		rte_cryptodev_sym_session_clear(t->prod[port].ca.cdev_id,
+				sess);
+		rte_cryptodev_sym_session_free(sess);
+	}
+
+	rte_cryptodev_stop(0);
+	rte_mempool_free(t->ca_op_pool);
+	rte_mempool_free(t->ca_sess_pool);
+	rte_mempool_free(t->ca_sess_priv_pool);
+}
+
 int
 perf_mempool_setup(struct evt_test *test, struct evt_options *opt)
 {
@@ -12,7 +12,7 @@ perf_queue_nb_event_queues(struct evt_options *opt)
 	/* nb_queues = number of producers * number of stages */
 	uint8_t nb_prod = opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR ?
 		rte_eth_dev_count_avail() : evt_nr_active_lcores(opt->plcores);
-	return nb_prod * opt->nb_stages;
+	return nb_prod * opt->nb_stages + perf_crypto_fwd_queue(opt);
 }
 
 static __rte_always_inline void
@@ -49,6 +49,9 @@ perf_queue_worker(void *arg, const int enable_fwd_latency)
 			rte_pause();
 			continue;
 		}
+		if (prod_crypto_type &&
+		    ev.event_type == RTE_EVENT_TYPE_CRYPTODEV)
+			perf_crypto_event_process(&ev, w);
 		if (enable_fwd_latency && !prod_timer_type)
 		/* first q in pipeline, mark timestamp to compute fwd latency */
 			mark_fwd_latency(&ev, nb_stages);
@@ -88,6 +91,9 @@ perf_queue_worker_burst(void *arg, const int enable_fwd_latency)
 		}
 
 		for (i = 0; i < nb_rx; i++) {
+			if (prod_crypto_type &&
+			    ev[i].event_type == RTE_EVENT_TYPE_CRYPTODEV)
+				perf_crypto_event_process(&ev[i], w);
 			if (enable_fwd_latency && !prod_timer_type) {
 				rte_prefetch0(ev[i+1].event_ptr);
 				/* first queue in pipeline.
@@ -198,8 +204,9 @@ perf_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 			 * RTE_EVENT_DEV_PRIORITY_LOWEST to
 			 * RTE_EVENT_DEV_PRIORITY_HIGHEST.
 			 */
-			uint8_t step = RTE_EVENT_DEV_PRIORITY_LOWEST /
-					(nb_stages - 1);
+			uint8_t step = nb_stages > 1 ?
+					RTE_EVENT_DEV_PRIORITY_LOWEST /
+					(nb_stages - 1) : 0;
 			/* Higher prio for the queues closer to last stage */
 			q_conf.priority = RTE_EVENT_DEV_PRIORITY_LOWEST -
 					(step * stage_pos);
@@ -229,7 +236,8 @@ perf_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	if (!evt_has_distributed_sched(opt->dev_id)) {
 		uint32_t service_id;
 		rte_event_dev_service_id_get(opt->dev_id, &service_id);
-		ret = evt_service_setup(service_id);
+		ret = evt_service_setup_multi(service_id,
+				opt->nb_sched_lcores);
 		if (ret) {
 			evt_err("No service lcore found to run event dev.");
 			return ret;
@@ -269,6 +277,12 @@ perf_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 				return ret;
 			}
 		}
+	} else if (opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
+		ret = rte_event_crypto_adapter_start(TEST_PERF_CA_ID);
+		if (ret) {
+			evt_err("Crypto adapter start failed");
+			return ret;
+		}
 	}
 
 	return 0;
@@ -311,11 +325,13 @@ static const struct evt_test_ops perf_queue =  {
 	.test_setup         = perf_test_setup,
 	.mempool_setup      = perf_mempool_setup,
 	.ethdev_setup	    = perf_ethdev_setup,
+	.cryptodev_setup    = perf_cryptodev_setup,
 	.eventdev_setup     = perf_queue_eventdev_setup,
 	.launch_lcores      = perf_queue_launch_lcores,
 	.eventdev_destroy   = perf_eventdev_destroy,
 	.mempool_destroy    = perf_mempool_destroy,
 	.ethdev_destroy	    = perf_ethdev_destroy,
+	.cryptodev_destroy  = perf_cryptodev_destroy,
 	.test_result        = perf_test_result,
 	.test_destroy       = perf_test_destroy,
 };
@@ -356,6 +356,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Swcopy rawdev autotest",
+        "Command": "swcopy_rawdev_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Kvargs autotest",
         "Command": "kvargs_autotest",
@@ -736,6 +742,18 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Sched perf autotest",
+        "Command": "sched_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Meter perf autotest",
+        "Command": "meter_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Red_perf",
         "Command": "red_perf",
@@ -16,6 +16,8 @@
 #include <rte_bpf.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_malloc.h>
 
 #include "test.h"
 
@@ -2859,6 +2861,163 @@ static const struct ebpf_insn test_ld_mbuf3_prog[] = {
 	},
 };
 
+/*
+ * optimizer test-cases: constants to be folded, redundant checks and
+ * unreachable code to be removed, divisors that are proven to be non-zero.
+ */
+#define TEST_OPT_LIM1	1000
+#define TEST_OPT_LIM2	2000
+#define TEST_OPT_LIM3	500
+#define TEST_OPT_DIV	100000
+#define TEST_OPT_RET	0xdead
+
+static const struct ebpf_insn test_opt1_prog[] = {
+
+	[0] = {
+		.code = (BPF_LDX | BPF_MEM | BPF_W),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_1,
+		.off = offsetof(struct dummy_offset, u32),
+	},
+	[1] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_3,
+		.imm = 10,
+	},
+	[2] = {
+		.code = (EBPF_ALU64 | BPF_MUL | BPF_K),
+		.dst_reg = EBPF_REG_3,
+		.imm = 3,
+	},
+	[3] = {
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_3,
+		.imm = 2,
+	},
+	[4] = {
+		.code = (BPF_ALU | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_5,
+		.imm = -1,
+	},
+	[5] = {
+		.code = (BPF_ALU | BPF_RSH | BPF_K),
+		.dst_reg = EBPF_REG_5,
+		.imm = 4,
+	},
+	[6] = {
+		.code = (BPF_JMP | BPF_JGT | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = TEST_OPT_LIM1,
+		.off = 8,
+	},
+	/* never taken */
+	[7] = {
+		.code = (BPF_JMP | BPF_JGT | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = TEST_OPT_LIM2,
+		.off = 11,
+	},
+	[8] = {
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_3,
+	},
+	[9] = {
+		.code = (BPF_ALU | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_4,
+		.imm = TEST_OPT_DIV,
+	},
+	[10] = {
+		.code = (EBPF_ALU64 | BPF_DIV | BPF_X),
+		.dst_reg = EBPF_REG_4,
+		.src_reg = EBPF_REG_2,
+	},
+	[11] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_4,
+	},
+	[12] = {
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_X),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_3,
+	},
+	[13] = {
+		.code = (EBPF_ALU64 | BPF_XOR | BPF_X),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_5,
+	},
+	[14] = {
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+	/* never taken */
+	[15] = {
+		.code = (BPF_JMP | EBPF_JLT | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = TEST_OPT_LIM3,
+		.off = 3,
+	},
+	[16] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_2,
+	},
+	[17] = {
+		.code = (EBPF_ALU64 | BPF_MOD | BPF_X),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_3,
+	},
+	[18] = {
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+	/* unreachable */
+	[19] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = TEST_OPT_RET,
+	},
+	[20] = {
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+static void
+test_opt1_prepare(void *arg)
+{
+	struct dummy_offset *df;
+
+	df = arg;
+	memset(df, 0, sizeof(*df));
+	df->u32 = TEST_OPT_LIM3;
+}
+
+static void
+test_opt2_prepare(void *arg)
+{
+	struct dummy_offset *df;
+
+	df = arg;
+	memset(df, 0, sizeof(*df));
+	df->u32 = TEST_OPT_LIM2 * 2 + 1;
+}
+
+static int
+test_opt1_check(uint64_t rc, const void *arg)
+{
+	uint64_t v;
+	const struct dummy_offset *dft;
+
+	dft = arg;
+	v = dft->u32;
+
+	if (v > TEST_OPT_LIM1)
+		v %= 32;
+	else
+		v = (TEST_OPT_DIV / (v + 32) + 32) ^ (UINT32_MAX >> 4);
+
+	return cmp_res(__func__, v, rc, arg, arg, 0);
+}
+
 /* all bpf test cases */
 static const struct bpf_test tests[] = {
 	{
@@ -3167,6 +3326,34 @@ static const struct bpf_test tests[] = {
 		/* mbuf as input argument is not supported on 32 bit platform */
 		.allow_fail = (sizeof(uint64_t) != sizeof(uintptr_t)),
 	},
+	{
+		.name = "test_opt1",
+		.arg_sz = sizeof(struct dummy_offset),
+		.prm = {
+			.ins = test_opt1_prog,
+			.nb_ins = RTE_DIM(test_opt1_prog),
+			.prog_arg = {
+				.type = RTE_BPF_ARG_PTR,
+				.size = sizeof(struct dummy_offset),
+			},
+		},
+		.prepare = test_opt1_prepare,
+		.check_result = test_opt1_check,
+	},
+	{
+		.name = "test_opt2",
+		.arg_sz = sizeof(struct dummy_offset),
+		.prm = {
+			.ins = test_opt1_prog,
+			.nb_ins = RTE_DIM(test_opt1_prog),
+			.prog_arg = {
+				.type = RTE_BPF_ARG_PTR,
+				.size = sizeof(struct dummy_offset),
+			},
+		},
+		.prepare = test_opt2_prepare,
+		.check_result = test_opt1_check,
+	},
 };
 
 static int
@@ -3211,6 +3398,26 @@ run_test(const struct bpf_test *tst)
 		}
 	}
 
+	/* and with burst version of jit */
+	if (jit.func_burst != NULL) {
+
+		void *ctx[] = {tbuf};
+		uint64_t rcb[RTE_DIM(ctx)];
+
+		tst->prepare(tbuf);
+		rv = (jit.func_burst(ctx, rcb, 0) != 0);
+		rv |= (jit.func_burst(ctx, rcb, RTE_DIM(ctx)) != RTE_DIM(ctx));
+		if (rv == 0)
+			rv = tst->check_result(rcb[0], tbuf);
+		ret |= rv;
+		if (rv != 0) {
+			printf("%s@%d: check_result(%s) for burst jit failed, "
+				"error: %d(%s);\n",
+				__func__, __LINE__, tst->name,
+				rv, strerror(rv));
+		}
+	}
+
 	rte_bpf_destroy(bpf);
 	return ret;
 
@@ -3233,3 +3440,287 @@ test_bpf(void)
 }
 
 REGISTER_TEST_COMMAND(bpf_autotest, test_bpf);
+
+/*
+ * cBPF to eBPF conversion tests.
+ * Convert classic BPF program with rte_bpf_convert(), then load and
+ * run the result as any other eBPF program.
+ */
+
+struct cbpf_test {
+	const char *name;
+	const struct cbpf_insn *ins;
+	uint32_t nb_ins;
+	void (*prepare)(void *);
+	int (*check_result)(uint64_t, const void *);
+};
+
+#define	TEST_CBPF_UDP_PORT	53
+#define	TEST_CBPF_UDP_RET	0x40000
+
+/* tcpdump -dd 'ip and udp dst port 53' */
+static const struct cbpf_insn test_cbpf_udp_prog[] = {
+	{ 0x28, 0, 0, 0x0000000c },	/* ldh [12] */
+	{ 0x15, 0, 8, 0x00000800 },	/* jeq #0x800 jt 2 jf 10 */
+	{ 0x30, 0, 0, 0x00000017 },	/* ldb [23] */
+	{ 0x15, 0, 6, 0x00000011 },	/* jeq #0x11 jt 4 jf 10 */
+	{ 0x28, 0, 0, 0x00000014 },	/* ldh [20] */
+	{ 0x45, 4, 0, 0x00001fff },	/* jset #0x1fff jt 10 jf 6 */
+	{ 0xb1, 0, 0, 0x0000000e },	/* ldxb 4*([14]&0xf) */
+	{ 0x48, 0, 0, 0x00000010 },	/* ldh [x + 16] */
+	{ 0x15, 0, 1, TEST_CBPF_UDP_PORT },	/* jeq #53 jt 9 jf 10 */
+	{ 0x06, 0, 0, TEST_CBPF_UDP_RET },	/* ret #262144 */
+	{ 0x06, 0, 0, 0x00000000 },	/* ret #0 */
+};
+
+/*
+ * Build ether/ipv4/udp packet split between two segments,
+ * so UDP header can't be accessed directly.
+ */
+static void
+test_cbpf_udp_prep(void *arg, uint16_t port)
+{
+	struct dummy_mbuf *dm;
+	uint8_t *p;
+	struct {
+		struct rte_ether_hdr eth;
+		struct rte_ipv4_hdr ip;
+		struct rte_udp_hdr udp;
+		uint8_t data[16];
+	} pkt;
+
+	const uint32_t seg0 = sizeof(pkt.eth) + sizeof(pkt.ip) / 2;
+
+	memset(&pkt, 0, sizeof(pkt));
+	pkt.eth.ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+	pkt.ip.version_ihl = RTE_IPV4_VHL_DEF;
+	pkt.ip.total_length = rte_cpu_to_be_16(sizeof(pkt) - sizeof(pkt.eth));
+	pkt.ip.time_to_live = IPDEFTTL;
+	pkt.ip.next_proto_id = IPPROTO_UDP;
+	pkt.udp.src_port = rte_cpu_to_be_16(port + 1);
+	pkt.udp.dst_port = rte_cpu_to_be_16(port);
+
+	dm = arg;
+	memset(dm, 0, sizeof(*dm));
+
+	dummy_mbuf_prep(&dm->mb[0], dm->buf[0], sizeof(dm->buf[0]), seg0);
+	dummy_mbuf_prep(&dm->mb[1], dm->buf[1], sizeof(dm->buf[1]),
+		sizeof(pkt) - seg0);
+	rte_pktmbuf_chain(&dm->mb[0], &dm->mb[1]);
+
+	p = (uint8_t *)&pkt;
+	memcpy(rte_pktmbuf_mtod(&dm->mb[0], void *), p, seg0);
+	memcpy(rte_pktmbuf_mtod(&dm->mb[1], void *), p + seg0,
+		sizeof(pkt) - seg0);
+}
+
+static void
+test_cbpf_udp1_prepare(void *arg)
+{
+	test_cbpf_udp_prep(arg, TEST_CBPF_UDP_PORT);
+}
+
+static int
+test_cbpf_udp1_check(uint64_t rc, const void *arg)
+{
+	return cmp_res(__func__, TEST_CBPF_UDP_RET, rc, arg, arg, 0);
+}
+
+static void
+test_cbpf_udp2_prepare(void *arg)
+{
+	test_cbpf_udp_prep(arg, TEST_CBPF_UDP_PORT + 1);
+}
+
+static int
+test_cbpf_udp2_check(uint64_t rc, const void *arg)
+{
+	return cmp_res(__func__, 0, rc, arg, arg, 0);
+}
+
+#define	TEST_CBPF_ALU_MEM	3
+#define	TEST_CBPF_ALU_JGT	0xfffffff0
+
+/*
+ * exercise packet length, scratch memory, X register,
+ * arithmetic and jump with 'negative' constant.
+ */
+static const struct cbpf_insn test_cbpf_alu_prog[] = {
+	{ BPF_LD | BPF_W | BPF_LEN, 0, 0, 0 },
+	{ BPF_ST, 0, 0, TEST_CBPF_ALU_MEM },
+	{ BPF_LD | BPF_W | BPF_IMM, 0, 0, 10 },
+	{ BPF_LDX | BPF_W | BPF_IMM, 0, 0, 5 },
+	{ BPF_ALU | BPF_ADD | BPF_X, 0, 0, 0 },
+	{ BPF_ALU | BPF_MUL | BPF_K, 0, 0, 3 },
+	{ BPF_MISC | BPF_TAX, 0, 0, 0 },
+	{ BPF_LD | BPF_W | BPF_MEM, 0, 0, TEST_CBPF_ALU_MEM },
+	{ BPF_ALU | BPF_SUB | BPF_X, 0, 0, 0 },
+	{ BPF_JMP | BPF_JGT | BPF_K, 2, 0, TEST_CBPF_ALU_JGT },
+	{ BPF_ALU | BPF_RSH | BPF_K, 0, 0, 1 },
+	{ BPF_RET | BPF_A, 0, 0, 0 },
+	{ BPF_RET | BPF_K, 0, 0, 1 },
+};
+
+static uint64_t
+test_cbpf_alu(const struct rte_mbuf *mb)
+{
+	uint32_t v;
+
+	v = mb->pkt_len - (10 + 5) * 3;
+	if (v > TEST_CBPF_ALU_JGT)
+		return 1;
+	return v >> 1;
+}
+
+static void
+test_cbpf_alu1_prepare(void *arg)
+{
+	test_ld_mbuf1_prepare(arg);
+}
+
+static void
+test_cbpf_alu2_prepare(void *arg)
+{
+	struct dummy_mbuf *dm;
+
+	dm = arg;
+	memset(dm, 0, sizeof(*dm));
+	dummy_mbuf_prep(&dm->mb[0], dm->buf[0], sizeof(dm->buf[0]), 40);
+}
+
+static int
+test_cbpf_alu_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_mbuf *dm;
+
+	dm = arg;
+	return cmp_res(__func__, test_cbpf_alu(dm->mb), rc, arg, arg, 0);
+}
+
+static const struct cbpf_test cbpf_tests[] = {
+	{
+		.name = "test_cbpf_udp1",
+		.ins = test_cbpf_udp_prog,
+		.nb_ins = RTE_DIM(test_cbpf_udp_prog),
+		.prepare = test_cbpf_udp1_prepare,
+		.check_result = test_cbpf_udp1_check,
+	},
+	{
+		.name = "test_cbpf_udp2",
+		.ins = test_cbpf_udp_prog,
+		.nb_ins = RTE_DIM(test_cbpf_udp_prog),
+		.prepare = test_cbpf_udp2_prepare,
+		.check_result = test_cbpf_udp2_check,
+	},
+	{
+		.name = "test_cbpf_alu1",
+		.ins = test_cbpf_alu_prog,
+		.nb_ins = RTE_DIM(test_cbpf_alu_prog),
+		.prepare = test_cbpf_alu1_prepare,
+		.check_result = test_cbpf_alu_check,
+	},
+	{
+		.name = "test_cbpf_alu2",
+		.ins = test_cbpf_alu_prog,
+		.nb_ins = RTE_DIM(test_cbpf_alu_prog),
+		.prepare = test_cbpf_alu2_prepare,
+		.check_result = test_cbpf_alu_check,
+	},
+};
+
+/* malformed or unsupported cBPF programs, conversion should fail */
+static const struct cbpf_insn test_cbpf_inval1_prog[] = {
+	{ BPF_LD | BPF_W | BPF_IMM, 0, 0, 0 },
+};
+
+static const struct cbpf_insn test_cbpf_inval2_prog[] = {
+	{ BPF_JMP | BPF_JA, 0, 0, 1 },
+	{ BPF_RET | BPF_K, 0, 0, 0 },
+};
+
+static const struct cbpf_insn test_cbpf_inval3_prog[] = {
+	{ BPF_ALU | BPF_DIV | BPF_K, 0, 0, 0 },
+	{ BPF_RET | BPF_K, 0, 0, 0 },
+};
+
+static const struct cbpf_insn test_cbpf_inval4_prog[] = {
+	/* linux ancillary load: ld #len via SKF_AD_OFF */
+	{ BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)-0x1000 },
+	{ BPF_RET | BPF_A, 0, 0, 0 },
+};
+
+static const struct cbpf_insn test_cbpf_inval5_prog[] = {
+	{ BPF_LD | BPF_W | BPF_MEM, 0, 0, BPF_MEMWORDS },
+	{ BPF_RET | BPF_A, 0, 0, 0 },
+};
+
+static const struct {
+	const struct cbpf_insn *ins;
+	uint32_t nb_ins;
+} cbpf_inval_tests[] = {
+	{ test_cbpf_inval1_prog, 0 },
+	{ test_cbpf_inval1_prog, RTE_DIM(test_cbpf_inval1_prog) },
+	{ test_cbpf_inval2_prog, RTE_DIM(test_cbpf_inval2_prog) },
+	{ test_cbpf_inval3_prog, RTE_DIM(test_cbpf_inval3_prog) },
+	{ test_cbpf_inval4_prog, RTE_DIM(test_cbpf_inval4_prog) },
+	{ test_cbpf_inval5_prog, RTE_DIM(test_cbpf_inval5_prog) },
+};
+
+static int
+run_cbpf_test(const struct cbpf_test *ctst)
+{
+	int32_t ret;
+	struct rte_bpf_prm *prm;
+	struct bpf_test tst;
+
+	prm = rte_bpf_convert(ctst->ins, ctst->nb_ins);
+	if (prm == NULL) {
+		printf("%s@%d: failed to convert cBPF code, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	memset(&tst, 0, sizeof(tst));
+	tst.name = ctst->name;
+	tst.arg_sz = sizeof(struct dummy_mbuf);
+	tst.prm = *prm;
+	tst.prepare = ctst->prepare;
+	tst.check_result = ctst->check_result;
+
+	ret = run_test(&tst);
+	rte_free(prm);
+	return ret;
+}
+
+static int
+test_bpf_convert(void)
+{
+	int32_t rc;
+	uint32_t i;
+	struct rte_bpf_prm *prm;
+
+	/* mbuf as input argument is not supported on 32 bit platform */
+	if (sizeof(uint64_t) != sizeof(uintptr_t))
+		return TEST_SKIPPED;
+
+	rc = 0;
+	for (i = 0; i != RTE_DIM(cbpf_tests); i++)
+		rc |= run_cbpf_test(cbpf_tests + i);
+
+	for (i = 0; i != RTE_DIM(cbpf_inval_tests); i++) {
+		rte_errno = 0;
+		prm = rte_bpf_convert(cbpf_inval_tests[i].ins,
+			cbpf_inval_tests[i].nb_ins);
+		if (prm != NULL || rte_errno == 0) {
+			printf("%s@%d: invalid cBPF program #%u "
+				"converted successfully;\n",
+				__func__, __LINE__, i);
+			rte_free(prm);
+			rc |= -1;
+		}
+	}
+
+	return rc;
+}
+
+REGISTER_TEST_COMMAND(bpf_convert_autotest, test_bpf_convert);
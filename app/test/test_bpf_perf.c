@@ -0,0 +1,428 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_bpf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+
+#include "test.h"
+
+/*
+ * BPF micro-benchmark: run typical packet parsers over a burst of packets,
+ * both with interpreter and JIT (when available), report time per packet.
+ */
+
+#define	PERF_BURST_SIZE	32
+#define	PERF_ITERATIONS	(1 << 16)
+#define	PERF_NB_MBUF	(2 * PERF_BURST_SIZE)
+#define	PERF_UDP_PORT	53
+
+struct bpf_perf_prog {
+	const char *name;
+	const struct ebpf_insn *ins;
+	uint32_t nb_ins;
+	const struct cbpf_insn *cins;
+	uint32_t nb_cins;
+};
+
+/* tcpdump -dd 'ip and udp dst port 53' */
+static const struct cbpf_insn perf_cbpf_udp_prog[] = {
+	{ 0x28, 0, 0, 0x0000000c },
+	{ 0x15, 0, 8, 0x00000800 },
+	{ 0x30, 0, 0, 0x00000017 },
+	{ 0x15, 0, 6, 0x00000011 },
+	{ 0x28, 0, 0, 0x00000014 },
+	{ 0x45, 4, 0, 0x00001fff },
+	{ 0xb1, 0, 0, 0x0000000e },
+	{ 0x48, 0, 0, 0x00000010 },
+	{ 0x15, 0, 1, PERF_UDP_PORT },
+	{ 0x06, 0, 0, 0x00040000 },
+	{ 0x06, 0, 0, 0x00000000 },
+};
+
+#define	PERF_L2_LEN	sizeof(struct rte_ether_hdr)
+#define	PERF_L3_LEN	sizeof(struct rte_ipv4_hdr)
+#define	PERF_L4_LEN	sizeof(struct rte_udp_hdr)
+
+/*
+ * same filter written directly in eBPF, the way a header parser usually
+ * looks like: packet length is checked again before each header access.
+ */
+static const struct ebpf_insn perf_ebpf_udp_prog[] = {
+	/* BPF_ABS/BPF_IND implicitly expect mbuf ptr in R6 */
+	[0] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_6,
+		.src_reg = EBPF_REG_1,
+	},
+	[1] = {
+		.code = (BPF_LDX | BPF_MEM | BPF_W),
+		.dst_reg = EBPF_REG_7,
+		.src_reg = EBPF_REG_6,
+		.off = offsetof(struct rte_mbuf, pkt_len),
+	},
+	[2] = {
+		.code = (BPF_JMP | EBPF_JLT | BPF_K),
+		.dst_reg = EBPF_REG_7,
+		.imm = PERF_L2_LEN,
+		.off = 20,
+	},
+	[3] = {
+		.code = (BPF_LD | BPF_ABS | BPF_H),
+		.imm = offsetof(struct rte_ether_hdr, ether_type),
+	},
+	[4] = {
+		.code = (BPF_JMP | EBPF_JNE | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = RTE_ETHER_TYPE_IPV4,
+		.off = 18,
+	},
+	[5] = {
+		.code = (BPF_JMP | EBPF_JLT | BPF_K),
+		.dst_reg = EBPF_REG_7,
+		.imm = PERF_L2_LEN + PERF_L3_LEN,
+		.off = 17,
+	},
+	[6] = {
+		.code = (BPF_LD | BPF_ABS | BPF_B),
+		.imm = PERF_L2_LEN + offsetof(struct rte_ipv4_hdr, version_ihl),
+	},
+	[7] = {
+		.code = (BPF_ALU | BPF_AND | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = RTE_IPV4_HDR_IHL_MASK,
+	},
+	[8] = {
+		.code = (BPF_ALU | BPF_LSH | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = 2,
+	},
+	[9] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_8,
+		.src_reg = EBPF_REG_0,
+	},
+	/* IP options are not supported */
+	[10] = {
+		.code = (BPF_JMP | EBPF_JNE | BPF_K),
+		.dst_reg = EBPF_REG_8,
+		.imm = PERF_L3_LEN,
+		.off = 12,
+	},
+	[11] = {
+		.code = (BPF_JMP | EBPF_JLT | BPF_K),
+		.dst_reg = EBPF_REG_7,
+		.imm = PERF_L2_LEN + PERF_L3_LEN,
+		.off = 11,
+	},
+	[12] = {
+		.code = (BPF_LD | BPF_ABS | BPF_B),
+		.imm = PERF_L2_LEN + offsetof(struct rte_ipv4_hdr,
+			next_proto_id),
+	},
+	[13] = {
+		.code = (BPF_JMP | EBPF_JNE | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = IPPROTO_UDP,
+		.off = 9,
+	},
+	[14] = {
+		.code = (BPF_LD | BPF_ABS | BPF_H),
+		.imm = PERF_L2_LEN + offsetof(struct rte_ipv4_hdr,
+			fragment_offset),
+	},
+	[15] = {
+		.code = (BPF_JMP | BPF_JSET | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = RTE_IPV4_HDR_OFFSET_MASK | RTE_IPV4_HDR_MF_FLAG,
+		.off = 7,
+	},
+	[16] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_9,
+		.src_reg = EBPF_REG_8,
+	},
+	[17] = {
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_9,
+		.imm = PERF_L2_LEN + PERF_L4_LEN,
+	},
+	[18] = {
+		.code = (BPF_JMP | BPF_JGT | BPF_X),
+		.dst_reg = EBPF_REG_9,
+		.src_reg = EBPF_REG_7,
+		.off = 4,
+	},
+	[19] = {
+		.code = (BPF_LD | BPF_IND | BPF_H),
+		.src_reg = EBPF_REG_8,
+		.imm = PERF_L2_LEN + offsetof(struct rte_udp_hdr, dst_port),
+	},
+	[20] = {
+		.code = (BPF_JMP | EBPF_JNE | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = PERF_UDP_PORT,
+		.off = 2,
+	},
+	[21] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = 1,
+	},
+	[22] = {
+		.code = (BPF_JMP | BPF_JA),
+		.off = 1,
+	},
+	/* drop */
+	[23] = {
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = 0,
+	},
+	[24] = {
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+static const struct bpf_perf_prog perf_progs[] = {
+	{
+		.name = "cBPF 'ip and udp dst port 53'",
+		.cins = perf_cbpf_udp_prog,
+		.nb_cins = RTE_DIM(perf_cbpf_udp_prog),
+	},
+	{
+		.name = "eBPF ipv4/udp parser",
+		.ins = perf_ebpf_udp_prog,
+		.nb_ins = RTE_DIM(perf_ebpf_udp_prog),
+	},
+};
+
+/* half of the packets are expected to match */
+static void
+perf_pkt_prep(struct rte_mbuf *mb, uint32_t i)
+{
+	uint16_t plen;
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_udp_hdr *udp;
+
+	plen = PERF_L3_LEN + PERF_L4_LEN + 64;
+
+	rte_pktmbuf_reset(mb);
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(mb,
+		PERF_L2_LEN + plen);
+	memset(eth, 0, PERF_L2_LEN + plen);
+
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	udp = (struct rte_udp_hdr *)(ip + 1);
+
+	eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+	ip->version_ihl = RTE_IPV4_VHL_DEF;
+	ip->total_length = rte_cpu_to_be_16(plen);
+	ip->time_to_live = IPDEFTTL;
+	ip->next_proto_id = IPPROTO_UDP;
+	udp->src_port = rte_cpu_to_be_16(1024 + i);
+	udp->dst_port = rte_cpu_to_be_16((i & 1) ? PERF_UDP_PORT :
+		PERF_UDP_PORT + 1 + i);
+	udp->dgram_len = rte_cpu_to_be_16(plen - PERF_L3_LEN);
+}
+
+static uint64_t
+perf_run_exec(const struct rte_bpf *bpf, struct rte_mbuf *mb[],
+	uint64_t *cycles)
+{
+	uint32_t i, j;
+	uint64_t n, tm;
+	uint64_t rc[PERF_BURST_SIZE];
+
+	n = 0;
+	tm = rte_rdtsc_precise();
+	for (i = 0; i != PERF_ITERATIONS; i++) {
+		rte_bpf_exec_burst(bpf, (void **)mb, rc, PERF_BURST_SIZE);
+		for (j = 0; j != PERF_BURST_SIZE; j++)
+			n += (rc[j] != 0);
+	}
+	*cycles = rte_rdtsc_precise() - tm;
+	return n;
+}
+
+static uint64_t
+perf_run_jit(const struct rte_bpf_jit *jit, struct rte_mbuf *mb[],
+	uint64_t *cycles)
+{
+	uint32_t i, j;
+	uint64_t n, tm;
+
+	n = 0;
+	tm = rte_rdtsc_precise();
+	for (i = 0; i != PERF_ITERATIONS; i++) {
+		for (j = 0; j != PERF_BURST_SIZE; j++)
+			n += (jit->func(mb[j]) != 0);
+	}
+	*cycles = rte_rdtsc_precise() - tm;
+	return n;
+}
+
+static uint64_t
+perf_run_jit_burst(const struct rte_bpf_jit *jit, struct rte_mbuf *mb[],
+	uint64_t *cycles)
+{
+	uint32_t i, j;
+	uint64_t n, tm;
+	uint64_t rc[PERF_BURST_SIZE];
+
+	n = 0;
+	tm = rte_rdtsc_precise();
+	for (i = 0; i != PERF_ITERATIONS; i++) {
+		jit->func_burst((void **)mb, rc, PERF_BURST_SIZE);
+		for (j = 0; j != PERF_BURST_SIZE; j++)
+			n += (rc[j] != 0);
+	}
+	*cycles = rte_rdtsc_precise() - tm;
+	return n;
+}
+
+static void
+perf_report(const char *name, const char *mode, uint64_t cycles,
+	uint64_t n)
+{
+	double cpp, hz;
+
+	hz = rte_get_tsc_hz();
+	cpp = (double)cycles / ((uint64_t)PERF_ITERATIONS * PERF_BURST_SIZE);
+
+	printf("%-32s %-8s %10.2f cycles/pkt %10.2f ns/pkt, matched: %"
+		PRIu64 "\n", name, mode, cpp, cpp * 1E9 / hz, n);
+}
+
+static int
+perf_run_prog(const struct bpf_perf_prog *pp, struct rte_mbuf *mb[])
+{
+	int32_t rc;
+	uint64_t cycles, ne, nj;
+	struct rte_bpf *bpf;
+	struct rte_bpf_prm *cprm;
+	struct rte_bpf_jit jit;
+	struct rte_bpf_prm prm;
+
+	cprm = NULL;
+	if (pp->cins != NULL) {
+		cprm = rte_bpf_convert(pp->cins, pp->nb_cins);
+		if (cprm == NULL) {
+			printf("%s@%d: failed to convert cBPF code, "
+				"error=%d(%s);\n",
+				__func__, __LINE__, rte_errno,
+				strerror(rte_errno));
+			return -1;
+		}
+		prm = *cprm;
+	} else {
+		memset(&prm, 0, sizeof(prm));
+		prm.ins = pp->ins;
+		prm.nb_ins = pp->nb_ins;
+		prm.prog_arg.type = RTE_BPF_ARG_PTR_MBUF;
+		prm.prog_arg.size = sizeof(struct rte_mbuf);
+		prm.prog_arg.buf_size = RTE_MBUF_DEFAULT_BUF_SIZE;
+	}
+
+	bpf = rte_bpf_load(&prm);
+	rte_free(cprm);
+	if (bpf == NULL) {
+		printf("%s@%d: failed to load bpf code, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	rc = 0;
+	ne = perf_run_exec(bpf, mb, &cycles);
+	perf_report(pp->name, "exec", cycles, ne);
+
+	rte_bpf_get_jit(bpf, &jit);
+	if (jit.func != NULL) {
+		nj = perf_run_jit(&jit, mb, &cycles);
+		perf_report(pp->name, "jit", cycles, nj);
+		if (nj != ne) {
+			printf("%s@%d: %s: JIT and interpreter results differ;\n",
+				__func__, __LINE__, pp->name);
+			rc = -1;
+		}
+	}
+
+	if (jit.func_burst != NULL) {
+		nj = perf_run_jit_burst(&jit, mb, &cycles);
+		perf_report(pp->name, "jit-bulk", cycles, nj);
+		if (nj != ne) {
+			printf("%s@%d: %s: burst JIT and interpreter "
+				"results differ;\n",
+				__func__, __LINE__, pp->name);
+			rc = -1;
+		}
+	}
+
+	/* every odd packet should match */
+	if (ne != (uint64_t)PERF_ITERATIONS * PERF_BURST_SIZE / 2) {
+		printf("%s@%d: %s: unexpected number of matches: %" PRIu64
+			";\n", __func__, __LINE__, pp->name, ne);
+		rc = -1;
+	}
+
+	rte_bpf_destroy(bpf);
+	return rc;
+}
+
+static int
+test_bpf_perf(void)
+{
+	int32_t rc;
+	uint32_t i;
+	struct rte_mempool *mp;
+	struct rte_mbuf *mb[PERF_BURST_SIZE];
+
+	/* mbuf as input argument is not supported on 32 bit platform */
+	if (sizeof(uint64_t) != sizeof(uintptr_t))
+		return TEST_SKIPPED;
+
+	mp = rte_pktmbuf_pool_create("bpf_perf_pool", PERF_NB_MBUF, 0, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (mp == NULL) {
+		printf("%s@%d: failed to create mbuf pool, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	rc = rte_pktmbuf_alloc_bulk(mp, mb, RTE_DIM(mb));
+	if (rc != 0) {
+		printf("%s@%d: failed to allocate mbufs, error=%d;\n",
+			__func__, __LINE__, rc);
+		rte_mempool_free(mp);
+		return -1;
+	}
+
+	for (i = 0; i != RTE_DIM(mb); i++)
+		perf_pkt_prep(mb[i], i);
+
+	printf("%u iterations of %u packets bursts:\n",
+		PERF_ITERATIONS, PERF_BURST_SIZE);
+
+	for (i = 0; i != RTE_DIM(perf_progs); i++)
+		rc |= perf_run_prog(perf_progs + i, mb);
+
+	rte_pktmbuf_free_bulk(mb, RTE_DIM(mb));
+	rte_mempool_free(mp);
+	return rc;
+}
+
+REGISTER_TEST_COMMAND(bpf_perf_autotest, test_bpf_perf);
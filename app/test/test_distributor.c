@@ -563,6 +563,31 @@ int test_error_distributor_create_numworkers(void)
 }
 
 
+static
+int test_error_distributor_flow_mode(struct rte_distributor *ds,
+		struct rte_distributor *db)
+{
+	if (rte_distributor_flow_mode_set(NULL,
+			RTE_DIST_FLOW_AFFINITY) != -EINVAL) {
+		printf("ERROR: No error on flow_mode_set() with NULL param\n");
+		return -1;
+	}
+
+	if (rte_distributor_flow_mode_set(db,
+			(enum rte_distributor_flow_mode)2) != -EINVAL) {
+		printf("ERROR: No error on flow_mode_set() with invalid mode\n");
+		return -1;
+	}
+
+	if (rte_distributor_flow_mode_set(ds,
+			RTE_DIST_FLOW_AFFINITY) != -ENOTSUP) {
+		printf("ERROR: No error on flow_mode_set() in single mode\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 /* Useful function which ensures that all worker functions terminate */
 static void
 quit_workers(struct worker_params *wp, struct rte_mempool *p)
@@ -593,7 +618,11 @@ test_distributor(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
-	static struct rte_distributor *dist[2];
+	static struct rte_distributor *dba;
+	static struct rte_distributor *dist[3];
+	static const char * const names[3] = {
+		"single", "burst", "burst flow affinity"
+	};
 	static struct rte_mempool *p;
 	int i;
 
@@ -629,6 +658,25 @@ test_distributor(void)
 		rte_distributor_clear_returns(ds);
 	}
 
+	if (dba == NULL) {
+		dba = rte_distributor_create("Test_dist_affinity",
+				rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST);
+		if (dba == NULL) {
+			printf("Error creating flow affinity distributor\n");
+			return -1;
+		}
+		if (rte_distributor_flow_mode_set(dba,
+				RTE_DIST_FLOW_AFFINITY) != 0) {
+			printf("Error setting flow affinity mode\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(dba);
+		rte_distributor_clear_returns(dba);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -642,16 +690,13 @@ test_distributor(void)
 
 	dist[0] = ds;
 	dist[1] = db;
+	dist[2] = dba;
 
-	for (i = 0; i < 2; i++) {
+	for (i = 0; i < 3; i++) {
 
 		worker_params.dist = dist[i];
-		if (i)
-			strlcpy(worker_params.name, "burst",
-					sizeof(worker_params.name));
-		else
-			strlcpy(worker_params.name, "single",
-					sizeof(worker_params.name));
+		strlcpy(worker_params.name, names[i],
+				sizeof(worker_params.name));
 
 		rte_eal_mp_remote_launch(handle_work,
 				&worker_params, SKIP_MASTER);
@@ -694,6 +739,11 @@ test_distributor(void)
 		return -1;
 	}
 
+	if (test_error_distributor_flow_mode(ds, db) == -1) {
+		printf("rte_distributor_flow_mode_set parameter check tests failed");
+		return -1;
+	}
+
 	return 0;
 
 err:
@@ -205,6 +205,7 @@ test_distributor_perf(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
+	static struct rte_distributor *dba;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -239,6 +240,24 @@ test_distributor_perf(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (dba == NULL) {
+		dba = rte_distributor_create("Test_burst_affinity",
+				rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST);
+		if (dba == NULL) {
+			printf("Error creating flow affinity distributor\n");
+			return -1;
+		}
+		if (rte_distributor_flow_mode_set(dba,
+				RTE_DIST_FLOW_AFFINITY) != 0) {
+			printf("Error setting flow affinity mode\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_clear_returns(dba);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -262,6 +281,12 @@ test_distributor_perf(void)
 		return -1;
 	quit_workers(db, p);
 
+	printf("=== Performance test of distributor (burst flow affinity mode) ===\n");
+	rte_eal_mp_remote_launch(handle_work, dba, SKIP_MASTER);
+	if (perf_test(dba, p) < 0)
+		return -1;
+	quit_workers(dba, p);
+
 	return 0;
 }
 
@@ -738,6 +738,38 @@ test_crypto_adapter_qp_add_del(void)
 	return TEST_SUCCESS;
 }
 
+static int
+test_crypto_adapter_batch_conf(void)
+{
+	struct rte_event_crypto_adapter_batch_conf conf = {
+		.max_burst = 64,
+		.max_latency_us = 100,
+	};
+	int ret;
+
+	ret = rte_event_crypto_adapter_batch_conf_set(TEST_ADAPTER_ID, NULL);
+	TEST_ASSERT(ret == -EINVAL, "Expected -EINVAL for NULL conf\n");
+
+	ret = rte_event_crypto_adapter_batch_conf_set(TEST_ADAPTER_ID + 1,
+						      &conf);
+	TEST_ASSERT(ret == -EINVAL, "Expected -EINVAL for invalid adapter\n");
+
+	ret = rte_event_crypto_adapter_batch_conf_set(TEST_ADAPTER_ID, &conf);
+	TEST_ASSERT_SUCCESS(ret, "Failed to set batching policy\n");
+
+	conf.max_burst = RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST + 1;
+	ret = rte_event_crypto_adapter_batch_conf_set(TEST_ADAPTER_ID, &conf);
+	TEST_ASSERT(ret == -EINVAL, "Expected -EINVAL for max_burst %u\n",
+		    conf.max_burst);
+
+	/* zero burst size selects the default */
+	conf.max_burst = 0;
+	ret = rte_event_crypto_adapter_batch_conf_set(TEST_ADAPTER_ID, &conf);
+	TEST_ASSERT_SUCCESS(ret, "Failed to set default burst size\n");
+
+	return TEST_SUCCESS;
+}
+
 static int
 configure_event_crypto_adapter(enum rte_event_crypto_adapter_mode mode)
 {
@@ -949,6 +981,10 @@ static struct unit_test_suite functional_testsuite = {
 				test_crypto_adapter_free,
 				test_crypto_adapter_stats),
 
+		TEST_CASE_ST(test_crypto_adapter_create,
+				test_crypto_adapter_free,
+				test_crypto_adapter_batch_conf),
+
 		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
 				test_crypto_adapter_stop,
 				test_session_with_op_forward_mode),
@@ -676,6 +676,86 @@ adapter_stats(void)
 	return TEST_SUCCESS;
 }
 
+static int
+adapter_idle_conf(void)
+{
+	int err;
+	uint32_t i;
+	uint32_t service_id;
+	struct rte_event ev;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event_eth_rx_adapter_idle_conf idle_conf;
+	struct rte_event_eth_rx_adapter_idle_stats idle_stats;
+	struct rte_event_eth_rx_adapter_stats stats;
+
+	memset(&idle_conf, 0, sizeof(idle_conf));
+	idle_conf.empty_polls = 1;
+	idle_conf.max_sleep_us = 10;
+
+	err = rte_event_eth_rx_adapter_idle_conf_set(TEST_INST_ID, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_idle_conf_set(1, &idle_conf);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	idle_conf.flags = ~RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR;
+	err = rte_event_eth_rx_adapter_idle_conf_set(TEST_INST_ID,
+						&idle_conf);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	idle_conf.flags = RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR;
+	err = rte_event_eth_rx_adapter_idle_conf_set(TEST_INST_ID,
+						&idle_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	if (default_params.caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)
+		return TEST_SUCCESS;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+
+	queue_config.rx_queue_flags = 0;
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+					-1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_service_id_get(TEST_INST_ID,
+						&service_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* the Rx queues stay empty, so the service function backs off */
+	for (i = 0; i < 64; i++)
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+
+	err = rte_event_eth_rx_adapter_stats_get(TEST_INST_ID, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_idle_stats_get(TEST_INST_ID, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_idle_stats_get(TEST_INST_ID,
+						&idle_stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	if (stats.rx_packets == 0)
+		TEST_ASSERT(idle_stats.idle_cycles != 0,
+			"Expected non-zero idle cycles");
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite event_eth_rx_tests = {
 	.suite_name = "rx event eth adapter test suite",
 	.setup = testsuite_setup,
@@ -688,6 +768,7 @@ static struct unit_test_suite event_eth_rx_tests = {
 					adapter_multi_eth_add_del),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_start_stop),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_stats),
+		TEST_CASE_ST(adapter_create, adapter_free, adapter_idle_conf),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
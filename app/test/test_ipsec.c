@@ -104,6 +104,12 @@ static const struct ipsec_test_cfg test_cfg[] = {
 	{REPLAY_WIN_128, ESN_ENABLED, RTE_IPSEC_SAFLAG_SQN_ATOM,
 		DATA_80_BYTES, 1, 0},
 	{REPLAY_WIN_256, ESN_DISABLED, 0, DATA_100_BYTES, 1, 0},
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+	{REPLAY_WIN_128, ESN_ENABLED, RTE_IPSEC_SAFLAG_SQN_MT,
+		DATA_80_BYTES, BURST_SIZE, REORDER_PKTS},
+	{REPLAY_WIN_256, ESN_DISABLED, RTE_IPSEC_SAFLAG_SQN_MT,
+		DATA_100_BYTES, 1, 0},
+#endif
 };
 
 static const int num_cfg = RTE_DIM(test_cfg);
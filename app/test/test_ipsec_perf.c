@@ -18,12 +18,18 @@
 #define BURST_SIZE	64
 #define NUM_MBUF	4095
 #define DEFAULT_SPI     7
+#define MAX_NB_SA	8
+#define MT_REPLAY_WIN	1024
+#define MT_DURATION	2
 
 struct ipsec_test_cfg {
 	uint32_t replay_win_sz;
 	uint32_t esn;
 	uint64_t flags;
 	enum rte_crypto_sym_xform_type type;
+	uint32_t pkt_len;
+	/* each burst is split evenly between that many SAs */
+	uint32_t nb_sa;
 };
 
 struct rte_mempool *mbuf_pool, *cop_pool;
@@ -53,13 +59,41 @@ struct ipsec_sa {
 };
 
 static const struct ipsec_test_cfg test_cfg[] = {
-	{0, 0, 0, RTE_CRYPTO_SYM_XFORM_AEAD},
-	{0, 0, 0, RTE_CRYPTO_SYM_XFORM_CIPHER},
-	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_AEAD},
-	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_CIPHER},
+	{0, 0, 0, RTE_CRYPTO_SYM_XFORM_AEAD, 64, 1},
+	{0, 0, 0, RTE_CRYPTO_SYM_XFORM_CIPHER, 64, 1},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_AEAD, 64, 1},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_CIPHER, 64, 1},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_AEAD, 1400, 1},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_CIPHER, 1400, 1},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_AEAD, 64, MAX_NB_SA},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_CIPHER, 64, MAX_NB_SA},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_AEAD, 1400, MAX_NB_SA},
+	{128, 1, 0, RTE_CRYPTO_SYM_XFORM_CIPHER, 1400, MAX_NB_SA},
+};
 
+/*
+ * Single SA shared by multiple lcores,
+ * uses lock-free replay window (RTE_IPSEC_SAFLAG_SQN_MT).
+ */
+static const struct ipsec_test_cfg mt_test_cfg = {
+	MT_REPLAY_WIN, 1, RTE_IPSEC_SAFLAG_SQN_MT,
+	RTE_CRYPTO_SYM_XFORM_AEAD, 64, 1,
 };
 
+struct mt_worker {
+	struct ipsec_sa *sa_out;
+	struct ipsec_sa *sa_in;
+	uint32_t pkt_len;
+	uint64_t nb_pkt;
+	uint64_t nb_drop;
+	uint64_t ticks_elapsed;
+	struct rte_mbuf *mb[BURST_SIZE];
+	struct rte_crypto_op *cop[BURST_SIZE];
+} __rte_cache_aligned;
+
+static struct mt_worker mt_worker[RTE_MAX_LCORE];
+static uint32_t mt_stop;
+
 static struct rte_ipv4_hdr ipv4_outer  = {
 	.version_ihl = IPVERSION << 4 |
 		sizeof(ipv4_outer) / RTE_IPV4_IHL_MULTIPLIER,
@@ -316,13 +350,50 @@ packet_process(struct rte_mbuf **buf, struct ipsec_sa *sa,
 	return k;
 }
 
+/*
+ * Split the burst into groups of *grp_sz* packets,
+ * each group is handled by the next SA.
+ */
+static int
+burst_prepare(struct rte_mbuf **buf, struct ipsec_sa sa[],
+	      uint16_t num_pkts, uint16_t grp_sz)
+{
+	uint16_t i, k, n;
+
+	for (i = 0, k = 0; k != num_pkts; i++, k += n) {
+		n = RTE_MIN(num_pkts - k, grp_sz);
+		if (packet_prepare(buf + k, &sa[i], n) != n)
+			return k;
+	}
+
+	return k;
+}
+
+static int
+burst_process(struct rte_mbuf **buf, struct ipsec_sa sa[],
+	      uint16_t num_pkts, uint16_t grp_sz)
+{
+	uint16_t i, k, n;
+
+	for (i = 0, k = 0; k != num_pkts; i++, k += n) {
+		n = RTE_MIN(num_pkts - k, grp_sz);
+		if (packet_process(buf + k, &sa[i], n) != n)
+			return k;
+	}
+
+	return k;
+}
+
 static int
-create_traffic(struct ipsec_sa *sa, struct rte_ring *deq_ring,
-	       struct rte_ring *enq_ring, struct rte_ring *ring)
+create_traffic(struct ipsec_sa sa[], uint32_t nb_sa,
+	       struct rte_ring *deq_ring, struct rte_ring *enq_ring,
+	       struct rte_ring *ring)
 {
 	struct rte_mbuf *mbuf[BURST_SIZE];
 	uint16_t num_pkts, n;
 
+	const uint16_t grp_sz = BURST_SIZE / nb_sa;
+
 	while (rte_ring_empty(deq_ring) == 0) {
 
 		num_pkts = rte_ring_sc_dequeue_burst(deq_ring, (void **)mbuf,
@@ -331,7 +402,7 @@ create_traffic(struct ipsec_sa *sa, struct rte_ring *deq_ring,
 		if (num_pkts == 0)
 			return TEST_FAILED;
 
-		n = packet_prepare(mbuf, sa, num_pkts);
+		n = burst_prepare(mbuf, sa, num_pkts, grp_sz);
 		if (n != num_pkts)
 			return TEST_FAILED;
 
@@ -351,7 +422,7 @@ create_traffic(struct ipsec_sa *sa, struct rte_ring *deq_ring,
 		if (num_pkts == 0)
 			return TEST_FAILED;
 
-		n = packet_process(mbuf, sa, num_pkts);
+		n = burst_process(mbuf, sa, num_pkts, grp_sz);
 		if (n != num_pkts)
 			return TEST_FAILED;
 
@@ -366,9 +437,9 @@ create_traffic(struct ipsec_sa *sa, struct rte_ring *deq_ring,
 
 static void
 fill_ipsec_sa_out(const struct ipsec_test_cfg *test_cfg,
-		  struct ipsec_sa *sa)
+		  struct ipsec_sa *sa, uint32_t spi)
 {
-	sa->ipsec_xform.spi = DEFAULT_SPI;
+	sa->ipsec_xform.spi = spi;
 	sa->ipsec_xform.direction = RTE_SECURITY_IPSEC_SA_DIR_EGRESS;
 	sa->ipsec_xform.proto = RTE_SECURITY_IPSEC_SA_PROTO_ESP;
 	sa->ipsec_xform.mode = RTE_SECURITY_IPSEC_SA_MODE_TUNNEL;
@@ -388,9 +459,9 @@ fill_ipsec_sa_out(const struct ipsec_test_cfg *test_cfg,
 
 static void
 fill_ipsec_sa_in(const struct ipsec_test_cfg *test_cfg,
-		  struct ipsec_sa *sa)
+		  struct ipsec_sa *sa, uint32_t spi)
 {
-	sa->ipsec_xform.spi = DEFAULT_SPI;
+	sa->ipsec_xform.spi = spi;
 	sa->ipsec_xform.direction = RTE_SECURITY_IPSEC_SA_DIR_INGRESS;
 	sa->ipsec_xform.proto = RTE_SECURITY_IPSEC_SA_PROTO_ESP;
 	sa->ipsec_xform.mode = RTE_SECURITY_IPSEC_SA_MODE_TUNNEL;
@@ -409,13 +480,13 @@ fill_ipsec_sa_in(const struct ipsec_test_cfg *test_cfg,
 
 static int
 init_sa_session(const struct ipsec_test_cfg *test_cfg,
-		struct ipsec_sa *sa_out, struct ipsec_sa *sa_in)
+		struct ipsec_sa *sa_out, struct ipsec_sa *sa_in, uint32_t spi)
 {
 
 	int rc;
 
-	fill_ipsec_sa_in(test_cfg, sa_in);
-	fill_ipsec_sa_out(test_cfg, sa_out);
+	fill_ipsec_sa_in(test_cfg, sa_in, spi);
+	fill_ipsec_sa_out(test_cfg, sa_out, spi);
 
 	rc = create_sa(RTE_SECURITY_ACTION_TYPE_NONE, sa_out);
 	if (rc != 0) {
@@ -432,6 +503,42 @@ init_sa_session(const struct ipsec_test_cfg *test_cfg,
 	return TEST_SUCCESS;
 }
 
+static void
+destroy_sa_session(struct ipsec_sa *sa_out, struct ipsec_sa *sa_in)
+{
+	rte_free(sa_out->ss[0].sa);
+	rte_free(sa_in->ss[0].sa);
+	sa_out->ss[0].sa = NULL;
+	sa_in->ss[0].sa = NULL;
+}
+
+/*
+ * (re)set length of all test packets, they are expected
+ * to be all in the ring_inb_prepare.
+ */
+static int
+set_pkt_len(uint32_t pkt_len)
+{
+	struct rte_mbuf *mbuf[BURST_SIZE];
+	uint32_t i, n, num;
+
+	num = rte_ring_count(ring_inb_prepare);
+	while (num != 0) {
+		n = rte_ring_sc_dequeue_burst(ring_inb_prepare,
+			(void **)mbuf, RTE_MIN(num, RTE_DIM(mbuf)), NULL);
+		for (i = 0; i != n; i++) {
+			mbuf[i]->data_len = pkt_len;
+			mbuf[i]->pkt_len = pkt_len;
+		}
+		if (rte_ring_sp_enqueue_bulk(ring_inb_prepare, (void **)mbuf,
+				n, NULL) != n)
+			return TEST_FAILED;
+		num -= n;
+	}
+
+	return TEST_SUCCESS;
+}
+
 static int
 testsuite_setup(void)
 {
@@ -493,7 +600,8 @@ testsuite_setup(void)
 }
 
 static int
-measure_performance(struct ipsec_sa *sa_out, struct ipsec_sa *sa_in)
+measure_performance(struct ipsec_sa sa_out[], struct ipsec_sa sa_in[],
+		    uint32_t nb_sa)
 {
 	uint64_t time_diff = 0;
 	uint64_t begin = 0;
@@ -502,12 +610,12 @@ measure_performance(struct ipsec_sa *sa_out, struct ipsec_sa *sa_in)
 	begin = rte_get_timer_cycles();
 
 	do {
-		if (create_traffic(sa_out, ring_inb_prepare, ring_inb_process,
-				   ring_outb_prepare) < 0)
+		if (create_traffic(sa_out, nb_sa, ring_inb_prepare,
+				   ring_inb_process, ring_outb_prepare) < 0)
 			return TEST_FAILED;
 
-		if (create_traffic(sa_in, ring_outb_prepare, ring_outb_process,
-				   ring_inb_prepare) < 0)
+		if (create_traffic(sa_in, nb_sa, ring_outb_prepare,
+				   ring_outb_process, ring_inb_prepare) < 0)
 			return TEST_FAILED;
 
 		time_diff = rte_get_timer_cycles() - begin;
@@ -517,12 +625,36 @@ measure_performance(struct ipsec_sa *sa_out, struct ipsec_sa *sa_in)
 	return TEST_SUCCESS;
 }
 
+static void
+sum_counters(struct stats_counter *sum, const struct ipsec_sa sa[],
+	     uint32_t nb_sa)
+{
+	uint32_t i;
+
+	memset(sum, 0, sizeof(*sum));
+	for (i = 0; i != nb_sa; i++) {
+		sum->nb_prepare_call += sa[i].cnt.nb_prepare_call;
+		sum->nb_prepare_pkt += sa[i].cnt.nb_prepare_pkt;
+		sum->nb_process_call += sa[i].cnt.nb_process_call;
+		sum->nb_process_pkt += sa[i].cnt.nb_process_pkt;
+		sum->prepare_ticks_elapsed += sa[i].cnt.prepare_ticks_elapsed;
+		sum->process_ticks_elapsed += sa[i].cnt.process_ticks_elapsed;
+	}
+}
+
 static void
 print_metrics(const struct ipsec_test_cfg *test_cfg,
-	      struct ipsec_sa *sa_out, struct ipsec_sa *sa_in)
+	      const struct ipsec_sa sa_out[], const struct ipsec_sa sa_in[])
 {
+	struct stats_counter out, in;
+
+	sum_counters(&out, sa_out, test_cfg->nb_sa);
+	sum_counters(&in, sa_in, test_cfg->nb_sa);
+
 	printf("\nMetrics of libipsec prepare/process api:\n");
 
+	printf("packet length = %u\n", test_cfg->pkt_len);
+	printf("number of SAs per burst = %u\n", test_cfg->nb_sa);
 	printf("replay window size = %u\n", test_cfg->replay_win_sz);
 	if (test_cfg->esn)
 		printf("replay esn is enabled\n");
@@ -535,17 +667,13 @@ print_metrics(const struct ipsec_test_cfg *test_cfg,
 
 
 	printf("avg cycles for a pkt prepare in outbound is = %.2Lf\n",
-	(long double)sa_out->cnt.prepare_ticks_elapsed
-		    / sa_out->cnt.nb_prepare_pkt);
+	(long double)out.prepare_ticks_elapsed / out.nb_prepare_pkt);
 	printf("avg cycles for a pkt process in outbound is = %.2Lf\n",
-	(long double)sa_out->cnt.process_ticks_elapsed
-		     / sa_out->cnt.nb_process_pkt);
+	(long double)out.process_ticks_elapsed / out.nb_process_pkt);
 	printf("avg cycles for a pkt prepare in inbound is = %.2Lf\n",
-	(long double)sa_in->cnt.prepare_ticks_elapsed
-		     / sa_in->cnt.nb_prepare_pkt);
+	(long double)in.prepare_ticks_elapsed / in.nb_prepare_pkt);
 	printf("avg cycles for a pkt process in inbound is = %.2Lf\n",
-	(long double)sa_in->cnt.process_ticks_elapsed
-		     / sa_in->cnt.nb_process_pkt);
+	(long double)in.process_ticks_elapsed / in.nb_process_pkt);
 
 }
 
@@ -577,12 +705,187 @@ testsuite_teardown(void)
 	ring_outb_process = NULL;
 }
 
+/*
+ * Each worker runs its own packets through outbound and then
+ * inbound path of the same pair of SAs, only inbound path is measured.
+ * As outbound SQNs are allocated concurrently, inbound side sees
+ * interleaved (reordered) sequence numbers from different lcores.
+ */
 static int
-test_libipsec_perf(void)
+mt_worker_loop(void *arg)
 {
-	struct ipsec_sa sa_out;
-	struct ipsec_sa sa_in;
+	struct mt_worker *w;
 	uint32_t i;
+	uint16_t k, n;
+	uint64_t tm;
+
+	w = arg;
+	n = RTE_DIM(w->mb);
+
+	while (__atomic_load_n(&mt_stop, __ATOMIC_RELAXED) == 0) {
+
+		for (i = 0; i != n; i++) {
+			rte_pktmbuf_reset(w->mb[i]);
+			w->mb[i]->data_len = w->pkt_len;
+			w->mb[i]->pkt_len = w->pkt_len;
+		}
+
+		k = rte_ipsec_pkt_crypto_prepare(&w->sa_out->ss[0], w->mb,
+			w->cop, n);
+		k = rte_ipsec_pkt_process(&w->sa_out->ss[0], w->mb, k);
+		if (k != n)
+			return -EIO;
+
+		tm = rte_rdtsc_precise();
+		k = rte_ipsec_pkt_crypto_prepare(&w->sa_in->ss[0], w->mb,
+			w->cop, n);
+		k = rte_ipsec_pkt_process(&w->sa_in->ss[0], w->mb, k);
+		w->ticks_elapsed += rte_rdtsc_precise() - tm;
+
+		w->nb_pkt += k;
+		w->nb_drop += n - k;
+	}
+
+	return 0;
+}
+
+static void
+mt_worker_free(struct mt_worker *w)
+{
+	rte_pktmbuf_free_bulk(w->mb, RTE_DIM(w->mb));
+	rte_mempool_put_bulk(cop_pool, (void **)w->cop, RTE_DIM(w->cop));
+}
+
+static int
+mt_worker_init(struct mt_worker *w, struct ipsec_sa *sa_out,
+	struct ipsec_sa *sa_in, uint32_t pkt_len)
+{
+	memset(w, 0, sizeof(*w));
+
+	if (rte_pktmbuf_alloc_bulk(mbuf_pool, w->mb, RTE_DIM(w->mb)) != 0)
+		return -ENOMEM;
+
+	if (rte_crypto_op_bulk_alloc(cop_pool, RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+			w->cop, RTE_DIM(w->cop)) != RTE_DIM(w->cop)) {
+		rte_pktmbuf_free_bulk(w->mb, RTE_DIM(w->mb));
+		return -ENOMEM;
+	}
+
+	w->sa_out = sa_out;
+	w->sa_in = sa_in;
+	w->pkt_len = pkt_len;
+	return 0;
+}
+
+static int
+measure_mt_performance(const struct ipsec_test_cfg *cfg, uint32_t nb_wrk)
+{
+	int32_t rc, ret;
+	uint32_t i, lc, n;
+	uint64_t hz, pkt, drop, ticks;
+	struct ipsec_sa sa_out, sa_in;
+
+	hz = rte_get_timer_hz();
+	memset(&sa_out, 0, sizeof(sa_out));
+	memset(&sa_in, 0, sizeof(sa_in));
+
+	ret = init_sa_session(cfg, &sa_out, &sa_in, DEFAULT_SPI);
+	if (ret != 0) {
+		destroy_sa_session(&sa_out, &sa_in);
+		return ret;
+	}
+
+	for (n = 0; n != nb_wrk; n++) {
+		ret = mt_worker_init(mt_worker + n, &sa_out, &sa_in,
+			cfg->pkt_len);
+		if (ret != 0)
+			break;
+	}
+
+	__atomic_store_n(&mt_stop, 0, __ATOMIC_RELAXED);
+
+	i = 0;
+	RTE_LCORE_FOREACH_SLAVE(lc) {
+		if (ret != 0 || i == n)
+			break;
+		ret = rte_eal_remote_launch(mt_worker_loop, mt_worker + i, lc);
+		i++;
+	}
+
+	if (ret == 0)
+		rte_delay_us_sleep(MT_DURATION * US_PER_S);
+
+	__atomic_store_n(&mt_stop, 1, __ATOMIC_RELAXED);
+
+	RTE_LCORE_FOREACH_SLAVE(lc) {
+		rc = rte_eal_wait_lcore(lc);
+		if (rc != 0)
+			ret = rc;
+	}
+
+	pkt = 0;
+	drop = 0;
+	ticks = 0;
+	for (i = 0; i != n; i++) {
+		pkt += mt_worker[i].nb_pkt;
+		drop += mt_worker[i].nb_drop;
+		ticks += mt_worker[i].ticks_elapsed;
+		mt_worker_free(mt_worker + i);
+	}
+
+	destroy_sa_session(&sa_out, &sa_in);
+
+	if (ret != 0 || pkt == 0)
+		return TEST_FAILED;
+
+	printf("workers = %u, avg cycles for a pkt inbound "
+		"prepare+process = %.2Lf, %.2Lf Mpps, %" PRIu64 " dropped\n",
+		nb_wrk, (long double)ticks / pkt,
+		(long double)pkt * hz / (ticks / nb_wrk) / 1e6, drop);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Measure how inbound path of a single SA scales with number of lcores.
+ */
+static int
+test_libipsec_mt_perf(void)
+{
+	int ret;
+	uint32_t n, nb_wrk;
+
+	nb_wrk = rte_lcore_count() - 1;
+	if (nb_wrk == 0) {
+		printf("\nAt least 2 lcores required for single SA "
+			"multi-core test, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+#if !defined(RTE_ARCH_X86_64) && !defined(RTE_ARCH_ARM64)
+	printf("\nLock-free replay window is not supported, "
+		"skipping single SA multi-core test\n");
+	return TEST_SUCCESS;
+#endif
+
+	printf("\nMetrics of libipsec single SA multi-core test:\n");
+	printf("packet length = %u\n", mt_test_cfg.pkt_len);
+	printf("replay window size = %u\n", mt_test_cfg.replay_win_sz);
+	printf("AEAD algo is AES_GCM\n");
+
+	ret = 0;
+	for (n = 1; ret == 0 && n <= nb_wrk; n *= 2)
+		ret = measure_mt_performance(&mt_test_cfg, n);
+
+	return ret;
+}
+
+static int
+test_libipsec_perf(void)
+{
+	struct ipsec_sa sa_out[MAX_NB_SA];
+	struct ipsec_sa sa_in[MAX_NB_SA];
+	uint32_t i, j;
 	int ret;
 
 	if (testsuite_setup() < 0) {
@@ -590,24 +893,40 @@ test_libipsec_perf(void)
 		return TEST_FAILED;
 	}
 
+	memset(sa_out, 0, sizeof(sa_out));
+	memset(sa_in, 0, sizeof(sa_in));
+
 	for (i = 0; i < RTE_DIM(test_cfg) ; i++) {
 
-		ret = init_sa_session(&test_cfg[i], &sa_out, &sa_in);
-		if (ret != 0) {
-			testsuite_teardown();
-			return TEST_FAILED;
-		}
+		ret = set_pkt_len(test_cfg[i].pkt_len);
+
+		for (j = 0; ret == 0 && j != test_cfg[i].nb_sa; j++)
+			ret = init_sa_session(&test_cfg[i], &sa_out[j],
+				&sa_in[j], DEFAULT_SPI + j);
+
+		if (ret == 0)
+			ret = measure_performance(sa_out, sa_in,
+				test_cfg[i].nb_sa);
 
-		if (measure_performance(&sa_out, &sa_in) < 0) {
+		if (ret == 0)
+			print_metrics(&test_cfg[i], sa_out, sa_in);
+
+		for (j = 0; j != test_cfg[i].nb_sa; j++)
+			destroy_sa_session(&sa_out[j], &sa_in[j]);
+
+		if (ret != 0) {
 			testsuite_teardown();
 			return TEST_FAILED;
 		}
-
-		print_metrics(&test_cfg[i], &sa_out, &sa_in);
 	}
 
+	ret = test_libipsec_mt_perf();
+
 	testsuite_teardown();
 
+	if (ret != 0)
+		return TEST_FAILED;
+
 	return TEST_SUCCESS;
 }
 
@@ -12,6 +12,7 @@
 
 #include <rte_cycles.h>
 #include <rte_meter.h>
+#include <rte_random.h>
 
 #define mlog(format, ...) do{\
 		printf("Line %d:",__LINE__);\
@@ -676,6 +677,172 @@ tm_test_trtcm_rfc4115_color_aware_check(void)
 	return 0;
 }
 
+#define TM_TEST_BULK_N_METERS 16
+#define TM_TEST_BULK_N_PKTS 256
+#define TM_TEST_BULK_N_BURSTS 64
+
+static struct rte_meter_srtcm_profile bulk_sp[2];
+static struct rte_meter_trtcm_profile bulk_tp[2];
+static struct rte_meter_srtcm bulk_sm[2][TM_TEST_BULK_N_METERS];
+static struct rte_meter_trtcm bulk_tm[2][TM_TEST_BULK_N_METERS];
+
+/* meter indexes with runs of the same meter and meters seen again later */
+static void
+tm_test_bulk_pkts(uint32_t *idx, uint32_t *len, enum rte_color *color)
+{
+	uint32_t i;
+
+	for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {
+		if (i > 0 && rte_rand_max(2) == 0)
+			idx[i] = idx[i - 1];
+		else
+			idx[i] = rte_rand_max(TM_TEST_BULK_N_METERS);
+		len[i] = 64 + rte_rand_max(1500);
+		color[i] = rte_rand_max(RTE_COLORS);
+	}
+}
+
+/* the meters see bursts close together, spread out, and after a long idle */
+static uint64_t
+tm_test_bulk_time(uint64_t time, uint32_t burst)
+{
+	if (burst == TM_TEST_BULK_N_BURSTS / 2)
+		return time + (1ULL << 52);
+
+	return time + rte_rand_max(burst & 1 ? rte_get_tsc_hz() / 1000 : 200);
+}
+
+/**
+ * functional test for rte_meter_srtcm_color_*_check_bulk
+ */
+static inline int
+tm_test_srtcm_bulk_check(void)
+{
+#define SRTCM_BULK_CHECK_MSG "srtcm_bulk_check"
+	struct rte_meter_srtcm_params sparams1 = sparams;
+	struct rte_meter_srtcm *m[TM_TEST_BULK_N_PKTS];
+	struct rte_meter_srtcm_profile *p[TM_TEST_BULK_N_PKTS];
+	uint32_t idx[TM_TEST_BULK_N_PKTS], len[TM_TEST_BULK_N_PKTS];
+	enum rte_color in[TM_TEST_BULK_N_PKTS], out[TM_TEST_BULK_N_PKTS];
+	enum rte_color color;
+	uint64_t time = rte_get_tsc_cycles();
+	uint32_t burst, i, aware;
+
+	sparams1.cir *= 3;
+	if (rte_meter_srtcm_profile_config(&bulk_sp[0], &sparams) != 0 ||
+		rte_meter_srtcm_profile_config(&bulk_sp[1], &sparams1) != 0)
+		melog(SRTCM_BULK_CHECK_MSG);
+
+	for (i = 0; i < TM_TEST_BULK_N_METERS; i++)
+		if (rte_meter_srtcm_config(&bulk_sm[0][i], &bulk_sp[i & 1]))
+			melog(SRTCM_BULK_CHECK_MSG);
+	memcpy(bulk_sm[1], bulk_sm[0], sizeof(bulk_sm[0]));
+
+	for (burst = 0; burst < TM_TEST_BULK_N_BURSTS; burst++) {
+		aware = burst & 2;
+		time = tm_test_bulk_time(time, burst);
+		tm_test_bulk_pkts(idx, len, in);
+
+		for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {
+			m[i] = &bulk_sm[1][idx[i]];
+			p[i] = &bulk_sp[idx[i] & 1];
+			out[i] = in[i];
+		}
+
+		if (aware)
+			rte_meter_srtcm_color_aware_check_bulk(m, p, time,
+				len, out, TM_TEST_BULK_N_PKTS);
+		else
+			rte_meter_srtcm_color_blind_check_bulk(m, p, time,
+				len, out, TM_TEST_BULK_N_PKTS);
+
+		for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {
+			if (aware)
+				color = rte_meter_srtcm_color_aware_check(
+					&bulk_sm[0][idx[i]], p[i], time,
+					len[i], in[i]);
+			else
+				color = rte_meter_srtcm_color_blind_check(
+					&bulk_sm[0][idx[i]], p[i], time,
+					len[i]);
+			if (color != out[i])
+				melog(SRTCM_BULK_CHECK_MSG" burst %u pkt %u",
+					burst, i);
+		}
+
+		if (memcmp(bulk_sm[0], bulk_sm[1], sizeof(bulk_sm[0])) != 0)
+			melog(SRTCM_BULK_CHECK_MSG" burst %u state", burst);
+	}
+
+	return 0;
+}
+
+/**
+ * functional test for rte_meter_trtcm_color_*_check_bulk
+ */
+static inline int
+tm_test_trtcm_bulk_check(void)
+{
+#define TRTCM_BULK_CHECK_MSG "trtcm_bulk_check"
+	struct rte_meter_trtcm_params tparams1 = tparams;
+	struct rte_meter_trtcm *m[TM_TEST_BULK_N_PKTS];
+	struct rte_meter_trtcm_profile *p[TM_TEST_BULK_N_PKTS];
+	uint32_t idx[TM_TEST_BULK_N_PKTS], len[TM_TEST_BULK_N_PKTS];
+	enum rte_color in[TM_TEST_BULK_N_PKTS], out[TM_TEST_BULK_N_PKTS];
+	enum rte_color color;
+	uint64_t time = rte_get_tsc_cycles();
+	uint32_t burst, i, aware;
+
+	tparams1.cir *= 3;
+	tparams1.pir *= 3;
+	if (rte_meter_trtcm_profile_config(&bulk_tp[0], &tparams) != 0 ||
+		rte_meter_trtcm_profile_config(&bulk_tp[1], &tparams1) != 0)
+		melog(TRTCM_BULK_CHECK_MSG);
+
+	for (i = 0; i < TM_TEST_BULK_N_METERS; i++)
+		if (rte_meter_trtcm_config(&bulk_tm[0][i], &bulk_tp[i & 1]))
+			melog(TRTCM_BULK_CHECK_MSG);
+	memcpy(bulk_tm[1], bulk_tm[0], sizeof(bulk_tm[0]));
+
+	for (burst = 0; burst < TM_TEST_BULK_N_BURSTS; burst++) {
+		aware = burst & 2;
+		time = tm_test_bulk_time(time, burst);
+		tm_test_bulk_pkts(idx, len, in);
+
+		for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {
+			m[i] = &bulk_tm[1][idx[i]];
+			p[i] = &bulk_tp[idx[i] & 1];
+			out[i] = in[i];
+		}
+
+		if (aware)
+			rte_meter_trtcm_color_aware_check_bulk(m, p, time,
+				len, out, TM_TEST_BULK_N_PKTS);
+		else
+			rte_meter_trtcm_color_blind_check_bulk(m, p, time,
+				len, out, TM_TEST_BULK_N_PKTS);
+
+		for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {
+			if (aware)
+				color = rte_meter_trtcm_color_aware_check(
+					&bulk_tm[0][idx[i]], p[i], time,
+					len[i], in[i]);
+			else
+				color = rte_meter_trtcm_color_blind_check(
+					&bulk_tm[0][idx[i]], p[i], time,
+					len[i]);
+			if (color != out[i])
+				melog(TRTCM_BULK_CHECK_MSG" burst %u pkt %u",
+					burst, i);
+		}
+
+		if (memcmp(bulk_tm[0], bulk_tm[1], sizeof(bulk_tm[0])) != 0)
+			melog(TRTCM_BULK_CHECK_MSG" burst %u state", burst);
+	}
+
+	return 0;
+}
+
 /**
  * test main entrance for library meter
  */
@@ -709,8 +876,149 @@ test_meter(void)
 	if (tm_test_trtcm_rfc4115_color_aware_check() != 0)
 		return -1;
 
+	if (tm_test_srtcm_bulk_check() != 0)
+		return -1;
+
+	if (tm_test_trtcm_bulk_check() != 0)
+		return -1;
+
 	return 0;
 
 }
 
 REGISTER_TEST_COMMAND(meter_autotest, test_meter);
+
+#define TM_PERF_N_METERS (1 << 15)
+#define TM_PERF_N_PKTS (1 << 16)
+#define TM_PERF_BURST 32
+#define TM_PERF_N_ROUNDS 16
+
+static struct rte_meter_srtcm perf_sm[TM_PERF_N_METERS];
+static struct rte_meter_trtcm perf_tm[TM_PERF_N_METERS];
+static struct rte_meter_srtcm *perf_sm_pkt[TM_PERF_N_PKTS];
+static struct rte_meter_srtcm_profile *perf_sp_pkt[TM_PERF_N_PKTS];
+static struct rte_meter_trtcm *perf_tm_pkt[TM_PERF_N_PKTS];
+static struct rte_meter_trtcm_profile *perf_tp_pkt[TM_PERF_N_PKTS];
+static uint32_t perf_len[TM_PERF_N_PKTS];
+static enum rte_color perf_color[TM_PERF_N_PKTS];
+
+/* packets of a flow come in runs of up to max_run */
+static void
+tm_perf_pkts_init(struct rte_meter_srtcm_profile *sp,
+	struct rte_meter_trtcm_profile *tp, uint32_t max_run)
+{
+	uint32_t i, meter = 0, run = 0;
+
+	for (i = 0; i < TM_PERF_N_PKTS; i++) {
+		if (run == 0) {
+			meter = rte_rand_max(TM_PERF_N_METERS);
+			run = 1 + rte_rand_max(max_run);
+		}
+		run--;
+		perf_sm_pkt[i] = &perf_sm[meter];
+		perf_sp_pkt[i] = sp;
+		perf_tm_pkt[i] = &perf_tm[meter];
+		perf_tp_pkt[i] = tp;
+		perf_len[i] = 64 + rte_rand_max(1500);
+	}
+}
+
+static void
+tm_perf_report(const char *name, uint64_t cycles)
+{
+	printf("  %-32s %6.2f cycles/pkt\n", name,
+		(double)cycles / (TM_PERF_N_PKTS * TM_PERF_N_ROUNDS));
+}
+
+static void
+tm_perf_srtcm(void)
+{
+	uint64_t start, time, cycles_pkt = 0, cycles_bulk = 0;
+	uint32_t round, i, j;
+
+	for (round = 0; round < TM_PERF_N_ROUNDS; round++) {
+		for (i = 0; i < TM_PERF_N_PKTS; i += TM_PERF_BURST) {
+			time = rte_rdtsc();
+			for (j = i; j < i + TM_PERF_BURST; j++)
+				perf_color[j] =
+					rte_meter_srtcm_color_blind_check(
+					perf_sm_pkt[j], perf_sp_pkt[j],
+					time, perf_len[j]);
+			cycles_pkt += rte_rdtsc() - time;
+		}
+
+		for (i = 0; i < TM_PERF_N_PKTS; i += TM_PERF_BURST) {
+			start = rte_rdtsc();
+			rte_meter_srtcm_color_blind_check_bulk(&perf_sm_pkt[i],
+				&perf_sp_pkt[i], start, &perf_len[i],
+				&perf_color[i], TM_PERF_BURST);
+			cycles_bulk += rte_rdtsc() - start;
+		}
+	}
+
+	tm_perf_report("srtcm_color_blind_check", cycles_pkt);
+	tm_perf_report("srtcm_color_blind_check_bulk", cycles_bulk);
+}
+
+static void
+tm_perf_trtcm(void)
+{
+	uint64_t start, time, cycles_pkt = 0, cycles_bulk = 0;
+	uint32_t round, i, j;
+
+	for (round = 0; round < TM_PERF_N_ROUNDS; round++) {
+		for (i = 0; i < TM_PERF_N_PKTS; i += TM_PERF_BURST) {
+			time = rte_rdtsc();
+			for (j = i; j < i + TM_PERF_BURST; j++)
+				perf_color[j] =
+					rte_meter_trtcm_color_blind_check(
+					perf_tm_pkt[j], perf_tp_pkt[j],
+					time, perf_len[j]);
+			cycles_pkt += rte_rdtsc() - time;
+		}
+
+		for (i = 0; i < TM_PERF_N_PKTS; i += TM_PERF_BURST) {
+			start = rte_rdtsc();
+			rte_meter_trtcm_color_blind_check_bulk(&perf_tm_pkt[i],
+				&perf_tp_pkt[i], start, &perf_len[i],
+				&perf_color[i], TM_PERF_BURST);
+			cycles_bulk += rte_rdtsc() - start;
+		}
+	}
+
+	tm_perf_report("trtcm_color_blind_check", cycles_pkt);
+	tm_perf_report("trtcm_color_blind_check_bulk", cycles_bulk);
+}
+
+/**
+ * performance test for the per packet and bulk meter checks
+ */
+static int
+test_meter_perf(void)
+{
+	static const uint32_t max_run[] = {1, 4, 16};
+	struct rte_meter_srtcm_profile sp;
+	struct rte_meter_trtcm_profile tp;
+	uint32_t i;
+
+	if (rte_meter_srtcm_profile_config(&sp, &sparams) != 0 ||
+		rte_meter_trtcm_profile_config(&tp, &tparams) != 0)
+		return -1;
+
+	for (i = 0; i < TM_PERF_N_METERS; i++)
+		if (rte_meter_srtcm_config(&perf_sm[i], &sp) != 0 ||
+			rte_meter_trtcm_config(&perf_tm[i], &tp) != 0)
+			return -1;
+
+	for (i = 0; i < RTE_DIM(max_run); i++) {
+		printf("%u meters, burst %u, flow runs of 1 to %u packets\n",
+			TM_PERF_N_METERS, TM_PERF_BURST, max_run[i]);
+		tm_perf_pkts_init(&sp, &tp, max_run[i]);
+		tm_perf_srtcm();
+		tm_perf_trtcm();
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(meter_perf_autotest, test_meter_perf);
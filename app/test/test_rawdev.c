@@ -45,3 +45,12 @@ test_rawdev_selftest_ioat(void)
 }
 
 REGISTER_TEST_COMMAND(ioat_rawdev_autotest, test_rawdev_selftest_ioat);
+
+static int
+test_rawdev_selftest_swcopy(void)
+{
+	return test_rawdev_selftest_impl("rawdev_swcopy", "") == 0 ?
+			TEST_SUCCESS : TEST_FAILED;
+}
+
+REGISTER_TEST_COMMAND(swcopy_rawdev_autotest, test_rawdev_selftest_swcopy);
@@ -114,6 +114,73 @@ prepare_pkt(struct rte_sched_port *port, struct rte_mbuf *mbuf)
 }
 
 
+/*
+ * Subport parallel path: packets pushed to the input rings of two
+ * subports come out of the dequeue of their own subport only.
+ */
+static int
+test_sched_subport_parallel(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[10];
+	struct rte_mbuf *out_mbufs[10];
+	uint32_t subport, pipe, traffic_class, queue;
+	int i, err;
+
+	params.n_subports_per_port = 2;
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	for (subport = 0; subport < params.n_subports_per_port; subport++) {
+		err = rte_sched_subport_config(port, subport, subport_param);
+		TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+		for (pipe = 0; pipe < subport_param[0].n_pipes_per_subport_enabled; pipe++) {
+			err = rte_sched_pipe_config(port, subport, pipe, 0);
+			TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n", pipe, err);
+		}
+
+		err = rte_sched_subport_input_config(port, subport, 16);
+		TEST_ASSERT_SUCCESS(err, "Error config subport input, err=%d\n", err);
+	}
+
+	/* nine packets for subport 1, then one for subport 0 */
+	for (i = 0; i < 10; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		prepare_pkt(port, in_mbufs[i]);
+		rte_sched_port_pkt_write(port, in_mbufs[i], i < 9 ? 1 : 0,
+				PIPE, TC, QUEUE, RTE_COLOR_YELLOW);
+	}
+
+	err = rte_sched_subport_input(port, 1, in_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 9, "Wrong subport input, err=%d\n", err);
+	err = rte_sched_subport_input(port, 0, &in_mbufs[9], 1);
+	TEST_ASSERT_EQUAL(err, 1, "Wrong subport input, err=%d\n", err);
+
+	err = rte_sched_subport_dequeue(port, 0, out_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 1, "Wrong subport dequeue, err=%d\n", err);
+	rte_sched_port_pkt_read_tree_path(port, out_mbufs[0],
+			&subport, &pipe, &traffic_class, &queue);
+	TEST_ASSERT_EQUAL(subport, 0, "Wrong subport\n");
+	rte_pktmbuf_free(out_mbufs[0]);
+
+	err = rte_sched_subport_dequeue(port, 1, out_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 9, "Wrong subport dequeue, err=%d\n", err);
+	for (i = 0; i < 9; i++) {
+		rte_sched_port_pkt_read_tree_path(port, out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		TEST_ASSERT_EQUAL(subport, 1, "Wrong subport\n");
+		TEST_ASSERT_EQUAL(pipe, PIPE, "Wrong pipe\n");
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -192,7 +259,7 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	return test_sched_subport_parallel(mp);
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
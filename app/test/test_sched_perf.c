@@ -0,0 +1,298 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_mbuf.h>
+#include <rte_pause.h>
+#include <rte_sched.h>
+
+#include "test.h"
+
+/*
+ * Measures the scheduler throughput when the subports of one port are
+ * scheduled by 1, 2, ... lcores in parallel, against a single lcore
+ * running rte_sched_port_enqueue() and rte_sched_port_dequeue().
+ */
+
+#define MAX_SUBPORTS      8
+#define N_PIPES           1024
+#define QSIZE             32
+#define BURST             32
+#define MBUFS_PER_SUBPORT 2048
+#define ITERATIONS        (1 << 16)
+#define PORT_RATE         ((uint64_t)100000 * 1000 * 1000 / 8)
+
+static struct rte_sched_pipe_params pipe_profile[] = {
+	{ /* no shaping, only the scheduling cost is measured */
+		.tb_rate = PORT_RATE,
+		.tb_size = 1000000,
+		.tc_rate = {PORT_RATE, PORT_RATE, PORT_RATE, PORT_RATE,
+			PORT_RATE, PORT_RATE, PORT_RATE, PORT_RATE,
+			PORT_RATE, PORT_RATE, PORT_RATE, PORT_RATE,
+			PORT_RATE},
+		.tc_period = 10,
+		.tc_ov_weight = 1,
+		.wrr_weights = {1, 1, 1, 1},
+	},
+};
+
+static struct rte_sched_subport_params subport_param = {
+	.tb_rate = PORT_RATE,
+	.tb_size = 1000000,
+	.tc_rate = {PORT_RATE, PORT_RATE, PORT_RATE, PORT_RATE,
+		PORT_RATE, PORT_RATE, PORT_RATE, PORT_RATE,
+		PORT_RATE, PORT_RATE, PORT_RATE, PORT_RATE,
+		PORT_RATE},
+	.tc_period = 10,
+	.n_pipes_per_subport_enabled = N_PIPES,
+	.qsize = {QSIZE, QSIZE, QSIZE, QSIZE, QSIZE, QSIZE, QSIZE,
+		QSIZE, QSIZE, QSIZE, QSIZE, QSIZE, QSIZE},
+	.pipe_profiles = pipe_profile,
+	.n_pipe_profiles = 1,
+	.n_max_pipe_profiles = 1,
+};
+
+struct perf_worker {
+	struct rte_sched_port *port;
+	uint32_t subport;
+	uint32_t n_subports;
+	struct rte_mbuf *free_mbufs[MBUFS_PER_SUBPORT * MAX_SUBPORTS];
+	uint32_t n_free;
+	uint32_t pipe;
+	uint64_t pkts;
+	uint64_t cycles;
+} __rte_cache_aligned;
+
+static struct perf_worker workers[MAX_SUBPORTS];
+static volatile int start;
+
+static struct rte_sched_port *
+perf_port_create(uint32_t n_subports)
+{
+	struct rte_sched_port_params params = {
+		.name = "sched_perf",
+		.socket = rte_socket_id(),
+		.rate = PORT_RATE,
+		.mtu = 1522,
+		.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT,
+		.n_subports_per_port = n_subports,
+		.n_pipes_per_subport = N_PIPES,
+	};
+	struct rte_sched_port *port;
+	uint32_t subport, pipe;
+
+	port = rte_sched_port_config(&params);
+	if (port == NULL)
+		return NULL;
+
+	for (subport = 0; subport < n_subports; subport++) {
+		if (rte_sched_subport_config(port, subport,
+				&subport_param) != 0)
+			goto err;
+		for (pipe = 0; pipe < N_PIPES; pipe++)
+			if (rte_sched_pipe_config(port, subport, pipe, 0) != 0)
+				goto err;
+		if (rte_sched_subport_input_config(port, subport,
+				MBUFS_PER_SUBPORT) != 0)
+			goto err;
+	}
+
+	return port;
+err:
+	rte_sched_port_free(port);
+	return NULL;
+}
+
+/* take a burst of free mbufs, spread over the pipes of the subports */
+static inline uint32_t
+perf_fill_burst(struct perf_worker *w, struct rte_mbuf **pkts)
+{
+	uint32_t i, n = RTE_MIN(w->n_free, (uint32_t)BURST);
+
+	for (i = 0; i < n; i++) {
+		pkts[i] = w->free_mbufs[--w->n_free];
+		rte_sched_port_pkt_write(w->port, pkts[i],
+			w->subport + w->pipe % w->n_subports,
+			w->pipe % N_PIPES, w->pipe % RTE_SCHED_TRAFFIC_CLASS_BE,
+			0, RTE_COLOR_GREEN);
+		w->pipe++;
+	}
+
+	return n;
+}
+
+static inline void
+perf_recycle(struct perf_worker *w, struct rte_mbuf **pkts, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i++)
+		w->free_mbufs[w->n_free++] = pkts[i];
+}
+
+/* one lcore enqueues into and dequeues from the whole port */
+static int
+perf_port_loop(void *arg)
+{
+	struct perf_worker *w = arg;
+	struct rte_mbuf *pkts[BURST];
+	uint64_t tsc;
+	uint32_t i, n;
+
+	tsc = rte_rdtsc();
+	for (i = 0; i < ITERATIONS; i++) {
+		n = perf_fill_burst(w, pkts);
+		rte_sched_port_enqueue(w->port, pkts, n);
+
+		n = rte_sched_port_dequeue(w->port, pkts, BURST);
+		w->pkts += n;
+		perf_recycle(w, pkts, n);
+	}
+	w->cycles = rte_rdtsc() - tsc;
+
+	return 0;
+}
+
+/* each lcore enqueues into and dequeues from its own subport */
+static int
+perf_subport_loop(void *arg)
+{
+	struct perf_worker *w = arg;
+	struct rte_mbuf *pkts[BURST];
+	uint64_t tsc;
+	uint32_t i, n, n_in;
+
+	while (start == 0)
+		rte_pause();
+
+	tsc = rte_rdtsc();
+	for (i = 0; i < ITERATIONS; i++) {
+		n = perf_fill_burst(w, pkts);
+		n_in = rte_sched_subport_input(w->port, w->subport, pkts, n);
+		perf_recycle(w, &pkts[n_in], n - n_in);
+
+		n = rte_sched_subport_dequeue(w->port, w->subport, pkts,
+			BURST);
+		w->pkts += n;
+		perf_recycle(w, pkts, n);
+	}
+	w->cycles = rte_rdtsc() - tsc;
+
+	return 0;
+}
+
+static int
+perf_workers_init(struct rte_mempool *mp, struct rte_sched_port *port,
+		uint32_t n_workers, uint32_t n_subports)
+{
+	struct perf_worker *w;
+	uint32_t i, n_mbufs = MBUFS_PER_SUBPORT * n_subports / n_workers;
+
+	for (i = 0; i < n_workers; i++) {
+		w = &workers[i];
+		w->port = port;
+		w->subport = (n_workers == 1) ? 0 : i;
+		w->n_subports = n_subports / n_workers;
+		w->pipe = 0;
+		w->pkts = 0;
+		w->cycles = 0;
+		if (rte_pktmbuf_alloc_bulk(mp, w->free_mbufs, n_mbufs) != 0)
+			return -1;
+		for (w->n_free = 0; w->n_free < n_mbufs; w->n_free++)
+			w->free_mbufs[w->n_free]->pkt_len = 60;
+	}
+
+	return 0;
+}
+
+static void
+perf_workers_report(const char *name, uint32_t n_workers)
+{
+	uint64_t pkts = 0, cycles = 0;
+	uint32_t i;
+
+	for (i = 0; i < n_workers; i++) {
+		pkts += workers[i].pkts;
+		cycles = RTE_MAX(cycles, workers[i].cycles);
+		rte_pktmbuf_free_bulk(workers[i].free_mbufs,
+			workers[i].n_free);
+	}
+
+	printf("%-24s %2u lcore(s): %8.2f cycles/pkt, %8.2f Mpps\n",
+		name, n_workers, (double)cycles * n_workers / (pkts + 1),
+		(double)pkts * rte_get_tsc_hz() / (cycles + 1) / 1e6);
+}
+
+static int
+test_sched_perf(void)
+{
+	struct rte_sched_port *port;
+	struct rte_mempool *mp;
+	uint32_t n_subports, n_workers, lcore_id;
+
+	/* one subport per worker lcore */
+	n_subports = RTE_MIN(rte_lcore_count() - 1, (unsigned int)MAX_SUBPORTS);
+	if (n_subports == 0) {
+		printf("Too few cores to run sched perf test\n");
+		return TEST_SKIPPED;
+	}
+
+	mp = rte_pktmbuf_pool_create("sched_perf", MBUFS_PER_SUBPORT *
+		n_subports, 0, 0, RTE_MBUF_DEFAULT_DATAROOM, SOCKET_ID_ANY);
+	if (mp == NULL) {
+		printf("Error creating mempool\n");
+		return TEST_FAILED;
+	}
+
+	printf("=== sched perf: %u subports, %u pipes each, burst %u ===\n",
+		n_subports, N_PIPES, BURST);
+
+	port = perf_port_create(n_subports);
+	if (port == NULL || perf_workers_init(mp, port, 1, n_subports) < 0)
+		goto err;
+	perf_port_loop(&workers[0]);
+	perf_workers_report("port enqueue/dequeue", 1);
+	rte_sched_port_free(port);
+
+	for (n_workers = 1; n_workers <= n_subports; n_workers++) {
+		uint32_t i = 0;
+
+		port = perf_port_create(n_workers);
+		if (port == NULL ||
+				perf_workers_init(mp, port, n_workers,
+					n_workers) < 0)
+			goto err;
+
+		start = 0;
+		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+			if (i == n_workers)
+				break;
+			rte_eal_remote_launch(perf_subport_loop, &workers[i++],
+				lcore_id);
+		}
+		start = 1;
+		rte_eal_mp_wait_lcore();
+
+		perf_workers_report("subport input/dequeue", n_workers);
+		rte_sched_port_free(port);
+	}
+
+	rte_mempool_free(mp);
+	return TEST_SUCCESS;
+
+err:
+	printf("Error setting up sched port\n");
+	rte_sched_port_free(port);
+	rte_mempool_free(mp);
+	return TEST_FAILED;
+}
+
+REGISTER_TEST_COMMAND(sched_perf_autotest, test_sched_perf);
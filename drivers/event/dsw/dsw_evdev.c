@@ -3,10 +3,14 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <rte_cycles.h>
 #include <rte_eventdev_pmd.h>
 #include <rte_eventdev_pmd_vdev.h>
+#include <rte_kvargs.h>
 #include <rte_random.h>
 #include <rte_ring_elem.h>
 
@@ -14,6 +18,14 @@
 
 #define EVENTDEV_NAME_DSW_PMD event_dsw
 
+#define NUM_FLOWS_ARG "num_flows"
+#define MIGRATION_FLOWS_ARG "migration_flows"
+#define MIGRATION_INTERVAL_ARG "migration_interval"
+#define MIGRATION_MODE_ARG "migration_mode"
+#define MIN_SOURCE_LOAD_ARG "min_source_load"
+#define MAX_TARGET_LOAD_ARG "max_target_load"
+#define REBALANCE_THRESHOLD_ARG "rebalance_threshold"
+
 static int
 dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	       const struct rte_event_port_conf *conf)
@@ -65,10 +77,11 @@ dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	rte_atomic32_init(&port->immigration_load);
 
 	port->load_update_interval =
-		(DSW_LOAD_UPDATE_INTERVAL * rte_get_timer_hz()) / US_PER_S;
+		(DSW_LOAD_UPDATE_INTERVAL(dsw->migration_interval) *
+		 rte_get_timer_hz()) / US_PER_S;
 
 	port->migration_interval =
-		(DSW_MIGRATION_INTERVAL * rte_get_timer_hz()) / US_PER_S;
+		(dsw->migration_interval * rte_get_timer_hz()) / US_PER_S;
 
 	dev->data->ports[port_id] = port;
 
@@ -208,13 +221,14 @@ dsw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 }
 
 static void
-dsw_info_get(struct rte_eventdev *dev __rte_unused,
-	     struct rte_event_dev_info *info)
+dsw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 {
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+
 	*info = (struct rte_event_dev_info) {
 		.driver_name = DSW_PMD_NAME,
 		.max_event_queues = DSW_MAX_QUEUES,
-		.max_event_queue_flows = DSW_MAX_FLOWS,
+		.max_event_queue_flows = 1 << dsw->flows_bits,
 		.max_event_queue_priority_levels = 1,
 		.max_event_priority_levels = 1,
 		.max_event_ports = DSW_MAX_PORTS,
@@ -255,8 +269,9 @@ initial_flow_to_port_assignment(struct dsw_evdev *dsw)
 	uint8_t queue_id;
 	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
 		struct dsw_queue *queue = &dsw->queues[queue_id];
-		uint16_t flow_hash;
-		for (flow_hash = 0; flow_hash < DSW_MAX_FLOWS; flow_hash++) {
+		uint32_t num_flows = 1 << dsw->flows_bits;
+		uint32_t flow_hash;
+		for (flow_hash = 0; flow_hash < num_flows; flow_hash++) {
 			uint8_t port_idx =
 				rte_rand() % queue->num_serving_ports;
 			uint8_t port_id =
@@ -391,12 +406,168 @@ static struct rte_eventdev_ops dsw_evdev_ops = {
 	.xstats_get_by_name = dsw_xstats_get_by_name
 };
 
+static int
+set_num_flows(const char *key __rte_unused, const char *value, void *opaque)
+{
+	uint16_t *flows_bits = opaque;
+	int num_flows = atoi(value);
+
+	if (num_flows < (1 << DSW_MIN_FLOWS_BITS) ||
+	    num_flows > DSW_MAX_FLOWS || !rte_is_power_of_2(num_flows))
+		return -1;
+	*flows_bits = rte_log2_u32(num_flows);
+	return 0;
+}
+
+static int
+set_migration_flows(const char *key __rte_unused, const char *value,
+		    void *opaque)
+{
+	uint8_t *flows_per_migration = opaque;
+	int flows = atoi(value);
+
+	if (flows <= 0 || flows > DSW_MAX_FLOWS_PER_MIGRATION)
+		return -1;
+	*flows_per_migration = flows;
+	return 0;
+}
+
+static int
+set_migration_interval(const char *key __rte_unused, const char *value,
+		       void *opaque)
+{
+	uint32_t *interval = opaque;
+	int us = atoi(value);
+
+	/* the load update interval is a quarter of this */
+	if (us < 4 || us > (int)US_PER_S)
+		return -1;
+	*interval = us;
+	return 0;
+}
+
+static int
+set_migration_mode(const char *key __rte_unused, const char *value,
+		   void *opaque)
+{
+	enum dsw_migration_mode *mode = opaque;
+
+	if (strcmp(value, "idle_target") == 0)
+		*mode = DSW_MIGRATION_MODE_IDLE_TARGET;
+	else if (strcmp(value, "largest_flow") == 0)
+		*mode = DSW_MIGRATION_MODE_LARGEST_FLOW;
+	else
+		return -1;
+	return 0;
+}
+
+static int
+set_load_percent(const char *key __rte_unused, const char *value,
+		 void *opaque)
+{
+	int16_t *load = opaque;
+	int percent = atoi(value);
+
+	if (percent < 0 || percent > 100)
+		return -1;
+	*load = DSW_LOAD_FROM_PERCENT(percent);
+	return 0;
+}
+
+static int
+dsw_parse_args(struct dsw_evdev *dsw, const char *name, const char *params)
+{
+	static const char *const args[] = {
+		NUM_FLOWS_ARG,
+		MIGRATION_FLOWS_ARG,
+		MIGRATION_INTERVAL_ARG,
+		MIGRATION_MODE_ARG,
+		MIN_SOURCE_LOAD_ARG,
+		MAX_TARGET_LOAD_ARG,
+		REBALANCE_THRESHOLD_ARG,
+		NULL
+	};
+	static const struct {
+		const char *key;
+		arg_handler_t handler;
+		size_t offset;
+	} handlers[] = {
+		{ NUM_FLOWS_ARG, set_num_flows,
+		  offsetof(struct dsw_evdev, flows_bits) },
+		{ MIGRATION_FLOWS_ARG, set_migration_flows,
+		  offsetof(struct dsw_evdev, flows_per_migration) },
+		{ MIGRATION_INTERVAL_ARG, set_migration_interval,
+		  offsetof(struct dsw_evdev, migration_interval) },
+		{ MIGRATION_MODE_ARG, set_migration_mode,
+		  offsetof(struct dsw_evdev, migration_mode) },
+		{ MIN_SOURCE_LOAD_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, min_source_load) },
+		{ MAX_TARGET_LOAD_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, max_target_load) },
+		{ REBALANCE_THRESHOLD_ARG, set_load_percent,
+		  offsetof(struct dsw_evdev, rebalance_threshold) }
+	};
+	struct rte_kvargs *kvlist;
+	unsigned int i;
+	int ret = 0;
+
+	dsw->flows_bits = DSW_DEFAULT_FLOWS_BITS;
+	dsw->flows_per_migration = DSW_DEFAULT_FLOWS_PER_MIGRATION;
+	dsw->migration_interval = DSW_DEFAULT_MIGRATION_INTERVAL;
+	dsw->migration_mode = DSW_MIGRATION_MODE_IDLE_TARGET;
+	dsw->min_source_load =
+		DSW_LOAD_FROM_PERCENT(DSW_DEFAULT_MIN_SOURCE_LOAD_FOR_MIGRATION);
+	dsw->max_target_load =
+		DSW_LOAD_FROM_PERCENT(DSW_DEFAULT_MAX_TARGET_LOAD_FOR_MIGRATION);
+	dsw->rebalance_threshold =
+		DSW_LOAD_FROM_PERCENT(DSW_DEFAULT_REBALANCE_THRESHOLD);
+
+	if (params == NULL || params[0] == '\0')
+		goto out;
+
+	kvlist = rte_kvargs_parse(params, args);
+	if (kvlist == NULL) {
+		DSW_LOG(ERR, "%s: invalid parameters '%s'\n", name, params);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < RTE_DIM(handlers); i++) {
+		ret = rte_kvargs_process(kvlist, handlers[i].key,
+					 handlers[i].handler,
+					 (char *)dsw + handlers[i].offset);
+		if (ret != 0) {
+			DSW_LOG(ERR, "%s: error parsing %s parameter\n",
+				name, handlers[i].key);
+			ret = -EINVAL;
+			break;
+		}
+	}
+
+	rte_kvargs_free(kvlist);
+
+	if (ret != 0)
+		return ret;
+
+out:
+	dsw->flows_mask = (1 << dsw->flows_bits) - 1;
+
+	DSW_LOG(INFO, "%s: num_flows=%u, migration_flows=%u, "
+		"migration_interval=%u, migration_mode=%s\n", name,
+		1U << dsw->flows_bits, dsw->flows_per_migration,
+		dsw->migration_interval,
+		dsw->migration_mode == DSW_MIGRATION_MODE_LARGEST_FLOW ?
+		"largest_flow" : "idle_target");
+
+	return 0;
+}
+
 static int
 dsw_probe(struct rte_vdev_device *vdev)
 {
 	const char *name;
 	struct rte_eventdev *dev;
 	struct dsw_evdev *dsw;
+	int ret;
 
 	name = rte_vdev_device_name(vdev);
 
@@ -419,6 +590,12 @@ dsw_probe(struct rte_vdev_device *vdev)
 	dsw = dev->data->dev_private;
 	dsw->data = dev->data;
 
+	ret = dsw_parse_args(dsw, name, rte_vdev_device_args(vdev));
+	if (ret != 0) {
+		rte_event_pmd_vdev_uninit(name);
+		return ret;
+	}
+
 	return 0;
 }
 
@@ -440,3 +617,8 @@ static struct rte_vdev_driver evdev_dsw_pmd_drv = {
 };
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_DSW_PMD, evdev_dsw_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(event_dsw, NUM_FLOWS_ARG "=<int> "
+		MIGRATION_FLOWS_ARG "=<int> " MIGRATION_INTERVAL_ARG "=<int> "
+		MIGRATION_MODE_ARG "=idle_target|largest_flow "
+		MIN_SOURCE_LOAD_ARG "=<int> " MAX_TARGET_LOAD_ARG "=<int> "
+		REBALANCE_THRESHOLD_ARG "=<int>");
@@ -29,12 +29,14 @@
  * being very small. The effect of migrating such flows will be small,
  * in terms amount of processing load redistributed. This will in turn
  * reduce the load balancing speed, since flow migration rate has an
- * upper limit. Code changes are required to allow > 32k DSW-level
- * flows.
+ * upper limit. The number of DSW-level flows is configurable with the
+ * "num_flows" devarg. Code changes are required to allow > 32k
+ * DSW-level flows.
  */
-#define DSW_MAX_FLOWS_BITS (13)
+#define DSW_MIN_FLOWS_BITS (8)
+#define DSW_MAX_FLOWS_BITS (15)
+#define DSW_DEFAULT_FLOWS_BITS (13)
 #define DSW_MAX_FLOWS (1<<(DSW_MAX_FLOWS_BITS))
-#define DSW_MAX_FLOWS_MASK (DSW_MAX_FLOWS-1)
 
 /* Eventdev RTE_SCHED_TYPE_PARALLEL doesn't have a concept of flows,
  * but the 'dsw' scheduler (more or less) randomly assign flow id to
@@ -81,7 +83,7 @@
  * source ports, to be migrated too quickly to a lightly loaded port -
  * in particular since this might cause the system to oscillate.
  */
-#define DSW_LOAD_UPDATE_INTERVAL (DSW_MIGRATION_INTERVAL/4)
+#define DSW_LOAD_UPDATE_INTERVAL(migration_interval) ((migration_interval)/4)
 #define DSW_OLD_LOAD_WEIGHT (1)
 
 /* The minimum time (in us) between two flow migrations. What puts an
@@ -90,14 +92,18 @@
  * largely a function of how much cycles are spent the processing of
  * an event burst.
  */
-#define DSW_MIGRATION_INTERVAL (1000)
-#define DSW_MIN_SOURCE_LOAD_FOR_MIGRATION (DSW_LOAD_FROM_PERCENT(70))
-#define DSW_MAX_TARGET_LOAD_FOR_MIGRATION (DSW_LOAD_FROM_PERCENT(95))
-#define DSW_REBALANCE_THRESHOLD (DSW_LOAD_FROM_PERCENT(3))
+#define DSW_DEFAULT_MIGRATION_INTERVAL (1000)
+#define DSW_DEFAULT_MIN_SOURCE_LOAD_FOR_MIGRATION (70)
+#define DSW_DEFAULT_MAX_TARGET_LOAD_FOR_MIGRATION (95)
+#define DSW_DEFAULT_REBALANCE_THRESHOLD (3)
 
 #define DSW_MAX_EVENTS_RECORDED (128)
 
-#define DSW_MAX_FLOWS_PER_MIGRATION (8)
+/* The number of flows moved in one migration is configurable, up to
+ * this limit, with the "migration_flows" devarg.
+ */
+#define DSW_MAX_FLOWS_PER_MIGRATION (32)
+#define DSW_DEFAULT_FLOWS_PER_MIGRATION (8)
 
 /* Only one outstanding migration per port is allowed */
 #define DSW_MAX_PAUSED_FLOWS (DSW_MAX_PORTS*DSW_MAX_FLOWS_PER_MIGRATION)
@@ -123,6 +129,20 @@ struct dsw_queue_flow {
 	uint16_t flow_hash;
 };
 
+/* With DSW_MIGRATION_MODE_IDLE_TARGET, the flow/target port
+ * combination which leaves the target port the least loaded is
+ * selected first, which in practice means the smallest flows are
+ * moved first. With DSW_MIGRATION_MODE_LARGEST_FLOW, the flows are
+ * picked in order of their estimated load (based on the recorded
+ * per-flow event counts), the largest first, which allows an
+ * imbalance caused by a few heavy flows to be corrected with fewer
+ * migrations.
+ */
+enum dsw_migration_mode {
+	DSW_MIGRATION_MODE_IDLE_TARGET,
+	DSW_MIGRATION_MODE_LARGEST_FLOW
+};
+
 enum dsw_migration_state {
 	DSW_MIGRATION_STATE_IDLE,
 	DSW_MIGRATION_STATE_PAUSING,
@@ -172,6 +192,15 @@ struct dsw_port {
 	uint64_t emigration_start;
 	uint64_t emigrations;
 	uint64_t emigration_latency;
+	uint64_t emigration_latency_max;
+
+	/* For measuring the time during which this port has flows
+	 * paused, either on its own behalf or on the request of
+	 * another port.
+	 */
+	uint64_t pause_start;
+	uint64_t pauses;
+	uint64_t pause_cycles;
 
 	uint8_t emigration_target_port_ids[DSW_MAX_FLOWS_PER_MIGRATION];
 	struct dsw_queue_flow
@@ -235,6 +264,16 @@ struct dsw_queue {
 struct dsw_evdev {
 	struct rte_eventdev_data *data;
 
+	/* Parameters set by devargs at probe time. */
+	uint16_t flows_bits;
+	uint16_t flows_mask;
+	uint8_t flows_per_migration;
+	enum dsw_migration_mode migration_mode;
+	uint32_t migration_interval;
+	int16_t min_source_load;
+	int16_t max_target_load;
+	int16_t rebalance_threshold;
+
 	struct dsw_port ports[DSW_MAX_PORTS];
 	uint16_t num_ports;
 	struct dsw_queue queues[DSW_MAX_QUEUES];
@@ -287,6 +326,9 @@ dsw_pmd_priv(const struct rte_eventdev *eventdev)
 	return eventdev->data->dev_private;
 }
 
+#define DSW_LOG(level, fmt, args...)					\
+	RTE_LOG(level, EVENTDEV, "[%s] " fmt, DSW_PMD_NAME, ## args)
+
 #define DSW_LOG_DP(level, fmt, args...)					\
 	RTE_LOG_DP(level, EVENTDEV, "[%s] %s() line %u: " fmt,		\
 		   DSW_PMD_NAME,					\
@@ -240,6 +240,9 @@ dsw_port_add_paused_flows(struct dsw_port *port, struct dsw_queue_flow *qfs,
 {
 	uint8_t i;
 
+	if (port->paused_flows_len == 0 && qfs_len > 0)
+		port->pause_start = rte_get_timer_cycles();
+
 	for (i = 0; i < qfs_len; i++) {
 		struct dsw_queue_flow *qf = &qfs[i];
 
@@ -268,6 +271,11 @@ dsw_port_remove_paused_flow(struct dsw_port *port,
 				port->paused_flows[i] =
 					port->paused_flows[last_idx];
 			port->paused_flows_len--;
+			if (port->paused_flows_len == 0) {
+				port->pause_cycles += rte_get_timer_cycles() -
+					port->pause_start;
+				port->pauses++;
+			}
 			break;
 		}
 	}
@@ -388,19 +396,19 @@ dsw_flow_load(uint16_t num_events, int16_t port_load)
 		DSW_MAX_EVENTS_RECORDED;
 }
 
-static int16_t
-dsw_evaluate_migration(int16_t source_load, int16_t target_load,
-		       int16_t flow_load)
+static int32_t
+dsw_evaluate_migration(struct dsw_evdev *dsw, int16_t source_load,
+		       int16_t target_load, int16_t flow_load)
 {
 	int32_t res_target_load;
 	int32_t imbalance;
 
-	if (target_load > DSW_MAX_TARGET_LOAD_FOR_MIGRATION)
+	if (target_load > dsw->max_target_load)
 		return -1;
 
 	imbalance = source_load - target_load;
 
-	if (imbalance < DSW_REBALANCE_THRESHOLD)
+	if (imbalance < dsw->rebalance_threshold)
 		return -1;
 
 	res_target_load = target_load + flow_load;
@@ -412,6 +420,13 @@ dsw_evaluate_migration(int16_t source_load, int16_t target_load,
 	if (res_target_load > source_load)
 		return -1;
 
+	/* Pick the largest flow which fits, and for that flow, the
+	 * least loaded target port.
+	 */
+	if (dsw->migration_mode == DSW_MIGRATION_MODE_LARGEST_FLOW)
+		return ((int32_t)flow_load << 16) |
+			(DSW_MAX_LOAD - target_load);
+
 	/* The more idle the target will be, the better. This will
 	 * make migration prefer moving smaller flows, and flows to
 	 * lightly loaded ports.
@@ -444,11 +459,11 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 	int16_t source_port_load = port_loads[source_port_id];
 	struct dsw_queue_flow *candidate_qf = NULL;
 	uint8_t candidate_port_id = 0;
-	int16_t candidate_weight = -1;
+	int32_t candidate_weight = -1;
 	int16_t candidate_flow_load = -1;
 	uint16_t i;
 
-	if (source_port_load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION)
+	if (source_port_load < dsw->min_source_load)
 		return false;
 
 	for (i = 0; i < num_bursts; i++) {
@@ -464,7 +479,7 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 		flow_load = dsw_flow_load(burst->count, source_port_load);
 
 		for (port_id = 0; port_id < num_ports; port_id++) {
-			int16_t weight;
+			int32_t weight;
 
 			if (port_id == source_port_id)
 				continue;
@@ -472,7 +487,7 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 			if (!dsw_is_serving_port(dsw, port_id, qf->queue_id))
 				continue;
 
-			weight = dsw_evaluate_migration(source_port_load,
+			weight = dsw_evaluate_migration(dsw, source_port_load,
 							port_loads[port_id],
 							flow_load);
 
@@ -519,7 +534,7 @@ dsw_select_emigration_targets(struct dsw_evdev *dsw,
 	uint8_t *targets_len = &source_port->emigration_targets_len;
 	uint16_t i;
 
-	for (i = 0; i < DSW_MAX_FLOWS_PER_MIGRATION; i++) {
+	for (i = 0; i < dsw->flows_per_migration; i++) {
 		bool found;
 
 		found = dsw_select_emigration_target(dsw, bursts, num_bursts,
@@ -620,14 +635,14 @@ dsw_port_buffer_non_paused(struct dsw_evdev *dsw, struct dsw_port *source_port,
 
 #define DSW_FLOW_ID_BITS (24)
 static uint16_t
-dsw_flow_id_hash(uint32_t flow_id)
+dsw_flow_id_hash(const struct dsw_evdev *dsw, uint32_t flow_id)
 {
 	uint16_t hash = 0;
 	uint16_t offset = 0;
 
 	do {
-		hash ^= ((flow_id >> offset) & DSW_MAX_FLOWS_MASK);
-		offset += DSW_MAX_FLOWS_BITS;
+		hash ^= ((flow_id >> offset) & dsw->flows_mask);
+		offset += dsw->flows_bits;
 	} while (offset < DSW_FLOW_ID_BITS);
 
 	return hash;
@@ -642,7 +657,7 @@ dsw_port_buffer_parallel(struct dsw_evdev *dsw, struct dsw_port *source_port,
 	event.flow_id = dsw_port_get_parallel_flow_id(source_port);
 
 	dest_port_id = dsw_schedule(dsw, event.queue_id,
-				    dsw_flow_id_hash(event.flow_id));
+				    dsw_flow_id_hash(dsw, event.flow_id));
 
 	dsw_port_buffer_non_paused(dsw, source_port, dest_port_id, &event);
 }
@@ -660,7 +675,7 @@ dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *source_port,
 		return;
 	}
 
-	flow_hash = dsw_flow_id_hash(event->flow_id);
+	flow_hash = dsw_flow_id_hash(dsw, event->flow_id);
 
 	if (unlikely(dsw_port_is_flow_paused(source_port, event->queue_id,
 					     flow_hash))) {
@@ -700,7 +715,7 @@ dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 		struct rte_event *event = &paused_events[i];
 		uint16_t flow_hash;
 
-		flow_hash = dsw_flow_id_hash(event->flow_id);
+		flow_hash = dsw_flow_id_hash(dsw, event->flow_id);
 
 		if (event->queue_id == qf->queue_id &&
 		    flow_hash == qf->flow_hash)
@@ -720,6 +735,8 @@ dsw_port_emigration_stats(struct dsw_port *port, uint8_t finished)
 		(rte_get_timer_cycles() - port->emigration_start);
 	port->emigration_latency += (flow_migration_latency * finished);
 	port->emigrations += finished;
+	port->emigration_latency_max =
+		RTE_MAX(port->emigration_latency_max, flow_migration_latency);
 }
 
 static void
@@ -851,11 +868,11 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 	}
 
 	source_port_load = rte_atomic16_read(&source_port->load);
-	if (source_port_load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION) {
+	if (source_port_load < dsw->min_source_load) {
 		DSW_LOG_DP_PORT(DEBUG, source_port->id,
 		      "Load %d is below threshold level %d.\n",
 		      DSW_LOAD_TO_PERCENT(source_port_load),
-		      DSW_LOAD_TO_PERCENT(DSW_MIN_SOURCE_LOAD_FOR_MIGRATION));
+		      DSW_LOAD_TO_PERCENT(dsw->min_source_load));
 		return;
 	}
 
@@ -864,7 +881,7 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 	 */
 	any_port_below_limit =
 		dsw_retrieve_port_loads(dsw, port_loads,
-					DSW_MAX_TARGET_LOAD_FOR_MIGRATION);
+					dsw->max_target_load);
 	if (!any_port_below_limit) {
 		DSW_LOG_DP_PORT(DEBUG, source_port->id,
 				"Candidate target ports are all too highly "
@@ -988,7 +1005,8 @@ dsw_port_forward_emigrated_flow(struct dsw_port *source_port,
 		for (i = 0; i < in_len; i++) {
 			struct rte_event *e = &in_burst[i];
 			if (e->queue_id == queue_id &&
-			    dsw_flow_id_hash(e->flow_id) == flow_hash) {
+			    dsw_flow_id_hash(source_port->dsw,
+					     e->flow_id) == flow_hash) {
 				while (rte_event_ring_enqueue_burst(dest_ring,
 								    e, 1,
 								    NULL) != 1)
@@ -1294,7 +1312,7 @@ dsw_port_record_seen_events(struct dsw_port *port, struct rte_event *events,
 		struct dsw_queue_flow *qf = &port->seen_events[l_idx];
 		struct rte_event *event = &events[i];
 		qf->queue_id = event->queue_id;
-		qf->flow_hash = dsw_flow_id_hash(event->flow_id);
+		qf->flow_hash = dsw_flow_id_hash(port->dsw, event->flow_id);
 
 		port->seen_events_idx = (l_idx+1) % DSW_MAX_EVENTS_RECORDED;
 
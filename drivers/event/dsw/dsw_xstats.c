@@ -97,6 +97,20 @@ dsw_xstats_port_get_migration_latency(struct dsw_evdev *dsw, uint8_t port_id,
 	return num_emigrations > 0 ? total_latency / num_emigrations : 0;
 }
 
+DSW_GEN_PORT_ACCESS_FN(emigration_latency_max)
+
+static uint64_t
+dsw_xstats_port_get_pause_time(struct dsw_evdev *dsw, uint8_t port_id,
+			       uint8_t queue_id __rte_unused)
+{
+	uint64_t pause_cycles = dsw->ports[port_id].pause_cycles;
+	uint64_t pauses = dsw->ports[port_id].pauses;
+
+	return pauses > 0 ? pause_cycles / pauses : 0;
+}
+
+DSW_GEN_PORT_ACCESS_FN(pause_cycles)
+
 static uint64_t
 dsw_xstats_port_get_event_proc_latency(struct dsw_evdev *dsw, uint8_t port_id,
 				       uint8_t queue_id __rte_unused)
@@ -150,6 +164,12 @@ static struct dsw_xstats_port dsw_port_xstats[] = {
 	  false },
 	{ "port_%u_migration_latency", dsw_xstats_port_get_migration_latency,
 	  false },
+	{ "port_%u_migration_latency_max",
+	  dsw_xstats_port_get_emigration_latency_max, false },
+	{ "port_%u_pause_time", dsw_xstats_port_get_pause_time,
+	  false },
+	{ "port_%u_paused_cycles", dsw_xstats_port_get_pause_cycles,
+	  false },
 	{ "port_%u_immigrations", dsw_xstats_port_get_immigrations,
 	  false },
 	{ "port_%u_event_proc_latency", dsw_xstats_port_get_event_proc_latency,
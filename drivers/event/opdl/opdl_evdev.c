@@ -96,16 +96,6 @@ opdl_port_link(struct rte_eventdev *dev,
 	RTE_SET_USED(priorities);
 	RTE_SET_USED(dev);
 
-	if (unlikely(dev->data->dev_started)) {
-		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
-			     "Attempt to link queue (%u) to port %d while device started\n",
-			     dev->data->dev_id,
-				queues[0],
-				p->id);
-		rte_errno = EINVAL;
-		return 0;
-	}
-
 	/* Max of 1 queue per port */
 	if (num > 1) {
 		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
@@ -117,6 +107,11 @@ opdl_port_link(struct rte_eventdev *dev,
 		return 0;
 	}
 
+	/* Worker ports can rejoin their queue at runtime */
+	if (unlikely(dev->data->dev_started))
+		return num ? opdl_port_reconf_start(dev, p, queues[0], true) :
+			0;
+
 	if (!p->configured) {
 		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
 			     "port %d not configured, cannot link to %u\n",
@@ -151,19 +146,10 @@ opdl_port_unlink(struct rte_eventdev *dev,
 {
 	struct opdl_port *p = port;
 
-	RTE_SET_USED(queues);
-	RTE_SET_USED(nb_unlinks);
-
-	if (unlikely(dev->data->dev_started)) {
-		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
-			     "Attempt to unlink queue (%u) to port %d while device started\n",
-			     dev->data->dev_id,
-			     queues[0],
-			     p->id);
-		rte_errno = EINVAL;
-		return 0;
-	}
-	RTE_SET_USED(nb_unlinks);
+	/* Worker ports can leave their queue at runtime */
+	if (unlikely(dev->data->dev_started))
+		return nb_unlinks ?
+			opdl_port_reconf_start(dev, p, queues[0], false) : 0;
 
 	/* Port Stuff */
 	p->queue_id = OPDL_INVALID_QID;
@@ -174,6 +160,14 @@ opdl_port_unlink(struct rte_eventdev *dev,
 	return 0;
 }
 
+static int
+opdl_port_unlinks_in_progress(struct rte_eventdev *dev, void *port)
+{
+	RTE_SET_USED(dev);
+
+	return opdl_port_reconf_in_progress(port);
+}
+
 static int
 opdl_port_setup(struct rte_eventdev *dev,
 		uint8_t port_id,
@@ -463,10 +457,20 @@ opdl_stop(struct rte_eventdev *dev)
 {
 	struct opdl_evdev *device = opdl_pmd_priv(dev);
 
+	uint32_t i;
+
 	opdl_xstats_uninit(dev);
 
 	destroy_queues_and_rings(dev);
 
+	/* Ports unlinked at runtime are producers after a restart */
+	for (i = 0; i < device->nb_ports; i++) {
+		struct opdl_port *p = &device->ports[i];
+
+		if (p->p_type == OPDL_REGULAR_PORT &&
+				p->external_qid == OPDL_INVALID_QID)
+			p->queue_id = OPDL_INVALID_QID;
+	}
 
 	device->started = 0;
 
@@ -546,6 +550,9 @@ opdl_close(struct rte_eventdev *dev)
 			0xFF,
 			sizeof(struct opdl_queue_meta_data)*OPDL_MAX_QUEUES);
 
+	/* the last queue is found by the first slot not setup */
+	for (i = 0; i < OPDL_MAX_QUEUES; i++)
+		device->q_md[i].setup = 0;
 
 	memset(device->q_map_ex_to_in,
 			0,
@@ -624,6 +631,7 @@ opdl_probe(struct rte_vdev_device *vdev)
 		.port_release = opdl_port_release,
 		.port_link = opdl_port_link,
 		.port_unlink = opdl_port_unlink,
+		.port_unlinks_in_progress = opdl_port_unlinks_in_progress,
 
 
 		.xstats_get = opdl_xstats_get,
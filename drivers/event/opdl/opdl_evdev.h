@@ -70,6 +70,16 @@ enum queue_pos {
 	OPDL_Q_POS_END
 };
 
+/* Instance state of a regular port, changed by runtime link/unlink */
+enum port_reconf_state {
+	OPDL_PORT_ACTIVE = 0,	/* instance of its queue */
+	OPDL_PORT_INACTIVE,	/* unlinked, not an instance */
+	OPDL_PORT_RETIRING,	/* unlinked, finishing its entries */
+	OPDL_PORT_DRAINING,	/* atomic queue, waits for all instances at
+				 * reconf_seq to keep flows atomic
+				 */
+};
+
 #define QE_FLAG_VALID    (1 << QE_FLAG_VALID_SHIFT)    /* for NEW FWD, FRAG */
 #define QE_FLAG_COMPLETE (1 << QE_FLAG_COMPLETE_SHIFT) /* set for FWD, DROP  */
 #define QE_FLAG_NOT_EOP  (1 << QE_FLAG_NOT_EOP_SHIFT)  /* set for FRAG only  */
@@ -161,6 +171,11 @@ struct opdl_port {
 	/* instance ID of this stage*/
 	uint32_t instance_id;
 
+	/* runtime instance reconfiguration, see opdl_port_reconf() */
+	enum port_reconf_state reconf_state;
+	uint32_t reconf_ack;	/* last quiesce generation acknowledged */
+	uint32_t reconf_seq;	/* sequence number of the last change */
+
 	/* track packets in and out of this port */
 	uint64_t port_stat[max_num_port_xstat];
 	uint64_t start_cycles;
@@ -201,6 +216,14 @@ struct opdl_queue {
 	struct opdl_port *ports[OPDL_PORTS_MAX];
 	uint32_t nb_ports;
 
+	/* Runtime instance reconfiguration: reconf_gen is odd while the
+	 * instances are quiesced for reconf_port to join or leave.
+	 */
+	uint32_t reconf_gen;
+	uint32_t reconf_acks;
+	uint32_t nb_active;
+	struct opdl_port *reconf_port;
+
 	/* priority, reserved for future */
 	uint8_t priority;
 };
@@ -309,6 +332,9 @@ int initialise_all_other_ports(struct rte_eventdev *dev);
 int initialise_queue_zero_ports(struct rte_eventdev *dev);
 int assign_internal_queue_ids(struct rte_eventdev *dev);
 void destroy_queues_and_rings(struct rte_eventdev *dev);
+int opdl_port_reconf_start(struct rte_eventdev *dev, struct opdl_port *p,
+		uint8_t queue_id, bool link);
+int opdl_port_reconf_in_progress(struct opdl_port *p);
 int opdl_selftest(void);
 
 #endif /* _OPDL_EVDEV_H_ */
@@ -225,6 +225,210 @@ opdl_tx_dequeue_multi_inst(struct opdl_port *p,
 }
 
 
+/*
+ * Runtime instance reconfiguration
+ *
+ * A worker port is added to or removed from the instances of its queue by
+ * linking or unlinking it while the device is started. The active instances
+ * are quiesced first: each one acknowledges the request on its next dequeue
+ * and stops claiming. The last one to acknowledge picks the furthest head of
+ * the instances as the switch-over sequence number. Entries before it are
+ * distributed over the old instances, entries from it on over the new ones,
+ * so the order of the entries is never changed. A leaving instance finishes
+ * its entries before the switch-over and then hands its place in the
+ * dependencies of the next stages to a remaining instance.
+ */
+
+/* Find another instance of the queue to stand in for a port */
+static struct opdl_port *
+opdl_queue_other_instance(struct opdl_queue *q, struct opdl_port *p)
+{
+	uint32_t i;
+
+	for (i = 0; i < q->nb_ports; i++)
+		if (q->ports[i] != p &&
+				q->ports[i]->reconf_state != OPDL_PORT_INACTIVE)
+			return q->ports[i];
+
+	return NULL;
+}
+
+/* Run by the last instance to acknowledge, while all others are quiesced */
+static void
+opdl_queue_reconf_apply(struct opdl_queue *q, uint32_t gen)
+{
+	struct opdl_port *rp = q->reconf_port;
+	bool joining = (rp->reconf_state == OPDL_PORT_INACTIVE);
+	uint32_t nb = joining ? q->nb_active + 1 : q->nb_active - 1;
+	uint32_t i, id = 0, seq = 0, head;
+	bool first = true;
+
+	/* switch over where the furthest instance has claimed up to */
+	for (i = 0; i < q->nb_ports; i++) {
+		if (q->ports[i]->reconf_state == OPDL_PORT_INACTIVE)
+			continue;
+		head = opdl_stage_get_head(q->ports[i]->deq_stage_inst);
+		if (first || (int32_t)(head - seq) > 0)
+			seq = head;
+		first = false;
+	}
+
+	if (joining) {
+		struct opdl_stage *s = rp->deq_stage_inst;
+		struct opdl_ring *t = opdl_stage_get_opdl_ring(s);
+
+		/* No instance is past seq yet, so neither are the next stages.
+		 * Take back one of the places held by a stand-in.
+		 */
+		opdl_stage_reset(s, seq);
+		for (i = 0; i < q->nb_ports; i++)
+			if (q->ports[i]->reconf_state != OPDL_PORT_INACTIVE &&
+					opdl_ring_replace_dep(t,
+						q->ports[i]->deq_stage_inst,
+						s, false) != 0)
+				break;
+	}
+
+	for (i = 0; i < q->nb_ports; i++) {
+		struct opdl_port *p = q->ports[i];
+
+		if (p == rp && !joining) {
+			opdl_stage_set_instance(p->deq_stage_inst, 0, 0, seq);
+			p->reconf_state = OPDL_PORT_RETIRING;
+		} else if (p == rp || p->reconf_state != OPDL_PORT_INACTIVE) {
+			opdl_stage_set_instance(p->deq_stage_inst, nb, id++,
+					seq);
+			p->reconf_state = p->atomic_claim ?
+				OPDL_PORT_DRAINING : OPDL_PORT_ACTIVE;
+		}
+		p->reconf_seq = seq;
+	}
+	q->nb_active = nb;
+
+	__atomic_store_n(&q->reconf_gen, gen + 1, __ATOMIC_RELEASE);
+}
+
+/* Return true if the port may claim entries */
+static bool
+opdl_port_reconf(struct opdl_port *p, struct opdl_queue *q, uint32_t gen)
+{
+	struct opdl_stage *s = p->deq_stage_inst;
+	uint32_t i;
+
+	if (gen & 1) {
+		if (p->reconf_state != OPDL_PORT_INACTIVE &&
+				p->reconf_ack != gen) {
+			p->reconf_ack = gen;
+			if (__atomic_add_fetch(&q->reconf_acks, 1,
+					__ATOMIC_ACQ_REL) == q->nb_active)
+				opdl_queue_reconf_apply(q, gen);
+		}
+		return false;
+	}
+
+	switch (p->reconf_state) {
+	case OPDL_PORT_INACTIVE:
+		return false;
+	case OPDL_PORT_RETIRING:
+		if (opdl_stage_get_tail(s) != p->reconf_seq)
+			return true;
+		opdl_ring_replace_dep(opdl_stage_get_opdl_ring(s), s,
+				opdl_queue_other_instance(q, p)->deq_stage_inst,
+				true);
+		__atomic_store_n(&p->reconf_state, OPDL_PORT_INACTIVE,
+				__ATOMIC_RELEASE);
+		return false;
+	case OPDL_PORT_DRAINING:
+		if (opdl_stage_get_head(s) != p->reconf_seq)
+			return true;
+		for (i = 0; i < q->nb_ports; i++) {
+			struct opdl_port *o = q->ports[i];
+			uint32_t tail = opdl_stage_get_tail(o->deq_stage_inst);
+
+			if (__atomic_load_n(&o->reconf_state, __ATOMIC_ACQUIRE)
+					!= OPDL_PORT_INACTIVE &&
+					(int32_t)(tail - p->reconf_seq) < 0)
+				return false;
+		}
+		p->reconf_state = OPDL_PORT_ACTIVE;
+		return true;
+	default:
+		return true;
+	}
+}
+
+int
+opdl_port_reconf_start(struct rte_eventdev *dev, struct opdl_port *p,
+		uint8_t queue_id, bool link)
+{
+	struct opdl_evdev *device = opdl_pmd_priv(dev);
+	struct opdl_queue *q;
+	uint32_t i;
+
+	if (p->p_type != OPDL_REGULAR_PORT ||
+			p->queue_id >= device->nb_queues ||
+			device->queue[p->queue_id].q_pos != OPDL_Q_POS_MIDDLE ||
+			device->q_map_ex_to_in[queue_id] != p->queue_id) {
+		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
+			     "port %d can only be linked to or unlinked from"
+			     " its worker queue while device started",
+			     dev->data->dev_id, p->id);
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	q = &device->queue[p->queue_id];
+	if (link != (p->reconf_state == OPDL_PORT_INACTIVE) ||
+			(!link && q->nb_active == 1)) {
+		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
+			     "port %d cannot be %s queue %u",
+			     dev->data->dev_id, p->id,
+			     link ? "linked to" : "unlinked from", queue_id);
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	/* one change at a time per queue */
+	if (__atomic_load_n(&q->reconf_gen, __ATOMIC_ACQUIRE) & 1) {
+		rte_errno = EBUSY;
+		return 0;
+	}
+	for (i = 0; i < q->nb_ports; i++) {
+		enum port_reconf_state st = __atomic_load_n(
+				&q->ports[i]->reconf_state, __ATOMIC_ACQUIRE);
+
+		if (st == OPDL_PORT_RETIRING || st == OPDL_PORT_DRAINING) {
+			rte_errno = EBUSY;
+			return 0;
+		}
+	}
+
+	p->external_qid = link ? queue_id : OPDL_INVALID_QID;
+	q->reconf_port = p;
+	q->reconf_acks = 0;
+	__atomic_store_n(&q->reconf_gen, q->reconf_gen + 1, __ATOMIC_RELEASE);
+
+	return 1;
+}
+
+int
+opdl_port_reconf_in_progress(struct opdl_port *p)
+{
+	struct opdl_queue *q;
+
+	if (p->p_type != OPDL_REGULAR_PORT ||
+			p->queue_id >= p->opdl->nb_queues)
+		return 0;
+
+	q = &p->opdl->queue[p->queue_id];
+	if (q->reconf_port == p &&
+			(__atomic_load_n(&q->reconf_gen, __ATOMIC_ACQUIRE) & 1))
+		return 1;
+
+	return __atomic_load_n(&p->reconf_state, __ATOMIC_ACQUIRE) ==
+		OPDL_PORT_RETIRING;
+}
+
 /*
  * Worker thread claim
  *
@@ -233,6 +437,8 @@ opdl_tx_dequeue_multi_inst(struct opdl_port *p,
 static uint16_t
 opdl_claim(struct opdl_port *p, struct rte_event ev[], uint16_t num)
 {
+	struct opdl_queue *q = &p->opdl->queue[p->queue_id];
+	uint32_t gen = __atomic_load_n(&q->reconf_gen, __ATOMIC_ACQUIRE);
 	uint32_t num_events = 0;
 
 	if (unlikely(num > MAX_OPDL_CONS_Q_DEPTH)) {
@@ -244,6 +450,11 @@ opdl_claim(struct opdl_port *p, struct rte_event ev[], uint16_t num)
 		return 0;
 	}
 
+	if (unlikely((gen & 1) || p->reconf_state != OPDL_PORT_ACTIVE) &&
+			!opdl_port_reconf(p, q, gen)) {
+		update_on_dequeue(p, ev, num, 0);
+		return 0;
+	}
 
 	num_events = opdl_stage_claim(p->deq_stage_inst,
 			(void *)ev,
@@ -267,11 +478,7 @@ opdl_disclaim(struct opdl_port *p, const struct rte_event ev[], uint16_t num)
 {
 	uint16_t enqueued = 0;
 
-	uint32_t i = 0;
-
-	for (i = 0; i < num; i++)
-		opdl_ring_cas_slot(p->enq_stage_inst, &ev[i],
-				i, p->atomic_claim);
+	opdl_ring_cas_burst(p->enq_stage_inst, ev, num, p->atomic_claim);
 
 	enqueued = opdl_stage_disclaim(p->enq_stage_inst,
 				       num,
@@ -850,7 +1057,9 @@ initialise_all_other_ports(struct rte_eventdev *dev)
 				}
 
 				port->num_instance = queue->nb_ports;
+				port->reconf_state = OPDL_PORT_ACTIVE;
 				port->initialized = 1;
+				queue->nb_active = queue->nb_ports;
 				queue->initialized = 1;
 			} else {
 				PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
@@ -106,6 +106,11 @@ struct opdl_stage {
 	uint32_t shadow_head;  /* Shadow head for single-thread operation */
 	uint32_t queue_id;     /* ID of Queue which is assigned to this stage */
 	uint32_t pos;		/* Atomic scan position */
+	/* Instance change applied once head reaches switch_seq */
+	bool switch_pending;
+	uint32_t switch_seq;
+	uint32_t next_nb_instance;
+	uint32_t next_instance_id;
 } __rte_cache_aligned;
 
 /* Context for opdl_ring */
@@ -505,6 +510,15 @@ opdl_stage_claim_singlethread(struct opdl_stage *s, void *entries,
 	struct opdl_ring *t = s->t;
 	uint8_t *entries_offset = (uint8_t *)entries;
 
+	if (unlikely(s->switch_pending) && s->head == s->switch_seq) {
+		s->nb_instance = s->next_nb_instance;
+		s->instance_id = s->next_instance_id;
+		s->switch_pending = false;
+	}
+	/* retired instance */
+	if (unlikely(s->nb_instance == 0))
+		return 0;
+
 	if (!atomic) {
 
 		offset = opdl_first_entry_id(s->seq, s->nb_instance,
@@ -513,6 +527,9 @@ opdl_stage_claim_singlethread(struct opdl_stage *s, void *entries,
 		num_entries = s->nb_instance * num_entries;
 
 		num_entries = num_to_process(s, num_entries, block);
+		if (unlikely(s->switch_pending))
+			num_entries = RTE_MIN(num_entries,
+					s->switch_seq - s->head);
 
 		for (; offset < num_entries; offset += s->nb_instance) {
 			get_slots = get_slot(t, s->head + offset);
@@ -522,12 +539,18 @@ opdl_stage_claim_singlethread(struct opdl_stage *s, void *entries,
 		}
 	} else {
 		num_entries = num_to_process(s, num_entries, block);
+		if (unlikely(s->switch_pending))
+			num_entries = RTE_MIN(num_entries,
+					s->switch_seq - s->head);
 
+		/* The slots were published by the release of the dependencies'
+		 * tails, the event words only need to be read atomically.
+		 */
 		for (j = 0; j < num_entries; j++) {
 			ev = (struct rte_event *)get_slot(t, s->head+j);
 
 			event  = __atomic_load_n(&(ev->event),
-					__ATOMIC_ACQUIRE);
+					__ATOMIC_RELAXED);
 
 			opa_id = OPDL_OPA_MASK & (event >> OPDL_OPA_OFFSET);
 			flow_id  = OPDL_FLOWID_MASK & event;
@@ -968,14 +991,13 @@ opdl_ring_get_slot(const struct opdl_ring *t, uint32_t index)
 	return get_slot(t, index);
 }
 
-bool
-opdl_ring_cas_slot(struct opdl_stage *s, const struct rte_event *ev,
-		uint32_t index, bool atomic)
+void
+opdl_ring_cas_burst(struct opdl_stage *s, const struct rte_event ev[],
+		uint32_t num, bool atomic)
 {
-	uint32_t i = 0, offset;
+	uint32_t i, j, offset;
 	struct opdl_ring *t = s->t;
 	struct rte_event *ev_orig = NULL;
-	bool ev_updated = false;
 	uint64_t ev_temp    = 0;
 	uint64_t ev_update  = 0;
 
@@ -983,34 +1005,38 @@ opdl_ring_cas_slot(struct opdl_stage *s, const struct rte_event *ev,
 	uint32_t flow_id  = 0;
 	uint64_t event    = 0;
 
-	if (index > s->num_event) {
+	if (unlikely(num > s->num_event)) {
 		PMD_DRV_LOG(ERR, "index is overflow");
-		return ev_updated;
+		num = s->num_event;
 	}
 
-	ev_temp = ev->event & OPDL_EVENT_MASK;
-
+	/* Slots are published by the release of the tail in
+	 * opdl_stage_disclaim(), so no per-event barrier is needed here.
+	 */
 	if (!atomic) {
 		offset = opdl_first_entry_id(s->seq, s->nb_instance,
 				s->instance_id);
-		offset += index*s->nb_instance;
-		ev_orig = get_slot(t, s->shadow_head+offset);
-		if ((ev_orig->event&OPDL_EVENT_MASK) != ev_temp) {
-			ev_orig->event = ev->event;
-			ev_updated = true;
-		}
-		if (ev_orig->u64 != ev->u64) {
-			ev_orig->u64 = ev->u64;
-			ev_updated = true;
+
+		for (i = 0; i < num; i++, offset += s->nb_instance) {
+			ev_temp = ev[i].event & OPDL_EVENT_MASK;
+			ev_orig = get_slot(t, s->shadow_head + offset);
+			if ((ev_orig->event & OPDL_EVENT_MASK) != ev_temp)
+				ev_orig->event = ev[i].event;
+			if (ev_orig->u64 != ev[i].u64)
+				ev_orig->u64 = ev[i].u64;
 		}
+		return;
+	}
 
-	} else {
-		for (i = s->pos; i < s->num_claimed; i++) {
+	for (i = 0, j = s->pos; i < num; i++) {
+		ev_temp = ev[i].event & OPDL_EVENT_MASK;
+
+		for (; j < s->num_claimed; j++) {
 			ev_orig = (struct rte_event *)
-				get_slot(t, s->shadow_head+i);
+				get_slot(t, s->shadow_head + j);
 
 			event  = __atomic_load_n(&(ev_orig->event),
-					__ATOMIC_ACQUIRE);
+					__ATOMIC_RELAXED);
 
 			opa_id = OPDL_OPA_MASK & (event >> OPDL_OPA_OFFSET);
 			flow_id  = OPDL_FLOWID_MASK & event;
@@ -1018,32 +1044,24 @@ opdl_ring_cas_slot(struct opdl_stage *s, const struct rte_event *ev,
 			if (opa_id >= s->queue_id)
 				continue;
 
-			if ((flow_id % s->nb_instance) == s->instance_id) {
+			if ((flow_id % s->nb_instance) != s->instance_id)
+				continue;
+
+			if ((event & OPDL_EVENT_MASK) != ev_temp) {
 				ev_update = s->queue_id;
 				ev_update = (ev_update << OPDL_OPA_OFFSET)
-					| ev->event;
-
-				s->pos = i + 1;
-
-				if ((event & OPDL_EVENT_MASK) !=
-						ev_temp) {
-					__atomic_store_n(&(ev_orig->event),
-							ev_update,
-							__ATOMIC_RELEASE);
-					ev_updated = true;
-				}
-				if (ev_orig->u64 != ev->u64) {
-					ev_orig->u64 = ev->u64;
-					ev_updated = true;
-				}
-
-				break;
+					| ev[i].event;
+				__atomic_store_n(&(ev_orig->event), ev_update,
+						__ATOMIC_RELAXED);
 			}
-		}
+			if (ev_orig->u64 != ev[i].u64)
+				ev_orig->u64 = ev[i].u64;
 
+			j++;
+			break;
+		}
 	}
-
-	return ev_updated;
+	s->pos = j;
 }
 
 int
@@ -1189,6 +1207,71 @@ opdl_stage_set_queue_id(struct opdl_stage *s,
 	s->queue_id = queue_id;
 }
 
+uint32_t
+opdl_stage_get_head(const struct opdl_stage *s)
+{
+	return s->head;
+}
+
+uint32_t
+opdl_stage_get_tail(const struct opdl_stage *s)
+{
+	return __atomic_load_n(&s->shared.tail, __ATOMIC_ACQUIRE);
+}
+
+void
+opdl_stage_set_instance(struct opdl_stage *s, uint32_t nb_instance,
+		uint32_t instance_id, uint32_t seq)
+{
+	s->next_nb_instance = nb_instance;
+	s->next_instance_id = instance_id;
+	s->switch_seq = seq;
+	s->switch_pending = true;
+}
+
+void
+opdl_stage_reset(struct opdl_stage *s, uint32_t seq)
+{
+	s->available_seq = seq;
+	s->head = seq;
+	s->shadow_head = seq;
+	s->seq = seq;
+	s->num_claimed = 0;
+	s->num_event = 0;
+	s->pos = 0;
+	__atomic_store_n(&s->shared.tail, seq, __ATOMIC_RELEASE);
+}
+
+uint32_t
+opdl_ring_replace_dep(struct opdl_ring *t, const struct opdl_stage *from,
+		struct opdl_stage *to, bool all)
+{
+	uint32_t i, j, n = 0;
+
+	for (i = 0; i < t->num_stages; i++) {
+		struct opdl_stage *s = &t->stages[i];
+		bool seen = false;
+
+		for (j = 0; j < s->num_deps; j++) {
+			if (s->deps[j] != &from->shared)
+				continue;
+			/* keep the first occurrence unless all are replaced */
+			if (!all && !seen) {
+				seen = true;
+				continue;
+			}
+			/* readers see either tail, both are safe to wait on */
+			__atomic_store_n(&s->deps[j], &to->shared,
+					__ATOMIC_RELEASE);
+			n++;
+			if (!all)
+				break;
+		}
+	}
+
+	return n;
+}
+
 void
 opdl_ring_dump(const struct opdl_ring *t, FILE *f)
 {
@@ -586,26 +586,105 @@ opdl_ring_set_stage_threadsafe(struct opdl_stage *s, bool threadsafe);
 
 
 /**
- * Compare the event descriptor with original version in the ring.
- * if key field event descriptor is changed by application, then
- * update the slot in the ring otherwise do nothing with it.
- * the key field is flow_id, priority, mbuf, impl_opaque
+ * Compare a burst of event descriptors with their original versions in the
+ * ring. If a key field of an event descriptor has been changed by the
+ * application, the slot in the ring is updated, otherwise it is left alone.
+ * The key fields are flow_id, priority, mbuf and impl_opaque. The slots are
+ * made visible to dependent stages by opdl_stage_disclaim().
  *
  * @param s
  *   The opdl_stage.
  * @param ev
- *   pointer of the event descriptor.
- * @param index
- *   index of the event descriptor.
+ *   Array of event descriptors, in the order they were claimed.
+ * @param num
+ *   Number of event descriptors.
  * @param atomic
  *   queue type associate with the stage.
+ */
+void
+opdl_ring_cas_burst(struct opdl_stage *s, const struct rte_event ev[],
+		uint32_t num, bool atomic);
+
+/**
+ * Get the head of a single-thread stage, i.e. the sequence number up to which
+ * it has claimed entries.
+ *
+ * @param s
+ *   The opdl_stage.
  * @return
- *   if the event key field is changed compare with previous record.
+ *   The head sequence number.
  */
+uint32_t
+opdl_stage_get_head(const struct opdl_stage *s);
 
-bool
-opdl_ring_cas_slot(struct opdl_stage *s, const struct rte_event *ev,
-		uint32_t index, bool atomic);
+/**
+ * Get the tail of a stage, i.e. the sequence number up to which it has
+ * disclaimed entries.
+ *
+ * @param s
+ *   The opdl_stage.
+ * @return
+ *   The tail sequence number.
+ */
+uint32_t
+opdl_stage_get_tail(const struct opdl_stage *s);
+
+/**
+ * Change the instance configuration of a single-thread stage from a given
+ * sequence number on. Claims do not cross that sequence number, entries before
+ * it are distributed with the current configuration and entries from it on
+ * with the new one. An instance with nb_instance of 0 claims no more entries
+ * once it reaches the sequence number.
+ *
+ * Must only be called while the thread using the stage does not claim.
+ *
+ * @param s
+ *   The opdl_stage.
+ * @param nb_instance
+ *   New number of instances of the stage, 0 to retire this instance.
+ * @param instance_id
+ *   New ID of this instance.
+ * @param seq
+ *   Sequence number from which the new configuration applies.
+ */
+void
+opdl_stage_set_instance(struct opdl_stage *s, uint32_t nb_instance,
+		uint32_t instance_id, uint32_t seq);
+
+/**
+ * Restart an idle single-thread stage at a sequence number, as if it had
+ * processed all entries before it.
+ *
+ * @param s
+ *   The opdl_stage.
+ * @param seq
+ *   Sequence number of the next entry to claim.
+ */
+void
+opdl_stage_reset(struct opdl_stage *s, uint32_t seq);
+
+/**
+ * Replace a dependency of the stages of a opdl_ring while it is running.
+ * Stages waiting on the tail of one stage wait on the tail of another one
+ * instead. This is only safe if the entries up to the tail of either stage
+ * can be processed by the dependent stages.
+ *
+ * @param t
+ *   The opdl_ring.
+ * @param from
+ *   The stage to replace as a dependency.
+ * @param to
+ *   The stage to depend on instead.
+ * @param all
+ *   If true every dependency on from is replaced, otherwise only stages
+ *   depending on it more than once are changed, and only one of their
+ *   dependencies on it.
+ * @return
+ *   Number of dependencies replaced.
+ */
+uint32_t
+opdl_ring_replace_dep(struct opdl_ring *t, const struct opdl_stage *from,
+		struct opdl_stage *to, bool all);
 
 #ifdef __cplusplus
 }
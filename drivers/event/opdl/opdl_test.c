@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/queue.h>
@@ -981,6 +982,152 @@ qid_basic(struct test *t)
 
 
 
+#define RECONF_EVENTS (NUM_EVENTS * 64)
+#define RECONF_ITERATIONS (1 << 20)
+
+/*
+ * Remove a worker instance from a queue at runtime and add it back, while
+ * events keep flowing through the pipeline. The removed worker is not polled
+ * once its unlink has completed, so it must no longer hold back the next
+ * stage. The events must still reach the tx port in order.
+ */
+static int
+runtime_reconfig(struct test *t, enum queue_type type)
+{
+	const uint8_t rx_port = 0;
+	const uint8_t w1_port = 1;
+	const uint8_t w2_port = 2;
+	const uint8_t w3_port = 3;
+	const uint8_t tx_port = 4;
+	struct rte_event ev[BURST_SIZE];
+	uint64_t sent = 0, received = 0;
+	uint32_t i, n, iter;
+	int phase = 0;
+	int err;
+
+	if (init(t, 2, tx_port+1) < 0 ||
+	    create_ports(t, tx_port+1) < 0 ||
+	    create_queues_type(t, 2, type)) {
+		PMD_DRV_LOG(ERR, "%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	for (i = w1_port; i <= w3_port; i++) {
+		err = rte_event_port_link(evdev, t->port[i], &t->qid[0], NULL,
+				1);
+		if (err != 1) {
+			PMD_DRV_LOG(ERR, "%d: error mapping lb qid\n",
+					__LINE__);
+			cleanup(t);
+			return -1;
+		}
+	}
+
+	err = rte_event_port_link(evdev, t->port[tx_port], &t->qid[1], NULL,
+			1);
+	if (err != 1) {
+		PMD_DRV_LOG(ERR, "%d: error mapping TX  qid\n", __LINE__);
+		cleanup(t);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		PMD_DRV_LOG(ERR, "%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (iter = 0; received < RECONF_EVENTS &&
+			iter < RECONF_ITERATIONS; iter++) {
+		n = RTE_MIN((uint64_t)BURST_SIZE, RECONF_EVENTS - sent);
+		for (i = 0; i < n; i++)
+			ev[i] = (struct rte_event) {
+				.queue_id = t->qid[0],
+				.op = RTE_EVENT_OP_NEW,
+				.flow_id = (sent + i) % 7,
+				.u64 = sent + i,
+			};
+		sent += rte_event_enqueue_burst(evdev, t->port[rx_port],
+				ev, n);
+
+		for (i = w1_port; i <= w3_port; i++) {
+			uint32_t j;
+
+			/* w2 is not an instance once its unlink completed */
+			if (i == w2_port && phase == 2)
+				continue;
+
+			n = rte_event_dequeue_burst(evdev, t->port[i], ev,
+					BURST_SIZE, 0);
+			if (n == 0)
+				continue;
+			for (j = 0; j < n; j++) {
+				ev[j].op = RTE_EVENT_OP_FORWARD;
+				ev[j].queue_id = t->qid[1];
+			}
+			if (rte_event_enqueue_burst(evdev, t->port[i], ev,
+					n) != n) {
+				PMD_DRV_LOG(ERR, "%d: Failed to enqueue\n",
+						__LINE__);
+				goto err;
+			}
+		}
+
+		n = rte_event_dequeue_burst(evdev, t->port[tx_port], ev,
+				BURST_SIZE, 0);
+		for (i = 0; i < n; i++, received++) {
+			if (ev[i].u64 != received) {
+				PMD_DRV_LOG(ERR, "%d: event %"PRIu64" out of order, expected %"PRIu64"\n",
+						__LINE__, ev[i].u64, received);
+				goto err;
+			}
+		}
+
+		if (phase == 0 && received >= RECONF_EVENTS / 4) {
+			if (rte_event_port_unlink(evdev, t->port[w2_port],
+					&t->qid[0], 1) != 1) {
+				PMD_DRV_LOG(ERR, "%d: runtime unlink failed\n",
+						__LINE__);
+				goto err;
+			}
+			/* only one change per queue at a time */
+			if (rte_event_port_unlink(evdev, t->port[w1_port],
+					&t->qid[0], 1) != 0 ||
+					rte_errno != EBUSY) {
+				PMD_DRV_LOG(ERR, "%d: second unlink not refused\n",
+						__LINE__);
+				goto err;
+			}
+			phase = 1;
+		} else if (phase == 1 && rte_event_port_unlinks_in_progress(
+					evdev, t->port[w2_port]) == 0) {
+			phase = 2;
+		} else if (phase == 2 && received >= RECONF_EVENTS / 2) {
+			if (rte_event_port_link(evdev, t->port[w2_port],
+					&t->qid[0], NULL, 1) != 1) {
+				PMD_DRV_LOG(ERR, "%d: runtime link failed\n",
+						__LINE__);
+				goto err;
+			}
+			phase = 3;
+		}
+	}
+
+	if (received != RECONF_EVENTS || phase != 3) {
+		PMD_DRV_LOG(ERR, "%d: got %"PRIu64" of %u events, phase %d\n",
+				__LINE__, received, RECONF_EVENTS, phase);
+		goto err;
+	}
+
+	cleanup(t);
+	return 0;
+
+err:
+	rte_event_dev_dump(evdev, stdout);
+	cleanup(t);
+	return -1;
+}
+
+
 int
 opdl_selftest(void)
 {
@@ -1041,6 +1188,12 @@ opdl_selftest(void)
 	PMD_DRV_LOG(ERR, "*** Running SINGLE LINK w stats test...\n");
 	ret = single_link_w_stats(t);
 
+	PMD_DRV_LOG(ERR, "*** Running Runtime reconfig test...\n");
+	if (ret == 0)
+		ret = runtime_reconfig(t, OPDL_Q_TYPE_ORDERED);
+	if (ret == 0)
+		ret = runtime_reconfig(t, OPDL_Q_TYPE_ATOMIC);
+
 	/*
 	 * Free test instance, free  mempool
 	 */
@@ -19,6 +19,10 @@
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define SCHED_CORES_ARG "sched_cores"
+#define MAX_EVENTS_ARG "max_events"
+#define PROD_Q_DEPTH_ARG "prod_q_depth"
+#define QID_FIDS_ARG "qid_fids"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
@@ -92,6 +96,7 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 	struct sw_port *p = port;
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	unsigned int i, j;
+	uint8_t scheds = 0;
 
 	int unlinked = 0;
 	for (i = 0; i < nb_unlinks; i++) {
@@ -109,12 +114,17 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 				if (q->type == RTE_SCHED_TYPE_ORDERED)
 					p->num_ordered_qids--;
 
+				scheds |= 1 << q->sched;
 				continue;
 			}
 		}
 	}
 
+	/* the previous unlinks are over once all instances acked them */
+	if (__atomic_load_n(&p->unlinks_scheds, __ATOMIC_ACQUIRE) == 0)
+		p->unlinks_in_progress = 0;
 	p->unlinks_in_progress += unlinked;
+	__atomic_fetch_or(&p->unlinks_scheds, scheds, __ATOMIC_RELEASE);
 	rte_smp_mb();
 
 	return unlinked;
@@ -125,9 +135,33 @@ sw_port_unlinks_in_progress(struct rte_eventdev *dev, void *port)
 {
 	RTE_SET_USED(dev);
 	struct sw_port *p = port;
+
+	if (__atomic_load_n(&p->unlinks_scheds, __ATOMIC_ACQUIRE) == 0)
+		return 0;
 	return p->unlinks_in_progress;
 }
 
+static int
+sw_port_hist_init(struct sw_evdev *sw, struct sw_port *p)
+{
+	uint32_t i;
+
+	p->hist_list = rte_zmalloc_socket(NULL,
+			sizeof(p->hist_list[0]) * sw->prod_q_depth,
+			RTE_CACHE_LINE_SIZE, sw->data->socket_id);
+	if (p->hist_list == NULL)
+		return -ENOMEM;
+
+	/* set hist list contents to empty */
+	p->hist_mask = sw->prod_q_depth - 1;
+	for (i = 0; i < sw->prod_q_depth; i++) {
+		p->hist_list[i].fid = -1;
+		p->hist_list[i].qid = -1;
+	}
+
+	return 0;
+}
+
 static int
 sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		const struct rte_event_port_conf *conf)
@@ -135,7 +169,6 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_port *p = &sw->ports[port_id];
 	char buf[RTE_RING_NAMESIZE];
-	unsigned int i;
 
 	struct rte_event_dev_info info;
 	sw_info_get(dev, &info);
@@ -151,6 +184,7 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		rte_atomic32_sub(&sw->inflights, possible_inflights);
 	}
 
+	rte_free(p->hist_list);
 	*p = (struct sw_port){0}; /* zero entire structure */
 	p->id = port_id;
 	p->sw = sw;
@@ -165,7 +199,7 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	if (existing_ring)
 		rte_event_ring_free(existing_ring);
 
-	p->rx_worker_ring = rte_event_ring_create(buf, MAX_SW_PROD_Q_DEPTH,
+	p->rx_worker_ring = rte_event_ring_create(buf, sw->prod_q_depth,
 			dev->data->socket_id,
 			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
 	if (p->rx_worker_ring == NULL) {
@@ -189,16 +223,21 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
 	if (p->cq_worker_ring == NULL) {
 		rte_event_ring_free(p->rx_worker_ring);
+		p->rx_worker_ring = NULL;
 		SW_LOG_ERR("Error creating CQ worker ring for port %d\n",
 				port_id);
 		return -1;
 	}
-	sw->cq_ring_space[port_id] = conf->dequeue_depth;
+	sw->sched[0].cq_ring_space[port_id] = conf->dequeue_depth;
 
-	/* set hist list contents to empty */
-	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
-		p->hist_list[i].fid = -1;
-		p->hist_list[i].qid = -1;
+	if (sw_port_hist_init(sw, p) != 0) {
+		rte_event_ring_free(p->rx_worker_ring);
+		rte_event_ring_free(p->cq_worker_ring);
+		p->rx_worker_ring = NULL;
+		p->cq_worker_ring = NULL;
+		SW_LOG_ERR("Error allocating history list for port %d\n",
+				port_id);
+		return -ENOMEM;
 	}
 	dev->data->ports[port_id] = p;
 
@@ -216,6 +255,7 @@ sw_port_release(void *port)
 
 	rte_event_ring_free(p->rx_worker_ring);
 	rte_event_ring_free(p->cq_worker_ring);
+	rte_free(p->hist_list);
 	memset(p, 0, sizeof(*p));
 }
 
@@ -224,14 +264,36 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 		const struct rte_event_queue_conf *queue_conf)
 {
 	unsigned int i;
+	uint32_t nb_fids;
 	int dev_id = sw->data->dev_id;
 	int socket_id = sw->data->socket_id;
 	char buf[IQ_ROB_NAMESIZE];
 	struct sw_qid *qid = &sw->qids[idx];
 
+	/* spread QIDs over the scheduler instances */
+	qid->sched = idx % sw->nb_scheds;
+
+	/* size the flow table for the number of atomic flows requested,
+	 * bigger tables mean less unrelated flows serialized by collisions
+	 */
+	nb_fids = sw->nb_fids;
+	if (type == RTE_SCHED_TYPE_ATOMIC &&
+			queue_conf->nb_atomic_flows > nb_fids)
+		nb_fids = RTE_MIN(rte_align32pow2(queue_conf->nb_atomic_flows),
+				(uint32_t)SW_QID_MAX_FIDS);
+
+	qid->fids = rte_malloc_socket(NULL, nb_fids * sizeof(qid->fids[0]),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (qid->fids == NULL) {
+		SW_LOG_DBG("fids malloc failed\n");
+		return -ENOMEM;
+	}
+	qid->fid_mask = nb_fids - 1;
+	qid->fid_shift = rte_bsf32(nb_fids);
+
 	/* Initialize the FID structures to no pinning (-1), and zero packets */
 	const struct sw_fid_t fid = {.cq = -1, .pcount = 0};
-	for (i = 0; i < RTE_DIM(qid->fids); i++)
+	for (i = 0; i < nb_fids; i++)
 		qid->fids[i] = fid;
 
 	qid->id = idx;
@@ -306,6 +368,9 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 	return 0;
 
 cleanup:
+	rte_free(qid->fids);
+	qid->fids = NULL;
+
 	if (qid->reorder_buffer) {
 		rte_free(qid->reorder_buffer);
 		qid->reorder_buffer = NULL;
@@ -329,6 +394,7 @@ sw_queue_release(struct rte_eventdev *dev, uint8_t id)
 		rte_free(qid->reorder_buffer);
 		rte_ring_free(qid->reorder_buffer_freelist);
 	}
+	rte_free(qid->fids);
 	memset(qid, 0, sizeof(*qid));
 }
 
@@ -369,7 +435,7 @@ sw_init_qid_iqs(struct sw_evdev *sw)
 			continue;
 
 		for (j = 0; j < SW_IQS_MAX; j++)
-			iq_init(sw, &qid->iq[j]);
+			iq_init(&sw->sched[qid->sched], &qid->iq[j]);
 	}
 }
 
@@ -391,12 +457,22 @@ sw_qids_empty(struct sw_evdev *sw)
 static int
 sw_ports_empty(struct sw_evdev *sw)
 {
-	unsigned int i;
+	unsigned int i, j, k;
 
-	for (i = 0; i < sw->port_count; i++) {
-		if ((rte_event_ring_count(sw->ports[i].rx_worker_ring)) ||
-		     rte_event_ring_count(sw->ports[i].cq_worker_ring))
-			return 0;
+	for (k = 0; k < sw->nb_scheds; k++) {
+		const struct sw_sched *s = &sw->sched[k];
+
+		for (i = 0; i < sw->port_count; i++) {
+			if ((rte_event_ring_count(s->ports[i].rx_worker_ring)) ||
+			     rte_event_ring_count(s->ports[i].cq_worker_ring))
+				return 0;
+		}
+
+		for (j = 0; j < sw->nb_scheds; j++) {
+			if (s->xfer_ring[j] != NULL &&
+					rte_event_ring_count(s->xfer_ring[j]))
+				return 0;
+		}
 	}
 
 	return 1;
@@ -429,9 +505,9 @@ sw_drain_ports(struct rte_eventdev *dev)
 }
 
 static void
-sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
+sw_drain_queue(struct rte_eventdev *dev, struct sw_sched *s,
+		struct sw_iq *iq)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	eventdev_stop_flush_t flush;
 	uint8_t dev_id;
 	void *arg;
@@ -443,7 +519,7 @@ sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
 	while (iq_count(iq) > 0) {
 		struct rte_event ev;
 
-		iq_dequeue_burst(sw, iq, &ev, 1);
+		iq_dequeue_burst(s, iq, &ev, 1);
 
 		if (flush)
 			flush(dev_id, ev, arg);
@@ -457,8 +533,11 @@ sw_drain_queues(struct rte_eventdev *dev)
 	unsigned int i, j;
 
 	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+
 		for (j = 0; j < SW_IQS_MAX; j++)
-			sw_drain_queue(dev, &sw->qids[i].iq[j]);
+			sw_drain_queue(dev, &sw->sched[qid->sched],
+					&qid->iq[j]);
 	}
 }
 
@@ -475,7 +554,8 @@ sw_clean_qid_iqs(struct rte_eventdev *dev)
 		for (j = 0; j < SW_IQS_MAX; j++) {
 			if (!qid->iq[j].head)
 				continue;
-			iq_free_chunk_list(sw, qid->iq[j].head);
+			iq_free_chunk_list(&sw->sched[qid->sched],
+					qid->iq[j].head);
 			qid->iq[j].head = NULL;
 		}
 	}
@@ -518,6 +598,7 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
 	int num_chunks, i;
+	uint32_t k;
 
 	sw->qid_count = conf->nb_event_queues;
 	sw->port_count = conf->nb_event_ports;
@@ -525,27 +606,33 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	rte_atomic32_set(&sw->inflights, 0);
 
 	/* Number of chunks sized for worst-case spread of events across IQs */
-	num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
+	num_chunks = ((sw->max_events/SW_EVS_PER_Q_CHUNK)+1) +
 			sw->qid_count*SW_IQS_MAX*2;
 
 	/* If this is a reconfiguration, free the previous IQ allocation. All
 	 * IQ chunk references were cleaned out of the QIDs in sw_stop(), and
 	 * will be reinitialized in sw_start().
+	 * Each scheduler instance has its own pool, as events can be
+	 * spread unevenly across the instances.
 	 */
-	if (sw->chunks)
-		rte_free(sw->chunks);
-
-	sw->chunks = rte_malloc_socket(NULL,
-				       sizeof(struct sw_queue_chunk) *
-				       num_chunks,
-				       0,
-				       sw->data->socket_id);
-	if (!sw->chunks)
-		return -ENOMEM;
-
-	sw->chunk_list_head = NULL;
-	for (i = 0; i < num_chunks; i++)
-		iq_free_chunk(sw, &sw->chunks[i]);
+	for (k = 0; k < sw->nb_scheds; k++) {
+		struct sw_sched *s = &sw->sched[k];
+
+		if (s->chunks)
+			rte_free(s->chunks);
+
+		s->chunks = rte_malloc_socket(NULL,
+					      sizeof(struct sw_queue_chunk) *
+					      num_chunks,
+					      0,
+					      sw->data->socket_id);
+		if (!s->chunks)
+			return -ENOMEM;
+
+		s->chunk_list_head = NULL;
+		for (i = 0; i < num_chunks; i++)
+			iq_free_chunk(s, &s->chunks[i]);
+	}
 
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
@@ -596,18 +683,16 @@ sw_crypto_adapter_caps_get(const struct rte_eventdev *dev,
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 {
-	RTE_SET_USED(dev);
+	const struct sw_evdev *sw = sw_pmd_priv(dev);
 
 	static const struct rte_event_dev_info evdev_sw_info = {
 			.driver_name = SW_PMD_NAME,
 			.max_event_queues = RTE_EVENT_MAX_QUEUES_PER_DEV,
-			.max_event_queue_flows = SW_QID_NUM_FIDS,
+			.max_event_queue_flows = SW_QID_MAX_FIDS,
 			.max_event_queue_priority_levels = SW_Q_PRIORITY_MAX,
 			.max_event_priority_levels = SW_IQS_MAX,
 			.max_event_ports = SW_PORTS_MAX,
 			.max_event_port_dequeue_depth = MAX_SW_CONS_Q_DEPTH,
-			.max_event_port_enqueue_depth = MAX_SW_PROD_Q_DEPTH,
-			.max_num_events = SW_INFLIGHT_EVENTS_TOTAL,
 			.event_dev_cap = (
 				RTE_EVENT_DEV_CAP_QUEUE_QOS |
 				RTE_EVENT_DEV_CAP_BURST_MODE |
@@ -619,6 +704,10 @@ sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 	};
 
 	*info = evdev_sw_info;
+
+	/* limits configurable with devargs */
+	info->max_event_port_enqueue_depth = sw->prod_q_depth;
+	info->max_num_events = sw->max_events;
 }
 
 static void
@@ -630,15 +719,26 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 			"Ordered", "Atomic", "Parallel", "Directed"
 	};
 	uint32_t i;
-	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
-			sw->port_count, sw->qid_count);
-
-	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+	fprintf(f, "EventDev %s: ports %d, qids %d, schedulers %u\n",
+			"todo-fix-name", sw->port_count, sw->qid_count,
+			sw->nb_scheds);
+
+	for (i = 0; i < sw->nb_scheds; i++) {
+		const struct sw_sched *s = &sw->sched[i];
+
+		fprintf(f, "  Scheduler %u\n", i);
+		fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n"
+			"\ttx   %"PRIu64"\n",
+			s->stats.rx_pkts, s->stats.rx_dropped,
+			s->stats.tx_pkts);
+		fprintf(f, "\tsched calls: %"PRIu64"\n", s->sched_called);
+		fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+			s->sched_cq_qid_called);
+		fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+			s->sched_no_iq_enqueues);
+		fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+			s->sched_no_cq_enqueues);
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -735,7 +835,7 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		}
 
 		uint32_t flow;
-		for (flow = 0; flow < RTE_DIM(qid->fids); flow++)
+		for (flow = 0; flow <= qid->fid_mask; flow++)
 			if (qid->fids[flow].cq != -1) {
 				affinities_per_port[qid->fids[flow].cq]++;
 				inflights += qid->fids[flow].pcount;
@@ -770,10 +870,147 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	}
 }
 
+static void
+sw_sched_uninit(struct sw_evdev *sw)
+{
+	uint32_t i, j, k;
+
+	for (k = 0; k < SW_SCHED_MAX; k++) {
+		struct sw_sched *s = &sw->sched[k];
+
+		for (j = 0; j < SW_SCHED_MAX; j++) {
+			rte_event_ring_free(s->xfer_ring[j]);
+			s->xfer_ring[j] = NULL;
+			s->xfer_count[j] = 0;
+		}
+
+		if (s->ports == sw->ports)
+			continue;
+
+		for (i = 0; i < sw->port_count; i++) {
+			rte_event_ring_free(s->ports[i].rx_worker_ring);
+			rte_event_ring_free(s->ports[i].cq_worker_ring);
+			rte_free(s->ports[i].hist_list);
+		}
+		rte_free(s->ports);
+		s->ports = sw->ports;
+	}
+
+	for (i = 0; i < sw->port_count; i++) {
+		struct sw_port *p = &sw->ports[i];
+
+		rte_free(p->deq_sched);
+		p->deq_sched = NULL;
+		p->nb_scheds = 0;
+		memset(p->sched_rx_ring, 0, sizeof(p->sched_rx_ring));
+		memset(p->sched_cq_ring, 0, sizeof(p->sched_cq_ring));
+	}
+}
+
+/* create the port rings of the extra scheduler instances and the rings
+ * used to pass events between the instances.
+ */
+static int
+sw_sched_init(struct sw_evdev *sw)
+{
+	const uint32_t flags = RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ;
+	int dev_id = sw->data->dev_id;
+	int socket_id = sw->data->socket_id;
+	char buf[RTE_RING_NAMESIZE];
+	uint32_t i, j, k, depth;
+
+	for (k = 1; k < sw->nb_scheds; k++) {
+		struct sw_sched *s = &sw->sched[k];
+
+		s->ports = rte_zmalloc_socket(NULL,
+				sizeof(s->ports[0]) * sw->port_count,
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (s->ports == NULL) {
+			s->ports = sw->ports;
+			goto error;
+		}
+
+		for (i = 0; i < sw->port_count; i++) {
+			struct sw_port *p = &s->ports[i];
+
+			p->id = i;
+			p->sw = sw;
+			if (sw_port_hist_init(sw, p) != 0) {
+				SW_LOG_ERR("Error allocating history list for "
+					"port %u of scheduler %u\n", i, k);
+				goto error;
+			}
+
+			snprintf(buf, sizeof(buf), "sw%d_s%u_p%u_rx",
+					dev_id, k, i);
+			p->rx_worker_ring = rte_event_ring_create(buf,
+					sw->prod_q_depth, socket_id, flags);
+
+			depth = rte_event_ring_get_capacity(
+					sw->ports[i].cq_worker_ring);
+			snprintf(buf, sizeof(buf), "sw%d_s%u_p%u_cq",
+					dev_id, k, i);
+			p->cq_worker_ring = rte_event_ring_create(buf,
+					depth, socket_id, flags);
+			s->cq_ring_space[i] = depth;
+
+			if (p->rx_worker_ring == NULL ||
+					p->cq_worker_ring == NULL) {
+				SW_LOG_ERR("Error creating rings for port %u "
+					"of scheduler %u\n", i, k);
+				goto error;
+			}
+		}
+	}
+
+	for (i = 0; i < sw->port_count; i++) {
+		struct sw_port *p = &sw->ports[i];
+
+		p->deq_sched = rte_zmalloc_socket(NULL, UINT16_MAX + 1, 0,
+				socket_id);
+		if (p->deq_sched == NULL)
+			goto error;
+
+		p->nb_scheds = sw->nb_scheds;
+		p->deq_sched_next = 0;
+		p->deq_sched_head = 0;
+		p->deq_sched_tail = 0;
+		for (k = 0; k < sw->nb_scheds; k++) {
+			p->sched_rx_ring[k] = sw->sched[k].ports[i].rx_worker_ring;
+			p->sched_cq_ring[k] = sw->sched[k].ports[i].cq_worker_ring;
+		}
+	}
+
+	/* large enough for all the events the device can hold */
+	depth = sw->nb_events_limit +
+		sw->port_count * sw->credit_update_quanta * 2;
+	for (k = 0; k < sw->nb_scheds; k++) {
+		for (j = 0; j < sw->nb_scheds; j++) {
+			if (j == k)
+				continue;
+			snprintf(buf, sizeof(buf), "sw%d_x%u_%u",
+					dev_id, k, j);
+			sw->sched[k].xfer_ring[j] = rte_event_ring_create(buf,
+					depth, socket_id, flags);
+			if (sw->sched[k].xfer_ring[j] == NULL) {
+				SW_LOG_ERR("Error creating transfer ring "
+					"%u->%u\n", k, j);
+				goto error;
+			}
+		}
+	}
+
+	return 0;
+
+error:
+	sw_sched_uninit(sw);
+	return -ENOMEM;
+}
+
 static int
 sw_start(struct rte_eventdev *dev)
 {
-	unsigned int i, j;
+	unsigned int i, j, k;
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 
 	rte_service_component_runstate_set(sw->service_id, 1);
@@ -806,16 +1043,22 @@ sw_start(struct rte_eventdev *dev)
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
+	for (k = 0; k < sw->nb_scheds; k++)
+		sw->sched[k].qid_count = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
 			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
+				struct sw_sched *s =
+					&sw->sched[sw->qids[i].sched];
+				s->qids_prioritized[s->qid_count++] =
+					&sw->qids[i];
 			}
 		}
 	}
 
+	if (sw->nb_scheds > 1 && sw_sched_init(sw) != 0)
+		return -ENOMEM;
+
 	sw_init_qid_iqs(sw);
 
 	if (sw_xstats_init(sw) < 0)
@@ -850,6 +1093,7 @@ sw_stop(struct rte_eventdev *dev)
 
 	sw_clean_qid_iqs(dev);
 	sw_xstats_uninit(sw);
+	sw_sched_uninit(sw);
 	sw->started = 0;
 	rte_smp_wmb();
 
@@ -871,11 +1115,15 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->nb_scheds; i++) {
+		struct sw_sched *s = &sw->sched[i];
+
+		memset(&s->stats, 0, sizeof(s->stats));
+		s->sched_called = 0;
+		s->sched_no_iq_enqueues = 0;
+		s->sched_no_cq_enqueues = 0;
+		s->sched_cq_qid_called = 0;
+	}
 
 	return 0;
 }
@@ -911,10 +1159,72 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 }
 
 
+static int
+set_sched_cores(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *cores = opaque;
+	*cores = atoi(value);
+	if (*cores <= 0 || *cores > SW_SCHED_MAX)
+		return -1;
+	return 0;
+}
+
+static int
+set_max_events(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *events = opaque;
+	*events = atoi(value);
+	if (*events <= 0 || *events > SW_INFLIGHT_EVENTS_MAX)
+		return -1;
+	return 0;
+}
+
+static int
+set_pow2_size(const char *key, const char *value, void *opaque)
+{
+	int *size = opaque;
+	int max;
+
+	max = (strcmp(key, PROD_Q_DEPTH_ARG) == 0) ?
+		SW_PROD_Q_DEPTH_MAX : SW_QID_MAX_FIDS;
+	*size = atoi(value);
+	if (*size < SCHED_DEQUEUE_BURST_SIZE || *size > max ||
+			!rte_is_power_of_2(*size))
+		return -1;
+	return 0;
+}
+
 static int32_t sw_sched_service_func(void *args)
 {
 	struct rte_eventdev *dev = args;
-	sw_event_schedule(dev);
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i, k, n;
+
+	n = sw->nb_scheds;
+	if (n == 1) {
+		sw_event_schedule(dev);
+		return 0;
+	}
+
+	/*
+	 * The service is MT safe: each lcore running it picks
+	 * the scheduler instances that no other lcore is running,
+	 * starting from a different one to spread the load.
+	 */
+	k = rte_lcore_id() % n;
+	for (i = 0; i != n; i++, k = (k + 1 == n) ? 0 : k + 1) {
+		struct sw_sched *s = &sw->sched[k];
+		uint32_t idle = 0;
+
+		if (__atomic_load_n(&s->busy, __ATOMIC_RELAXED) != 0 ||
+				!__atomic_compare_exchange_n(&s->busy, &idle,
+				1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			continue;
+
+		sw_sched_run(s);
+		__atomic_store_n(&s->busy, 0, __ATOMIC_RELEASE);
+	}
+
 	return 0;
 }
 
@@ -957,15 +1267,24 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		SCHED_CORES_ARG,
+		MAX_EVENTS_ARG,
+		PROD_Q_DEPTH_ARG,
+		QID_FIDS_ARG,
 		NULL
 	};
 	const char *name;
 	const char *params;
 	struct rte_eventdev *dev;
 	struct sw_evdev *sw;
+	uint32_t i;
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int sched_cores = 1;
+	int max_events = SW_INFLIGHT_EVENTS_TOTAL;
+	int prod_q_depth = MAX_SW_PROD_Q_DEPTH;
+	int qid_fids = SW_QID_NUM_FIDS;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -1007,13 +1326,54 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_CORES_ARG,
+					set_sched_cores, &sched_cores);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched cores parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
+			ret = rte_kvargs_process(kvlist, MAX_EVENTS_ARG,
+					set_max_events, &max_events);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing max events parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
+			ret = rte_kvargs_process(kvlist, PROD_Q_DEPTH_ARG,
+					set_pow2_size, &prod_q_depth);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing prod queue depth parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
+			ret = rte_kvargs_process(kvlist, QID_FIDS_ARG,
+					set_pow2_size, &qid_fids);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing qid fids parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, sched_cores=%d, max_events=%d, prod_q_depth=%d, qid_fids=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			sched_cores, max_events, prod_q_depth, qid_fids);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -1038,6 +1398,15 @@ sw_probe(struct rte_vdev_device *vdev)
 	/* copy values passed from vdev command line to instance */
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
+	sw->nb_scheds = sched_cores;
+	sw->max_events = max_events;
+	sw->prod_q_depth = prod_q_depth;
+	sw->nb_fids = qid_fids;
+	for (i = 0; i < SW_SCHED_MAX; i++) {
+		sw->sched[i].sw = sw;
+		sw->sched[i].id = i;
+		sw->sched[i].ports = sw->ports;
+	}
 
 	/* register service with EAL */
 	struct rte_service_spec service;
@@ -1048,6 +1417,8 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	if (sched_cores > 1)
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
@@ -1082,5 +1453,7 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>"
+		SCHED_CORES_ARG "=<int>" MAX_EVENTS_ARG "=<int>"
+		PROD_Q_DEPTH_ARG "=<int>" QID_FIDS_ARG "=<int>");
 RTE_LOG_REGISTER(eventdev_sw_log_level, pmd.event.sw, NOTICE);
@@ -12,14 +12,18 @@
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
-#define SW_QID_NUM_FIDS 16384
+#define SW_QID_NUM_FIDS 16384 /* default size of QID flow table */
+#define SW_QID_MAX_FIDS (1 << 20) /* whole flow_id range, no collisions */
 #define SW_IQS_MAX 4
 #define SW_Q_PRIORITY_MAX 255
 #define SW_PORTS_MAX 64
+#define SW_SCHED_MAX 8 /* max number of scheduler instances */
 #define MAX_SW_CONS_Q_DEPTH 128
-#define SW_INFLIGHT_EVENTS_TOTAL 4096
+#define SW_INFLIGHT_EVENTS_TOTAL 4096 /* default */
+#define SW_INFLIGHT_EVENTS_MAX (1 << 20)
 /* allow for lots of over-provisioning */
-#define MAX_SW_PROD_Q_DEPTH 4096
+#define MAX_SW_PROD_Q_DEPTH 4096 /* default */
+#define SW_PROD_Q_DEPTH_MAX 32768
 #define SW_FRAGMENTS_MAX 16
 
 /* Should be power-of-two minus one, to leave room for the next pointer */
@@ -31,7 +35,6 @@
 /* how many packets pulled from port by sched */
 #define SCHED_DEQUEUE_BURST_SIZE 32
 
-#define SW_PORT_HIST_LIST (MAX_SW_PROD_Q_DEPTH) /* size of our history list */
 #define NUM_SAMPLES 64 /* how many data points use for average stats */
 
 #define EVENTDEV_NAME_SW_PMD event_sw
@@ -72,12 +75,16 @@ struct sw_point_stats {
 	uint64_t tx_pkts;
 };
 
-/* structure used to track what port a flow (FID) is pinned to */
+/* structure used to track what port a flow (FID) is pinned to,
+ * kept small so large flow tables stay cache friendly.
+ */
 struct sw_fid_t {
 	/* which CQ this FID is currently pinned to */
-	int32_t cq;
-	/* number of packets gone to the CQ with this FID */
-	uint32_t pcount;
+	int16_t cq;
+	/* number of packets gone to the CQ with this FID, can't exceed
+	 * the port history list size
+	 */
+	uint16_t pcount;
 };
 
 struct reorder_buffer_entry {
@@ -118,7 +125,9 @@ struct sw_qid {
 	uint64_t to_port[SW_PORTS_MAX];
 
 	/* Track flow ids for atomic load balancing */
-	struct sw_fid_t fids[SW_QID_NUM_FIDS];
+	struct sw_fid_t *fids;
+	uint32_t fid_mask; /* number of fids - 1 */
+	uint32_t fid_shift; /* log2 of number of fids */
 
 	/* Track packet order for reordering when needed */
 	struct reorder_buffer_entry *reorder_buffer; /*< pkts await reorder */
@@ -127,6 +136,8 @@ struct sw_qid {
 	uint32_t window_size;          /* Used to wrap reorder_buffer_index */
 
 	uint8_t priority;
+	/* scheduler instance this QID belongs to */
+	uint8_t sched;
 };
 
 struct sw_hist_list_entry {
@@ -153,8 +164,12 @@ struct sw_port {
 	 * events in the buffers going to the port. When the unlinks in
 	 * progress is read by the scheduler, no more events will be pushed to
 	 * the port - hence the scheduler core can just assign zero.
+	 * With multiple scheduler instances, the unlinks are only done once
+	 * every instance owning one of the unlinked QIDs has acked them,
+	 * unlinks_scheds has a bit per instance yet to do so.
 	 */
 	uint8_t unlinks_in_progress;
+	uint8_t unlinks_scheds;
 
 	int16_t is_directed; /** Takes from a single directed QID */
 	/**
@@ -172,7 +187,7 @@ struct sw_port {
 
 	/* num releases yet to be completed on this port */
 	uint16_t outstanding_releases __rte_cache_aligned;
-	uint16_t inflight_max; /* app requested max inflights for this port */
+	uint32_t inflight_max; /* app requested max inflights for this port */
 	uint16_t inflight_credits; /* num credits this port has right now */
 	uint8_t implicit_release; /* release events before dequeueing */
 
@@ -188,7 +203,8 @@ struct sw_port {
 	uint16_t hist_head __rte_cache_aligned;
 	uint16_t hist_tail;
 	uint16_t inflights;
-	struct sw_hist_list_entry hist_list[SW_PORT_HIST_LIST];
+	uint16_t hist_mask; /* size of our history list - 1 */
+	struct sw_hist_list_entry *hist_list;
 
 	/* track packets in and out of this port */
 	struct sw_point_stats stats;
@@ -201,8 +217,61 @@ struct sw_port {
 	struct rte_event cq_buf[MAX_SW_CONS_Q_DEPTH];
 
 	uint8_t num_qids_mapped;
+
+	/*
+	 * With multiple scheduler instances, each of them has its own pair
+	 * of rings for the port ([0] are rx/cq_worker_ring above), the worker
+	 * remembers which instance each outstanding event came from, so the
+	 * completion is returned to the right one.
+	 */
+	uint8_t nb_scheds;
+	uint8_t deq_sched_next; /* instance to dequeue from first */
+	uint16_t deq_sched_head;
+	uint16_t deq_sched_tail;
+	uint8_t *deq_sched; /* UINT16_MAX + 1 entries */
+	struct rte_event_ring *sched_rx_ring[SW_SCHED_MAX];
+	struct rte_event_ring *sched_cq_ring[SW_SCHED_MAX];
 };
 
+/*
+ * Scheduler instance: schedules a subset of QIDs (qid->sched == id),
+ * owns all the state it touches, so several instances can run
+ * concurrently on different service cores. Events enqueued to the QIDs
+ * of another instance are passed to it via single producer/single
+ * consumer transfer rings.
+ */
+struct sw_sched {
+	struct sw_evdev *sw;
+	uint32_t id;
+	uint32_t busy; /* set while some lcore runs this instance */
+
+	/* scheduler side port state: sw->ports for instance 0 */
+	struct sw_port *ports;
+
+	/* Cache how many packets are in each cq */
+	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+
+	/* QIDs of this instance sorted by priority */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* IQ memory */
+	struct sw_queue_chunk *chunk_list_head;
+	struct sw_queue_chunk *chunks;
+
+	/* transfer rings and buffers, indexed by the destination instance */
+	struct rte_event_ring *xfer_ring[SW_SCHED_MAX];
+	uint16_t xfer_count[SW_SCHED_MAX];
+	struct rte_event xfer_buf[SW_SCHED_MAX][SCHED_DEQUEUE_BURST_SIZE];
+
+	/* Stats */
+	struct sw_point_stats stats __rte_cache_aligned;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -227,26 +296,21 @@ struct sw_evdev {
 
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
-	struct sw_queue_chunk *chunk_list_head;
-	struct sw_queue_chunk *chunks;
-
-	/* Cache how many packets are in each cq */
-	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	/* Scheduler instances */
+	uint32_t nb_scheds;
+	struct sw_sched sched[SW_SCHED_MAX];
 
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
 
 	uint8_t started;
 	uint32_t credit_update_quanta;
 
+	/* limits set at probe time with devargs */
+	uint32_t max_events; /* max value of nb_events_limit */
+	uint32_t prod_q_depth; /* port rx ring and history list size */
+	uint32_t nb_fids; /* min size of QID flow tables */
+
 	/* store num stats and offset of the stats for each port */
 	uint16_t xstats_count_per_port[SW_PORTS_MAX];
 	uint16_t xstats_offset_for_port[SW_PORTS_MAX];
@@ -278,6 +342,7 @@ uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
 void sw_event_schedule(struct rte_eventdev *dev);
+void sw_sched_run(struct sw_sched *s);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
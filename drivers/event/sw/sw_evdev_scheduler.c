@@ -22,12 +22,18 @@
 #define PRIO_TO_IQ(prio) (prio >> 6)
 
 #define MAX_PER_IQ_DEQUEUE 48
-#define FLOWID_MASK (SW_QID_NUM_FIDS-1)
-/* use cheap bit mixing, we only need to lose a few bits */
-#define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
+/* use cheap bit mixing, we only need to lose a few bits: folding keeps
+ * consecutive flow ids collision free up to the table size, and tables
+ * of SW_QID_MAX_FIDS entries map each flow id to its own slot.
+ */
+static __rte_always_inline uint32_t
+sw_hash_flowid(const struct sw_qid *qid, uint32_t f)
+{
+	return (f ^ (f >> qid->fid_shift)) & qid->fid_mask;
+}
 
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_atomic_to_cq(struct sw_sched *s, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
@@ -43,10 +49,10 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	 */
 	uint32_t qid_id = qid->id;
 
-	iq_dequeue_burst(sw, &qid->iq[iq_num], qes, count);
+	iq_dequeue_burst(s, &qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
-		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
+		const uint32_t flow_id = sw_hash_flowid(qid, qes[i].flow_id);
 		struct sw_fid_t *fid = &qid->fids[flow_id];
 		int cq = fid->cq;
 
@@ -59,11 +65,11 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			cq = qid->cq_map[cq_idx];
 
 			/* find least used */
-			int cq_free_cnt = sw->cq_ring_space[cq];
+			int cq_free_cnt = s->cq_ring_space[cq];
 			for (cq_idx = 0; cq_idx < qid->cq_num_mapped_cqs;
 					cq_idx++) {
 				int test_cq = qid->cq_map[cq_idx];
-				int test_cq_free = sw->cq_ring_space[test_cq];
+				int test_cq_free = s->cq_ring_space[test_cq];
 				if (test_cq_free > cq_free_cnt) {
 					cq = test_cq;
 					cq_free_cnt = test_cq_free;
@@ -73,21 +79,21 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			fid->cq = cq; /* this pins early */
 		}
 
-		if (sw->cq_ring_space[cq] == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST) {
+		if (s->cq_ring_space[cq] == 0 ||
+				s->ports[cq].inflights > s->ports[cq].hist_mask) {
 			blocked_qes[nb_blocked++] = *qe;
 			continue;
 		}
 
-		struct sw_port *p = &sw->ports[cq];
+		struct sw_port *p = &s->ports[cq];
 
 		/* at this point we can queue up the packet on the cq_buf */
 		fid->pcount++;
 		p->cq_buf[p->cq_buf_count++] = *qe;
 		p->inflights++;
-		sw->cq_ring_space[cq]--;
+		s->cq_ring_space[cq]--;
 
-		int head = (p->hist_head++ & (SW_PORT_HIST_LIST-1));
+		int head = (p->hist_head++ & p->hist_mask);
 		p->hist_list[head].fid = flow_id;
 		p->hist_list[head].qid = qid_id;
 
@@ -96,21 +102,21 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 		qid->to_port[cq]++;
 
 		/* if we just filled in the last slot, flush the buffer */
-		if (sw->cq_ring_space[cq] == 0) {
+		if (s->cq_ring_space[cq] == 0) {
 			struct rte_event_ring *worker = p->cq_worker_ring;
 			rte_event_ring_enqueue_burst(worker, p->cq_buf,
 					p->cq_buf_count,
-					&sw->cq_ring_space[cq]);
+					&s->cq_ring_space[cq]);
 			p->cq_buf_count = 0;
 		}
 	}
-	iq_put_back(sw, &qid->iq[iq_num], blocked_qes, nb_blocked);
+	iq_put_back(s, &qid->iq[iq_num], blocked_qes, nb_blocked);
 
 	return count - nb_blocked;
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_parallel_to_cq(struct sw_sched *s, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count, int keep_order)
 {
 	uint32_t i;
@@ -147,28 +153,28 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			cq = qid->cq_map[cq_idx++];
 
 		} while (rte_event_ring_free_count(
-				sw->ports[cq].cq_worker_ring) == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST);
+				s->ports[cq].cq_worker_ring) == 0 ||
+				s->ports[cq].inflights > s->ports[cq].hist_mask);
 
-		struct sw_port *p = &sw->ports[cq];
-		if (sw->cq_ring_space[cq] == 0 ||
-				p->inflights == SW_PORT_HIST_LIST)
+		struct sw_port *p = &s->ports[cq];
+		if (s->cq_ring_space[cq] == 0 ||
+				p->inflights > p->hist_mask)
 			break;
 
-		sw->cq_ring_space[cq]--;
+		s->cq_ring_space[cq]--;
 
 		qid->stats.tx_pkts++;
 
-		const int head = (p->hist_head & (SW_PORT_HIST_LIST-1));
-		p->hist_list[head].fid = SW_HASH_FLOWID(qe->flow_id);
+		const int head = (p->hist_head & p->hist_mask);
+		p->hist_list[head].fid = sw_hash_flowid(qid, qe->flow_id);
 		p->hist_list[head].qid = qid_id;
 
 		if (keep_order)
 			rte_ring_sc_dequeue(qid->reorder_buffer_freelist,
 					(void *)&p->hist_list[head].rob_entry);
 
-		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
-		iq_pop(sw, &qid->iq[iq_num]);
+		p->cq_buf[p->cq_buf_count++] = *qe;
+		iq_pop(s, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
 		p->inflights++;
@@ -181,20 +187,20 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_dir_to_cq(struct sw_sched *s, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
-	struct sw_port *port = &sw->ports[cq_id];
+	struct sw_port *port = &s->ports[cq_id];
 
 	/* get max burst enq size for cq_ring */
-	uint32_t count_free = sw->cq_ring_space[cq_id];
+	uint32_t count_free = s->cq_ring_space[cq_id];
 	if (count_free == 0)
 		return 0;
 
 	/* burst dequeue from the QID IQ ring */
 	struct sw_iq *iq = &qid->iq[iq_num];
-	uint32_t ret = iq_dequeue_burst(sw, iq,
+	uint32_t ret = iq_dequeue_burst(s, iq,
 			&port->cq_buf[port->cq_buf_count], count_free);
 	port->cq_buf_count += ret;
 
@@ -203,21 +209,21 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	port->stats.tx_pkts += ret;
 
 	/* Subtract credits from cached value */
-	sw->cq_ring_space[cq_id] -= ret;
+	s->cq_ring_space[cq_id] -= ret;
 
 	return ret;
 }
 
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_sched *s)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
 
-	sw->sched_cq_qid_called++;
+	s->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	for (qid_idx = 0; qid_idx < s->qid_count; qid_idx++) {
+		struct sw_qid *qid = s->qids_prioritized[qid_idx];
 
 		int type = qid->type;
 		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
@@ -231,13 +237,13 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 
 		if (count > 0) {
 			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
+				pkts_done += sw_schedule_dir_to_cq(s, qid,
 						iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
+				pkts_done += sw_schedule_atomic_to_cq(s, qid,
 						iq_num, count);
 			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
+				pkts_done += sw_schedule_parallel_to_cq(s, qid,
 						iq_num, count,
 						type == RTE_SCHED_TYPE_ORDERED);
 		}
@@ -254,13 +260,89 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 	return pkts;
 }
 
+/* Push the QE into the given IQ of the QID, if the QID belongs to another
+ * scheduler instance, pass the QE to that instance instead.
+ * Returns zero if the QE was passed to another instance.
+ */
+static __rte_always_inline uint32_t
+sw_qid_enqueue(struct sw_sched *s, struct sw_qid *qid, uint32_t iq_num,
+		const struct rte_event *qe)
+{
+	uint32_t dst, n;
+
+	if (qid->sched != s->id) {
+		dst = qid->sched;
+		n = s->xfer_count[dst];
+		s->xfer_buf[dst][n++] = *qe;
+		if (n == RTE_DIM(s->xfer_buf[dst])) {
+			/* transfer rings are sized to hold all events
+			 * allowed by the device, so it can't fail
+			 */
+			n -= rte_event_ring_enqueue_burst(s->xfer_ring[dst],
+					s->xfer_buf[dst], n, NULL);
+			s->stats.rx_dropped += n;
+			n = 0;
+		}
+		s->xfer_count[dst] = n;
+		return 0;
+	}
+
+	qid->iq_pkt_mask |= (1 << (iq_num));
+	iq_enqueue(s, &qid->iq[iq_num], qe);
+	qid->iq_pkt_count[iq_num]++;
+	qid->stats.rx_pkts++;
+	return 1;
+}
+
+/* Send buffered QEs to the other scheduler instances. */
+static void
+sw_xfer_flush(struct sw_sched *s)
+{
+	uint32_t i, n;
+
+	for (i = 0; i != s->sw->nb_scheds; i++) {
+		n = s->xfer_count[i];
+		if (n == 0)
+			continue;
+		n -= rte_event_ring_enqueue_burst(s->xfer_ring[i],
+				s->xfer_buf[i], n, NULL);
+		s->stats.rx_dropped += n;
+		s->xfer_count[i] = 0;
+	}
+}
+
+/* Pull QEs passed by the other scheduler instances into the local IQs. */
+static uint32_t
+sw_xfer_pull(struct sw_sched *s)
+{
+	uint32_t i, j, n, pkts;
+	struct sw_evdev *sw = s->sw;
+	struct rte_event qes[SCHED_DEQUEUE_BURST_SIZE];
+
+	pkts = 0;
+	for (i = 0; i != sw->nb_scheds; i++) {
+		if (i == s->id)
+			continue;
+
+		n = rte_event_ring_dequeue_burst(sw->sched[i].xfer_ring[s->id],
+				qes, RTE_DIM(qes), NULL);
+		for (j = 0; j != n; j++)
+			sw_qid_enqueue(s, &sw->qids[qes[j].queue_id],
+					PRIO_TO_IQ(qes[j].priority), &qes[j]);
+		pkts += n;
+	}
+
+	return pkts;
+}
+
 /* This function will perform re-ordering of packets, and injecting into
  * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
  * contiguous in that array, this function accepts a "range" of QIDs to scan.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_sched *s, int qid_start, int qid_end)
 {
+	struct sw_evdev *sw = s->sw;
 	/* Perform egress reordering */
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
@@ -269,7 +351,8 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 		struct sw_qid *qid = &sw->qids[qid_start];
 		int i, num_entries_in_use;
 
-		if (qid->type != RTE_SCHED_TYPE_ORDERED)
+		if (qid->type != RTE_SCHED_TYPE_ORDERED ||
+				qid->sched != s->id)
 			continue;
 
 		num_entries_in_use = rte_ring_free_count(
@@ -295,22 +378,16 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				dest_iq  = PRIO_TO_IQ(qe->priority);
 
 				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+					s->stats.rx_dropped++;
 					continue;
 				}
 
-				pkts_iter++;
-
-				struct sw_qid *q = &sw->qids[dest_qid];
-				struct sw_iq *iq = &q->iq[dest_iq];
-
 				/* we checked for space above, so enqueue must
 				 * succeed
 				 */
-				iq_enqueue(sw, iq, qe);
-				q->iq_pkt_mask |= (1 << (dest_iq));
-				q->iq_pkt_count[dest_iq]++;
-				q->stats.rx_pkts++;
+				pkts_iter += sw_qid_enqueue(s,
+						&sw->qids[dest_qid], dest_iq,
+						qe);
 			}
 
 			entry->ready = (j != entry->num_fragments);
@@ -333,9 +410,8 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 }
 
 static __rte_always_inline void
-sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
+sw_refill_pp_buf(struct sw_port *port)
 {
-	RTE_SET_USED(sw);
 	struct rte_event_ring *worker = port->rx_worker_ring;
 	port->pp_buf_start = 0;
 	port->pp_buf_count = rte_event_ring_dequeue_burst(worker, port->pp_buf,
@@ -343,15 +419,16 @@ sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
 }
 
 static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_sched *s, uint32_t port_id, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
 	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_evdev *sw = s->sw;
+	struct sw_port *port = &s->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(port);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -379,7 +456,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 		 */
 		if ((flags & QE_FLAG_COMPLETE) && port->inflights > 0) {
 			const uint32_t hist_tail = port->hist_tail &
-					(SW_PORT_HIST_LIST - 1);
+					port->hist_mask;
 
 			hist_entry = &port->hist_list[hist_tail];
 			const uint32_t hist_qid = hist_entry->qid;
@@ -422,7 +499,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				 */
 				int num_frag = rob_entry->num_fragments;
 				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
+					s->stats.rx_dropped++;
 				else {
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
@@ -433,12 +510,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 			/* Use the iq_num from above to push the QE
 			 * into the qid at the right priority
 			 */
-
-			qid->iq_pkt_mask |= (1 << (iq_num));
-			iq_enqueue(sw, &qid->iq[iq_num], qe);
-			qid->iq_pkt_count[iq_num]++;
-			qid->stats.rx_pkts++;
-			pkts_iter++;
+			pkts_iter += sw_qid_enqueue(s, qid, iq_num, qe);
 		}
 
 end_qe:
@@ -450,26 +522,27 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_sched *s, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(s, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_sched *s, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(s, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_sched *s, uint32_t port_id)
 {
 	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_evdev *sw = s->sw;
+	struct sw_port *port = &s->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(port);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -480,18 +553,13 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 
 		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
-		struct sw_iq *iq = &qid->iq[iq_num];
 
 		port->stats.rx_pkts++;
 
 		/* Use the iq_num from above to push the QE
 		 * into the qid at the right priority
 		 */
-		qid->iq_pkt_mask |= (1 << (iq_num));
-		iq_enqueue(sw, iq, qe);
-		qid->iq_pkt_count[iq_num]++;
-		qid->stats.rx_pkts++;
-		pkts_iter++;
+		pkts_iter += sw_qid_enqueue(s, qid, iq_num, qe);
 
 end_qe:
 		port->pp_buf_start++;
@@ -502,15 +570,15 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 }
 
 void
-sw_event_schedule(struct rte_eventdev *dev)
+sw_sched_run(struct sw_sched *s)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_evdev *sw = s->sw;
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	s->sched_called++;
 	if (unlikely(!sw->started))
 		return;
 
@@ -521,26 +589,39 @@ sw_event_schedule(struct rte_eventdev *dev)
 		do {
 			in_pkts = 0;
 			for (i = 0; i < sw->port_count; i++) {
-				/* ack the unlinks in progress as done */
-				if (sw->ports[i].unlinks_in_progress)
-					sw->ports[i].unlinks_in_progress = 0;
+				/* ack the unlinks of the QIDs of this instance */
+				if (unlikely(__atomic_load_n(
+						&sw->ports[i].unlinks_scheds,
+						__ATOMIC_RELAXED) &
+						(1 << s->id)))
+					__atomic_fetch_and(
+						&sw->ports[i].unlinks_scheds,
+						(uint8_t)~(1 << s->id),
+						__ATOMIC_RELEASE);
 
 				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
+					in_pkts += sw_schedule_pull_port_dir(s, i);
 				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+					in_pkts += sw_schedule_pull_port_lb(s, i);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(s, i);
 			}
 
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
+			in_pkts += sw_schedule_reorder(s, 0,
 					sw->qid_count);
+
+			/* events from the other scheduler instances */
+			if (sw->nb_scheds > 1) {
+				sw_xfer_flush(s);
+				in_pkts += sw_xfer_pull(s);
+			}
+
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
-		out_pkts = sw_schedule_qid_to_cq(sw);
+		out_pkts = sw_schedule_qid_to_cq(s);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -548,21 +629,30 @@ sw_event_schedule(struct rte_eventdev *dev)
 			break;
 	} while ((int)out_pkts_total < sched_quanta);
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	s->stats.tx_pkts += out_pkts_total;
+	s->stats.rx_pkts += in_pkts_total;
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	s->sched_no_iq_enqueues += (in_pkts_total == 0);
+	s->sched_no_cq_enqueues += (out_pkts_total == 0);
 
 	/* push all the internal buffered QEs in port->cq_ring to the
 	 * worker cores: aka, do the ring transfers batched.
 	 */
 	for (i = 0; i < sw->port_count; i++) {
-		struct rte_event_ring *worker = sw->ports[i].cq_worker_ring;
-		rte_event_ring_enqueue_burst(worker, sw->ports[i].cq_buf,
-				sw->ports[i].cq_buf_count,
-				&sw->cq_ring_space[i]);
-		sw->ports[i].cq_buf_count = 0;
+		struct sw_port *p = &s->ports[i];
+		rte_event_ring_enqueue_burst(p->cq_worker_ring, p->cq_buf,
+				p->cq_buf_count, &s->cq_ring_space[i]);
+		p->cq_buf_count = 0;
 	}
 
 }
+
+void
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i;
+
+	for (i = 0; i != sw->nb_scheds; i++)
+		sw_sched_run(&sw->sched[i]);
+}
@@ -18,13 +18,18 @@ sw_event_release(struct sw_port *p, uint8_t index)
 	 * to clear any history before dequeuing more events.
 	 */
 	RTE_SET_USED(index);
+	struct rte_event_ring *ring = p->rx_worker_ring;
 
 	/* create drop message */
 	struct rte_event ev;
 	ev.op = sw_qe_flag_map[RTE_EVENT_OP_RELEASE];
 
+	/* release goes to the instance the event came from */
+	if (p->nb_scheds > 1)
+		ring = p->sched_rx_ring[p->deq_sched[p->deq_sched_tail++]];
+
 	uint16_t free_count;
-	rte_event_ring_enqueue_burst(p->rx_worker_ring, &ev, 1, &free_count);
+	rte_event_ring_enqueue_burst(ring, &ev, 1, &free_count);
 
 	/* each release returns one credit */
 	p->outstanding_releases--;
@@ -49,11 +54,81 @@ enqueue_burst_with_ops(struct rte_event_ring *r, const struct rte_event *events,
 	return rte_event_ring_enqueue_burst(r, tmp_evs, n, NULL);
 }
 
+/*
+ * with multiple scheduler instances, completions go to the instance
+ * the event was dequeued from, other events to the instance that owns
+ * the destination QID.
+ * Returns the number of events at the head of ev[] that fit in their
+ * destination rings, so that nothing is consumed for the others.
+ */
+static inline uint16_t
+multi_sched_enqueue_fit(const struct sw_port *p, const struct sw_evdev *sw,
+		const struct rte_event ev[], uint16_t num)
+{
+	uint32_t space[SW_SCHED_MAX];
+	uint16_t outstanding = p->outstanding_releases;
+	uint16_t tail = p->deq_sched_tail;
+	uint32_t k;
+	uint16_t i;
+
+	/* this port is the only producer, the free space can only grow */
+	for (k = 0; k < p->nb_scheds; k++)
+		space[k] = rte_event_ring_free_count(p->sched_rx_ring[k]);
+
+	for (i = 0; i < num; i++) {
+		if ((sw_qe_flag_map[ev[i].op] & QE_FLAG_COMPLETE) &&
+				outstanding > 0) {
+			outstanding--;
+			k = p->deq_sched[tail++];
+		} else if (ev[i].queue_id >= sw->qid_count)
+			k = 0;
+		else
+			k = sw->qids[ev[i].queue_id].sched;
+
+		if (space[k] == 0)
+			break;
+		space[k]--;
+	}
+
+	return i;
+}
+
+/*
+ * dst[] rings were checked to have room for all the events by
+ * multi_sched_enqueue_fit().
+ */
+static inline unsigned int
+enqueue_burst_multi_sched(struct sw_port *p, const struct rte_event *events,
+		unsigned int n, const uint8_t *ops, const uint8_t *dst)
+{
+	struct rte_event tmp_evs[SW_SCHED_MAX][PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint32_t cnt[SW_SCHED_MAX];
+	unsigned int i, k, enq;
+
+	memset(cnt, 0, sizeof(cnt));
+	for (i = 0; i < n; i++) {
+		k = dst[i];
+		tmp_evs[k][cnt[k]] = events[i];
+		tmp_evs[k][cnt[k]++].op = ops[i];
+	}
+
+	enq = 0;
+	for (k = 0; k < p->nb_scheds; k++) {
+		if (cnt[k] != 0)
+			enq += rte_event_ring_enqueue_burst(
+					p->sched_rx_ring[k], tmp_evs[k],
+					cnt[k], NULL);
+	}
+
+	return enq;
+}
+
 uint16_t
 sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 {
 	int32_t i;
 	uint8_t new_ops[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t dst[PORT_ENQUEUE_MAX_BURST_SIZE];
 	struct sw_port *p = port;
 	struct sw_evdev *sw = (void *)p->sw;
 	uint32_t sw_inflights = rte_atomic32_read(&sw->inflights);
@@ -83,6 +158,9 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 		num = (p->inflight_credits < new) ? p->inflight_credits : new;
 	}
 
+	if (p->nb_scheds > 1)
+		num = multi_sched_enqueue_fit(p, sw, ev, num);
+
 	for (i = 0; i < num; i++) {
 		int op = ev[i].op;
 		int outstanding = p->outstanding_releases > 0;
@@ -99,8 +177,12 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 		 * correct usage of the API), providing very high correct
 		 * prediction rate.
 		 */
-		if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding)
+		if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding) {
 			p->outstanding_releases--;
+			if (p->nb_scheds > 1)
+				dst[i] = p->deq_sched[p->deq_sched_tail++];
+		} else if (p->nb_scheds > 1)
+			dst[i] = invalid_qid ? 0 : sw->qids[ev[i].queue_id].sched;
 
 		/* error case: branch to avoid touching p->stats */
 		if (unlikely(invalid_qid && op != RTE_EVENT_OP_RELEASE)) {
@@ -110,8 +192,12 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 	}
 
 	/* returns number of events actually enqueued */
-	uint32_t enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
-					     new_ops);
+	uint32_t enq;
+	if (p->nb_scheds > 1)
+		enq = enqueue_burst_multi_sched(p, ev, i, new_ops, dst);
+	else
+		enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
+				new_ops);
 	if (p->outstanding_releases == 0 && p->last_dequeue_burst_sz != 0) {
 		uint64_t burst_ticks = rte_get_timer_cycles() -
 				p->last_dequeue_ticks;
@@ -137,6 +223,34 @@ sw_event_enqueue(void *port, const struct rte_event *ev)
 	return sw_event_enqueue_burst(port, ev, 1);
 }
 
+/*
+ * dequeue from the CQ rings of all scheduler instances, remembering
+ * where each event came from, start from a different instance each
+ * time for fairness.
+ */
+static inline uint16_t
+dequeue_burst_multi_sched(struct sw_port *p, struct rte_event *ev,
+		uint16_t num)
+{
+	uint32_t i, j, k, n;
+	uint16_t ndeq;
+
+	ndeq = 0;
+	k = p->deq_sched_next;
+	for (i = 0; i != p->nb_scheds && ndeq != num; i++) {
+		n = rte_event_ring_dequeue_burst(p->sched_cq_ring[k],
+				ev + ndeq, num - ndeq, NULL);
+		for (j = 0; j != n; j++)
+			p->deq_sched[p->deq_sched_head++] = k;
+		ndeq += n;
+		k = (k + 1 == p->nb_scheds) ? 0 : k + 1;
+	}
+
+	p->deq_sched_next = (p->deq_sched_next + 1 == p->nb_scheds) ?
+			0 : p->deq_sched_next + 1;
+	return ndeq;
+}
+
 uint16_t
 sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 		uint64_t wait)
@@ -162,7 +276,11 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 	}
 
 	/* returns number of events actually dequeued */
-	uint16_t ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
+	uint16_t ndeq;
+	if (p->nb_scheds > 1)
+		ndeq = dequeue_burst_multi_sched(p, ev, num);
+	else
+		ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
 	if (unlikely(ndeq == 0)) {
 		p->zero_polls++;
 		p->total_polls++;
@@ -47,26 +47,36 @@ struct sw_xstats_entry {
 };
 
 static uint64_t
-get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
-		enum xstats_type type, int extra_arg __rte_unused)
+get_sched_stat(const struct sw_sched *s, enum xstats_type type)
 {
 	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
+	case rx: return s->stats.rx_pkts;
+	case tx: return s->stats.tx_pkts;
+	case dropped: return s->stats.rx_dropped;
+	case calls: return s->sched_called;
+	case no_iq_enq: return s->sched_no_iq_enqueues;
+	case no_cq_enq: return s->sched_no_cq_enqueues;
 	default: return -1;
 	}
 }
 
 static uint64_t
-get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
+get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
-	const struct sw_port *p = &sw->ports[obj_idx];
+	uint64_t val;
+	uint32_t i;
 
+	/* sum of all the scheduler instances */
+	val = get_sched_stat(&sw->sched[0], type);
+	for (i = 1; i < sw->nb_scheds; i++)
+		val += get_sched_stat(&sw->sched[i], type);
+	return val;
+}
+
+static uint64_t
+get_sched_port_stat(const struct sw_port *p, enum xstats_type type)
+{
 	switch (type) {
 	case rx: return p->stats.rx_pkts;
 	case tx: return p->stats.tx_pkts;
@@ -84,6 +94,35 @@ get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 	}
 }
 
+static uint64_t
+get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
+		enum xstats_type type, int extra_arg __rte_unused)
+{
+	uint64_t val;
+	uint32_t i;
+
+	val = get_sched_port_stat(&sw->ports[obj_idx], type);
+
+	/* worker side only stats are kept in sw->ports */
+	switch (type) {
+	case pkt_cycles:
+	case calls:
+	case credits:
+	case poll_return:
+		return val;
+	default:
+		break;
+	}
+
+	/* add the port state of the other scheduler instances */
+	for (i = 1; i < sw->nb_scheds; i++) {
+		const struct sw_sched *s = &sw->sched[i];
+		if (s->ports != sw->ports)
+			val += get_sched_port_stat(&s->ports[obj_idx], type);
+	}
+	return val;
+}
+
 static uint64_t
 get_port_bucket_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg)
@@ -110,7 +149,7 @@ get_qid_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		do {
 			uint64_t infl = 0;
 			unsigned int i;
-			for (i = 0; i < RTE_DIM(qid->fids); i++)
+			for (i = 0; i <= qid->fid_mask; i++)
 				infl += qid->fids[i].pcount;
 			return infl;
 		} while (0);
@@ -144,7 +183,7 @@ get_qid_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		do {
 			uint64_t pin = 0;
 			unsigned int i;
-			for (i = 0; i < RTE_DIM(qid->fids); i++)
+			for (i = 0; i <= qid->fid_mask; i++)
 				if (qid->fids[i].cq == port)
 					pin++;
 			return pin;
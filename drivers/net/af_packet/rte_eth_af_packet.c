@@ -34,18 +34,38 @@
 #define ETH_AF_PACKET_FRAMESIZE_ARG	"framesz"
 #define ETH_AF_PACKET_FRAMECOUNT_ARG	"framecnt"
 #define ETH_AF_PACKET_QDISC_BYPASS_ARG	"qdisc_bypass"
+#define ETH_AF_PACKET_TPACKET_V3_ARG	"tpacket_v3"
+#define ETH_AF_PACKET_BLOCKTMO_ARG	"blocktmo"
+#define ETH_AF_PACKET_ZEROCOPY_ARG	"zerocopy"
 
 #define DFLT_FRAME_SIZE		(1 << 11)
 #define DFLT_FRAME_COUNT	(1 << 9)
 
+/* zero copy: a block of the Rx ring, lent to the application */
+struct af_packet_zc_block {
+	/* holds the mbufs of the block and the reference of the queue */
+	struct rte_mbuf_ext_shared_info shinfo;
+	struct tpacket_block_desc *pbd;
+	/* set until the block is given back to the Kernel */
+	uint8_t lent;
+};
+
 struct pkt_rx_queue {
 	int sockfd;
 
 	struct iovec *rd;
 	uint8_t *map;
+	size_t map_size;
 	unsigned int framecount;
 	unsigned int framenum;
 
+	/* TPACKET_V3 ring, rd has an entry per block */
+	unsigned int blockcount;
+	unsigned int blocknum;
+	struct tpacket3_hdr *frame; /* next frame of the current block */
+	uint32_t frames_left; /* frames left in the current block */
+	struct af_packet_zc_block *zc_blocks; /* zero copy, per block */
+
 	struct rte_mempool *mb_pool;
 	uint16_t in_port;
 
@@ -59,6 +79,7 @@ struct pkt_tx_queue {
 
 	struct iovec *rd;
 	uint8_t *map;
+	size_t map_size;
 	unsigned int framecount;
 	unsigned int framenum;
 
@@ -75,6 +96,8 @@ struct pmd_internals {
 	struct rte_ether_addr eth_addr;
 
 	struct tpacket_req req;
+	struct tpacket_req3 req3; /* Rx ring, in TPACKET_V3 mode */
+	unsigned int tpacket_v3;
 
 	struct pkt_rx_queue *rx_queue;
 	struct pkt_tx_queue *tx_queue;
@@ -87,6 +110,9 @@ static const char *valid_arguments[] = {
 	ETH_AF_PACKET_FRAMESIZE_ARG,
 	ETH_AF_PACKET_FRAMECOUNT_ARG,
 	ETH_AF_PACKET_QDISC_BYPASS_ARG,
+	ETH_AF_PACKET_TPACKET_V3_ARG,
+	ETH_AF_PACKET_BLOCKTMO_ARG,
+	ETH_AF_PACKET_ZEROCOPY_ARG,
 	NULL
 };
 
@@ -167,6 +193,149 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_rx;
 }
 
+static inline void
+af_packet_block_release(struct tpacket_block_desc *pbd)
+{
+	__atomic_store_n(&pbd->hdr.bh1.block_status, TP_STATUS_KERNEL,
+			 __ATOMIC_RELEASE);
+}
+
+/*
+ * Called once the last reference on a zero copy block is dropped, the
+ * block being only given back to the Kernel from here.
+ */
+static void
+af_packet_extbuf_free(void *addr __rte_unused, void *opaque)
+{
+	struct af_packet_zc_block *blk = opaque;
+
+	af_packet_block_release(blk->pbd);
+	__atomic_store_n(&blk->lent, 0, __ATOMIC_RELEASE);
+}
+
+/* Give back the current block, or the reference of the queue on it */
+static inline void
+eth_af_packet_rx_block_done(struct pkt_rx_queue *pkt_q)
+{
+	struct af_packet_zc_block *blk;
+
+	if (pkt_q->zc_blocks == NULL) {
+		af_packet_block_release(pkt_q->rd[pkt_q->blocknum].iov_base);
+	} else {
+		blk = &pkt_q->zc_blocks[pkt_q->blocknum];
+		if (rte_mbuf_ext_refcnt_update(&blk->shinfo, -1) == 0)
+			af_packet_extbuf_free(NULL, blk);
+	}
+
+	if (++pkt_q->blocknum >= pkt_q->blockcount)
+		pkt_q->blocknum = 0;
+	pkt_q->frame = NULL;
+}
+
+static uint16_t
+eth_af_packet_rx_v3(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct tpacket_block_desc *pbd;
+	struct tpacket3_hdr *ppd;
+	struct af_packet_zc_block *blk;
+	struct rte_mbuf *mbuf;
+	uint8_t *pbuf;
+	struct pkt_rx_queue *pkt_q = queue;
+	uint16_t num_rx = 0;
+	unsigned long num_rx_bytes = 0;
+
+	/*
+	 * The kernel fills a whole block of variable size frames before
+	 * handing it over, or earlier on the block timeout. The frames of the
+	 * block are then either copied into mbufs, or attached to them as
+	 * external buffers, the block being given back to the kernel once
+	 * its last mbuf is freed.
+	 */
+	while (num_rx < nb_pkts) {
+		if (pkt_q->frame == NULL) {
+			/*
+			 * A block the application still has mbufs of is
+			 * left as the Kernel gave it, the ring is full until
+			 * they are freed.
+			 */
+			if (pkt_q->zc_blocks != NULL &&
+			    __atomic_load_n(&pkt_q->zc_blocks[
+					    pkt_q->blocknum].lent,
+					    __ATOMIC_ACQUIRE))
+				break;
+
+			pbd = pkt_q->rd[pkt_q->blocknum].iov_base;
+			if ((__atomic_load_n(&pbd->hdr.bh1.block_status,
+					     __ATOMIC_ACQUIRE) &
+			     TP_STATUS_USER) == 0)
+				break;
+
+			if (pkt_q->zc_blocks != NULL) {
+				blk = &pkt_q->zc_blocks[pkt_q->blocknum];
+				blk->lent = 1;
+				rte_mbuf_ext_refcnt_set(&blk->shinfo, 1);
+			}
+
+			pkt_q->frames_left = pbd->hdr.bh1.num_pkts;
+			if (unlikely(pkt_q->frames_left == 0)) {
+				eth_af_packet_rx_block_done(pkt_q);
+				continue;
+			}
+			pkt_q->frame = (struct tpacket3_hdr *)((uint8_t *)pbd +
+					pbd->hdr.bh1.offset_to_first_pkt);
+		}
+
+		/* allocate the next mbuf */
+		mbuf = rte_pktmbuf_alloc(pkt_q->mb_pool);
+		if (unlikely(mbuf == NULL))
+			break;
+
+		ppd = pkt_q->frame;
+		pbuf = (uint8_t *)ppd + ppd->tp_mac;
+		if (pkt_q->zc_blocks != NULL) {
+			blk = &pkt_q->zc_blocks[pkt_q->blocknum];
+			rte_mbuf_ext_refcnt_update(&blk->shinfo, 1);
+			rte_pktmbuf_attach_extbuf(mbuf, pbuf, RTE_BAD_IOVA,
+						  ppd->tp_snaplen, &blk->shinfo);
+		} else if (likely(ppd->tp_snaplen <=
+				  rte_pktmbuf_tailroom(mbuf))) {
+			memcpy(rte_pktmbuf_mtod(mbuf, void *), pbuf,
+			       ppd->tp_snaplen);
+		} else {
+			/* frame grown past the mbuf after an MTU change */
+			rte_pktmbuf_free(mbuf);
+			mbuf = NULL;
+		}
+
+		if (likely(mbuf != NULL)) {
+			rte_pktmbuf_pkt_len(mbuf) = ppd->tp_snaplen;
+			rte_pktmbuf_data_len(mbuf) = ppd->tp_snaplen;
+
+			/* check for vlan info */
+			if (ppd->tp_status & TP_STATUS_VLAN_VALID) {
+				mbuf->vlan_tci = ppd->hv1.tp_vlan_tci;
+				mbuf->ol_flags |= (PKT_RX_VLAN |
+						   PKT_RX_VLAN_STRIPPED);
+			}
+			mbuf->port = pkt_q->in_port;
+
+			/* account for the receive frame */
+			bufs[num_rx++] = mbuf;
+			num_rx_bytes += mbuf->pkt_len;
+		}
+
+		/* advance to the next frame, or the next block */
+		if (--pkt_q->frames_left == 0)
+			eth_af_packet_rx_block_done(pkt_q);
+		else
+			pkt_q->frame = (struct tpacket3_hdr *)((uint8_t *)ppd +
+					ppd->tp_next_offset);
+	}
+	pkt_q->rx_pkts += num_rx;
+	pkt_q->rx_bytes += num_rx_bytes;
+	return num_rx;
+}
+
 /*
  * Callback to handle sending packets through a real NIC.
  */
@@ -411,9 +580,13 @@ eth_rx_queue_setup(struct rte_eth_dev *dev,
 	buf_size = rte_pktmbuf_data_room_size(pkt_q->mb_pool) -
 		RTE_PKTMBUF_HEADROOM;
 	data_size = internals->req.tp_frame_size;
-	data_size -= TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
+	if (internals->tpacket_v3)
+		data_size -= TPACKET3_HDRLEN - sizeof(struct sockaddr_ll);
+	else
+		data_size -= TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
 
-	if (data_size > buf_size) {
+	/* zero copy mbufs only carry the frames attached to them */
+	if (pkt_q->zc_blocks == NULL && data_size > buf_size) {
 		PMD_LOG(ERR,
 			"%s: %d bytes will not fit in mbuf (%d bytes)",
 			dev->device->name, data_size, buf_size);
@@ -575,6 +748,50 @@ open_packet_iface(const char *key __rte_unused,
 	return 0;
 }
 
+/*
+ * Sets the options common to the Rx and Tx sockets of a queue
+ */
+static int
+af_packet_set_sockopts(const char *name, const char *if_name, int qsockfd,
+		       int tpver, unsigned int qdisc_bypass)
+{
+	int rc, discard;
+
+	rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
+			&tpver, sizeof(tpver));
+	if (rc == -1) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: could not set PACKET_VERSION on AF_PACKET socket for %s",
+			name, if_name);
+		return -1;
+	}
+
+	discard = 1;
+	rc = setsockopt(qsockfd, SOL_PACKET, PACKET_LOSS,
+			&discard, sizeof(discard));
+	if (rc == -1) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: could not set PACKET_LOSS on AF_PACKET socket for %s",
+			name, if_name);
+		return -1;
+	}
+
+#if defined(PACKET_QDISC_BYPASS)
+	rc = setsockopt(qsockfd, SOL_PACKET, PACKET_QDISC_BYPASS,
+			&qdisc_bypass, sizeof(qdisc_bypass));
+	if (rc == -1) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: could not set PACKET_QDISC_BYPASS on AF_PACKET socket for %s",
+			name, if_name);
+		return -1;
+	}
+#else
+	RTE_SET_USED(qdisc_bypass);
+#endif
+
+	return 0;
+}
+
 static int
 rte_pmd_init_internals(struct rte_vdev_device *dev,
                        const int sockfd,
@@ -584,6 +801,9 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
                        unsigned int framesize,
                        unsigned int framecnt,
 		       unsigned int qdisc_bypass,
+		       unsigned int tpacket_v3,
+		       unsigned int blocktmo,
+		       unsigned int zerocopy,
                        struct pmd_internals **internals,
                        struct rte_eth_dev **eth_dev,
                        struct rte_kvargs *kvlist)
@@ -596,11 +816,15 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	size_t ifnamelen;
 	unsigned k_idx;
 	struct sockaddr_ll sockaddr;
+	struct sockaddr_ll tx_sockaddr;
 	struct tpacket_req *req;
+	struct tpacket_req3 *req3;
 	struct pkt_rx_queue *rx_queue;
 	struct pkt_tx_queue *tx_queue;
-	int rc, tpver, discard;
+	struct af_packet_zc_block *blk;
+	int rc;
 	int qsockfd = -1;
+	int txsockfd = -1;
 	unsigned int i, q, rdsize;
 #if defined(PACKET_FANOUT)
 	int fanout_arg;
@@ -654,6 +878,14 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	req->tp_frame_size = framesize;
 	req->tp_frame_nr = framecnt;
 
+	(*internals)->tpacket_v3 = tpacket_v3;
+	req3 = &((*internals)->req3);
+	req3->tp_block_size = blocksize;
+	req3->tp_block_nr = blockcnt;
+	req3->tp_frame_size = framesize;
+	req3->tp_frame_nr = framecnt;
+	req3->tp_retire_blk_tov = blocktmo;
+
 	ifnamelen = strlen(pair->value);
 	if (ifnamelen < sizeof(ifr.ifr_name)) {
 		memcpy(ifr.ifr_name, pair->value, ifnamelen);
@@ -684,6 +916,10 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	sockaddr.sll_protocol = htons(ETH_P_ALL);
 	sockaddr.sll_ifindex = (*internals)->if_index;
 
+	/* the Tx only sockets of TPACKET_V3 mode do not receive anything */
+	tx_sockaddr = sockaddr;
+	tx_sockaddr.sll_protocol = 0;
+
 #if defined(PACKET_FANOUT)
 	fanout_arg = (getpid() ^ (*internals)->if_index) & 0xffff;
 	fanout_arg |= (PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16;
@@ -693,6 +929,8 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 #endif
 
 	for (q = 0; q < nb_queues; q++) {
+		txsockfd = -1;
+
 		/* Open an AF_PACKET socket for this queue... */
 		qsockfd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
 		if (qsockfd == -1) {
@@ -702,48 +940,52 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			return -1;
 		}
 
-		tpver = TPACKET_V2;
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
-				&tpver, sizeof(tpver));
-		if (rc == -1) {
-			PMD_LOG_ERRNO(ERR,
-				"%s: could not set PACKET_VERSION on AF_PACKET socket for %s",
-				name, pair->value);
+		rc = af_packet_set_sockopts(name, pair->value, qsockfd,
+				tpacket_v3 ? TPACKET_V3 : TPACKET_V2,
+				qdisc_bypass);
+		if (rc == -1)
 			goto error;
-		}
 
-		discard = 1;
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_LOSS,
-				&discard, sizeof(discard));
+		if (tpacket_v3)
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING,
+					req3, sizeof(*req3));
+		else
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING,
+					req, sizeof(*req));
 		if (rc == -1) {
 			PMD_LOG_ERRNO(ERR,
-				"%s: could not set PACKET_LOSS on AF_PACKET socket for %s",
+				"%s: could not set PACKET_RX_RING on AF_PACKET socket for %s",
 				name, pair->value);
 			goto error;
 		}
 
-#if defined(PACKET_QDISC_BYPASS)
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_QDISC_BYPASS,
-				&qdisc_bypass, sizeof(qdisc_bypass));
-		if (rc == -1) {
-			PMD_LOG_ERRNO(ERR,
-				"%s: could not set PACKET_QDISC_BYPASS on AF_PACKET socket for %s",
-				name, pair->value);
-			goto error;
-		}
-#else
-		RTE_SET_USED(qdisc_bypass);
-#endif
+		rx_queue = &((*internals)->rx_queue[q]);
+		tx_queue = &((*internals)->tx_queue[q]);
+		rx_queue->sockfd = qsockfd;
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
-		if (rc == -1) {
-			PMD_LOG_ERRNO(ERR,
-				"%s: could not set PACKET_RX_RING on AF_PACKET socket for %s",
-				name, pair->value);
-			goto error;
+		/*
+		 * TPACKET_V3 only brings block based Rx, so the Tx ring then
+		 * lives on a TPACKET_V2 socket of its own.
+		 */
+		if (tpacket_v3) {
+			txsockfd = socket(AF_PACKET, SOCK_RAW, 0);
+			if (txsockfd == -1) {
+				PMD_LOG_ERRNO(ERR,
+					"%s: could not open AF_PACKET socket",
+					name);
+				goto error;
+			}
+			tx_queue->sockfd = txsockfd;
+			rc = af_packet_set_sockopts(name, pair->value,
+					txsockfd, TPACKET_V2, qdisc_bypass);
+			if (rc == -1)
+				goto error;
+		} else {
+			txsockfd = qsockfd;
+			tx_queue->sockfd = qsockfd;
 		}
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
+		rc = setsockopt(txsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
 		if (rc == -1) {
 			PMD_LOG_ERRNO(ERR,
 				"%s: could not set PACKET_TX_RING on AF_PACKET "
@@ -751,10 +993,18 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			goto error;
 		}
 
-		rx_queue = &((*internals)->rx_queue[q]);
-		rx_queue->framecount = req->tp_frame_nr;
+		if (tpacket_v3) {
+			rx_queue->map_size = (size_t)req->tp_block_size *
+					     req->tp_block_nr;
+			tx_queue->map_size = rx_queue->map_size;
+		} else {
+			/* the Tx ring follows the Rx ring in the same mapping */
+			rx_queue->map_size = 2 * (size_t)req->tp_block_size *
+					     req->tp_block_nr;
+			tx_queue->map_size = 0;
+		}
 
-		rx_queue->map = mmap(NULL, 2 * req->tp_block_size * req->tp_block_nr,
+		rx_queue->map = mmap(NULL, rx_queue->map_size,
 				    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
 				    qsockfd, 0);
 		if (rx_queue->map == MAP_FAILED) {
@@ -764,26 +1014,69 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			goto error;
 		}
 
-		/* rdsize is same for both Tx and Rx */
-		rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
+		if (tpacket_v3) {
+			rx_queue->blockcount = req3->tp_block_nr;
+			rdsize = req3->tp_block_nr * sizeof(*(rx_queue->rd));
+			rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0,
+							  numa_node);
+			if (rx_queue->rd == NULL)
+				goto error;
+			for (i = 0; i < req3->tp_block_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+							   (i * blocksize);
+				rx_queue->rd[i].iov_len = req3->tp_block_size;
+			}
 
-		rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
-		if (rx_queue->rd == NULL)
-			goto error;
-		for (i = 0; i < req->tp_frame_nr; ++i) {
-			rx_queue->rd[i].iov_base = rx_queue->map + (i * framesize);
-			rx_queue->rd[i].iov_len = req->tp_frame_size;
+			if (zerocopy) {
+				rx_queue->zc_blocks = rte_zmalloc_socket(name,
+					req3->tp_block_nr *
+					sizeof(*(rx_queue->zc_blocks)),
+					0, numa_node);
+				if (rx_queue->zc_blocks == NULL)
+					goto error;
+				for (i = 0; i < req3->tp_block_nr; ++i) {
+					blk = &rx_queue->zc_blocks[i];
+					blk->pbd = rx_queue->rd[i].iov_base;
+					blk->shinfo.free_cb =
+						af_packet_extbuf_free;
+					blk->shinfo.fcb_opaque = blk;
+				}
+			}
+		} else {
+			rx_queue->framecount = req->tp_frame_nr;
+			rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
+			rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0,
+							  numa_node);
+			if (rx_queue->rd == NULL)
+				goto error;
+			for (i = 0; i < req->tp_frame_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+							   (i * framesize);
+				rx_queue->rd[i].iov_len = req->tp_frame_size;
+			}
 		}
-		rx_queue->sockfd = qsockfd;
 
-		tx_queue = &((*internals)->tx_queue[q]);
 		tx_queue->framecount = req->tp_frame_nr;
 		tx_queue->frame_data_size = req->tp_frame_size;
 		tx_queue->frame_data_size -= TPACKET2_HDRLEN -
 			sizeof(struct sockaddr_ll);
 
-		tx_queue->map = rx_queue->map + req->tp_block_size * req->tp_block_nr;
+		if (tpacket_v3) {
+			tx_queue->map = mmap(NULL, tx_queue->map_size,
+					PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_LOCKED, txsockfd, 0);
+			if (tx_queue->map == MAP_FAILED) {
+				PMD_LOG_ERRNO(ERR,
+					"%s: call to mmap failed on AF_PACKET socket for %s",
+					name, pair->value);
+				goto error;
+			}
+		} else {
+			tx_queue->map = rx_queue->map +
+					req->tp_block_size * req->tp_block_nr;
+		}
 
+		rdsize = req->tp_frame_nr * sizeof(*(tx_queue->rd));
 		tx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
 		if (tx_queue->rd == NULL)
 			goto error;
@@ -791,7 +1084,17 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			tx_queue->rd[i].iov_base = tx_queue->map + (i * framesize);
 			tx_queue->rd[i].iov_len = req->tp_frame_size;
 		}
-		tx_queue->sockfd = qsockfd;
+
+		if (tpacket_v3) {
+			rc = bind(txsockfd, (const struct sockaddr *)&tx_sockaddr,
+				  sizeof(tx_sockaddr));
+			if (rc == -1) {
+				PMD_LOG_ERRNO(ERR,
+					"%s: could not bind AF_PACKET socket to %s",
+					name, pair->value);
+				goto error;
+			}
+		}
 
 		rc = bind(qsockfd, (const struct sockaddr*)&sockaddr, sizeof(sockaddr));
 		if (rc == -1) {
@@ -842,15 +1145,26 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 error:
 	if (qsockfd != -1)
 		close(qsockfd);
+	if (txsockfd != -1 && txsockfd != qsockfd)
+		close(txsockfd);
 	for (q = 0; q < nb_queues; q++) {
-		munmap((*internals)->rx_queue[q].map,
-		       2 * req->tp_block_size * req->tp_block_nr);
-
-		rte_free((*internals)->rx_queue[q].rd);
-		rte_free((*internals)->tx_queue[q].rd);
-		if (((*internals)->rx_queue[q].sockfd != 0) &&
-			((*internals)->rx_queue[q].sockfd != qsockfd))
-			close((*internals)->rx_queue[q].sockfd);
+		rx_queue = &((*internals)->rx_queue[q]);
+		tx_queue = &((*internals)->tx_queue[q]);
+		if (rx_queue->map != MAP_FAILED)
+			munmap(rx_queue->map, rx_queue->map_size);
+		if (tx_queue->map != MAP_FAILED && tx_queue->map_size != 0)
+			munmap(tx_queue->map, tx_queue->map_size);
+
+		rte_free(rx_queue->rd);
+		rte_free(rx_queue->zc_blocks);
+		rte_free(tx_queue->rd);
+		if ((tx_queue->sockfd != 0) &&
+			(tx_queue->sockfd != rx_queue->sockfd) &&
+			(tx_queue->sockfd != txsockfd))
+			close(tx_queue->sockfd);
+		if ((rx_queue->sockfd != 0) &&
+			(rx_queue->sockfd != qsockfd))
+			close(rx_queue->sockfd);
 	}
 	free((*internals)->if_name);
 	rte_free(*internals);
@@ -873,6 +1187,9 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	unsigned int framecount = DFLT_FRAME_COUNT;
 	unsigned int qpairs = 1;
 	unsigned int qdisc_bypass = 1;
+	unsigned int tpacket_v3 = 0;
+	unsigned int blocktmo = 0;
+	unsigned int zerocopy = 0;
 
 	/* do some parameter checking */
 	if (*sockfd < 0)
@@ -935,6 +1252,43 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 			}
 			continue;
 		}
+		if (strstr(pair->key, ETH_AF_PACKET_TPACKET_V3_ARG) != NULL) {
+			tpacket_v3 = atoi(pair->value);
+			if (tpacket_v3 > 1) {
+				PMD_LOG(ERR,
+					"%s: invalid tpacket_v3 value",
+					name);
+				return -1;
+			}
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_BLOCKTMO_ARG) != NULL) {
+			blocktmo = atoi(pair->value);
+			if (!blocktmo) {
+				PMD_LOG(ERR,
+					"%s: invalid block timeout value",
+					name);
+				return -1;
+			}
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_ZEROCOPY_ARG) != NULL) {
+			zerocopy = atoi(pair->value);
+			if (zerocopy > 1) {
+				PMD_LOG(ERR,
+					"%s: invalid zerocopy value",
+					name);
+				return -1;
+			}
+			continue;
+		}
+	}
+
+	if (zerocopy && !tpacket_v3) {
+		PMD_LOG(ERR,
+			"%s: zero copy Rx requires TPACKET_V3",
+		        name);
+		return -1;
 	}
 
 	if (framesize > blocksize) {
@@ -956,16 +1310,26 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	PMD_LOG(INFO, "%s:\tblock count %d", name, blockcount);
 	PMD_LOG(INFO, "%s:\tframe size %d", name, framesize);
 	PMD_LOG(INFO, "%s:\tframe count %d", name, framecount);
+	if (tpacket_v3) {
+		PMD_LOG(INFO, "%s:\tTPACKET_V3 Rx%s", name,
+			zerocopy ? ", zero copy" : "");
+		PMD_LOG(INFO, "%s:\tblock timeout %u ms%s", name, blocktmo,
+			blocktmo ? "" : " (kernel default)");
+	}
 
 	if (rte_pmd_init_internals(dev, *sockfd, qpairs,
 				   blocksize, blockcount,
 				   framesize, framecount,
 				   qdisc_bypass,
+				   tpacket_v3, blocktmo, zerocopy,
 				   &internals, &eth_dev,
 				   kvlist) < 0)
 		return -1;
 
-	eth_dev->rx_pkt_burst = eth_af_packet_rx;
+	if (tpacket_v3)
+		eth_dev->rx_pkt_burst = eth_af_packet_rx_v3;
+	else
+		eth_dev->rx_pkt_burst = eth_af_packet_rx;
 	eth_dev->tx_pkt_burst = eth_af_packet_tx;
 
 	rte_eth_dev_probing_finish(eth_dev);
@@ -1025,12 +1389,33 @@ rte_pmd_af_packet_probe(struct rte_vdev_device *dev)
 	return ret;
 }
 
+/*
+ * Zero copy: drop the reference of the queue on the block it was reading,
+ * and tell whether the application still has mbufs pointing into the ring.
+ */
+static int
+af_packet_rx_zc_busy(struct pkt_rx_queue *pkt_q)
+{
+	unsigned int i;
+
+	if (pkt_q->zc_blocks == NULL)
+		return 0;
+
+	if (pkt_q->frame != NULL)
+		eth_af_packet_rx_block_done(pkt_q);
+
+	for (i = 0; i < pkt_q->blockcount; i++)
+		if (__atomic_load_n(&pkt_q->zc_blocks[i].lent,
+				    __ATOMIC_ACQUIRE))
+			return 1;
+	return 0;
+}
+
 static int
 rte_pmd_af_packet_remove(struct rte_vdev_device *dev)
 {
 	struct rte_eth_dev *eth_dev = NULL;
 	struct pmd_internals *internals;
-	struct tpacket_req *req;
 	unsigned q;
 
 	PMD_LOG(INFO, "Closing AF_PACKET ethdev on numa socket %u",
@@ -1044,18 +1429,33 @@ rte_pmd_af_packet_remove(struct rte_vdev_device *dev)
 	if (eth_dev == NULL)
 		return -1;
 
-	/* mac_addrs must not be freed alone because part of dev_private */
-	eth_dev->data->mac_addrs = NULL;
-
-	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		/* mac_addrs must not be freed alone because part of dev_private */
+		eth_dev->data->mac_addrs = NULL;
 		return rte_eth_dev_release_port(eth_dev);
+	}
 
+	/* the ring can not be unmapped under the zero copy mbufs */
 	internals = eth_dev->data->dev_private;
-	req = &internals->req;
+	for (q = 0; q < internals->nb_queues; q++) {
+		if (af_packet_rx_zc_busy(&internals->rx_queue[q])) {
+			PMD_LOG(ERR, "%s: zero copy mbufs of Rx queue %u not freed",
+				rte_vdev_device_name(dev), q);
+			return -EBUSY;
+		}
+	}
+
+	/* mac_addrs must not be freed alone because part of dev_private */
+	eth_dev->data->mac_addrs = NULL;
+
 	for (q = 0; q < internals->nb_queues; q++) {
 		munmap(internals->rx_queue[q].map,
-			2 * req->tp_block_size * req->tp_block_nr);
+			internals->rx_queue[q].map_size);
+		if (internals->tx_queue[q].map_size != 0)
+			munmap(internals->tx_queue[q].map,
+				internals->tx_queue[q].map_size);
 		rte_free(internals->rx_queue[q].rd);
+		rte_free(internals->rx_queue[q].zc_blocks);
 		rte_free(internals->tx_queue[q].rd);
 	}
 	free(internals->if_name);
@@ -1080,4 +1480,7 @@ RTE_PMD_REGISTER_PARAM_STRING(net_af_packet,
 	"blocksz=<int> "
 	"framesz=<int> "
 	"framecnt=<int> "
-	"qdisc_bypass=<0|1>");
+	"qdisc_bypass=<0|1> "
+	"tpacket_v3=<0|1> "
+	"blocktmo=<int> "
+	"zerocopy=<0|1>");
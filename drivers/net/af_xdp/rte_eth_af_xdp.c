@@ -3,19 +3,23 @@
  */
 #include <unistd.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <poll.h>
+#include <pthread.h>
 #include <netinet/in.h>
 #include <net/if.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/queue.h>
 #include <linux/if_ether.h>
 #include <linux/if_xdp.h>
 #include <linux/if_link.h>
 #include <linux/ethtool.h>
 #include <linux/sockios.h>
 #include "af_xdp_deps.h"
+#include <bpf/bpf.h>
 #include <bpf/xsk.h>
 
 #include <rte_ethdev.h>
@@ -65,15 +69,24 @@ RTE_LOG_REGISTER(af_xdp_logtype, pmd.net.af_xdp, NOTICE);
 #define ETH_AF_XDP_RX_BATCH_SIZE	32
 #define ETH_AF_XDP_TX_BATCH_SIZE	32
 
+#ifdef SO_PREFER_BUSY_POLL
+#define ETH_AF_XDP_DFLT_BUSY_BUDGET	64
+#else
+#define ETH_AF_XDP_DFLT_BUSY_BUDGET	0
+#endif
+/* usecs the kernel busy polls the device queue for */
+#define ETH_AF_XDP_DFLT_BUSY_TIMEOUT	20
 
 struct xsk_umem_info {
-	struct xsk_ring_prod fq;
-	struct xsk_ring_cons cq;
 	struct xsk_umem *umem;
 	struct rte_ring *buf_ring;
 	const struct rte_memzone *mz;
 	struct rte_mempool *mb_pool;
 	void *buffer;
+	/* number of xsks using the umem */
+	uint32_t refcnt;
+	/* number of xsks the mempool has enough buffers for */
+	uint32_t max_xsks;
 };
 
 struct rx_stats {
@@ -90,9 +103,14 @@ struct pkt_rx_queue {
 
 	struct rx_stats stats;
 
+	/* each xsk has its own fill and completion rings on a shared umem */
+	struct xsk_ring_prod fq;
+	struct xsk_ring_cons cq;
+
 	struct pkt_tx_queue *pair;
 	struct pollfd fds[1];
 	int xsk_queue_idx;
+	uint32_t busy_budget;
 };
 
 struct tx_stats {
@@ -118,6 +136,12 @@ struct pmd_internals {
 	int queue_cnt;
 	int max_queue_cnt;
 	int combined_queue_cnt;
+	bool shared_umem;
+	uint32_t busy_budget;
+	char prog_path[PATH_MAX];
+	bool custom_prog_configured;
+	struct bpf_object *prog_obj;
+	int map_fd;
 
 	struct rte_ether_addr eth_addr;
 
@@ -128,14 +152,32 @@ struct pmd_internals {
 #define ETH_AF_XDP_IFACE_ARG			"iface"
 #define ETH_AF_XDP_START_QUEUE_ARG		"start_queue"
 #define ETH_AF_XDP_QUEUE_COUNT_ARG		"queue_count"
+#define ETH_AF_XDP_SHARED_UMEM_ARG		"shared_umem"
+#define ETH_AF_XDP_BUSY_BUDGET_ARG		"busy_budget"
+#define ETH_AF_XDP_PROG_ARG			"xdp_prog"
 
 static const char * const valid_arguments[] = {
 	ETH_AF_XDP_IFACE_ARG,
 	ETH_AF_XDP_START_QUEUE_ARG,
 	ETH_AF_XDP_QUEUE_COUNT_ARG,
+	ETH_AF_XDP_SHARED_UMEM_ARG,
+	ETH_AF_XDP_BUSY_BUDGET_ARG,
+	ETH_AF_XDP_PROG_ARG,
 	NULL
 };
 
+/* af_xdp ports, looked up to share umems between them */
+struct internal_list {
+	TAILQ_ENTRY(internal_list) next;
+	struct rte_eth_dev *eth_dev;
+};
+
+TAILQ_HEAD(internal_list_head, internal_list);
+static struct internal_list_head internal_list =
+	TAILQ_HEAD_INITIALIZER(internal_list);
+
+static pthread_mutex_t internal_list_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static const struct rte_eth_link pmd_link = {
 	.link_speed = ETH_SPEED_NUM_10G,
 	.link_duplex = ETH_LINK_FULL_DUPLEX,
@@ -146,9 +188,8 @@ static const struct rte_eth_link pmd_link = {
 #if defined(XDP_UMEM_UNALIGNED_CHUNK_FLAG)
 static inline int
 reserve_fill_queue_zc(struct xsk_umem_info *umem, uint16_t reserve_size,
-		      struct rte_mbuf **bufs)
+		      struct rte_mbuf **bufs, struct xsk_ring_prod *fq)
 {
-	struct xsk_ring_prod *fq = &umem->fq;
 	uint32_t idx;
 	uint16_t i;
 
@@ -176,9 +217,9 @@ reserve_fill_queue_zc(struct xsk_umem_info *umem, uint16_t reserve_size,
 #else
 static inline int
 reserve_fill_queue_cp(struct xsk_umem_info *umem, uint16_t reserve_size,
-		      struct rte_mbuf **bufs __rte_unused)
+		      struct rte_mbuf **bufs __rte_unused,
+		      struct xsk_ring_prod *fq)
 {
-	struct xsk_ring_prod *fq = &umem->fq;
 	void *addrs[reserve_size];
 	uint32_t idx;
 	uint16_t i;
@@ -211,12 +252,32 @@ reserve_fill_queue_cp(struct xsk_umem_info *umem, uint16_t reserve_size,
 
 static inline int
 reserve_fill_queue(struct xsk_umem_info *umem, uint16_t reserve_size,
-		   struct rte_mbuf **bufs)
+		   struct rte_mbuf **bufs, struct xsk_ring_prod *fq)
 {
 #if defined(XDP_UMEM_UNALIGNED_CHUNK_FLAG)
-	return reserve_fill_queue_zc(umem, reserve_size, bufs);
+	return reserve_fill_queue_zc(umem, reserve_size, bufs, fq);
 #else
-	return reserve_fill_queue_cp(umem, reserve_size, bufs);
+	return reserve_fill_queue_cp(umem, reserve_size, bufs, fq);
+#endif
+}
+
+/*
+ * Nothing was received: with busy polling, the syscall makes the kernel
+ * poll the device queue, otherwise it is only made when the kernel asks
+ * to be woken up.
+ */
+static inline void
+rx_wakeup(struct pkt_rx_queue *rxq)
+{
+	if (rxq->busy_budget) {
+		(void)recvfrom(xsk_socket__fd(rxq->xsk), NULL, 0, MSG_DONTWAIT,
+			       NULL, NULL);
+		return;
+	}
+
+#if defined(XDP_USE_NEED_WAKEUP)
+	if (xsk_ring_prod__needs_wakeup(&rxq->fq))
+		(void)poll(rxq->fds, 1, 1000);
 #endif
 }
 
@@ -226,6 +287,7 @@ af_xdp_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct pkt_rx_queue *rxq = queue;
 	struct xsk_ring_cons *rx = &rxq->rx;
+	struct xsk_ring_prod *fq = &rxq->fq;
 	struct xsk_umem_info *umem = rxq->umem;
 	uint32_t idx_rx = 0;
 	unsigned long rx_bytes = 0;
@@ -242,11 +304,7 @@ af_xdp_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	rcvd = xsk_ring_cons__peek(rx, nb_pkts, &idx_rx);
 
 	if (rcvd == 0) {
-#if defined(XDP_USE_NEED_WAKEUP)
-		if (xsk_ring_prod__needs_wakeup(&umem->fq))
-			(void)poll(rxq->fds, 1, 1000);
-#endif
-
+		rx_wakeup(rxq);
 		goto out;
 	}
 
@@ -277,7 +335,7 @@ af_xdp_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	xsk_ring_cons__release(rx, rcvd);
 
-	(void)reserve_fill_queue(umem, rcvd, fq_bufs);
+	(void)reserve_fill_queue(umem, rcvd, fq_bufs, fq);
 
 	/* statistics */
 	rxq->stats.rx_pkts += rcvd;
@@ -297,7 +355,7 @@ af_xdp_rx_cp(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	struct pkt_rx_queue *rxq = queue;
 	struct xsk_ring_cons *rx = &rxq->rx;
 	struct xsk_umem_info *umem = rxq->umem;
-	struct xsk_ring_prod *fq = &umem->fq;
+	struct xsk_ring_prod *fq = &rxq->fq;
 	uint32_t idx_rx = 0;
 	unsigned long rx_bytes = 0;
 	int rcvd, i;
@@ -309,16 +367,13 @@ af_xdp_rx_cp(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	rcvd = xsk_ring_cons__peek(rx, nb_pkts, &idx_rx);
 	if (rcvd == 0) {
-#if defined(XDP_USE_NEED_WAKEUP)
-		if (xsk_ring_prod__needs_wakeup(fq))
-			(void)poll(rxq->fds, 1, 1000);
-#endif
-
+		rx_wakeup(rxq);
 		goto out;
 	}
 
 	if (xsk_prod_nb_free(fq, free_thresh) >= free_thresh)
-		(void)reserve_fill_queue(umem, ETH_AF_XDP_RX_BATCH_SIZE, NULL);
+		(void)reserve_fill_queue(umem, ETH_AF_XDP_RX_BATCH_SIZE,
+					 NULL, fq);
 
 	for (i = 0; i < rcvd; i++) {
 		const struct xdp_desc *desc;
@@ -367,9 +422,8 @@ eth_af_xdp_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 }
 
 static void
-pull_umem_cq(struct xsk_umem_info *umem, int size)
+pull_umem_cq(struct xsk_umem_info *umem, int size, struct xsk_ring_cons *cq)
 {
-	struct xsk_ring_cons *cq = &umem->cq;
 	size_t i, n;
 	uint32_t idx_cq = 0;
 
@@ -392,11 +446,11 @@ pull_umem_cq(struct xsk_umem_info *umem, int size)
 }
 
 static void
-kick_tx(struct pkt_tx_queue *txq)
+kick_tx(struct pkt_tx_queue *txq, struct xsk_ring_cons *cq)
 {
 	struct xsk_umem_info *umem = txq->umem;
 
-	pull_umem_cq(umem, XSK_RING_CONS__DEFAULT_NUM_DESCS);
+	pull_umem_cq(umem, XSK_RING_CONS__DEFAULT_NUM_DESCS, cq);
 
 #if defined(XDP_USE_NEED_WAKEUP)
 	if (xsk_ring_prod__needs_wakeup(&txq->tx))
@@ -410,7 +464,8 @@ kick_tx(struct pkt_tx_queue *txq)
 			/* pull from completion queue to leave more space */
 			if (errno == EAGAIN)
 				pull_umem_cq(umem,
-					     XSK_RING_CONS__DEFAULT_NUM_DESCS);
+					     XSK_RING_CONS__DEFAULT_NUM_DESCS,
+					     cq);
 		}
 }
 
@@ -420,6 +475,7 @@ af_xdp_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct pkt_tx_queue *txq = queue;
 	struct xsk_umem_info *umem = txq->umem;
+	struct xsk_ring_cons *cq = &txq->pair->cq;
 	struct rte_mbuf *mbuf;
 	unsigned long tx_bytes = 0;
 	int i;
@@ -427,17 +483,17 @@ af_xdp_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	uint16_t count = 0;
 	struct xdp_desc *desc;
 	uint64_t addr, offset;
-	uint32_t free_thresh = umem->cq.size >> 1;
+	uint32_t free_thresh = cq->size >> 1;
 
-	if (xsk_cons_nb_avail(&umem->cq, free_thresh) >= free_thresh)
-		pull_umem_cq(umem, XSK_RING_CONS__DEFAULT_NUM_DESCS);
+	if (xsk_cons_nb_avail(cq, free_thresh) >= free_thresh)
+		pull_umem_cq(umem, XSK_RING_CONS__DEFAULT_NUM_DESCS, cq);
 
 	for (i = 0; i < nb_pkts; i++) {
 		mbuf = bufs[i];
 
 		if (mbuf->pool == umem->mb_pool) {
 			if (!xsk_ring_prod__reserve(&txq->tx, 1, &idx_tx)) {
-				kick_tx(txq);
+				kick_tx(txq, cq);
 				if (!xsk_ring_prod__reserve(&txq->tx, 1,
 							    &idx_tx))
 					goto out;
@@ -462,7 +518,7 @@ af_xdp_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 			if (!xsk_ring_prod__reserve(&txq->tx, 1, &idx_tx)) {
 				rte_pktmbuf_free(local_mbuf);
-				kick_tx(txq);
+				kick_tx(txq, cq);
 				goto out;
 			}
 
@@ -486,7 +542,7 @@ af_xdp_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		tx_bytes += mbuf->pkt_len;
 	}
 
-	kick_tx(txq);
+	kick_tx(txq, cq);
 
 out:
 	xsk_ring_prod__submit(&txq->tx, count);
@@ -503,6 +559,7 @@ af_xdp_tx_cp(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	struct pkt_tx_queue *txq = queue;
 	struct xsk_umem_info *umem = txq->umem;
+	struct xsk_ring_cons *cq = &txq->pair->cq;
 	struct rte_mbuf *mbuf;
 	void *addrs[ETH_AF_XDP_TX_BATCH_SIZE];
 	unsigned long tx_bytes = 0;
@@ -511,7 +568,7 @@ af_xdp_tx_cp(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	nb_pkts = RTE_MIN(nb_pkts, ETH_AF_XDP_TX_BATCH_SIZE);
 
-	pull_umem_cq(umem, nb_pkts);
+	pull_umem_cq(umem, nb_pkts, cq);
 
 	nb_pkts = rte_ring_dequeue_bulk(umem->buf_ring, addrs,
 					nb_pkts, NULL);
@@ -519,7 +576,7 @@ af_xdp_tx_cp(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		return 0;
 
 	if (xsk_ring_prod__reserve(&txq->tx, nb_pkts, &idx_tx) != nb_pkts) {
-		kick_tx(txq);
+		kick_tx(txq, cq);
 		rte_ring_enqueue_bulk(umem->buf_ring, addrs, nb_pkts, NULL);
 		return 0;
 	}
@@ -542,7 +599,7 @@ af_xdp_tx_cp(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	xsk_ring_prod__submit(&txq->tx, nb_pkts);
 
-	kick_tx(txq);
+	kick_tx(txq, cq);
 
 	txq->stats.tx_pkts += nb_pkts;
 	txq->stats.tx_bytes += tx_bytes;
@@ -688,7 +745,7 @@ static void
 xdp_umem_destroy(struct xsk_umem_info *umem)
 {
 #if defined(XDP_UMEM_UNALIGNED_CHUNK_FLAG)
-	rte_mempool_free(umem->mb_pool);
+	/* the mempool belongs to the application, and may back other umems */
 	umem->mb_pool = NULL;
 #else
 	rte_memzone_free(umem->mz);
@@ -702,28 +759,49 @@ xdp_umem_destroy(struct xsk_umem_info *umem)
 	umem = NULL;
 }
 
+/* Drop the reference of an xsk on its umem, freeing it with the last one */
+static void
+xdp_umem_release(struct xsk_umem_info *umem)
+{
+	if (__atomic_sub_fetch(&umem->refcnt, 1, __ATOMIC_ACQ_REL) > 0)
+		return;
+
+	(void)xsk_umem__delete(umem->umem);
+	xdp_umem_destroy(umem);
+}
+
 static void
 eth_dev_close(struct rte_eth_dev *dev)
 {
 	struct pmd_internals *internals = dev->data->dev_private;
+	struct internal_list *list;
 	struct pkt_rx_queue *rxq;
 	int i;
 
 	AF_XDP_LOG(INFO, "Closing AF_XDP ethdev on numa socket %u\n",
 		rte_socket_id());
 
+	pthread_mutex_lock(&internal_list_lock);
+	TAILQ_FOREACH(list, &internal_list, next) {
+		if (list->eth_dev == dev) {
+			TAILQ_REMOVE(&internal_list, list, next);
+			rte_free(list);
+			break;
+		}
+	}
+
 	for (i = 0; i < internals->queue_cnt; i++) {
 		rxq = &internals->rx_queues[i];
 		if (rxq->umem == NULL)
 			break;
 		xsk_socket__delete(rxq->xsk);
-		(void)xsk_umem__delete(rxq->umem->umem);
-		xdp_umem_destroy(rxq->umem);
+		xdp_umem_release(rxq->umem);
 
 		/* free pkt_tx_queue */
 		rte_free(rxq->pair);
 		rte_free(rxq);
 	}
+	pthread_mutex_unlock(&internal_list_lock);
 
 	/*
 	 * MAC is not allocated dynamically, setting it to NULL would prevent
@@ -732,6 +810,11 @@ eth_dev_close(struct rte_eth_dev *dev)
 	dev->data->mac_addrs = NULL;
 
 	remove_xdp_program(internals);
+
+	if (internals->prog_obj != NULL) {
+		bpf_object__close(internals->prog_obj);
+		internals->prog_obj = NULL;
+	}
 }
 
 static void
@@ -755,8 +838,46 @@ static inline uint64_t get_base_addr(struct rte_mempool *mp)
 	return (uint64_t)memhdr->addr & ~(getpagesize() - 1);
 }
 
+/*
+ * Look for a umem set up over the mempool of the queue by another queue,
+ * of this port or of another af_xdp port. Returns it with a reference
+ * taken, or NULL if the queue needs a umem of its own.
+ * Must be called with internal_list_lock held.
+ */
+static struct xsk_umem_info *
+get_shared_umem(struct pkt_rx_queue *rxq)
+{
+	struct internal_list *list;
+	struct pmd_internals *internals;
+	struct pkt_rx_queue *list_rxq;
+	struct xsk_umem_info *umem;
+	int i;
+
+	TAILQ_FOREACH(list, &internal_list, next) {
+		internals = list->eth_dev->data->dev_private;
+		if (!internals->shared_umem)
+			continue;
+		for (i = 0; i < internals->queue_cnt; i++) {
+			list_rxq = &internals->rx_queues[i];
+			umem = list_rxq->umem;
+			if (list_rxq == rxq || umem == NULL ||
+					umem->mb_pool != rxq->mb_pool)
+				continue;
+			if (umem->refcnt >= umem->max_xsks) {
+				AF_XDP_LOG(INFO, "Not enough buffers in %s to share its umem with another xsk\n",
+					   rxq->mb_pool->name);
+				continue;
+			}
+			__atomic_add_fetch(&umem->refcnt, 1, __ATOMIC_ACQ_REL);
+			return umem;
+		}
+	}
+
+	return NULL;
+}
+
 static struct
-xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals __rte_unused,
+xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals,
 				  struct pkt_rx_queue *rxq)
 {
 	struct xsk_umem_info *umem;
@@ -776,6 +897,16 @@ xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals __rte_unused,
 					rte_pktmbuf_priv_size(mb_pool) +
 					RTE_PKTMBUF_HEADROOM;
 
+	if (internals->shared_umem) {
+		umem = get_shared_umem(rxq);
+		if (umem != NULL) {
+			AF_XDP_LOG(INFO, "%s,qid%i sharing umem of mempool %s\n",
+				   internals->if_name, rxq->xsk_queue_idx,
+				   mb_pool->name);
+			return umem;
+		}
+	}
+
 	umem = rte_zmalloc_socket("umem", sizeof(*umem), 0, rte_socket_id());
 	if (umem == NULL) {
 		AF_XDP_LOG(ERR, "Failed to allocate umem info");
@@ -787,7 +918,7 @@ xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals __rte_unused,
 
 	ret = xsk_umem__create(&umem->umem, base_addr,
 			       mb_pool->populated_size * usr_config.frame_size,
-			       &umem->fq, &umem->cq,
+			       &rxq->fq, &rxq->cq,
 			       &usr_config);
 
 	if (ret) {
@@ -795,6 +926,10 @@ xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals __rte_unused,
 		goto err;
 	}
 	umem->buffer = base_addr;
+	umem->refcnt = 1;
+	umem->max_xsks = mb_pool->populated_size / ETH_AF_XDP_NUM_BUFFERS;
+	if (umem->max_xsks == 0)
+		umem->max_xsks = 1;
 
 #else
 static struct
@@ -847,7 +982,7 @@ xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals,
 
 	ret = xsk_umem__create(&umem->umem, mz->addr,
 			       ETH_AF_XDP_NUM_BUFFERS * ETH_AF_XDP_FRAME_SIZE,
-			       &umem->fq, &umem->cq,
+			       &rxq->fq, &rxq->cq,
 			       &usr_config);
 
 	if (ret) {
@@ -855,6 +990,8 @@ xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals,
 		goto err;
 	}
 	umem->mz = mz;
+	umem->refcnt = 1;
+	umem->max_xsks = 1;
 
 #endif
 	return umem;
@@ -864,6 +1001,125 @@ xsk_umem_info *xdp_umem_configure(struct pmd_internals *internals,
 	return NULL;
 }
 
+/*
+ * Load the XDP program of an object file and attach it to the interface,
+ * in place of the default program of libbpf redirecting all the traffic
+ * of the bound queues. The program must provide a map of xsks named
+ * xsks_map, which the xsks get inserted into by queue id.
+ */
+static int
+load_custom_xdp_prog(const char *prog_path, int if_index, int *map_fd,
+		     struct bpf_object **prog_obj)
+{
+	int ret, prog_fd = -1;
+	struct bpf_object *obj;
+	struct bpf_map *map;
+
+	ret = bpf_prog_load(prog_path, BPF_PROG_TYPE_XDP, &obj, &prog_fd);
+	if (ret) {
+		AF_XDP_LOG(ERR, "Failed to load program %s\n", prog_path);
+		return ret;
+	}
+
+	map = bpf_object__find_map_by_name(obj, "xsks_map");
+	if (map == NULL) {
+		AF_XDP_LOG(ERR, "Failed to find xsks_map in %s\n", prog_path);
+		goto err;
+	}
+	*map_fd = bpf_map__fd(map);
+
+	ret = bpf_set_link_xdp_fd(if_index, prog_fd,
+				  XDP_FLAGS_UPDATE_IF_NOEXIST);
+	if (ret) {
+		AF_XDP_LOG(ERR, "Failed to set prog fd %d on interface\n",
+			   prog_fd);
+		goto err;
+	}
+
+	AF_XDP_LOG(INFO, "Successfully loaded XDP program %s with fd %d\n",
+		   prog_path, prog_fd);
+
+	/* the object is closed along with the device */
+	*prog_obj = obj;
+	return 0;
+
+err:
+	bpf_object__close(obj);
+	return -1;
+}
+
+/* Let the custom program redirect the packets of the queue to the xsk */
+static int
+update_xskmap(struct xsk_socket *xsk, int map_fd, int xsk_queue_idx)
+{
+	int fd = xsk_socket__fd(xsk);
+	int ret;
+
+	ret = bpf_map_update_elem(map_fd, &xsk_queue_idx, &fd, 0);
+	if (ret) {
+		AF_XDP_LOG(ERR, "Failed to insert xsk of queue %d in xsks_map\n",
+			   xsk_queue_idx);
+		return ret;
+	}
+
+	return 0;
+}
+
+#ifdef SO_PREFER_BUSY_POLL
+/*
+ * Have the kernel process the device queue from the syscalls of the
+ * application instead of from softirq, up to busy_budget packets per call.
+ */
+static int
+configure_preferred_busy_poll(struct pkt_rx_queue *rxq)
+{
+	int sock_opt = 1;
+	int fd = xsk_socket__fd(rxq->xsk);
+	int ret;
+
+	ret = setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL,
+			 (void *)&sock_opt, sizeof(sock_opt));
+	if (ret < 0) {
+		AF_XDP_LOG(DEBUG, "Failed to set SO_PREFER_BUSY_POLL\n");
+		goto err_prefer;
+	}
+
+	sock_opt = ETH_AF_XDP_DFLT_BUSY_TIMEOUT;
+	ret = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, (void *)&sock_opt,
+			 sizeof(sock_opt));
+	if (ret < 0) {
+		AF_XDP_LOG(DEBUG, "Failed to set SO_BUSY_POLL\n");
+		goto err_timeout;
+	}
+
+	sock_opt = rxq->busy_budget;
+	ret = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET,
+			 (void *)&sock_opt, sizeof(sock_opt));
+	if (ret < 0) {
+		AF_XDP_LOG(DEBUG, "Failed to set SO_BUSY_POLL_BUDGET\n");
+		goto err_budget;
+	}
+
+	AF_XDP_LOG(INFO, "Busy polling budget set to: %u\n", rxq->busy_budget);
+
+	return 0;
+
+err_budget:
+	sock_opt = 0;
+	if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, (void *)&sock_opt,
+		       sizeof(sock_opt)) < 0)
+		AF_XDP_LOG(ERR, "Failed to unset SO_BUSY_POLL\n");
+err_timeout:
+	sock_opt = 0;
+	if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL,
+		       (void *)&sock_opt, sizeof(sock_opt)) < 0)
+		AF_XDP_LOG(ERR, "Failed to unset SO_PREFER_BUSY_POLL\n");
+err_prefer:
+	rxq->busy_budget = 0;
+	return ret;
+}
+#endif
+
 static int
 xsk_configure(struct pmd_internals *internals, struct pkt_rx_queue *rxq,
 	      int ring_size)
@@ -874,7 +1130,9 @@ xsk_configure(struct pmd_internals *internals, struct pkt_rx_queue *rxq,
 	int reserve_size = ETH_AF_XDP_DFLT_NUM_DESCS;
 	struct rte_mbuf *fq_bufs[reserve_size];
 
+	pthread_mutex_lock(&internal_list_lock);
 	rxq->umem = xdp_umem_configure(internals, rxq);
+	pthread_mutex_unlock(&internal_list_lock);
 	if (rxq->umem == NULL)
 		return -ENOMEM;
 	txq->umem = rxq->umem;
@@ -889,21 +1147,71 @@ xsk_configure(struct pmd_internals *internals, struct pkt_rx_queue *rxq,
 	cfg.bind_flags |= XDP_USE_NEED_WAKEUP;
 #endif
 
-	ret = xsk_socket__create(&rxq->xsk, internals->if_name,
-			rxq->xsk_queue_idx, rxq->umem->umem, &rxq->rx,
-			&txq->tx, &cfg);
+	if (strnlen(internals->prog_path, PATH_MAX) &&
+				!internals->custom_prog_configured) {
+		ret = load_custom_xdp_prog(internals->prog_path,
+					   internals->if_index,
+					   &internals->map_fd,
+					   &internals->prog_obj);
+		if (ret) {
+			AF_XDP_LOG(ERR, "Failed to load custom XDP program %s\n",
+					internals->prog_path);
+			goto err;
+		}
+		internals->custom_prog_configured = 1;
+	}
+
+	if (internals->custom_prog_configured)
+		cfg.libbpf_flags |= XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD;
+
+#ifdef ETH_AF_XDP_SHARED_UMEM
+	/*
+	 * The fill and completion rings of the first xsk of a umem are the
+	 * ones created along with it, the following xsks get their own.
+	 */
+	if (internals->shared_umem)
+		ret = xsk_socket__create_shared(&rxq->xsk, internals->if_name,
+				rxq->xsk_queue_idx, rxq->umem->umem, &rxq->rx,
+				&txq->tx, &rxq->fq, &rxq->cq, &cfg);
+	else
+#endif
+		ret = xsk_socket__create(&rxq->xsk, internals->if_name,
+				rxq->xsk_queue_idx, rxq->umem->umem, &rxq->rx,
+				&txq->tx, &cfg);
 	if (ret) {
 		AF_XDP_LOG(ERR, "Failed to create xsk socket.\n");
 		goto err;
 	}
 
+	if (internals->custom_prog_configured) {
+		ret = update_xskmap(rxq->xsk, internals->map_fd,
+				    rxq->xsk_queue_idx);
+		if (ret) {
+			xsk_socket__delete(rxq->xsk);
+			goto err;
+		}
+	}
+
+#ifdef SO_PREFER_BUSY_POLL
+	if (rxq->busy_budget) {
+		ret = configure_preferred_busy_poll(rxq);
+		if (ret) {
+			AF_XDP_LOG(ERR, "Failed to configure busy polling.\n");
+			xsk_socket__delete(rxq->xsk);
+			goto err;
+		}
+	}
+#endif
+
 #if defined(XDP_UMEM_UNALIGNED_CHUNK_FLAG)
 	if (rte_pktmbuf_alloc_bulk(rxq->umem->mb_pool, fq_bufs, reserve_size)) {
 		AF_XDP_LOG(DEBUG, "Failed to get enough buffers for fq.\n");
+		xsk_socket__delete(rxq->xsk);
+		ret = -ENOMEM;
 		goto err;
 	}
 #endif
-	ret = reserve_fill_queue(rxq->umem, reserve_size, fq_bufs);
+	ret = reserve_fill_queue(rxq->umem, reserve_size, fq_bufs, &rxq->fq);
 	if (ret) {
 		xsk_socket__delete(rxq->xsk);
 		AF_XDP_LOG(ERR, "Failed to reserve fill queue.\n");
@@ -913,7 +1221,11 @@ xsk_configure(struct pmd_internals *internals, struct pkt_rx_queue *rxq,
 	return 0;
 
 err:
-	xdp_umem_destroy(rxq->umem);
+	pthread_mutex_lock(&internal_list_lock);
+	xdp_umem_release(rxq->umem);
+	pthread_mutex_unlock(&internal_list_lock);
+	rxq->umem = NULL;
+	txq->umem = NULL;
 
 	return ret;
 }
@@ -1082,6 +1394,30 @@ parse_integer_arg(const char *key __rte_unused,
 	return 0;
 }
 
+/** parse path of the custom XDP program */
+static int
+parse_prog_arg(const char *key __rte_unused,
+	       const char *value, void *extra_args)
+{
+	char *path = extra_args;
+
+	if (strnlen(value, PATH_MAX) == PATH_MAX) {
+		AF_XDP_LOG(ERR, "Invalid path %s, should be less than %u bytes.\n",
+			   value, PATH_MAX);
+		return -EINVAL;
+	}
+
+	if (access(value, F_OK) != 0) {
+		AF_XDP_LOG(ERR, "Error accessing %s: %s\n",
+			   value, strerror(errno));
+		return -EINVAL;
+	}
+
+	strlcpy(path, value, PATH_MAX);
+
+	return 0;
+}
+
 /** parse name argument */
 static int
 parse_name_arg(const char *key __rte_unused,
@@ -1143,7 +1479,8 @@ xdp_get_channels_info(const char *if_name, int *max_queues,
 
 static int
 parse_parameters(struct rte_kvargs *kvlist, char *if_name, int *start_queue,
-			int *queue_cnt)
+			int *queue_cnt, int *shared_umem, int *busy_budget,
+			char *prog_path)
 {
 	int ret;
 
@@ -1164,6 +1501,23 @@ parse_parameters(struct rte_kvargs *kvlist, char *if_name, int *start_queue,
 		goto free_kvlist;
 	}
 
+	ret = rte_kvargs_process(kvlist, ETH_AF_XDP_SHARED_UMEM_ARG,
+				 &parse_integer_arg, shared_umem);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, ETH_AF_XDP_BUSY_BUDGET_ARG,
+				 &parse_integer_arg, busy_budget);
+	if (ret < 0 || *busy_budget > UINT16_MAX) {
+		ret = -EINVAL;
+		goto free_kvlist;
+	}
+
+	ret = rte_kvargs_process(kvlist, ETH_AF_XDP_PROG_ARG,
+				 &parse_prog_arg, prog_path);
+	if (ret < 0)
+		goto free_kvlist;
+
 free_kvlist:
 	rte_kvargs_free(kvlist);
 	return ret;
@@ -1201,11 +1555,13 @@ get_iface_info(const char *if_name,
 
 static struct rte_eth_dev *
 init_internals(struct rte_vdev_device *dev, const char *if_name,
-			int start_queue_idx, int queue_cnt)
+			int start_queue_idx, int queue_cnt, int shared_umem,
+			int busy_budget, const char *prog_path)
 {
 	const char *name = rte_vdev_device_name(dev);
 	const unsigned int numa_node = dev->device.numa_node;
 	struct pmd_internals *internals;
+	struct internal_list *list;
 	struct rte_eth_dev *eth_dev;
 	int ret;
 	int i;
@@ -1217,6 +1573,29 @@ init_internals(struct rte_vdev_device *dev, const char *if_name,
 	internals->start_queue_idx = start_queue_idx;
 	internals->queue_cnt = queue_cnt;
 	strlcpy(internals->if_name, if_name, IFNAMSIZ);
+	strlcpy(internals->prog_path, prog_path, PATH_MAX);
+	internals->custom_prog_configured = 0;
+	internals->prog_obj = NULL;
+	internals->map_fd = -1;
+
+#if !defined(ETH_AF_XDP_SHARED_UMEM) || \
+	!defined(XDP_UMEM_UNALIGNED_CHUNK_FLAG)
+	if (shared_umem) {
+		AF_XDP_LOG(ERR, "Shared UMEM feature not available. "
+				"Check kernel and libbpf version\n");
+		goto err_free_internals;
+	}
+#endif
+	internals->shared_umem = shared_umem;
+
+#ifndef SO_PREFER_BUSY_POLL
+	if (busy_budget) {
+		AF_XDP_LOG(ERR, "Busy polling not available. "
+				"Check kernel headers version\n");
+		goto err_free_internals;
+	}
+#endif
+	internals->busy_budget = busy_budget;
 
 	if (xdp_get_channels_info(if_name, &internals->max_queue_cnt,
 				  &internals->combined_queue_cnt)) {
@@ -1251,6 +1630,7 @@ init_internals(struct rte_vdev_device *dev, const char *if_name,
 		internals->rx_queues[i].pair = &internals->tx_queues[i];
 		internals->rx_queues[i].xsk_queue_idx = start_queue_idx + i;
 		internals->tx_queues[i].xsk_queue_idx = start_queue_idx + i;
+		internals->rx_queues[i].busy_budget = busy_budget;
 	}
 
 	ret = get_iface_info(if_name, &internals->eth_addr,
@@ -1258,9 +1638,13 @@ init_internals(struct rte_vdev_device *dev, const char *if_name,
 	if (ret)
 		goto err_free_tx;
 
+	list = rte_zmalloc_socket(name, sizeof(*list), 0, numa_node);
+	if (list == NULL)
+		goto err_free_tx;
+
 	eth_dev = rte_eth_vdev_allocate(dev, 0);
 	if (eth_dev == NULL)
-		goto err_free_tx;
+		goto err_free_list;
 
 	eth_dev->data->dev_private = internals;
 	eth_dev->data->dev_link = pmd_link;
@@ -1275,8 +1659,15 @@ init_internals(struct rte_vdev_device *dev, const char *if_name,
 	AF_XDP_LOG(INFO, "Zero copy between umem and mbuf enabled.\n");
 #endif
 
+	list->eth_dev = eth_dev;
+	pthread_mutex_lock(&internal_list_lock);
+	TAILQ_INSERT_TAIL(&internal_list, list, next);
+	pthread_mutex_unlock(&internal_list_lock);
+
 	return eth_dev;
 
+err_free_list:
+	rte_free(list);
 err_free_tx:
 	rte_free(internals->tx_queues);
 err_free_rx:
@@ -1293,6 +1684,9 @@ rte_pmd_af_xdp_probe(struct rte_vdev_device *dev)
 	char if_name[IFNAMSIZ] = {'\0'};
 	int xsk_start_queue_idx = ETH_AF_XDP_DFLT_START_QUEUE_IDX;
 	int xsk_queue_cnt = ETH_AF_XDP_DFLT_QUEUE_COUNT;
+	int shared_umem = 0;
+	int busy_budget = -1;
+	char prog_path[PATH_MAX] = {'\0'};
 	struct rte_eth_dev *eth_dev = NULL;
 	const char *name;
 
@@ -1322,7 +1716,8 @@ rte_pmd_af_xdp_probe(struct rte_vdev_device *dev)
 		dev->device.numa_node = rte_socket_id();
 
 	if (parse_parameters(kvlist, if_name, &xsk_start_queue_idx,
-			     &xsk_queue_cnt) < 0) {
+			     &xsk_queue_cnt, &shared_umem, &busy_budget,
+			     prog_path) < 0) {
 		AF_XDP_LOG(ERR, "Invalid kvargs value\n");
 		return -EINVAL;
 	}
@@ -1332,8 +1727,12 @@ rte_pmd_af_xdp_probe(struct rte_vdev_device *dev)
 		return -EINVAL;
 	}
 
+	busy_budget = busy_budget == -1 ? ETH_AF_XDP_DFLT_BUSY_BUDGET :
+					busy_budget;
+
 	eth_dev = init_internals(dev, if_name, xsk_start_queue_idx,
-					xsk_queue_cnt);
+					xsk_queue_cnt, shared_umem, busy_budget,
+					prog_path);
 	if (eth_dev == NULL) {
 		AF_XDP_LOG(ERR, "Failed to init internals\n");
 		return -1;
@@ -1376,4 +1775,7 @@ RTE_PMD_REGISTER_VDEV(net_af_xdp, pmd_af_xdp_drv);
 RTE_PMD_REGISTER_PARAM_STRING(net_af_xdp,
 			      "iface=<string> "
 			      "start_queue=<int> "
-			      "queue_count=<int> ");
+			      "queue_count=<int> "
+			      "shared_umem=<int> "
+			      "busy_budget=<int> "
+			      "xdp_prog=<string> ");
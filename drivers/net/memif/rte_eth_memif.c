@@ -61,6 +61,11 @@ static const struct rte_eth_link pmd_link = {
 
 #define MEMIF_MP_SEND_REGION		"memif_mp_send_region"
 
+/* Number of mbufs allocated or freed at once in the data path */
+#define ETH_MEMIF_BULK_SIZE		32
+/* Packets copied with the inlined SIMD moves of rte_memcpy() */
+#define ETH_MEMIF_SMALL_COPY_LEN	256
+
 
 static int memif_region_init_zc(const struct rte_memseg_list *msl,
 				const struct rte_memseg *ms, void *arg);
@@ -245,21 +250,50 @@ memif_get_buffer(struct pmd_process_private *proc_private, memif_desc_t *d)
 	return ((uint8_t *)proc_private->regions[d->region]->addr + d->offset);
 }
 
+static __rte_always_inline void
+memif_copy(void *dst, const void *src, uint16_t len)
+{
+	/*
+	 * Small packets are copied with the SIMD moves inlined by
+	 * rte_memcpy(), saving the call and size dispatch of memcpy().
+	 */
+	if (len < ETH_MEMIF_SMALL_COPY_LEN)
+		rte_memcpy(dst, src, len);
+	else
+		memcpy(dst, src, len);
+}
+
 /* Free mbufs received by master */
 static void
 memif_free_stored_mbufs(struct pmd_process_private *proc_private, struct memif_queue *mq)
 {
 	uint16_t mask = (1 << mq->log2_ring_size) - 1;
 	memif_ring_t *ring = memif_get_ring_from_queue(proc_private, mq);
+	uint16_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	struct rte_mbuf *free[ETH_MEMIF_BULK_SIZE];
+	struct rte_mbuf *m;
+	unsigned int n = 0;
 
-	/* FIXME: improve performance */
-	while (mq->last_tail != ring->tail) {
+	/* The segments are put back to their mempool in bulk. */
+	while (mq->last_tail != tail) {
 		RTE_MBUF_PREFETCH_TO_FREE(mq->buffers[(mq->last_tail + 1) & mask]);
 		/* Decrement refcnt and free mbuf. (current segment) */
-		rte_mbuf_refcnt_update(mq->buffers[mq->last_tail & mask], -1);
-		rte_pktmbuf_free_seg(mq->buffers[mq->last_tail & mask]);
+		m = mq->buffers[mq->last_tail & mask];
+		rte_mbuf_refcnt_update(m, -1);
+		m = rte_pktmbuf_prefree_seg(m);
 		mq->last_tail++;
+		if (m == NULL)
+			continue;
+
+		if (n == ETH_MEMIF_BULK_SIZE ||
+		    (n != 0 && m->pool != free[0]->pool)) {
+			rte_mempool_put_bulk(free[0]->pool, (void **)free, n);
+			n = 0;
+		}
+		free[n++] = m;
 	}
+	if (n != 0)
+		rte_mempool_put_bulk(free[0]->pool, (void **)free, n);
 }
 
 static int
@@ -334,6 +368,56 @@ eth_memif_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		goto refill;
 	n_slots = last_slot - cur_slot;
 
+	/*
+	 * When a descriptor fits in an mbuf, the mbufs are allocated in bulk
+	 * and the next descriptors and packet data are prefetched. Chained
+	 * and oversized descriptors are left to the generic loop below.
+	 */
+	while (n_slots && n_rx_pkts < nb_pkts &&
+	       mbuf_size >= pmd->run.pkt_buffer_size) {
+		struct rte_mbuf *mbufs[ETH_MEMIF_BULK_SIZE];
+		uint16_t i, n_bulk;
+
+		n_bulk = RTE_MIN(n_slots, nb_pkts - n_rx_pkts);
+		n_bulk = RTE_MIN(n_bulk, ETH_MEMIF_BULK_SIZE);
+		if (unlikely(rte_pktmbuf_alloc_bulk(mq->mempool, mbufs,
+						    n_bulk) < 0))
+			break;
+
+		rte_prefetch0(&ring->desc[(cur_slot + 1) & mask]);
+		for (i = 0; i < n_bulk; i++) {
+			d0 = &ring->desc[cur_slot & mask];
+			cp_len = d0->length;
+			if (unlikely((d0->flags & MEMIF_DESC_FLAG_NEXT) ||
+				     cp_len > mbuf_size))
+				break;
+
+			if (i + 1 < n_bulk) {
+				rte_prefetch0(&ring->desc[(cur_slot + 2) & mask]);
+				rte_prefetch0(memif_get_buffer(proc_private,
+					&ring->desc[(cur_slot + 1) & mask]));
+			}
+
+			mbuf = mbufs[i];
+			mbuf->port = mq->in_port;
+			rte_pktmbuf_data_len(mbuf) = cp_len;
+			rte_pktmbuf_pkt_len(mbuf) = cp_len;
+			memif_copy(rte_pktmbuf_mtod(mbuf, void *),
+				   memif_get_buffer(proc_private, d0), cp_len);
+
+			mq->n_bytes += cp_len;
+			*bufs++ = mbuf;
+			n_rx_pkts++;
+			cur_slot++;
+			n_slots--;
+		}
+
+		if (i < n_bulk) {
+			rte_pktmbuf_free_bulk(&mbufs[i], n_bulk - i);
+			break;
+		}
+	}
+
 	while (n_slots && n_rx_pkts < nb_pkts) {
 		mbuf_head = rte_pktmbuf_alloc(mq->mempool);
 		if (unlikely(mbuf_head == NULL))
@@ -375,9 +459,9 @@ eth_memif_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			if (mbuf != mbuf_head)
 				rte_pktmbuf_pkt_len(mbuf_head) += cp_len;
 
-			memcpy(rte_pktmbuf_mtod_offset(mbuf, void *, dst_off),
-			       (uint8_t *)memif_get_buffer(proc_private, d0) + src_off,
-			       cp_len);
+			memif_copy(rte_pktmbuf_mtod_offset(mbuf, void *, dst_off),
+				   (uint8_t *)memif_get_buffer(proc_private, d0) + src_off,
+				   cp_len);
 
 			src_off += cp_len;
 			dst_off += cp_len;
@@ -396,8 +480,11 @@ eth_memif_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	}
 
 no_free_bufs:
+	/* Publish the consumed slots once per burst. */
 	if (type == MEMIF_RING_S2M) {
-		__atomic_store_n(&ring->tail, cur_slot, __ATOMIC_RELEASE);
+		if (cur_slot != mq->last_head)
+			__atomic_store_n(&ring->tail, cur_slot,
+					 __ATOMIC_RELEASE);
 		mq->last_head = cur_slot;
 	} else {
 		mq->last_tail = cur_slot;
@@ -407,6 +494,8 @@ eth_memif_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	if (type == MEMIF_RING_M2S) {
 		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
 		n_slots = ring_size - head + mq->last_tail;
+		if (n_slots == 0)
+			goto out;
 
 		while (n_slots--) {
 			s0 = head++ & mask;
@@ -416,6 +505,8 @@ eth_memif_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
 	}
 
+out:
+
 	mq->n_pkts += n_rx_pkts;
 	return n_rx_pkts;
 }
@@ -455,7 +546,7 @@ eth_memif_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	mask = ring_size - 1;
 
 	cur_slot = mq->last_tail;
-	last_slot = ring->tail;
+	last_slot = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
 	if (cur_slot == last_slot)
 		goto refill;
 	n_slots = last_slot - cur_slot;
@@ -472,6 +563,10 @@ eth_memif_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		if (n_rx_pkts + 1 < nb_pkts)
 			rte_prefetch0(&ring->desc[(cur_slot + 1) & mask]);
 
+		/* and the mbuf of the one after */
+		if (n_slots > 1)
+			rte_prefetch0(mq->buffers[(cur_slot + 1) & mask]);
+
 		mbuf->port = mq->in_port;
 		rte_pktmbuf_data_len(mbuf) = d0->length;
 		rte_pktmbuf_pkt_len(mbuf) = rte_pktmbuf_data_len(mbuf);
@@ -504,30 +599,42 @@ eth_memif_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	head = ring->head;
 	n_slots = ring_size - head + mq->last_tail;
 
-	if (n_slots < 32)
-		goto no_free_mbufs;
-
-	ret = rte_pktmbuf_alloc_bulk(mq->mempool, &mq->buffers[head & mask], n_slots);
-	if (unlikely(ret < 0))
+	if (n_slots < ETH_MEMIF_BULK_SIZE)
 		goto no_free_mbufs;
 
-	while (n_slots--) {
-		s0 = head++ & mask;
-		if (n_slots > 0)
-			rte_prefetch0(mq->buffers[head & mask]);
-		d0 = &ring->desc[s0];
-		/* store buffer header */
-		mbuf = mq->buffers[s0];
-		/* populate descriptor */
-		d0->length = rte_pktmbuf_data_room_size(mq->mempool) -
+	/*
+	 * Allocate in bulk, without wrapping around the end of the buffers
+	 * array, whose slots match the ring's.
+	 */
+	while (n_slots) {
+		uint16_t n_bulk = RTE_MIN(n_slots,
+					  ring_size - (head & mask));
+		uint16_t data_room = rte_pktmbuf_data_room_size(mq->mempool) -
 				RTE_PKTMBUF_HEADROOM;
-		d0->region = 1;
-		d0->offset = rte_pktmbuf_mtod(mbuf, uint8_t *) -
-			(uint8_t *)proc_private->regions[d0->region]->addr;
+		uint8_t *region_addr = proc_private->regions[1]->addr;
+
+		ret = rte_pktmbuf_alloc_bulk(mq->mempool,
+					     &mq->buffers[head & mask], n_bulk);
+		if (unlikely(ret < 0))
+			break;
+
+		n_slots -= n_bulk;
+		while (n_bulk--) {
+			s0 = head++ & mask;
+			if (n_bulk > 0)
+				rte_prefetch0(mq->buffers[head & mask]);
+			d0 = &ring->desc[s0];
+			/* store buffer header */
+			mbuf = mq->buffers[s0];
+			/* populate descriptor */
+			d0->length = data_room;
+			d0->region = 1;
+			d0->offset = rte_pktmbuf_mtod(mbuf, uint8_t *) -
+				region_addr;
+		}
 	}
 no_free_mbufs:
-	rte_mb();
-	ring->head = head;
+	__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
 
 	mq->n_pkts += n_rx_pkts;
 
@@ -582,6 +689,8 @@ eth_memif_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	while (n_tx_pkts < nb_pkts && n_free) {
 		mbuf_head = *bufs++;
 		mbuf = mbuf_head;
+		if (n_tx_pkts + 1 < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(*bufs, void *));
 
 		saved_slot = slot;
 		d0 = &ring->desc[slot & mask];
@@ -611,9 +720,9 @@ eth_memif_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			}
 			cp_len = RTE_MIN(dst_len, src_len);
 
-			memcpy((uint8_t *)memif_get_buffer(proc_private, d0) + dst_off,
-			       rte_pktmbuf_mtod_offset(mbuf, void *, src_off),
-			       cp_len);
+			memif_copy((uint8_t *)memif_get_buffer(proc_private, d0) + dst_off,
+				   rte_pktmbuf_mtod_offset(mbuf, void *, src_off),
+				   cp_len);
 
 			mq->n_bytes += cp_len;
 			src_off += cp_len;
@@ -636,6 +745,10 @@ eth_memif_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	}
 
 no_free_slots:
+	/* Publish the slots and notify the peer once per burst. */
+	if (n_tx_pkts == 0)
+		return 0;
+
 	if (type == MEMIF_RING_S2M)
 		__atomic_store_n(&ring->head, slot, __ATOMIC_RELEASE);
 	else
@@ -724,7 +837,7 @@ eth_memif_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	/* ring type always MEMIF_RING_S2M */
 	slot = ring->head;
-	n_free = ring_size - ring->head + mq->last_tail;
+	n_free = ring_size - slot + mq->last_tail;
 
 	int used_slots;
 
@@ -778,12 +891,14 @@ eth_memif_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	}
 
 no_free_slots:
-	rte_mb();
-	/* update ring pointers */
+	if (n_tx_pkts == 0)
+		return 0;
+
+	/* update ring pointers, once per burst */
 	if (type == MEMIF_RING_S2M)
-		ring->head = slot;
+		__atomic_store_n(&ring->head, slot, __ATOMIC_RELEASE);
 	else
-		ring->tail = slot;
+		__atomic_store_n(&ring->tail, slot, __ATOMIC_RELEASE);
 
 	/* Send interrupt, if enabled. */
 	if ((ring->flags & MEMIF_RING_FLAG_MASK_INT) == 0) {
@@ -4,6 +4,8 @@
  * All rights reserved.
  */
 
+#include <errno.h>
+#include <stdlib.h>
 #include <time.h>
 
 #include <net/if.h>
@@ -19,11 +21,14 @@
 #include <pcap.h>
 
 #include <rte_cycles.h>
+#include <rte_ether.h>
 #include <rte_ethdev_driver.h>
 #include <rte_ethdev_vdev.h>
+#include <rte_ip.h>
 #include <rte_kvargs.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
+#include <rte_memory.h>
 #include <rte_bus_vdev.h>
 #include <rte_string_fns.h>
 
@@ -40,11 +45,24 @@
 #define ETH_PCAP_IFACE_ARG    "iface"
 #define ETH_PCAP_PHY_MAC_ARG  "phy_mac"
 #define ETH_PCAP_INFINITE_RX_ARG  "infinite_rx"
+#define ETH_PCAP_REPLAY_ARG       "replay"
+#define ETH_PCAP_REPLAY_LOOP_ARG  "replay_loop"
+#define ETH_PCAP_REPLAY_PPS_ARG   "replay_pps"
+#define ETH_PCAP_REPLAY_BPS_ARG   "replay_bps"
+#define ETH_PCAP_REPLAY_TIMING_ARG "replay_timing"
+#define ETH_PCAP_REPLAY_QUEUES_ARG "replay_queues"
 
 #define ETH_PCAP_ARG_MAXLEN	64
 
 #define RTE_PMD_PCAP_MAX_QUEUES 16
 
+/* preamble, start of frame delimiter, inter frame gap and CRC */
+#define RTE_ETH_PCAP_WIRE_OVERHEAD 24
+/* fractional bits of the replay delays, in TSC cycles */
+#define RTE_ETH_PCAP_REPLAY_FRAC_SHIFT 16
+#define RTE_ETH_PCAP_REPLAY_FRAC_MASK \
+	((UINT64_C(1) << RTE_ETH_PCAP_REPLAY_FRAC_SHIFT) - 1)
+
 static char errbuf[PCAP_ERRBUF_SIZE];
 static struct timeval start_time;
 static uint64_t start_cycles;
@@ -67,6 +85,39 @@ struct pcap_rx_queue {
 
 	/* Contains pre-generated packets to be looped through */
 	struct rte_ring *pkts;
+
+	/* Replay mode: the packets of the queue, preloaded in hugepages */
+	struct pcap_replay_pkt *replay_pkts;
+	uint32_t replay_nb_pkts;
+	uint32_t replay_pos;
+	int replay_loop;
+	int replay_started;
+	/* TSC at which the packet at replay_pos is due, and its fraction */
+	uint64_t replay_next_tsc;
+	uint64_t replay_next_frac;
+	/* wait before the first packet, in original timing mode */
+	uint64_t replay_start_delay;
+};
+
+/* A packet of a replayed file, attached to the mbufs it is received in */
+struct pcap_replay_pkt {
+	struct rte_mbuf_ext_shared_info shinfo;
+	void *data;
+	rte_iova_t iova;
+	uint64_t timestamp;
+	/* TSC cycles to wait after it, in fixed point */
+	uint64_t delay;
+	uint16_t len;
+};
+
+/* Replay settings of a port */
+struct pcap_replay_conf {
+	uint64_t enabled;
+	uint64_t loop;
+	uint64_t pps;
+	uint64_t bps;
+	uint64_t timing;
+	uint64_t nb_queues;
 };
 
 struct pcap_tx_queue {
@@ -86,6 +137,9 @@ struct pmd_internals {
 	int single_iface;
 	int phy_mac;
 	unsigned int infinite_rx;
+	unsigned int replay;
+	/* data of the replayed packets, one area per file */
+	void *replay_data[RTE_PMD_PCAP_MAX_QUEUES];
 };
 
 struct pmd_process_private {
@@ -114,6 +168,7 @@ struct pmd_devargs_all {
 	unsigned int is_rx_pcap;
 	unsigned int is_rx_iface;
 	unsigned int infinite_rx;
+	struct pcap_replay_conf replay;
 };
 
 static const char *valid_arguments[] = {
@@ -125,6 +180,12 @@ static const char *valid_arguments[] = {
 	ETH_PCAP_IFACE_ARG,
 	ETH_PCAP_PHY_MAC_ARG,
 	ETH_PCAP_INFINITE_RX_ARG,
+	ETH_PCAP_REPLAY_ARG,
+	ETH_PCAP_REPLAY_LOOP_ARG,
+	ETH_PCAP_REPLAY_PPS_ARG,
+	ETH_PCAP_REPLAY_BPS_ARG,
+	ETH_PCAP_REPLAY_TIMING_ARG,
+	ETH_PCAP_REPLAY_QUEUES_ARG,
 	NULL
 };
 
@@ -279,6 +340,82 @@ eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_rx;
 }
 
+/*
+ * Receives the preloaded packets which are due, attached to the mbufs
+ * as external buffers: the packet data is never copied.
+ */
+static uint16_t
+eth_pcap_rx_replay(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pcap_rx_queue *pcap_q = queue;
+	struct pcap_replay_pkt *pkts = pcap_q->replay_pkts;
+	const uint32_t nb_replay = pcap_q->replay_nb_pkts;
+	uint64_t next_tsc = pcap_q->replay_next_tsc;
+	uint64_t next_frac = pcap_q->replay_next_frac;
+	uint32_t pos = pcap_q->replay_pos;
+	struct pcap_replay_pkt *pkt;
+	struct rte_mbuf *mbuf;
+	uint32_t rx_bytes = 0;
+	uint16_t i, num_rx;
+	uint64_t now;
+
+	if (unlikely(nb_pkts == 0 || nb_replay == 0))
+		return 0;
+
+	now = rte_rdtsc();
+	if (unlikely(!pcap_q->replay_started)) {
+		next_tsc = now + pcap_q->replay_start_delay;
+		next_frac = 0;
+		pcap_q->replay_started = 1;
+	}
+
+	/* Count the packets due, moving the pacing state along. */
+	for (num_rx = 0; num_rx < nb_pkts; num_rx++) {
+		if (unlikely(pos == nb_replay)) {
+			if (!pcap_q->replay_loop)
+				break;
+			pos = 0;
+		}
+		if (next_tsc > now)
+			break;
+
+		next_frac += pkts[pos].delay;
+		next_tsc += next_frac >> RTE_ETH_PCAP_REPLAY_FRAC_SHIFT;
+		next_frac &= RTE_ETH_PCAP_REPLAY_FRAC_MASK;
+		pos++;
+	}
+
+	if (num_rx == 0 ||
+	    rte_pktmbuf_alloc_bulk(pcap_q->mb_pool, bufs, num_rx) != 0)
+		return 0;
+
+	pos = pcap_q->replay_pos;
+	for (i = 0; i < num_rx; i++) {
+		if (pos == nb_replay)
+			pos = 0;
+		pkt = &pkts[pos++];
+		mbuf = bufs[i];
+
+		rte_mbuf_ext_refcnt_update(&pkt->shinfo, 1);
+		rte_pktmbuf_attach_extbuf(mbuf, pkt->data, pkt->iova, pkt->len,
+				&pkt->shinfo);
+		mbuf->data_len = pkt->len;
+		mbuf->pkt_len = pkt->len;
+		mbuf->timestamp = pkt->timestamp;
+		mbuf->ol_flags |= PKT_RX_TIMESTAMP;
+		mbuf->port = pcap_q->port_id;
+		rx_bytes += pkt->len;
+	}
+
+	pcap_q->replay_pos = pos;
+	pcap_q->replay_next_tsc = next_tsc;
+	pcap_q->replay_next_frac = next_frac;
+	pcap_q->rx_stat.pkts += num_rx;
+	pcap_q->rx_stat.bytes += rx_bytes;
+
+	return num_rx;
+}
+
 static uint16_t
 eth_null_rx(void *queue __rte_unused,
 		struct rte_mbuf **bufs __rte_unused,
@@ -534,6 +671,313 @@ count_packets_in_pcap(pcap_t **pcap, struct pcap_rx_queue *pcap_q)
 	return pcap_pkt_count;
 }
 
+static void
+pcap_replay_buf_free(void *addr __rte_unused, void *opaque __rte_unused)
+{
+	/* The replayed packets stay in memory until the port is closed. */
+}
+
+/*
+ * Symmetric hash of the addresses and ports of a packet, so that both
+ * directions of a flow are replayed on the same queue.
+ */
+static uint32_t
+pcap_replay_flow_hash(const u_char *data, uint32_t len)
+{
+	const struct rte_ether_hdr *eth = (const void *)data;
+	const struct rte_vlan_hdr *vlan;
+	const struct rte_ipv4_hdr *ip4;
+	const struct rte_ipv6_hdr *ip6;
+	const uint16_t *ports = NULL;
+	uint32_t off = sizeof(*eth);
+	uint32_t hash = 0;
+	uint16_t proto;
+	uint8_t l4_proto;
+	unsigned int i;
+
+	if (len < off)
+		return 0;
+	proto = eth->ether_type;
+
+	while (proto == RTE_BE16(RTE_ETHER_TYPE_VLAN) ||
+			proto == RTE_BE16(RTE_ETHER_TYPE_QINQ)) {
+		if (len < off + sizeof(*vlan))
+			return 0;
+		vlan = (const void *)(data + off);
+		proto = vlan->eth_proto;
+		off += sizeof(*vlan);
+	}
+
+	if (proto == RTE_BE16(RTE_ETHER_TYPE_IPV4)) {
+		if (len < off + sizeof(*ip4))
+			return 0;
+		ip4 = (const void *)(data + off);
+		hash = ip4->src_addr ^ ip4->dst_addr;
+		l4_proto = ip4->next_proto_id;
+		off += (ip4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+				RTE_IPV4_IHL_MULTIPLIER;
+		/* only the first fragment has the ports */
+		if (ip4->fragment_offset &
+				RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK))
+			l4_proto = 0;
+	} else if (proto == RTE_BE16(RTE_ETHER_TYPE_IPV6)) {
+		const uint32_t *src, *dst;
+
+		if (len < off + sizeof(*ip6))
+			return 0;
+		ip6 = (const void *)(data + off);
+		src = (const void *)ip6->src_addr;
+		dst = (const void *)ip6->dst_addr;
+		for (i = 0; i < 4; i++)
+			hash ^= src[i] ^ dst[i];
+		l4_proto = ip6->proto;
+		off += sizeof(*ip6);
+	} else {
+		return 0;
+	}
+
+	if ((l4_proto == IPPROTO_TCP || l4_proto == IPPROTO_UDP ||
+			l4_proto == IPPROTO_SCTP) && len >= off + 4) {
+		ports = (const void *)(data + off);
+		hash ^= ports[0] ^ ports[1];
+	}
+	hash ^= l4_proto;
+
+	/* mix the bits, the queue is taken modulo */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+static int
+pcap_replay_open(const char *pcap_filename, pcap_t **pcap)
+{
+	*pcap = pcap_open_offline_with_tstamp_precision(pcap_filename,
+			PCAP_TSTAMP_PRECISION_NANO, errbuf);
+	if (*pcap == NULL) {
+		PMD_LOG(ERR, "Couldn't open %s: %s", pcap_filename, errbuf);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Timestamp in nanoseconds, the file being open with that precision */
+static inline uint64_t
+pcap_replay_ns(const struct pcap_pkthdr *header)
+{
+	return (uint64_t)header->ts.tv_sec * NSEC_PER_SEC + header->ts.tv_usec;
+}
+
+/* Converts a duration to TSC cycles, with fractional bits */
+static inline uint64_t
+pcap_replay_delay(double seconds)
+{
+	return seconds * rte_get_tsc_hz() *
+			(1 << RTE_ETH_PCAP_REPLAY_FRAC_SHIFT);
+}
+
+static inline uint64_t
+pcap_replay_ns_delay(uint64_t from, uint64_t to)
+{
+	if (to <= from)
+		return 0;
+	return pcap_replay_delay((double)(to - from) / NSEC_PER_SEC);
+}
+
+/*
+ * Preloads the packets of a pcap file in hugepage memory, spreading them
+ * over the queues [first_q, first_q + nb_q) of the port by flow, and sets
+ * the pacing of each packet from the replay configuration.
+ */
+static int
+pcap_replay_load(struct pmd_internals *internals, const char *pcap_filename,
+		unsigned int first_q, unsigned int nb_q, unsigned int nb_rxq,
+		const struct pcap_replay_conf *conf, int socket_id)
+{
+	uint32_t count[RTE_PMD_PCAP_MAX_QUEUES] = {0};
+	uint32_t idx[RTE_PMD_PCAP_MAX_QUEUES] = {0};
+	uint64_t first_ns[RTE_PMD_PCAP_MAX_QUEUES];
+	uint64_t last_ns[RTE_PMD_PCAP_MAX_QUEUES];
+	uint64_t file_first_ns = 0, file_last_ns = 0;
+	uint64_t bytes = 0, size, off, pps_delay = 0;
+	uint32_t max_len = 0, nb_pkts = 0, nb_loaded = 0, skipped = 0;
+	struct pcap_replay_pkt *pkt;
+	struct pcap_rx_queue *rx;
+	struct pcap_pkthdr header;
+	const u_char *packet;
+	unsigned int i, q;
+	pcap_t *pcap;
+	void *data;
+
+	/* First pass: size the queues and the data area. */
+	if (pcap_replay_open(pcap_filename, &pcap) < 0)
+		return -1;
+
+	while ((packet = pcap_next(pcap, &header))) {
+		if (header.caplen == 0 || header.caplen > UINT16_MAX) {
+			skipped++;
+			continue;
+		}
+		q = nb_q > 1 ?
+			pcap_replay_flow_hash(packet, header.caplen) % nb_q : 0;
+		count[q]++;
+		bytes += RTE_ALIGN_CEIL(header.caplen, RTE_CACHE_LINE_SIZE);
+		max_len = RTE_MAX(max_len, header.caplen);
+		nb_pkts++;
+	}
+	pcap_close(pcap);
+
+	if (nb_pkts == 0) {
+		PMD_LOG(ERR, "No packet to replay in %s", pcap_filename);
+		return -1;
+	}
+	if (skipped)
+		PMD_LOG(WARNING, "%u packets of %s cannot be replayed",
+				skipped, pcap_filename);
+
+	/*
+	 * With physical addresses, a packet must not cross a page boundary
+	 * unless the pages are contiguous: leave room to skip to the next
+	 * page as many times as there are pages.
+	 */
+	size = bytes + (bytes / RTE_PGSIZE_2M + 1) *
+			RTE_ALIGN_CEIL(max_len, RTE_CACHE_LINE_SIZE);
+	data = rte_malloc_socket("pcap_replay", size, RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (data == NULL) {
+		PMD_LOG(ERR, "Couldn't allocate %" PRIu64 " bytes to preload %s",
+				size, pcap_filename);
+		return -1;
+	}
+	internals->replay_data[first_q] = data;
+
+	for (q = 0; q < nb_q; q++) {
+		rx = &internals->rx_queue[first_q + q];
+		rx->replay_pkts = rte_zmalloc_socket("pcap_replay_pkts",
+				sizeof(*rx->replay_pkts) * count[q],
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (rx->replay_pkts == NULL && count[q] != 0) {
+			PMD_LOG(ERR, "Couldn't allocate the replay queue %u",
+					first_q + q);
+			return -1;
+		}
+		rx->replay_nb_pkts = count[q];
+		rx->replay_loop = conf->loop;
+	}
+
+	if (conf->pps)
+		pps_delay = pcap_replay_delay((double)nb_rxq / conf->pps);
+
+	/* Second pass: copy the packets. */
+	if (pcap_replay_open(pcap_filename, &pcap) < 0)
+		return -1;
+
+	off = 0;
+	while ((packet = pcap_next(pcap, &header))) {
+		uint64_t ns = pcap_replay_ns(&header);
+		uint32_t len = header.caplen;
+		void *addr;
+
+		if (len == 0 || len > UINT16_MAX)
+			continue;
+		q = nb_q > 1 ? pcap_replay_flow_hash(packet, len) % nb_q : 0;
+		rx = &internals->rx_queue[first_q + q];
+
+		addr = RTE_PTR_ADD(data, off);
+		if (rte_malloc_virt2iova(RTE_PTR_ADD(addr, len - 1)) !=
+				rte_malloc_virt2iova(addr) + len - 1) {
+			const struct rte_memseg *ms;
+
+			ms = rte_mem_virt2memseg(addr, NULL);
+			addr = RTE_PTR_ALIGN_CEIL(RTE_PTR_ADD(addr, 1),
+					ms->hugepage_sz);
+			off = RTE_PTR_DIFF(addr, data);
+		}
+		if (off + len > size) {
+			PMD_LOG(ERR, "Couldn't preload %s: memory too fragmented",
+					pcap_filename);
+			pcap_close(pcap);
+			return -1;
+		}
+		rte_memcpy(addr, packet, len);
+		off += RTE_ALIGN_CEIL(len, RTE_CACHE_LINE_SIZE);
+
+		pkt = &rx->replay_pkts[idx[q]];
+		pkt->shinfo.free_cb = pcap_replay_buf_free;
+		pkt->shinfo.fcb_opaque = NULL;
+		/* never dropped to 0 by the mbufs, which would free it */
+		rte_mbuf_ext_refcnt_set(&pkt->shinfo, 1);
+		pkt->data = addr;
+		pkt->iova = rte_malloc_virt2iova(addr);
+		pkt->len = len;
+		pkt->timestamp = (uint64_t)header.ts.tv_sec * 1000000
+				+ header.ts.tv_usec / 1000;
+
+		if (conf->pps)
+			pkt->delay = pps_delay;
+		else if (conf->bps)
+			pkt->delay = pcap_replay_delay((double)nb_rxq *
+					(len + RTE_ETH_PCAP_WIRE_OVERHEAD) * 8 /
+					conf->bps);
+		else if (conf->timing && idx[q] != 0)
+			/* the gap after the previous packet of the queue */
+			rx->replay_pkts[idx[q] - 1].delay =
+				pcap_replay_ns_delay(last_ns[q], ns);
+
+		if (idx[q] == 0)
+			first_ns[q] = ns;
+		last_ns[q] = ns;
+		if (nb_loaded++ == 0)
+			file_first_ns = ns;
+		file_last_ns = ns;
+		idx[q]++;
+	}
+	pcap_close(pcap);
+
+	if (conf->timing) {
+		for (q = 0; q < nb_q; q++) {
+			rx = &internals->rx_queue[first_q + q];
+			if (count[q] == 0)
+				continue;
+			/*
+			 * Each queue waits for its first packet as long as in
+			 * the file, and loops back in step with the file.
+			 */
+			rx->replay_start_delay = pcap_replay_ns_delay(
+					file_first_ns, first_ns[q]) >>
+					RTE_ETH_PCAP_REPLAY_FRAC_SHIFT;
+			rx->replay_pkts[count[q] - 1].delay =
+				pcap_replay_ns_delay(last_ns[q], file_last_ns) +
+				pcap_replay_ns_delay(file_first_ns, first_ns[q]);
+		}
+	}
+
+	for (i = 0; i < nb_q; i++)
+		PMD_LOG(INFO, "Replaying %u packets of %s on queue %u",
+				count[i], pcap_filename, first_q + i);
+
+	return 0;
+}
+
+static void
+pcap_replay_free(struct pmd_internals *internals)
+{
+	unsigned int i;
+
+	for (i = 0; i < RTE_PMD_PCAP_MAX_QUEUES; i++) {
+		rte_free(internals->rx_queue[i].replay_pkts);
+		internals->rx_queue[i].replay_pkts = NULL;
+		internals->rx_queue[i].replay_nb_pkts = 0;
+		rte_free(internals->replay_data[i]);
+		internals->replay_data[i] = NULL;
+	}
+}
+
 static int
 eth_dev_start(struct rte_eth_dev *dev)
 {
@@ -578,6 +1022,13 @@ eth_dev_start(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
 		rx = &internals->rx_queue[i];
 
+		/* The replayed packets are already in memory. */
+		if (internals->replay) {
+			rx->replay_pos = 0;
+			rx->replay_started = 0;
+			continue;
+		}
+
 		if (pp->rx_pcap[i] != NULL)
 			continue;
 
@@ -748,6 +1199,8 @@ eth_dev_close(struct rte_eth_dev *dev)
 		}
 	}
 
+	if (internals->replay && rte_eal_process_type() == RTE_PROC_PRIMARY)
+		pcap_replay_free(internals);
 }
 
 static void
@@ -778,6 +1231,18 @@ eth_rx_queue_setup(struct rte_eth_dev *dev,
 	pcap_q->queue_id = rx_queue_id;
 	dev->data->rx_queues[rx_queue_id] = pcap_q;
 
+	/*
+	 * Each mbuf holding a replayed packet takes a reference on it, which
+	 * must not overflow when the whole pool holds the queue's packets.
+	 */
+	if (internals->replay && pcap_q->replay_nb_pkts != 0 &&
+			mb_pool->size / pcap_q->replay_nb_pkts + 1 >=
+			UINT16_MAX) {
+		PMD_LOG(ERR, "Mempool too large to replay %u packets on queue %"
+				PRIu16, pcap_q->replay_nb_pkts, rx_queue_id);
+		return -EINVAL;
+	}
+
 	if (internals->infinite_rx) {
 		struct pmd_process_private *pp;
 		char ring_name[NAME_MAX];
@@ -1082,6 +1547,72 @@ get_infinite_rx_arg(const char *key __rte_unused,
 	return 0;
 }
 
+static int
+get_replay_arg(const char *key, const char *value, void *extra_args)
+{
+	uint64_t *arg = extra_args;
+	char *end;
+
+	errno = 0;
+	*arg = strtoull(value, &end, 10);
+	if (errno != 0 || end == value || *end != '\0') {
+		PMD_LOG(ERR, "Invalid value %s for %s", value, key);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+parse_replay_args(struct rte_kvargs *kvlist, struct pcap_replay_conf *conf)
+{
+	static const char * const keys[] = {
+		ETH_PCAP_REPLAY_ARG,
+		ETH_PCAP_REPLAY_LOOP_ARG,
+		ETH_PCAP_REPLAY_PPS_ARG,
+		ETH_PCAP_REPLAY_BPS_ARG,
+		ETH_PCAP_REPLAY_TIMING_ARG,
+		ETH_PCAP_REPLAY_QUEUES_ARG,
+	};
+	uint64_t *args[] = {
+		&conf->enabled,
+		&conf->loop,
+		&conf->pps,
+		&conf->bps,
+		&conf->timing,
+		&conf->nb_queues,
+	};
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(keys); i++) {
+		if (rte_kvargs_count(kvlist, keys[i]) > 1) {
+			PMD_LOG(ERR, "%s has been provided more than once",
+					keys[i]);
+			return -1;
+		}
+		if (rte_kvargs_process(kvlist, keys[i], &get_replay_arg,
+				args[i]) < 0)
+			return -1;
+	}
+
+	if (!conf->enabled)
+		return 0;
+
+	if (!!conf->pps + !!conf->bps + !!conf->timing > 1) {
+		PMD_LOG(ERR, "Only one of %s, %s and %s can be set",
+				ETH_PCAP_REPLAY_PPS_ARG, ETH_PCAP_REPLAY_BPS_ARG,
+				ETH_PCAP_REPLAY_TIMING_ARG);
+		return -1;
+	}
+	if (conf->nb_queues == 0 ||
+			conf->nb_queues > RTE_PMD_PCAP_MAX_QUEUES) {
+		PMD_LOG(ERR, "%s must be between 1 and %d",
+				ETH_PCAP_REPLAY_QUEUES_ARG,
+				RTE_PMD_PCAP_MAX_QUEUES);
+		return -1;
+	}
+	return 0;
+}
+
 static int
 pmd_init_internals(struct rte_vdev_device *vdev,
 		const unsigned int nb_rx_queues,
@@ -1291,6 +1822,40 @@ eth_from_pcaps(struct rte_vdev_device *vdev,
 	/* store weather we are using a single interface for rx/tx or not */
 	internals->single_iface = single_iface;
 
+	if (devargs_all->replay.enabled) {
+		struct pmd_process_private *pp = eth_dev->process_private;
+		const unsigned int nb_rxq = rx_queues->num_of_queue;
+		/* a single file split over the queues, or a file per queue */
+		const unsigned int nb_q = devargs_all->replay.nb_queues;
+		unsigned int i;
+
+		internals->replay = 1;
+		for (i = 0; i < nb_rxq; i += nb_q) {
+			ret = pcap_replay_load(internals,
+					rx_queues->queue[i].name, i, nb_q,
+					nb_rxq, &devargs_all->replay,
+					vdev->device.numa_node);
+			if (ret < 0)
+				break;
+		}
+
+		for (i = 0; i < nb_rxq; i++) {
+			if (pp->rx_pcap[i] != NULL)
+				pcap_close(pp->rx_pcap[i]);
+			pp->rx_pcap[i] = NULL;
+		}
+
+		if (ret < 0) {
+			pcap_replay_free(internals);
+			rte_free(pp);
+			eth_dev->process_private = NULL;
+			/* not dynamically allocated, must not be freed */
+			eth_dev->data->mac_addrs = NULL;
+			rte_eth_dev_release_port(eth_dev);
+			return ret;
+		}
+	}
+
 	if (single_iface) {
 		internals->if_index = if_nametoindex(rx_queues->queue[0].name);
 
@@ -1305,7 +1870,9 @@ eth_from_pcaps(struct rte_vdev_device *vdev,
 
 	internals->infinite_rx = infinite_rx;
 	/* Assign rx ops. */
-	if (infinite_rx)
+	if (internals->replay)
+		eth_dev->rx_pkt_burst = eth_pcap_rx_replay;
+	else if (infinite_rx)
 		eth_dev->rx_pkt_burst = eth_pcap_rx_infinite;
 	else if (devargs_all->is_rx_pcap || devargs_all->is_rx_iface ||
 			single_iface)
@@ -1341,6 +1908,10 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 		.is_tx_pcap = 0,
 		.is_tx_iface = 0,
 		.infinite_rx = 0,
+		.replay = {
+			.loop = 1,
+			.nb_queues = 1,
+		},
 	};
 
 	name = rte_vdev_device_name(dev);
@@ -1436,8 +2007,36 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 					"for %s", name);
 		}
 
+		ret = parse_replay_args(kvlist, &devargs_all.replay);
+		if (ret < 0)
+			goto free_kvlist;
+
+		if (devargs_all.replay.enabled && devargs_all.infinite_rx) {
+			PMD_LOG(ERR, "replay and infinite_rx cannot be both "
+					"enabled for %s", name);
+			ret = -EINVAL;
+			goto free_kvlist;
+		}
+
 		ret = rte_kvargs_process(kvlist, ETH_PCAP_RX_PCAP_ARG,
 				&open_rx_pcap, &pcaps);
+
+		/* Add the queues the single file is split over. */
+		if (ret == 0 && devargs_all.replay.enabled &&
+				devargs_all.replay.nb_queues > 1) {
+			unsigned int i;
+
+			if (pcaps.num_of_queue != 1) {
+				PMD_LOG(ERR, "%s needs a single %s for %s",
+						ETH_PCAP_REPLAY_QUEUES_ARG,
+						ETH_PCAP_RX_PCAP_ARG, name);
+				ret = -EINVAL;
+			}
+			for (i = 1; ret == 0 &&
+					i < devargs_all.replay.nb_queues; i++)
+				ret = add_queue(&pcaps, pcaps.queue[0].name,
+						pcaps.queue[0].type, NULL, NULL);
+		}
 	} else if (devargs_all.is_rx_iface) {
 		ret = rte_kvargs_process(kvlist, NULL,
 				&rx_iface_args_process, &pcaps);
@@ -1519,7 +2118,10 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 		}
 
 		eth_dev->process_private = pp;
-		eth_dev->rx_pkt_burst = eth_pcap_rx;
+		if (internal->replay)
+			eth_dev->rx_pkt_burst = eth_pcap_rx_replay;
+		else
+			eth_dev->rx_pkt_burst = eth_pcap_rx;
 		if (devargs_all.is_tx_pcap)
 			eth_dev->tx_pkt_burst = eth_pcap_tx_dumper;
 		else
@@ -1587,4 +2189,10 @@ RTE_PMD_REGISTER_PARAM_STRING(net_pcap,
 	ETH_PCAP_TX_IFACE_ARG "=<ifc> "
 	ETH_PCAP_IFACE_ARG "=<ifc> "
 	ETH_PCAP_PHY_MAC_ARG "=<int>"
-	ETH_PCAP_INFINITE_RX_ARG "=<0|1>");
+	ETH_PCAP_INFINITE_RX_ARG "=<0|1> "
+	ETH_PCAP_REPLAY_ARG "=<0|1> "
+	ETH_PCAP_REPLAY_LOOP_ARG "=<0|1> "
+	ETH_PCAP_REPLAY_PPS_ARG "=<int> "
+	ETH_PCAP_REPLAY_BPS_ARG "=<int> "
+	ETH_PCAP_REPLAY_TIMING_ARG "=<0|1> "
+	ETH_PCAP_REPLAY_QUEUES_ARG "=<int>");
@@ -70,6 +70,9 @@
 
 #define TAP_IOV_DEFAULT_MAX 1024
 
+/* Largest TCP aggregate the kernel passes with a vnet header */
+#define TAP_MAX_LRO_PKT_LEN 65535
+
 static int tap_devices_count;
 
 static const char *valid_arguments[] = {
@@ -160,6 +163,15 @@ tun_alloc(struct pmd_internals *pmd, int is_keepalive)
 	}
 	TAP_LOG(DEBUG, "%s Features %08x", TUN_TAP_DEV_PATH, features);
 
+	/*
+	 * The keep-alive queue is allocated first: all the queues use the
+	 * virtio net headers if it does.
+	 */
+	if (is_keepalive && (features & IFF_VNET_HDR)) {
+		TAP_LOG(DEBUG, "  Virtio net header support");
+		pmd->vnet_hdr = 1;
+	}
+
 	if (features & IFF_MULTI_QUEUE) {
 		TAP_LOG(DEBUG, "  Multi-queue support for %d queues",
 			RTE_PMD_TAP_MAX_QUEUES);
@@ -171,6 +183,13 @@ tun_alloc(struct pmd_internals *pmd, int is_keepalive)
 		TAP_LOG(DEBUG, "  Single queue only support");
 	}
 
+	/*
+	 * With the virtio net header, the checksum and segmentation offloads
+	 * are passed along with the frames instead of done in software.
+	 */
+	if (pmd->vnet_hdr)
+		ifr.ifr_flags |= IFF_VNET_HDR;
+
 	/* Set the TUN/TAP configuration and set the name if needed */
 	if (ioctl(fd, TUNSETIFF, (void *)&ifr) < 0) {
 		TAP_LOG(WARNING, "Unable to set TUNSETIFF for %s: %s",
@@ -306,7 +325,9 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 		/* IPv6 extensions are not supported */
 		return;
 	}
-	if (l4 == RTE_PTYPE_L4_UDP || l4 == RTE_PTYPE_L4_TCP) {
+	/* The L4 checksum may be already known from the vnet header. */
+	if ((l4 == RTE_PTYPE_L4_UDP || l4 == RTE_PTYPE_L4_TCP) &&
+	    !(mbuf->ol_flags & PKT_RX_L4_CKSUM_MASK)) {
 		l4_hdr = rte_pktmbuf_mtod_offset(mbuf, void *, l2_len + l3_len);
 		/* Don't verify checksum for multi-segment packets. */
 		if (mbuf->nb_segs > 1)
@@ -321,13 +342,34 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 	}
 }
 
+/* Translate the offload information of a vnet header to mbuf flags */
+static void
+tap_rx_vnet_offload(struct rte_mbuf *mbuf, const struct virtio_net_hdr *hdr)
+{
+	if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM)
+		/* Partial checksum, the data itself is valid */
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_NONE;
+	else if (hdr->flags & VIRTIO_NET_HDR_F_DATA_VALID)
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_GOOD;
+
+	switch (hdr->gso_type & ~VIRTIO_NET_HDR_GSO_ECN) {
+	case VIRTIO_NET_HDR_GSO_TCPV4:
+	case VIRTIO_NET_HDR_GSO_TCPV6:
+		mbuf->ol_flags |= PKT_RX_LRO;
+		mbuf->tso_segsz = hdr->gso_size;
+		break;
+	default:
+		break;
+	}
+}
+
 static uint64_t
-tap_rx_offload_get_port_capa(void)
+tap_rx_offload_get_port_capa(struct pmd_internals *pmd)
 {
 	/*
-	 * No specific port Rx offload capabilities.
+	 * The kernel aggregates TCP segments only with the vnet headers.
 	 */
-	return 0;
+	return pmd->vnet_hdr ? DEV_RX_OFFLOAD_TCP_LRO : 0;
 }
 
 static uint64_t
@@ -381,18 +423,19 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 		len = readv(process_private->rxq_fds[rxq->queue_id],
 			*rxq->iovecs,
-			1 + (rxq->rxmode->offloads & DEV_RX_OFFLOAD_SCATTER ?
+			1 + (rxq->rxmode->offloads &
+			     (DEV_RX_OFFLOAD_SCATTER | DEV_RX_OFFLOAD_TCP_LRO) ?
 			     rxq->nb_rx_desc : 1));
-		if (len < (int)sizeof(struct tun_pi))
+		if (len < (int)rxq->hdr_len)
 			break;
 
 		/* Packet couldn't fit in the provided mbuf */
-		if (unlikely(rxq->pi.flags & TUN_PKT_STRIP)) {
+		if (unlikely(rxq->hdr.pi.flags & TUN_PKT_STRIP)) {
 			rxq->stats.ierrors++;
 			continue;
 		}
 
-		len -= sizeof(struct tun_pi);
+		len -= rxq->hdr_len;
 
 		mbuf->pkt_len = len;
 		mbuf->port = rxq->in_port;
@@ -418,7 +461,7 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			new_tail = buf;
 			new_tail->next = seg->next;
 
-			/* iovecs[0] is reserved for packet info (pi) */
+			/* iovecs[0] is reserved for packet headers */
 			(*rxq->iovecs)[mbuf->nb_segs].iov_len =
 				buf->buf_len - data_off;
 			(*rxq->iovecs)[mbuf->nb_segs].iov_base =
@@ -437,6 +480,8 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		seg->next = NULL;
 		mbuf->packet_type = rte_net_get_ptype(mbuf, NULL,
 						      RTE_PTYPE_ALL_MASK);
+		if (rxq->hdr_len > sizeof(struct tun_pi))
+			tap_rx_vnet_offload(mbuf, &rxq->hdr.vnet);
 		if (rxq->rxmode->offloads & DEV_RX_OFFLOAD_CHECKSUM)
 			tap_verify_csum(mbuf);
 
@@ -538,6 +583,35 @@ tap_tx_l3_cksum(char *packet, uint64_t ol_flags, unsigned int l2_len,
 	}
 }
 
+/*
+ * Leave the L4 checksum and the TCP segmentation to the kernel: the L4
+ * checksum field only holds the pseudo header checksum.
+ */
+static void
+tap_tx_vnet_offload(struct virtio_net_hdr *hdr, struct rte_mbuf *mbuf,
+		uint16_t *l4_cksum, uint16_t l4_phdr_cksum)
+{
+	uint64_t ol_flags = mbuf->ol_flags;
+
+	if (l4_cksum == NULL)
+		return;
+
+	*l4_cksum = l4_phdr_cksum;
+	hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+	hdr->csum_start = mbuf->l2_len + mbuf->l3_len;
+	if ((ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM)
+		hdr->csum_offset = offsetof(struct rte_udp_hdr, dgram_cksum);
+	else
+		hdr->csum_offset = offsetof(struct rte_tcp_hdr, cksum);
+
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		hdr->gso_type = (ol_flags & PKT_TX_IPV4) ?
+			VIRTIO_NET_HDR_GSO_TCPV4 : VIRTIO_NET_HDR_GSO_TCPV6;
+		hdr->gso_size = mbuf->tso_segsz;
+		hdr->hdr_len = mbuf->l2_len + mbuf->l3_len + mbuf->l4_len;
+	}
+}
+
 static inline int
 tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 			struct rte_mbuf **pmbufs,
@@ -552,7 +626,7 @@ tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 	for (i = 0; i < num_mbufs; i++) {
 		struct rte_mbuf *mbuf = pmbufs[i];
 		struct iovec iovecs[mbuf->nb_segs + 2];
-		struct tun_pi pi = { .flags = 0, .proto = 0x00 };
+		struct tap_pkt_hdr hdr = { .pi = { .flags = 0, .proto = 0x00 } };
 		struct rte_mbuf *seg = mbuf;
 		char m_copy[mbuf->data_len];
 		int proto;
@@ -580,7 +654,7 @@ tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 			 */
 			char *buff_data = rte_pktmbuf_mtod(seg, void *);
 			proto = (*buff_data & 0xf0);
-			pi.proto = (proto == 0x40) ?
+			hdr.pi.proto = (proto == 0x40) ?
 				rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) :
 				((proto == 0x60) ?
 					rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) :
@@ -588,12 +662,12 @@ tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 		}
 
 		k = 0;
-		iovecs[k].iov_base = &pi;
-		iovecs[k].iov_len = sizeof(pi);
+		iovecs[k].iov_base = &hdr;
+		iovecs[k].iov_len = txq->vnet_hdr ? sizeof(hdr) : sizeof(hdr.pi);
 		k++;
 
 		nb_segs = mbuf->nb_segs;
-		if (txq->csum &&
+		if ((txq->csum || (mbuf->ol_flags & PKT_TX_TCP_SEG)) &&
 		    ((mbuf->ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_IPV4) ||
 		     (mbuf->ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM ||
 		     (mbuf->ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM))) {
@@ -616,6 +690,12 @@ tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 				       mbuf->l2_len, mbuf->l3_len, mbuf->l4_len,
 				       &l4_cksum, &l4_phdr_cksum,
 				       &l4_raw_cksum);
+			if (txq->vnet_hdr) {
+				tap_tx_vnet_offload(&hdr.vnet, mbuf, l4_cksum,
+						    l4_phdr_cksum);
+				/* No L4 checksum left to compute */
+				l4_cksum = NULL;
+			}
 			iovecs[k].iov_base = m_copy;
 			iovecs[k].iov_len = l234_hlen;
 			k++;
@@ -688,8 +768,6 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 		tso = mbuf_in->ol_flags & PKT_TX_TCP_SEG;
 		if (tso) {
-			struct rte_gso_ctx *gso_ctx = &txq->gso_ctx;
-
 			/* TCP segmentation implies TCP checksum offload */
 			mbuf_in->ol_flags |= PKT_TX_TCP_CKSUM;
 
@@ -702,6 +780,11 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 				txq->stats.errs++;
 				break;
 			}
+		}
+
+		if (tso && !txq->vnet_hdr) {
+			struct rte_gso_ctx *gso_ctx = &txq->gso_ctx;
+
 			gso_ctx->gso_size = tso_segsz;
 			/* 'mbuf_in' packet to segment */
 			num_tso_mbufs = rte_gso_segment(mbuf_in,
@@ -716,8 +799,11 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			mbuf = gso_mbufs;
 			num_mbufs = num_tso_mbufs;
 		} else {
-			/* stats.errs will be incremented */
-			if (rte_pktmbuf_pkt_len(mbuf_in) > max_size)
+			/*
+			 * stats.errs will be incremented. TSO packets are
+			 * segmented by the kernel, from the vnet header.
+			 */
+			if (!tso && rte_pktmbuf_pkt_len(mbuf_in) > max_size)
 				break;
 
 			/* ret 0 indicates no new mbufs were created */
@@ -839,11 +925,46 @@ tap_link_set_up(struct rte_eth_dev *dev)
 	return tap_ioctl(pmd, SIOCSIFFLAGS, &ifr, 1, LOCAL_AND_REMOTE);
 }
 
+/*
+ * Let the kernel pass partially checksummed frames, and TCP aggregates,
+ * when the corresponding Rx offloads are enabled.
+ */
+static int
+tap_rx_offload_set(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *pmd = dev->data->dev_private;
+	struct pmd_process_private *process_private = dev->process_private;
+	uint64_t offloads = dev->data->dev_conf.rxmode.offloads;
+	unsigned int tun_offloads = 0;
+
+	if (!pmd->vnet_hdr || dev->data->nb_rx_queues == 0)
+		return 0;
+
+	if (offloads & (DEV_RX_OFFLOAD_UDP_CKSUM | DEV_RX_OFFLOAD_TCP_CKSUM |
+			DEV_RX_OFFLOAD_TCP_LRO))
+		tun_offloads |= TUN_F_CSUM;
+	if (offloads & DEV_RX_OFFLOAD_TCP_LRO)
+		tun_offloads |= TUN_F_TSO4 | TUN_F_TSO6;
+
+	if (ioctl(process_private->rxq_fds[0], TUNSETOFFLOAD,
+		  tun_offloads) < 0) {
+		TAP_LOG(ERR, "%s: unable to set offloads 0x%x: %s",
+			pmd->name, tun_offloads, strerror(errno));
+		return -errno;
+	}
+
+	return 0;
+}
+
 static int
 tap_dev_start(struct rte_eth_dev *dev)
 {
 	int err, i;
 
+	err = tap_rx_offload_set(dev);
+	if (err)
+		return err;
+
 	err = tap_intr_handle_set(dev, 1);
 	if (err)
 		return err;
@@ -953,8 +1074,10 @@ tap_dev_info(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 	dev_info->max_tx_queues = RTE_PMD_TAP_MAX_QUEUES;
 	dev_info->min_rx_bufsize = 0;
 	dev_info->speed_capa = tap_dev_speed_capa();
+	if (internals->vnet_hdr)
+		dev_info->max_lro_pkt_size = TAP_MAX_LRO_PKT_LEN;
 	dev_info->rx_queue_offload_capa = tap_rx_offload_get_queue_capa();
-	dev_info->rx_offload_capa = tap_rx_offload_get_port_capa() |
+	dev_info->rx_offload_capa = tap_rx_offload_get_port_capa(internals) |
 				    dev_info->rx_queue_offload_capa;
 	dev_info->tx_queue_offload_capa = tap_tx_offload_get_queue_capa();
 	dev_info->tx_offload_capa = tap_tx_offload_get_port_capa() |
@@ -1476,8 +1599,11 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 		goto error;
 	}
 
-	(*rxq->iovecs)[0].iov_len = sizeof(struct tun_pi);
-	(*rxq->iovecs)[0].iov_base = &rxq->pi;
+	rxq->hdr_len = sizeof(struct tun_pi);
+	if (internals->vnet_hdr)
+		rxq->hdr_len += sizeof(struct virtio_net_hdr);
+	(*rxq->iovecs)[0].iov_len = rxq->hdr_len;
+	(*rxq->iovecs)[0].iov_base = &rxq->hdr;
 
 	for (i = 1; i <= nb_desc; i++) {
 		*tmp = rte_pktmbuf_alloc(rxq->mp);
@@ -1534,6 +1660,7 @@ tap_tx_queue_setup(struct rte_eth_dev *dev,
 			(DEV_TX_OFFLOAD_IPV4_CKSUM |
 			 DEV_TX_OFFLOAD_UDP_CKSUM |
 			 DEV_TX_OFFLOAD_TCP_CKSUM));
+	txq->vnet_hdr = internals->vnet_hdr;
 
 	ret = tap_setup_queue(dev, internals, tx_queue_id, 0);
 	if (ret == -1)
@@ -12,6 +12,7 @@
 #include <net/if.h>
 
 #include <linux/if_tun.h>
+#include <linux/virtio_net.h>
 
 #include <rte_ethdev_driver.h>
 #include <rte_ether.h>
@@ -42,6 +43,15 @@ struct pkt_stats {
 	uint64_t rx_nombuf;             /* Nb of RX mbuf alloc failures */
 };
 
+/*
+ * Headers of the frames read from and written to the tap fds, contiguous
+ * as both are made of 16-bit fields at most.
+ */
+struct tap_pkt_hdr {
+	struct tun_pi pi;               /* packet info */
+	struct virtio_net_hdr vnet;     /* offloads, with IFF_VNET_HDR only */
+};
+
 struct rx_queue {
 	struct rte_mempool *mp;         /* Mempool for RX packets */
 	uint32_t trigger_seen;          /* Last seen Rx trigger value */
@@ -52,13 +62,15 @@ struct rx_queue {
 	struct rte_eth_rxmode *rxmode;  /* RX features */
 	struct rte_mbuf *pool;          /* mbufs pool for this queue */
 	struct iovec (*iovecs)[];       /* descriptors for this queue */
-	struct tun_pi pi;               /* packet info for iovecs */
+	struct tap_pkt_hdr hdr;         /* packet headers for iovecs */
+	uint16_t hdr_len;               /* length of the headers read */
 };
 
 struct tx_queue {
 	int type;                       /* Type field - TUN|TAP */
 	uint16_t *mtu;                  /* Pointer to MTU from dev_data */
 	uint16_t csum:1;                /* Enable checksum offloading */
+	uint16_t vnet_hdr:1;            /* Offloads done by the kernel */
 	struct pkt_stats stats;         /* Stats for this TX queue */
 	struct rte_gso_ctx gso_ctx;     /* GSO context */
 	uint16_t out_port;              /* Port ID */
@@ -80,6 +92,7 @@ struct pmd_internals {
 	int flower_support;               /* 1 if kernel supports, else 0 */
 	int flower_vlan_support;          /* 1 if kernel supports, else 0 */
 	int rss_enabled;                  /* 1 if RSS is enabled, else 0 */
+	int vnet_hdr;                     /* 1 if IFF_VNET_HDR is set, else 0 */
 	/* implicit rules set when RSS is enabled */
 	int map_fd;                       /* BPF RSS map fd */
 	int bpf_fd[RTE_PMD_TAP_MAX_QUEUES];/* List of bpf fds per queue */
@@ -14,7 +14,12 @@
 #include <rte_bus_vdev.h>
 #include <rte_kvargs.h>
 #include <rte_vhost.h>
+#include <rte_vhost_async.h>
 #include <rte_spinlock.h>
+#include <rte_lcore.h>
+#include <rte_per_lcore.h>
+#include <rte_service.h>
+#include <rte_service_component.h>
 
 #include "rte_eth_vhost.h"
 
@@ -34,8 +39,17 @@ enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
 #define ETH_VHOST_VIRTIO_NET_F_HOST_TSO "tso"
 #define ETH_VHOST_LINEAR_BUF  "linear-buffer"
 #define ETH_VHOST_EXT_BUF  "ext-buffer"
+#define ETH_VHOST_COPY_LCORES "copy-lcores"
 #define VHOST_MAX_PKT_BURST 32
 
+/* segments of each virtqueue in the copy engine */
+#define VHOST_COPY_RING_SIZE 1024
+#define VHOST_COPY_RING_MASK (VHOST_COPY_RING_SIZE - 1)
+/* the copy lcores take the copies by batches of about this many bytes */
+#define VHOST_COPY_BATCH_BYTES 8192
+/* shorter copies are done by the vhost library on the queue's lcore */
+#define VHOST_COPY_THRESHOLD 256
+
 static const char *valid_arguments[] = {
 	ETH_VHOST_IFACE_ARG,
 	ETH_VHOST_QUEUES_ARG,
@@ -46,6 +60,7 @@ static const char *valid_arguments[] = {
 	ETH_VHOST_VIRTIO_NET_F_HOST_TSO,
 	ETH_VHOST_LINEAR_BUF,
 	ETH_VHOST_EXT_BUF,
+	ETH_VHOST_COPY_LCORES,
 	NULL
 };
 
@@ -86,12 +101,55 @@ struct vhost_stats {
 	uint64_t xstats[VHOST_XSTATS_MAX];
 };
 
+struct vhost_copy_seg {
+	void *src;
+	void *dst;
+	size_t len;
+};
+
+struct vhost_copy_batch {
+	uint32_t first;
+	uint32_t nb_segs;
+	uint32_t done;
+} __rte_cache_aligned;
+
+/*
+ * Copies of one virtqueue, handed by the vhost async channel of the queue.
+ * They are cut in batches which the copy lcores take in turn, so that the
+ * copies of a single virtqueue run on several lcores. Batches complete in
+ * any order, but are reported to the vhost library in submission order,
+ * which gives the buffers back to the guest in order.
+ */
+struct vhost_copy_queue {
+	struct vhost_copy_seg segs[VHOST_COPY_RING_SIZE];
+	struct vhost_copy_batch batches[VHOST_COPY_RING_SIZE];
+
+	/* only accessed with the virtqueue lock of the vhost library held */
+	uint32_t seg_tail;
+	uint32_t seg_head;
+	uint32_t batch_tail;
+	uint32_t batch_head;
+	uint32_t cpl_segs;
+
+	/* protects the fields below, used by the queue's and copy lcores */
+	rte_spinlock_t lock;
+	bool registered;
+	int vid;
+	uint16_t pkts_inflight;
+	uint16_t cpl_size;
+	struct rte_mbuf **cpl_pkts;
+
+	/* next batch to copy, taken by the copy lcores */
+	uint32_t batch_claim __rte_cache_aligned;
+};
+
 struct vhost_queue {
 	int vid;
 	rte_atomic32_t allow_queuing;
 	rte_atomic32_t while_queuing;
 	struct pmd_internal *internal;
 	struct rte_mempool *mb_pool;
+	struct vhost_copy_queue *copy;
 	uint16_t port;
 	uint16_t virtqueue_id;
 	struct vhost_stats stats;
@@ -106,6 +164,16 @@ struct pmd_internal {
 	int vid;
 	rte_atomic32_t started;
 	uint8_t vlan_strip;
+	struct vhost_copy_queue *copy_queues;
+	uint32_t copy_service_id;
+};
+
+/* copy queue whose vhost async channel is being called on this lcore */
+static RTE_DEFINE_PER_LCORE(struct vhost_copy_queue *, vhost_copy_cur);
+
+struct vhost_copy_lcores {
+	unsigned int nb;
+	unsigned int id[RTE_MAX_LCORE];
 };
 
 struct internal_list {
@@ -376,12 +444,201 @@ vhost_update_packet_xstats(struct vhost_queue *vq,
 	}
 }
 
+/* Copy the next batch waiting on the queue, return 0 if there was none */
+static int
+vhost_copy_run(struct vhost_copy_queue *cq)
+{
+	struct vhost_copy_batch *b;
+	struct vhost_copy_seg *seg;
+	uint32_t claim, tail, i;
+
+	claim = __atomic_load_n(&cq->batch_claim, __ATOMIC_RELAXED);
+	do {
+		tail = __atomic_load_n(&cq->batch_tail, __ATOMIC_ACQUIRE);
+		if (claim == tail)
+			return 0;
+	} while (!__atomic_compare_exchange_n(&cq->batch_claim, &claim,
+			claim + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	b = &cq->batches[claim & VHOST_COPY_RING_MASK];
+	for (i = 0; i < b->nb_segs; i++) {
+		seg = &cq->segs[(b->first + i) & VHOST_COPY_RING_MASK];
+		rte_memcpy(seg->dst, seg->src, seg->len);
+	}
+	__atomic_store_n(&b->done, 1, __ATOMIC_RELEASE);
+
+	return 1;
+}
+
+/* Hand the segments from first to tail to the copy lcores */
+static void
+vhost_copy_publish(struct vhost_copy_queue *cq, uint32_t first, uint32_t tail)
+{
+	struct vhost_copy_batch *b;
+
+	if (first == tail)
+		return;
+
+	b = &cq->batches[cq->batch_tail & VHOST_COPY_RING_MASK];
+	b->first = first;
+	b->nb_segs = tail - first;
+	b->done = 0;
+	cq->seg_tail = tail;
+	__atomic_store_n(&cq->batch_tail, cq->batch_tail + 1,
+			__ATOMIC_RELEASE);
+}
+
+/* Release the batches completed in order, and count their segments */
+static void
+vhost_copy_retire(struct vhost_copy_queue *cq)
+{
+	struct vhost_copy_batch *b;
+
+	while (cq->batch_head != cq->batch_tail) {
+		b = &cq->batches[cq->batch_head & VHOST_COPY_RING_MASK];
+		if (!__atomic_load_n(&b->done, __ATOMIC_ACQUIRE))
+			break;
+		cq->seg_head += b->nb_segs;
+		cq->cpl_segs += b->nb_segs;
+		cq->batch_head++;
+	}
+}
+
+static int
+vhost_copy_transfer_data(int vid __rte_unused, uint16_t queue_id __rte_unused,
+		struct rte_vhost_async_desc *descs,
+		struct rte_vhost_async_status *opaque_data, uint16_t count)
+{
+	struct vhost_copy_queue *cq = RTE_PER_LCORE(vhost_copy_cur);
+	struct rte_vhost_iov_iter *src, *dst;
+	struct vhost_copy_seg *seg;
+	uint32_t first, tail;
+	size_t bytes = 0;
+	unsigned long j;
+	uint16_t i;
+
+	if (cq == NULL || opaque_data != NULL)
+		return -1;
+
+	first = tail = cq->seg_tail;
+	for (i = 0; i < count; i++) {
+		src = descs[i].src;
+		dst = descs[i].dst;
+
+		/*
+		 * The vhost library has no way to retry a refused packet,
+		 * so wait for room, doing the oldest copies here if the copy
+		 * lcores are late.
+		 */
+		while (VHOST_COPY_RING_SIZE - (tail - cq->seg_head) <
+				src->nr_segs) {
+			vhost_copy_publish(cq, first, tail);
+			first = tail;
+			bytes = 0;
+			if (!vhost_copy_run(cq))
+				rte_pause();
+			vhost_copy_retire(cq);
+		}
+
+		for (j = 0; j < src->nr_segs; j++, tail++) {
+			seg = &cq->segs[tail & VHOST_COPY_RING_MASK];
+			seg->src = src->iov[j].iov_base;
+			seg->dst = dst->iov[j].iov_base;
+			seg->len = src->iov[j].iov_len;
+			bytes += seg->len;
+		}
+
+		if (bytes >= VHOST_COPY_BATCH_BYTES) {
+			vhost_copy_publish(cq, first, tail);
+			first = tail;
+			bytes = 0;
+		}
+	}
+	vhost_copy_publish(cq, first, tail);
+
+	return count;
+}
+
+static int
+vhost_copy_check_completed_copies(int vid __rte_unused,
+		uint16_t queue_id __rte_unused,
+		struct rte_vhost_async_status *opaque_data,
+		uint16_t max_packets __rte_unused)
+{
+	struct vhost_copy_queue *cq = RTE_PER_LCORE(vhost_copy_cur);
+	uint32_t n_segs;
+
+	if (cq == NULL || opaque_data != NULL)
+		return -1;
+
+	vhost_copy_retire(cq);
+	n_segs = cq->cpl_segs;
+	cq->cpl_segs = 0;
+
+	return n_segs;
+}
+
+static struct rte_vhost_async_channel_ops vhost_copy_ops = {
+	.transfer_data = vhost_copy_transfer_data,
+	.check_completed_copies = vhost_copy_check_completed_copies,
+};
+
+/*
+ * Give the packets enqueued to the guest back to their mempool once they
+ * are copied. Called by the queue's lcore and by the copy lcores, so that
+ * the guest gets the packets without waiting for the next Tx burst.
+ */
+static void
+vhost_copy_tx_complete(struct vhost_copy_queue *cq, uint16_t queue_id)
+{
+	uint16_t n;
+
+	if (!rte_spinlock_trylock(&cq->lock))
+		return;
+
+	if (cq->registered && cq->pkts_inflight) {
+		RTE_PER_LCORE(vhost_copy_cur) = cq;
+		n = rte_vhost_poll_enqueue_completed(cq->vid, queue_id,
+				cq->cpl_pkts, cq->cpl_size);
+		rte_pktmbuf_free_bulk(cq->cpl_pkts, n);
+		cq->pkts_inflight -= n;
+	}
+
+	rte_spinlock_unlock(&cq->lock);
+}
+
+/* Service function of the copy lcores, MT safe */
+static int32_t
+vhost_copy_service(void *args)
+{
+	struct pmd_internal *internal = args;
+	struct vhost_copy_queue *cq;
+	unsigned int i, nb_vrings = internal->max_queues * VIRTIO_QNUM;
+	int copied;
+
+	do {
+		copied = 0;
+		for (i = 0; i < nb_vrings; i++) {
+			cq = &internal->copy_queues[i];
+			if (!vhost_copy_run(cq))
+				continue;
+			copied = 1;
+			if (i % VIRTIO_QNUM == VIRTIO_RXQ)
+				vhost_copy_tx_complete(cq, i);
+		}
+	} while (copied);
+
+	return 0;
+}
+
 static uint16_t
 eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	struct vhost_queue *r = q;
+	struct vhost_copy_queue *cq;
 	uint16_t i, nb_rx = 0;
 	uint16_t nb_receive = nb_bufs;
+	int nr_inflight;
 
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		return 0;
@@ -391,15 +648,28 @@ eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		goto out;
 
+	cq = r->copy;
+	if (cq != NULL && !cq->registered)
+		cq = NULL;
+	if (cq != NULL)
+		RTE_PER_LCORE(vhost_copy_cur) = cq;
+
 	/* Dequeue packets from guest TX queue */
 	while (nb_receive) {
 		uint16_t nb_pkts;
 		uint16_t num = (uint16_t)RTE_MIN(nb_receive,
 						 VHOST_MAX_PKT_BURST);
 
-		nb_pkts = rte_vhost_dequeue_burst(r->vid, r->virtqueue_id,
-						  r->mb_pool, &bufs[nb_rx],
-						  num);
+		if (cq != NULL) {
+			nb_pkts = rte_vhost_async_try_dequeue_burst(r->vid,
+					r->virtqueue_id, r->mb_pool,
+					&bufs[nb_rx], num, &nr_inflight);
+			cq->pkts_inflight = RTE_MAX(nr_inflight, 0);
+		} else {
+			nb_pkts = rte_vhost_dequeue_burst(r->vid,
+					r->virtqueue_id, r->mb_pool,
+					&bufs[nb_rx], num);
+		}
 
 		nb_rx += nb_pkts;
 		nb_receive -= nb_pkts;
@@ -431,6 +701,7 @@ static uint16_t
 eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	struct vhost_queue *r = q;
+	struct vhost_copy_queue *cq;
 	uint16_t i, nb_tx = 0;
 	uint16_t nb_send = 0;
 
@@ -442,6 +713,10 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	if (unlikely(rte_atomic32_read(&r->allow_queuing) == 0))
 		goto out;
 
+	cq = r->copy;
+	if (cq != NULL && !cq->registered)
+		cq = NULL;
+
 	for (i = 0; i < nb_bufs; i++) {
 		struct rte_mbuf *m = bufs[i];
 
@@ -459,13 +734,21 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	}
 
 	/* Enqueue packets to guest RX queue */
+	if (cq != NULL) {
+		rte_spinlock_lock(&cq->lock);
+		RTE_PER_LCORE(vhost_copy_cur) = cq;
+	}
 	while (nb_send) {
 		uint16_t nb_pkts;
 		uint16_t num = (uint16_t)RTE_MIN(nb_send,
 						 VHOST_MAX_PKT_BURST);
 
-		nb_pkts = rte_vhost_enqueue_burst(r->vid, r->virtqueue_id,
-						  &bufs[nb_tx], num);
+		if (cq != NULL)
+			nb_pkts = rte_vhost_submit_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
+		else
+			nb_pkts = rte_vhost_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
 
 		nb_tx += nb_pkts;
 		nb_send -= nb_pkts;
@@ -488,8 +771,18 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	for (i = nb_tx; i < nb_bufs; i++)
 		vhost_count_multicast_broadcast(r, bufs[i]);
 
-	for (i = 0; likely(i < nb_tx); i++)
-		rte_pktmbuf_free(bufs[i]);
+	/*
+	 * The packets given to the copy engine are freed once copied, the
+	 * copy lcores must not do it before they are accounted above.
+	 */
+	if (cq != NULL) {
+		cq->pkts_inflight += nb_tx;
+		rte_spinlock_unlock(&cq->lock);
+		vhost_copy_tx_complete(cq, r->virtqueue_id);
+	} else {
+		for (i = 0; likely(i < nb_tx); i++)
+			rte_pktmbuf_free(bufs[i]);
+	}
 out:
 	rte_atomic32_set(&r->while_queuing, 0);
 
@@ -702,6 +995,8 @@ queue_setup(struct rte_eth_dev *eth_dev, struct pmd_internal *internal)
 		vq->vid = internal->vid;
 		vq->internal = internal;
 		vq->port = eth_dev->data->port_id;
+		if (internal->copy_queues != NULL)
+			vq->copy = &internal->copy_queues[vq->virtqueue_id];
 	}
 	for (i = 0; i < eth_dev->data->nb_tx_queues; i++) {
 		vq = eth_dev->data->tx_queues[i];
@@ -710,6 +1005,114 @@ queue_setup(struct rte_eth_dev *eth_dev, struct pmd_internal *internal)
 		vq->vid = internal->vid;
 		vq->internal = internal;
 		vq->port = eth_dev->data->port_id;
+		if (internal->copy_queues != NULL)
+			vq->copy = &internal->copy_queues[vq->virtqueue_id];
+	}
+}
+
+static void
+vhost_copy_register(struct rte_eth_dev *dev, int vid)
+{
+	struct pmd_internal *internal = dev->data->dev_private;
+	struct rte_vhost_async_features f;
+	struct rte_vhost_vring vring;
+	struct vhost_copy_queue *cq;
+	unsigned int i, nb_vrings;
+
+	if (internal->copy_queues == NULL)
+		return;
+
+	f.intval = 0;
+	f.async_inorder = 1;
+	f.async_threshold = VHOST_COPY_THRESHOLD;
+
+	nb_vrings = RTE_MIN(rte_vhost_get_vring_num(vid),
+			    internal->max_queues * VIRTIO_QNUM);
+	for (i = 0; i < nb_vrings; i++) {
+		cq = &internal->copy_queues[i];
+
+		/* the whole ring may complete in one poll */
+		if (i % VIRTIO_QNUM == VIRTIO_RXQ) {
+			if (rte_vhost_get_vhost_vring(vid, i, &vring) < 0)
+				continue;
+			cq->cpl_pkts = rte_malloc_socket(NULL,
+					vring.size * sizeof(cq->cpl_pkts[0]),
+					0, dev->data->numa_node);
+			if (cq->cpl_pkts == NULL)
+				continue;
+			cq->cpl_size = vring.size;
+		}
+
+		if (rte_vhost_async_channel_register(vid, i, f.intval,
+						     &vhost_copy_ops) < 0) {
+			VHOST_LOG(ERR,
+				"Failed to offload the copies of vring%u\n", i);
+			rte_free(cq->cpl_pkts);
+			cq->cpl_pkts = NULL;
+			continue;
+		}
+
+		rte_spinlock_lock(&cq->lock);
+		cq->vid = vid;
+		cq->pkts_inflight = 0;
+		cq->registered = true;
+		rte_spinlock_unlock(&cq->lock);
+	}
+}
+
+/*
+ * Wait for the copies in flight, which have to complete before the device
+ * is stopped or destroyed. The packets the Rx queues get meanwhile are
+ * dropped.
+ */
+static void
+vhost_copy_drain(struct rte_eth_dev *dev, bool unregister)
+{
+	struct pmd_internal *internal = dev->data->dev_private;
+	struct rte_mbuf *pkts[VHOST_MAX_PKT_BURST];
+	struct vhost_copy_queue *cq;
+	struct vhost_queue *vq;
+	unsigned int i;
+	int nr_inflight;
+	uint16_t n;
+
+	if (internal->copy_queues == NULL)
+		return;
+
+	for (i = 0; i < internal->max_queues * VIRTIO_QNUM; i++) {
+		cq = &internal->copy_queues[i];
+		if (!cq->registered)
+			continue;
+
+		if (i % VIRTIO_QNUM == VIRTIO_RXQ) {
+			while (cq->pkts_inflight) {
+				vhost_copy_run(cq);
+				vhost_copy_tx_complete(cq, i);
+			}
+		} else if (cq->pkts_inflight) {
+			vq = dev->data->rx_queues[i / VIRTIO_QNUM];
+			RTE_PER_LCORE(vhost_copy_cur) = cq;
+			do {
+				vhost_copy_run(cq);
+				n = rte_vhost_async_try_dequeue_burst(cq->vid, i,
+						vq->mb_pool, pkts,
+						VHOST_MAX_PKT_BURST,
+						&nr_inflight);
+				rte_pktmbuf_free_bulk(pkts, n);
+			} while (nr_inflight > 0);
+			cq->pkts_inflight = 0;
+		}
+
+		if (!unregister)
+			continue;
+
+		rte_spinlock_lock(&cq->lock);
+		cq->registered = false;
+		rte_spinlock_unlock(&cq->lock);
+
+		rte_vhost_async_channel_unregister(cq->vid, i);
+		rte_free(cq->cpl_pkts);
+		cq->cpl_pkts = NULL;
 	}
 }
 
@@ -758,6 +1161,8 @@ new_device(int vid)
 		VHOST_LOG(INFO, "RX/TX queues not exist yet\n");
 	}
 
+	vhost_copy_register(eth_dev, vid);
+
 	for (i = 0; i < rte_vhost_get_vring_num(vid); i++)
 		rte_vhost_enable_guest_notification(vid, i, 0);
 
@@ -797,6 +1202,7 @@ destroy_device(int vid)
 
 	rte_atomic32_set(&internal->dev_attached, 0);
 	update_queuing_status(eth_dev);
+	vhost_copy_drain(eth_dev, true);
 
 	eth_dev->data->dev_link.link_status = ETH_LINK_DOWN;
 
@@ -1054,6 +1460,23 @@ eth_dev_stop(struct rte_eth_dev *dev)
 
 	rte_atomic32_set(&internal->started, 0);
 	update_queuing_status(dev);
+	vhost_copy_drain(dev, false);
+}
+
+static void
+vhost_copy_release(struct pmd_internal *internal)
+{
+	if (internal->copy_queues == NULL)
+		return;
+
+	rte_service_runstate_set(internal->copy_service_id, 0);
+	rte_service_component_runstate_set(internal->copy_service_id, 0);
+	while (rte_service_may_be_active(internal->copy_service_id) == 1)
+		rte_pause();
+	rte_service_component_unregister(internal->copy_service_id);
+
+	rte_free(internal->copy_queues);
+	internal->copy_queues = NULL;
 }
 
 static void
@@ -1078,6 +1501,8 @@ eth_dev_close(struct rte_eth_dev *dev)
 		rte_free(list);
 	}
 
+	vhost_copy_release(internal);
+
 	if (dev->data->rx_queues)
 		for (i = 0; i < dev->data->nb_rx_queues; i++)
 			rte_free(dev->data->rx_queues[i]);
@@ -1286,10 +1711,73 @@ static const struct eth_dev_ops ops = {
 	.rx_queue_intr_disable = eth_rxq_intr_disable,
 };
 
+/*
+ * Run the copies of all the virtqueues of the port as a service mapped on
+ * the copy lcores.
+ */
+static int
+vhost_copy_setup(struct rte_eth_dev *dev,
+		 const struct vhost_copy_lcores *lcores)
+{
+	struct pmd_internal *internal = dev->data->dev_private;
+	unsigned int nb_vrings = internal->max_queues * VIRTIO_QNUM;
+	struct rte_service_spec service;
+	unsigned int i, lcore;
+	int ret;
+
+	internal->copy_queues = rte_zmalloc_socket(NULL,
+			nb_vrings * sizeof(*internal->copy_queues),
+			RTE_CACHE_LINE_SIZE, dev->data->numa_node);
+	if (internal->copy_queues == NULL) {
+		VHOST_LOG(ERR, "Failed to allocate memory for copy queues\n");
+		return -1;
+	}
+	for (i = 0; i < nb_vrings; i++)
+		rte_spinlock_init(&internal->copy_queues[i].lock);
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name), "%s_copy",
+		 dev->data->name);
+	service.socket_id = dev->data->numa_node;
+	service.callback = vhost_copy_service;
+	service.callback_userdata = internal;
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	if (rte_service_component_register(&service,
+					   &internal->copy_service_id) != 0) {
+		VHOST_LOG(ERR, "Failed to register the copy service\n");
+		rte_free(internal->copy_queues);
+		internal->copy_queues = NULL;
+		return -1;
+	}
+	rte_service_component_runstate_set(internal->copy_service_id, 1);
+	rte_service_runstate_set(internal->copy_service_id, 1);
+
+	for (i = 0; i < lcores->nb; i++) {
+		lcore = lcores->id[i];
+		ret = rte_service_lcore_add(lcore);
+		if (ret != 0 && ret != -EALREADY)
+			goto error;
+		ret = rte_service_map_lcore_set(internal->copy_service_id,
+						lcore, 1);
+		if (ret != 0)
+			goto error;
+		ret = rte_service_lcore_start(lcore);
+		if (ret != 0 && ret != -EALREADY)
+			goto error;
+	}
+
+	return 0;
+
+error:
+	VHOST_LOG(ERR, "Failed to run the copy service on lcore %u\n", lcore);
+	vhost_copy_release(internal);
+	return -1;
+}
+
 static int
 eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	int16_t queues, const unsigned int numa_node, uint64_t flags,
-	uint64_t disable_flags)
+	uint64_t disable_flags, const struct vhost_copy_lcores *copy_lcores)
 {
 	const char *name = rte_vdev_device_name(dev);
 	struct rte_eth_dev_data *data;
@@ -1342,6 +1830,9 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	eth_dev->rx_pkt_burst = eth_vhost_rx;
 	eth_dev->tx_pkt_burst = eth_vhost_tx;
 
+	if (copy_lcores->nb > 0 && vhost_copy_setup(eth_dev, copy_lcores) < 0)
+		goto error;
+
 	rte_eth_dev_probing_finish(eth_dev);
 	return 0;
 
@@ -1381,6 +1872,56 @@ open_int(const char *key __rte_unused, const char *value, void *extra_args)
 	return 0;
 }
 
+/* parse a list of lcores such as 2, 2-4 or [2,4-5] */
+static int
+open_lcores(const char *key __rte_unused, const char *value,
+	    void *extra_args)
+{
+	struct vhost_copy_lcores *lcores = extra_args;
+	unsigned long first, last;
+	const char *p;
+	char *end;
+
+	if (value == NULL || extra_args == NULL)
+		return -EINVAL;
+
+	p = value;
+	if (*p == '[')
+		p++;
+	do {
+		errno = 0;
+		first = strtoul(p, &end, 10);
+		if (errno != 0 || end == p)
+			return -EINVAL;
+		last = first;
+		if (*end == '-') {
+			p = end + 1;
+			last = strtoul(p, &end, 10);
+			if (errno != 0 || end == p || last < first)
+				return -EINVAL;
+		}
+		for (; first <= last; first++) {
+			if (first >= RTE_MAX_LCORE ||
+			    !rte_lcore_is_enabled(first) ||
+			    first == rte_get_master_lcore() ||
+			    lcores->nb == RTE_MAX_LCORE) {
+				VHOST_LOG(ERR, "Invalid copy lcore %lu\n",
+					first);
+				return -EINVAL;
+			}
+			lcores->id[lcores->nb++] = first;
+		}
+		p = end + 1;
+	} while (*end == ',');
+
+	if (*value == '[' && *end++ != ']')
+		return -EINVAL;
+	if (*end != '\0')
+		return -EINVAL;
+
+	return 0;
+}
+
 static int
 rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 {
@@ -1397,6 +1938,7 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 	int tso = 0;
 	int linear_buf = 0;
 	int ext_buf = 0;
+	struct vhost_copy_lcores copy_lcores = { .nb = 0 };
 	struct rte_eth_dev *eth_dev;
 	const char *name = rte_vdev_device_name(dev);
 
@@ -1516,11 +2058,28 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 			flags |= RTE_VHOST_USER_EXTBUF_SUPPORT;
 	}
 
+	if (rte_kvargs_count(kvlist, ETH_VHOST_COPY_LCORES) == 1) {
+		ret = rte_kvargs_process(kvlist,
+				ETH_VHOST_COPY_LCORES,
+				&open_lcores, &copy_lcores);
+		if (ret < 0)
+			goto out_free;
+
+		/* the copies are done by CPU on the iova of the buffers */
+		if (rte_eal_iova_mode() != RTE_IOVA_VA) {
+			VHOST_LOG(ERR, "copy-lcores needs IOVA as VA mode\n");
+			ret = -1;
+			goto out_free;
+		}
+		flags |= RTE_VHOST_USER_ASYNC_COPY;
+	}
+
 	if (dev->device.numa_node == SOCKET_ID_ANY)
 		dev->device.numa_node = rte_socket_id();
 
 	ret = eth_dev_vhost_create(dev, iface_name, queues,
-				   dev->device.numa_node, flags, disable_flags);
+				   dev->device.numa_node, flags, disable_flags,
+				   &copy_lcores);
 	if (ret == -1)
 		VHOST_LOG(ERR, "Failed to create %s\n", name);
 
@@ -1569,4 +2128,5 @@ RTE_PMD_REGISTER_PARAM_STRING(net_vhost,
 	"postcopy-support=<0|1> "
 	"tso=<0|1> "
 	"linear-buffer=<0|1> "
-	"ext-buffer=<0|1>");
+	"ext-buffer=<0|1> "
+	"copy-lcores=<list>");
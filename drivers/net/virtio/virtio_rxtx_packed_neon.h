@@ -0,0 +1,266 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#ifndef _VIRTIO_RXTX_PACKED_NEON_H_
+#define _VIRTIO_RXTX_PACKED_NEON_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_net.h>
+#include <rte_vect.h>
+
+#include "virtio_ethdev.h"
+#include "virtio_pci.h"
+#include "virtio_rxtx_packed.h"
+#include "virtqueue.h"
+
+/* refcnt and nb_segs bits in mbuf rearm data */
+#define REARM_REF_SEGS_MASK ((uint64_t)UINT16_MAX << REFCNT_BITS_OFFSET | \
+	(uint64_t)UINT16_MAX << SEG_NUM_BITS_OFFSET)
+
+static inline int
+virtqueue_enqueue_batch_packed_vec(struct virtnet_tx *txvq,
+				   struct rte_mbuf **tx_pkts)
+{
+	struct virtqueue *vq = txvq->vq;
+	uint16_t head_size = vq->hw->vtnet_hdr_size;
+	uint16_t idx = vq->vq_avail_idx;
+	struct vring_packed_desc *start_dp;
+	struct virtio_net_hdr *hdr;
+	struct vq_desc_extra *dxp;
+	uint64_t hi_base, head_hi;
+	uint16_t i;
+
+	if (vq->vq_avail_idx & PACKED_BATCH_MASK)
+		return -1;
+
+	if (unlikely((idx + PACKED_BATCH_SIZE) > vq->vq_nentries))
+		return -1;
+
+	/* Load four mbufs rearm data */
+	RTE_BUILD_BUG_ON(REFCNT_BITS_OFFSET >= 64);
+	RTE_BUILD_BUG_ON(SEG_NUM_BITS_OFFSET >= 64);
+	uint64x2_t mbufs[PACKED_BATCH_SIZE / 2];
+	mbufs[0] = vcombine_u64(vcreate_u64(*tx_pkts[0]->rearm_data),
+				vcreate_u64(*tx_pkts[1]->rearm_data));
+	mbufs[1] = vcombine_u64(vcreate_u64(*tx_pkts[2]->rearm_data),
+				vcreate_u64(*tx_pkts[3]->rearm_data));
+
+	/* Check refcnt=1 and nb_segs=1 */
+	uint64x2_t ref_mask = vdupq_n_u64(REARM_REF_SEGS_MASK);
+	uint64x2_t mbuf_ref = vdupq_n_u64(DEFAULT_REARM_DATA);
+	uint64x2_t cmp = vandq_u64(
+		vceqq_u64(vandq_u64(mbufs[0], ref_mask), mbuf_ref),
+		vceqq_u64(vandq_u64(mbufs[1], ref_mask), mbuf_ref));
+	if (unlikely(vminvq_u32(vreinterpretq_u32_u64(cmp)) != UINT32_MAX))
+		return -1;
+
+	/* Check headroom is enough */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, data_off) !=
+		offsetof(struct rte_mbuf, rearm_data));
+	const uint16x8_t data_mask = {UINT16_MAX, 0, 0, 0,
+				      UINT16_MAX, 0, 0, 0};
+	uint16x8_t head_rooms = vdupq_n_u16(head_size);
+	uint16x8_t room_cmp = vorrq_u16(
+		vcltq_u16(vreinterpretq_u16_u64(mbufs[0]), head_rooms),
+		vcltq_u16(vreinterpretq_u16_u64(mbufs[1]), head_rooms));
+	if (unlikely(vmaxvq_u16(vandq_u16(room_cmp, data_mask))))
+		return -1;
+
+	virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+		dxp = &vq->vq_descx[idx + i];
+		dxp->ndescs = 1;
+		dxp->cookie = tx_pkts[i];
+	}
+
+	virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+		tx_pkts[i]->data_off -= head_size;
+		tx_pkts[i]->data_len += head_size;
+	}
+
+	if (!vq->hw->has_tx_offload) {
+		/* only the first six 16-bit words belong to the net hdr */
+		const uint16x8_t hdr_mask = {UINT16_MAX, UINT16_MAX,
+					     UINT16_MAX, UINT16_MAX,
+					     UINT16_MAX, UINT16_MAX, 0, 0};
+		virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+			hdr = rte_pktmbuf_mtod_offset(tx_pkts[i],
+					struct virtio_net_hdr *, -head_size);
+			uint16x8_t v_hdr = vld1q_u16((void *)hdr);
+			if (unlikely(vmaxvq_u16(vandq_u16(v_hdr, hdr_mask))))
+				vst1q_u16((void *)hdr,
+					  vbicq_u16(v_hdr, hdr_mask));
+		}
+	} else {
+		virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+			hdr = rte_pktmbuf_mtod_offset(tx_pkts[i],
+					struct virtio_net_hdr *, -head_size);
+			virtqueue_xmit_offload(hdr, tx_pkts[i], true);
+		}
+	}
+
+	/*
+	 * The descriptors are written two by two with 128 bits stores, which
+	 * the device may observe in any order. The head descriptor keeps its
+	 * old, not available, flags until the others are complete, and is
+	 * only made available by the flags store below.
+	 */
+	start_dp = vq->vq_packed.ring.desc;
+	hi_base = (uint64_t)idx << ID_BITS_OFFSET |
+		(uint64_t)vq->vq_packed.cached_flags << FLAGS_BITS_OFFSET;
+	head_hi = (uint64_t)idx << ID_BITS_OFFSET |
+		(uint64_t)start_dp[idx].flags << FLAGS_BITS_OFFSET;
+
+	uint64x2x2_t new_descs[PACKED_BATCH_SIZE / 2];
+	new_descs[0].val[0] = vcombine_u64(
+		vcreate_u64(VIRTIO_MBUF_DATA_DMA_ADDR(tx_pkts[0], vq)),
+		vcreate_u64(VIRTIO_MBUF_DATA_DMA_ADDR(tx_pkts[1], vq)));
+	new_descs[0].val[1] = vcombine_u64(
+		vcreate_u64(head_hi | tx_pkts[0]->data_len),
+		vcreate_u64((hi_base + ((uint64_t)1 << ID_BITS_OFFSET)) |
+			    tx_pkts[1]->data_len));
+	new_descs[1].val[0] = vcombine_u64(
+		vcreate_u64(VIRTIO_MBUF_DATA_DMA_ADDR(tx_pkts[2], vq)),
+		vcreate_u64(VIRTIO_MBUF_DATA_DMA_ADDR(tx_pkts[3], vq)));
+	new_descs[1].val[1] = vcombine_u64(
+		vcreate_u64((hi_base + ((uint64_t)2 << ID_BITS_OFFSET)) |
+			    tx_pkts[2]->data_len),
+		vcreate_u64((hi_base + ((uint64_t)3 << ID_BITS_OFFSET)) |
+			    tx_pkts[3]->data_len));
+
+	/* Enqueue Packet buffers */
+	vst2q_u64((uint64_t *)&start_dp[idx], new_descs[0]);
+	vst2q_u64((uint64_t *)&start_dp[idx + 2], new_descs[1]);
+
+	virtqueue_store_flags_packed(&start_dp[idx],
+			vq->vq_packed.cached_flags, vq->hw->weak_barriers);
+
+	virtio_update_batch_stats(&txvq->stats, tx_pkts[0]->pkt_len,
+			tx_pkts[1]->pkt_len, tx_pkts[2]->pkt_len,
+			tx_pkts[3]->pkt_len);
+
+	vq->vq_avail_idx += PACKED_BATCH_SIZE;
+	vq->vq_free_cnt -= PACKED_BATCH_SIZE;
+
+	if (vq->vq_avail_idx >= vq->vq_nentries) {
+		vq->vq_avail_idx -= vq->vq_nentries;
+		vq->vq_packed.cached_flags ^=
+			VRING_PACKED_DESC_F_AVAIL_USED;
+	}
+
+	return 0;
+}
+
+static inline uint16_t
+virtqueue_dequeue_batch_packed_vec(struct virtnet_rx *rxvq,
+				   struct rte_mbuf **rx_pkts)
+{
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	uint16_t hdr_size = hw->vtnet_hdr_size;
+	uint16_t id = vq->vq_used_cons_idx;
+	uint16_t i;
+	void *desc_addr;
+
+	if (id & PACKED_BATCH_MASK)
+		return -1;
+
+	if (unlikely((id + PACKED_BATCH_SIZE) > vq->vq_nentries))
+		return -1;
+
+	/*
+	 * Load four descs, de-interleaved so that val[1] holds the higher
+	 * 64 bits (len, id and flags) of two consecutive descs.
+	 */
+	desc_addr = &vq->vq_packed.ring.desc[id];
+	uint64x2x2_t v_desc[PACKED_BATCH_SIZE / 2];
+	v_desc[0] = vld2q_u64((uint64_t *)desc_addr);
+	v_desc[1] = vld2q_u64((uint64_t *)desc_addr + 4);
+
+	/* only care avail/used bits */
+	uint64x2_t v_mask = vdupq_n_u64(PACKED_FLAGS_MASK);
+	uint64x2_t v_used_flag = vdupq_n_u64(0);
+	if (vq->vq_packed.used_wrap_counter)
+		v_used_flag = v_mask;
+
+	/* Check all descs are used */
+	uint64x2_t v_cmp = vandq_u64(
+		vceqq_u64(vandq_u64(v_desc[0].val[1], v_mask), v_used_flag),
+		vceqq_u64(vandq_u64(v_desc[1].val[1], v_mask), v_used_flag));
+	if (vminvq_u32(vreinterpretq_u32_u64(v_cmp)) != UINT32_MAX)
+		return -1;
+
+	/* same ordering as desc_is_used() for the buffers content */
+	virtio_rmb(hw->weak_barriers);
+
+	virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+		rx_pkts[i] = (struct rte_mbuf *)vq->vq_descx[id + i].cookie;
+		rte_packet_prefetch(rte_pktmbuf_mtod(rx_pkts[i], void *));
+	}
+
+	/*
+	 * load len from desc, store into mbuf pkt_len and data_len
+	 * len limiated by l6bit buf_len, pkt_len[16:31] can be ignored
+	 *
+	 * rx_descriptor_fields1 is written whole:
+	 * | packet_type = 0 | pkt_len | data_len, vlan_tci = 0 | hash = 0 |
+	 */
+	const uint8x16_t shuf_even = {
+		0xFF, 0xFF, 0xFF, 0xFF, /* packet_type */
+		0, 1, 2, 3,             /* pkt_len */
+		0, 1, 2, 3,             /* data_len, vlan_tci */
+		0xFF, 0xFF, 0xFF, 0xFF  /* hash */
+	};
+	const uint8x16_t shuf_odd = {
+		0xFF, 0xFF, 0xFF, 0xFF,
+		8, 9, 10, 11,
+		8, 9, 10, 11,
+		0xFF, 0xFF, 0xFF, 0xFF
+	};
+
+	/* reduce hdr_len from pkt_len and data_len */
+	const uint32x4_t len_adjust = {0, hdr_size, hdr_size, 0};
+
+	/* assert offset of data_len */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, data_len) !=
+		offsetof(struct rte_mbuf, rx_descriptor_fields1) + 8);
+
+	virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+		uint8x16_t v_hi = vreinterpretq_u8_u64(v_desc[i / 2].val[1]);
+		uint32x4_t v_value = vreinterpretq_u32_u8(vqtbl1q_u8(v_hi,
+				(i & 1) ? shuf_odd : shuf_even));
+
+		/* batch store into mbufs */
+		vst1q_u32((void *)rx_pkts[i]->rx_descriptor_fields1,
+			  vsubq_u32(v_value, len_adjust));
+	}
+
+	if (hw->has_rx_offload) {
+		virtio_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
+			char *addr = (char *)rx_pkts[i]->buf_addr +
+				RTE_PKTMBUF_HEADROOM - hdr_size;
+			virtio_vec_rx_offload(rx_pkts[i],
+					(struct virtio_net_hdr *)addr);
+		}
+	}
+
+	virtio_update_batch_stats(&rxvq->stats, rx_pkts[0]->pkt_len,
+			rx_pkts[1]->pkt_len, rx_pkts[2]->pkt_len,
+			rx_pkts[3]->pkt_len);
+
+	vq->vq_free_cnt += PACKED_BATCH_SIZE;
+
+	vq->vq_used_cons_idx += PACKED_BATCH_SIZE;
+	if (vq->vq_used_cons_idx >= vq->vq_nentries) {
+		vq->vq_used_cons_idx -= vq->vq_nentries;
+		vq->vq_packed.used_wrap_counter ^= 1;
+	}
+
+	return 0;
+}
+
+#endif /* _VIRTIO_RXTX_PACKED_NEON_H_ */
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#ifndef _RTE_SWCOPY_RAWDEV_H_
+#define _RTE_SWCOPY_RAWDEV_H_
+
+/**
+ * @file rte_swcopy_rawdev.h
+ *
+ * Definitions for using the software copy engine rawdev device driver
+ *
+ * The functions mirror those of rte_ioat_rawdev.h, so that an application
+ * can run its copy offload pipeline without DMA hardware, the copies being
+ * done by the service core the device's service is mapped to.
+ *
+ * @warning
+ * @b EXPERIMENTAL: these structures and APIs may change without prior notice
+ */
+
+#include <stdbool.h>
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_prefetch.h>
+#include <rte_rawdev.h>
+
+/** Name of the device driver */
+#define SWCOPY_PMD_RAWDEV_NAME rawdev_swcopy
+/** String reported as the device driver name by rte_rawdev_info_get() */
+#define SWCOPY_PMD_RAWDEV_NAME_STR "rawdev_swcopy"
+
+/**
+ * Configuration structure for a swcopy rawdev instance
+ *
+ * This structure is to be passed as the ".dev_private" parameter when
+ * calling the rte_rawdev_get_info() and rte_rawdev_configure() APIs on
+ * a swcopy rawdev instance.
+ */
+struct rte_swcopy_rawdev_config {
+	unsigned short ring_size;
+	/**
+	 * Copies of at least this many bytes are written with non-temporal
+	 * stores, which keeps them out of the cache of the copy lcore.
+	 * 0 disables the non-temporal stores, otherwise it must be at
+	 * least 64.
+	 */
+	unsigned int nt_threshold;
+	/**
+	 * Id of the service doing the copies, to be mapped to a service
+	 * lcore. Only set by rte_rawdev_info_get().
+	 */
+	uint32_t service_id;
+};
+
+/**
+ * @internal
+ * Copy descriptor, as read by the copy engine
+ */
+struct rte_swcopy_desc {
+	rte_iova_t src;
+	rte_iova_t dst;
+	uint32_t length;
+};
+
+/**
+ * @internal
+ * Completion handles of a copy, returned to the user
+ */
+struct rte_swcopy_hdls {
+	uintptr_t src;
+	uintptr_t dst;
+};
+
+/**
+ * @internal
+ * Structure representing a device instance
+ */
+struct rte_swcopy_rawdev {
+	struct rte_rawdev *rawdev;
+	const struct rte_memzone *desc_mz;
+
+	unsigned short ring_size;
+	struct rte_swcopy_desc *desc_ring;
+	struct rte_swcopy_hdls *hdls; /* completion handles for the user */
+
+	uint32_t service_id;
+	unsigned int nt_threshold;
+	bool iova_as_va;
+
+	/* written by the application */
+	unsigned short next_read __rte_cache_aligned;
+	unsigned short next_write;
+
+	/* some statistics for tracking, if added/changed update xstats fns*/
+	uint64_t enqueue_failed;
+	uint64_t enqueued;
+	uint64_t started;
+	uint64_t completed;
+
+	/* ring index up to which the copy engine may copy */
+	unsigned short doorbell __rte_cache_aligned;
+
+	/* written by the copy engine */
+	unsigned short done __rte_cache_aligned;
+	unsigned short next_copy;
+	uint64_t batches;
+};
+
+/**
+ * Enqueue a copy operation onto the swcopy device
+ *
+ * This queues up a copy operation to be performed by the copy engine, but
+ * does not let the engine begin that operation.
+ *
+ * @param dev_id
+ *   The rawdev device id of the swcopy instance
+ * @param src
+ *   The IOVA of the source buffer
+ * @param dst
+ *   The IOVA of the destination buffer
+ * @param length
+ *   The length of the data to be copied
+ * @param src_hdl
+ *   An opaque handle for the source data, to be returned when this operation
+ *   has been completed and the user polls for the completion details
+ * @param dst_hdl
+ *   An opaque handle for the destination data, to be returned when this
+ *   operation has been completed and the user polls for the completion details
+ * @param fence
+ *   Accepted for compatibility with rte_ioat_enqueue_copy(). The copy engine
+ *   performs the copies one after the other, so each one is always complete
+ *   before the next one begins
+ * @return
+ *   Number of operations enqueued, either 0 or 1
+ */
+static inline int
+rte_swcopy_enqueue_copy(int dev_id, rte_iova_t src, rte_iova_t dst,
+		unsigned int length, uintptr_t src_hdl, uintptr_t dst_hdl,
+		int fence)
+{
+	struct rte_swcopy_rawdev *sw = rte_rawdevs[dev_id].dev_private;
+	unsigned short read = sw->next_read;
+	unsigned short write = sw->next_write;
+	unsigned short mask = sw->ring_size - 1;
+	unsigned short space = mask + read - write;
+	struct rte_swcopy_desc *desc;
+
+	RTE_SET_USED(fence);
+
+	if (space == 0) {
+		sw->enqueue_failed++;
+		return 0;
+	}
+
+	sw->next_write = write + 1;
+	write &= mask;
+
+	desc = &sw->desc_ring[write];
+	desc->src = src;
+	desc->dst = dst;
+	desc->length = length;
+
+	sw->hdls[write].src = src_hdl;
+	sw->hdls[write].dst = dst_hdl;
+	rte_prefetch0(&sw->desc_ring[sw->next_write & mask]);
+
+	sw->enqueued++;
+	return 1;
+}
+
+/**
+ * Let the copy engine begin performing enqueued copy operations
+ *
+ * This API is the equivalent of rte_ioat_do_copies(): it makes the copy
+ * operations previously enqueued by rte_swcopy_enqueue_copy() visible to
+ * the copy engine.
+ *
+ * @param dev_id
+ *   The rawdev device id of the swcopy instance
+ */
+static inline void
+rte_swcopy_do_copies(int dev_id)
+{
+	struct rte_swcopy_rawdev *sw = rte_rawdevs[dev_id].dev_private;
+
+	__atomic_store_n(&sw->doorbell, sw->next_write, __ATOMIC_RELEASE);
+	sw->started = sw->enqueued;
+}
+
+/**
+ * Returns details of copy operations that have been completed
+ *
+ * Returns to the caller the user-provided "handles" for the copy operations
+ * which have been completed by the copy engine, and not already returned by
+ * a previous call to this API. Completions are returned in enqueue order.
+ *
+ * @param dev_id
+ *   The rawdev device id of the swcopy instance
+ * @param max_copies
+ *   The number of entries which can fit in the src_hdls and dst_hdls
+ *   arrays, i.e. max number of completed operations to report
+ * @param src_hdls
+ *   Array to hold the source handle parameters of the completed copies
+ * @param dst_hdls
+ *   Array to hold the destination handle parameters of the completed copies
+ * @return
+ *   Number of completed operations i.e. number of entries written to the
+ *   src_hdls and dst_hdls array parameters.
+ */
+static inline int
+rte_swcopy_completed_copies(int dev_id, uint8_t max_copies,
+		uintptr_t *src_hdls, uintptr_t *dst_hdls)
+{
+	struct rte_swcopy_rawdev *sw = rte_rawdevs[dev_id].dev_private;
+	unsigned short mask = (sw->ring_size - 1);
+	unsigned short read = sw->next_read;
+	unsigned short count;
+	int i;
+
+	count = __atomic_load_n(&sw->done, __ATOMIC_ACQUIRE) - read;
+	if (count > max_copies)
+		count = max_copies;
+
+	for (i = 0; i < count; i++, read++) {
+		src_hdls[i] = sw->hdls[read & mask].src;
+		dst_hdls[i] = sw->hdls[read & mask].dst;
+	}
+
+	sw->next_read = read;
+	sw->completed += count;
+	return count;
+}
+
+#endif /* _RTE_SWCOPY_RAWDEV_H_ */
@@ -0,0 +1,430 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <rte_bus_vdev.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_memcpy.h>
+#include <rte_pause.h>
+#include <rte_service_component.h>
+#include <rte_string_fns.h>
+#include <rte_vect.h>
+#include <rte_rawdev_pmd.h>
+
+#include "rte_swcopy_rawdev.h"
+
+RTE_LOG_REGISTER(swcopy_pmd_logtype, rawdev.swcopy, INFO);
+
+#define SWCOPY_PMD_LOG(level, fmt, args...) rte_log(RTE_LOG_ ## level, \
+	swcopy_pmd_logtype, "%s(): " fmt "\n", __func__, ##args)
+
+#define SWCOPY_PMD_DEBUG(fmt, args...)  SWCOPY_PMD_LOG(DEBUG, fmt, ## args)
+#define SWCOPY_PMD_INFO(fmt, args...)   SWCOPY_PMD_LOG(INFO, fmt, ## args)
+#define SWCOPY_PMD_ERR(fmt, args...)    SWCOPY_PMD_LOG(ERR, fmt, ## args)
+#define SWCOPY_PMD_WARN(fmt, args...)   SWCOPY_PMD_LOG(WARNING, fmt, ## args)
+
+#define DESC_SZ sizeof(struct rte_swcopy_desc)
+#define COMPLETION_SZ sizeof(struct rte_swcopy_hdls)
+
+/* copies done before the completions are published to the application */
+#define SWCOPY_BURST 32
+
+/* smallest copy worth using non-temporal stores for */
+#define SWCOPY_NT_THRESHOLD_MIN 64
+
+static inline void *
+swcopy_iova2virt(const struct rte_swcopy_rawdev *sw, rte_iova_t iova)
+{
+	if (sw->iova_as_va)
+		return (void *)(uintptr_t)iova;
+	return rte_mem_iova2virt(iova);
+}
+
+#ifdef RTE_ARCH_X86
+/*
+ * Copy with non-temporal stores to a 16B aligned destination, the
+ * unaligned head and tail being copied the usual way.
+ */
+static inline void
+swcopy_copy_nt(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+	uint32_t head = RTE_MIN((uint32_t)(-(uintptr_t)dst) & 15, len);
+	__m128i x0, x1, x2, x3;
+
+	rte_memcpy(dst, src, head);
+	dst += head;
+	src += head;
+	len -= head;
+
+	for (; len >= 64; len -= 64, dst += 64, src += 64) {
+		x0 = _mm_loadu_si128((const __m128i *)src);
+		x1 = _mm_loadu_si128((const __m128i *)(src + 16));
+		x2 = _mm_loadu_si128((const __m128i *)(src + 32));
+		x3 = _mm_loadu_si128((const __m128i *)(src + 48));
+		_mm_stream_si128((__m128i *)dst, x0);
+		_mm_stream_si128((__m128i *)(dst + 16), x1);
+		_mm_stream_si128((__m128i *)(dst + 32), x2);
+		_mm_stream_si128((__m128i *)(dst + 48), x3);
+	}
+	for (; len >= 16; len -= 16, dst += 16, src += 16) {
+		x0 = _mm_loadu_si128((const __m128i *)src);
+		_mm_stream_si128((__m128i *)dst, x0);
+	}
+
+	rte_memcpy(dst, src, len);
+}
+#endif
+
+static inline void
+swcopy_copy(const struct rte_swcopy_rawdev *sw,
+		const struct rte_swcopy_desc *desc)
+{
+	void *dst = swcopy_iova2virt(sw, desc->dst);
+	const void *src = swcopy_iova2virt(sw, desc->src);
+
+#ifdef RTE_ARCH_X86
+	if (sw->nt_threshold != 0 && desc->length >= sw->nt_threshold) {
+		swcopy_copy_nt(dst, src, desc->length);
+		return;
+	}
+#endif
+	rte_memcpy(dst, src, desc->length);
+}
+
+static int32_t
+swcopy_service_func(void *args)
+{
+	struct rte_swcopy_rawdev *sw = args;
+	unsigned short mask = sw->ring_size - 1;
+	unsigned short idx = sw->next_copy;
+	unsigned short end;
+	unsigned int n = 0;
+
+	end = __atomic_load_n(&sw->doorbell, __ATOMIC_ACQUIRE);
+	if (idx == end)
+		return -EAGAIN;
+
+	while (idx != end) {
+		rte_prefetch0(&sw->desc_ring[(idx + 1) & mask]);
+		swcopy_copy(sw, &sw->desc_ring[idx & mask]);
+		idx++;
+
+		if (++n == SWCOPY_BURST || idx == end) {
+			/* also orders the non-temporal stores */
+			rte_wmb();
+			__atomic_store_n(&sw->done, idx, __ATOMIC_RELEASE);
+			n = 0;
+		}
+	}
+
+	sw->next_copy = idx;
+	sw->batches++;
+	return 0;
+}
+
+static int
+swcopy_dev_configure(const struct rte_rawdev *dev, rte_rawdev_obj_t config)
+{
+	struct rte_swcopy_rawdev_config *params = config;
+	struct rte_swcopy_rawdev *sw = dev->dev_private;
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+
+	if (dev->started)
+		return -EBUSY;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	if (params->ring_size > 4096 || params->ring_size < 64 ||
+			!rte_is_power_of_2(params->ring_size))
+		return -EINVAL;
+
+	if (params->nt_threshold != 0 &&
+			params->nt_threshold < SWCOPY_NT_THRESHOLD_MIN)
+		return -EINVAL;
+
+	sw->ring_size = params->ring_size;
+	sw->nt_threshold = params->nt_threshold;
+	if (sw->desc_ring != NULL) {
+		rte_memzone_free(sw->desc_mz);
+		sw->desc_ring = NULL;
+		sw->desc_mz = NULL;
+	}
+
+	/* allocate one block of memory for both descriptors
+	 * and completion handles.
+	 */
+	snprintf(mz_name, sizeof(mz_name), "rawdev%u_desc_ring", dev->dev_id);
+	sw->desc_mz = rte_memzone_reserve(mz_name,
+			(DESC_SZ + COMPLETION_SZ) * sw->ring_size,
+			dev->socket_id, 0);
+	if (sw->desc_mz == NULL)
+		return -ENOMEM;
+	sw->desc_ring = sw->desc_mz->addr;
+	sw->hdls = (void *)&sw->desc_ring[sw->ring_size];
+
+	return 0;
+}
+
+static int
+swcopy_dev_start(struct rte_rawdev *dev)
+{
+	struct rte_swcopy_rawdev *sw = dev->dev_private;
+
+	if (sw->ring_size == 0 || sw->desc_ring == NULL)
+		return -EBUSY;
+
+	sw->next_read = 0;
+	sw->next_write = 0;
+	sw->doorbell = 0;
+	sw->done = 0;
+	sw->next_copy = 0;
+
+	rte_service_component_runstate_set(sw->service_id, 1);
+
+	/* check a service core is mapped to this service */
+	if (!rte_service_runstate_get(sw->service_id)) {
+		SWCOPY_PMD_ERR("No service core enabled on service %s",
+				rte_service_get_name(sw->service_id));
+		rte_service_component_runstate_set(sw->service_id, 0);
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+static void
+swcopy_dev_stop(struct rte_rawdev *dev)
+{
+	struct rte_swcopy_rawdev *sw = dev->dev_private;
+
+	rte_service_component_runstate_set(sw->service_id, 0);
+	while (rte_service_may_be_active(sw->service_id) == 1)
+		rte_pause();
+}
+
+static void
+swcopy_dev_info_get(struct rte_rawdev *dev, rte_rawdev_obj_t dev_info)
+{
+	struct rte_swcopy_rawdev_config *cfg = dev_info;
+	struct rte_swcopy_rawdev *sw = dev->dev_private;
+
+	if (cfg != NULL) {
+		cfg->ring_size = sw->ring_size;
+		cfg->nt_threshold = sw->nt_threshold;
+		cfg->service_id = sw->service_id;
+	}
+}
+
+static const char * const xstat_names[] = {
+		"failed_enqueues", "successful_enqueues",
+		"copies_started", "copies_completed",
+		"engine_batches"
+};
+
+static int
+swcopy_xstats_get(const struct rte_rawdev *dev, const unsigned int ids[],
+		uint64_t values[], unsigned int n)
+{
+	const struct rte_swcopy_rawdev *sw = dev->dev_private;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		switch (ids[i]) {
+		case 0: values[i] = sw->enqueue_failed; break;
+		case 1: values[i] = sw->enqueued; break;
+		case 2: values[i] = sw->started; break;
+		case 3: values[i] = sw->completed; break;
+		case 4: values[i] = sw->batches; break;
+		default: values[i] = 0; break;
+		}
+	}
+	return n;
+}
+
+static int
+swcopy_xstats_get_names(const struct rte_rawdev *dev,
+		struct rte_rawdev_xstats_name *names,
+		unsigned int size)
+{
+	unsigned int i;
+
+	RTE_SET_USED(dev);
+	if (size < RTE_DIM(xstat_names))
+		return RTE_DIM(xstat_names);
+
+	for (i = 0; i < RTE_DIM(xstat_names); i++)
+		strlcpy(names[i].name, xstat_names[i], sizeof(names[i]));
+
+	return RTE_DIM(xstat_names);
+}
+
+static int
+swcopy_xstats_reset(struct rte_rawdev *dev, const uint32_t *ids,
+		uint32_t nb_ids)
+{
+	struct rte_swcopy_rawdev *sw = dev->dev_private;
+	unsigned int i;
+
+	if (!ids) {
+		sw->enqueue_failed = 0;
+		sw->enqueued = 0;
+		sw->started = 0;
+		sw->completed = 0;
+		sw->batches = 0;
+		return 0;
+	}
+
+	for (i = 0; i < nb_ids; i++) {
+		switch (ids[i]) {
+		case 0:
+			sw->enqueue_failed = 0;
+			break;
+		case 1:
+			sw->enqueued = 0;
+			break;
+		case 2:
+			sw->started = 0;
+			break;
+		case 3:
+			sw->completed = 0;
+			break;
+		case 4:
+			sw->batches = 0;
+			break;
+		default:
+			SWCOPY_PMD_WARN("Invalid xstat id - cannot reset value");
+			break;
+		}
+	}
+
+	return 0;
+}
+
+extern int swcopy_rawdev_test(uint16_t dev_id);
+
+static int
+swcopy_rawdev_create(const char *name, struct rte_vdev_device *dev)
+{
+	static const struct rte_rawdev_ops swcopy_rawdev_ops = {
+			.dev_configure = swcopy_dev_configure,
+			.dev_start = swcopy_dev_start,
+			.dev_stop = swcopy_dev_stop,
+			.dev_info_get = swcopy_dev_info_get,
+			.xstats_get = swcopy_xstats_get,
+			.xstats_get_names = swcopy_xstats_get_names,
+			.xstats_reset = swcopy_xstats_reset,
+			.dev_selftest = swcopy_rawdev_test,
+	};
+
+	struct rte_service_spec service;
+	struct rte_rawdev *rawdev = NULL;
+	struct rte_swcopy_rawdev *sw = NULL;
+	int socket_id = rte_socket_id();
+	int ret = 0;
+
+	if (!name) {
+		SWCOPY_PMD_ERR("Invalid name of the device!");
+		ret = -EINVAL;
+		goto cleanup;
+	}
+
+	/* Allocate device structure */
+	rawdev = rte_rawdev_pmd_allocate(name,
+			sizeof(struct rte_swcopy_rawdev), socket_id);
+	if (rawdev == NULL) {
+		SWCOPY_PMD_ERR("Unable to allocate raw device");
+		ret = -ENOMEM;
+		goto cleanup;
+	}
+
+	rawdev->dev_ops = &swcopy_rawdev_ops;
+	rawdev->device = &dev->device;
+	rawdev->driver_name = SWCOPY_PMD_RAWDEV_NAME_STR;
+
+	sw = rawdev->dev_private;
+	sw->rawdev = rawdev;
+	sw->iova_as_va = rte_eal_iova_mode() == RTE_IOVA_VA;
+	if (!sw->iova_as_va)
+		SWCOPY_PMD_INFO("%s: IOVA as PA mode, copies translate the addresses",
+				name);
+
+	/* register the copy engine with EAL */
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name), "%s_service", name);
+	service.socket_id = socket_id;
+	service.callback = swcopy_service_func;
+	service.callback_userdata = sw;
+	if (rte_service_component_register(&service, &sw->service_id) != 0) {
+		SWCOPY_PMD_ERR("Unable to register service for %s", name);
+		ret = -ENOEXEC;
+		goto cleanup;
+	}
+
+	return 0;
+
+cleanup:
+	if (rawdev)
+		rte_rawdev_pmd_release(rawdev);
+
+	return ret;
+}
+
+static int
+swcopy_rawdev_destroy(const char *name)
+{
+	int ret;
+	struct rte_rawdev *rdev;
+
+	if (!name) {
+		SWCOPY_PMD_ERR("Invalid device name");
+		return -EINVAL;
+	}
+
+	rdev = rte_rawdev_pmd_get_named_dev(name);
+	if (!rdev) {
+		SWCOPY_PMD_ERR("Invalid device name (%s)", name);
+		return -EINVAL;
+	}
+
+	if (rdev->dev_private != NULL) {
+		struct rte_swcopy_rawdev *sw = rdev->dev_private;
+		rte_service_component_unregister(sw->service_id);
+		rte_memzone_free(sw->desc_mz);
+	}
+
+	/* rte_rawdev_close is called, and dev_private freed, by pmd_release */
+	ret = rte_rawdev_pmd_release(rdev);
+	if (ret)
+		SWCOPY_PMD_DEBUG("Device cleanup failed");
+
+	return 0;
+}
+
+static int
+swcopy_rawdev_probe(struct rte_vdev_device *dev)
+{
+	const char *name = rte_vdev_device_name(dev);
+
+	SWCOPY_PMD_INFO("Init %s on NUMA node %d", name, rte_socket_id());
+
+	return swcopy_rawdev_create(name, dev);
+}
+
+static int
+swcopy_rawdev_remove(struct rte_vdev_device *dev)
+{
+	const char *name = rte_vdev_device_name(dev);
+
+	SWCOPY_PMD_INFO("Closing %s", name);
+
+	return swcopy_rawdev_destroy(name);
+}
+
+static struct rte_vdev_driver swcopy_pmd_drv = {
+	.probe = swcopy_rawdev_probe,
+	.remove = swcopy_rawdev_remove,
+};
+
+RTE_PMD_REGISTER_VDEV(SWCOPY_PMD_RAWDEV_NAME, swcopy_pmd_drv);
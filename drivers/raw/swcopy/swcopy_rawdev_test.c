@@ -0,0 +1,420 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <inttypes.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+#include <rte_service.h>
+#include "rte_rawdev.h"
+#include "rte_swcopy_rawdev.h"
+
+int swcopy_rawdev_test(uint16_t dev_id); /* pre-define to keep compiler happy */
+
+#define SWCOPY_TEST_RINGSIZE 512
+#define SWCOPY_TEST_NT_THRESHOLD 1024
+#define SWCOPY_TEST_TIMEOUT_US 100000
+
+static struct rte_mempool *pool;
+static uint32_t service_id;
+
+/*
+ * Wait for the completion of up to max_copies copies, running the copy
+ * engine on this lcore.
+ */
+static int
+wait_completed_copies(int dev_id, uint8_t max_copies,
+		uintptr_t *src_hdls, uintptr_t *dst_hdls)
+{
+	uint64_t timeout = rte_get_timer_cycles() +
+			rte_get_timer_hz() / 1000000 * SWCOPY_TEST_TIMEOUT_US;
+	int n = 0;
+
+	do {
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+		n += rte_swcopy_completed_copies(dev_id, max_copies - n,
+				&src_hdls[n], &dst_hdls[n]);
+	} while (n < max_copies && rte_get_timer_cycles() < timeout);
+
+	return n;
+}
+
+static int
+test_enqueue_copies(int dev_id, unsigned int length)
+{
+	unsigned int i;
+
+	do {
+		struct rte_mbuf *src, *dst;
+		char *src_data, *dst_data;
+		struct rte_mbuf *completed[2] = {0};
+
+		/* test doing a single copy */
+		src = rte_pktmbuf_alloc(pool);
+		dst = rte_pktmbuf_alloc(pool);
+		src->data_len = src->pkt_len = length;
+		dst->data_len = dst->pkt_len = length;
+		src_data = rte_pktmbuf_mtod(src, char *);
+		dst_data = rte_pktmbuf_mtod(dst, char *);
+
+		for (i = 0; i < length; i++)
+			src_data[i] = rand() & 0xFF;
+
+		if (rte_swcopy_enqueue_copy(dev_id,
+				src->buf_iova + src->data_off,
+				dst->buf_iova + dst->data_off,
+				length,
+				(uintptr_t)src,
+				(uintptr_t)dst,
+				0 /* no fence */) != 1) {
+			printf("Error with rte_swcopy_enqueue_copy\n");
+			return -1;
+		}
+
+		/* nothing is copied before the doorbell */
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+		if (rte_swcopy_completed_copies(dev_id, 1, (void *)&completed[0],
+				(void *)&completed[1]) != 0) {
+			printf("Error, copy completed before rte_swcopy_do_copies\n");
+			return -1;
+		}
+		rte_swcopy_do_copies(dev_id);
+
+		if (wait_completed_copies(dev_id, 1, (void *)&completed[0],
+				(void *)&completed[1]) != 1) {
+			printf("Error with rte_swcopy_completed_copies\n");
+			return -1;
+		}
+		if (completed[0] != src || completed[1] != dst) {
+			printf("Error with completions: got (%p, %p), not (%p,%p)\n",
+					completed[0], completed[1], src, dst);
+			return -1;
+		}
+
+		for (i = 0; i < length; i++)
+			if (dst_data[i] != src_data[i]) {
+				printf("Data mismatch at char %u\n", i);
+				return -1;
+			}
+		rte_pktmbuf_free(src);
+		rte_pktmbuf_free(dst);
+	} while (0);
+
+	/* test doing multiple copies */
+	do {
+		struct rte_mbuf *srcs[32], *dsts[32];
+		struct rte_mbuf *completed_src[64];
+		struct rte_mbuf *completed_dst[64];
+		unsigned int j;
+
+		for (i = 0; i < RTE_DIM(srcs); i++) {
+			char *src_data;
+
+			srcs[i] = rte_pktmbuf_alloc(pool);
+			dsts[i] = rte_pktmbuf_alloc(pool);
+			srcs[i]->data_len = srcs[i]->pkt_len = length;
+			dsts[i]->data_len = dsts[i]->pkt_len = length;
+			src_data = rte_pktmbuf_mtod(srcs[i], char *);
+
+			for (j = 0; j < length; j++)
+				src_data[j] = rand() & 0xFF;
+
+			if (rte_swcopy_enqueue_copy(dev_id,
+					srcs[i]->buf_iova + srcs[i]->data_off,
+					dsts[i]->buf_iova + dsts[i]->data_off,
+					length,
+					(uintptr_t)srcs[i],
+					(uintptr_t)dsts[i],
+					0 /* nofence */) != 1) {
+				printf("Error with rte_swcopy_enqueue_copy for buffer %u\n",
+						i);
+				return -1;
+			}
+		}
+		rte_swcopy_do_copies(dev_id);
+
+		if (wait_completed_copies(dev_id, RTE_DIM(srcs),
+				(void *)completed_src,
+				(void *)completed_dst) != RTE_DIM(srcs)) {
+			printf("Error with rte_swcopy_completed_copies\n");
+			return -1;
+		}
+		for (i = 0; i < RTE_DIM(srcs); i++) {
+			char *src_data, *dst_data;
+
+			if (completed_src[i] != srcs[i]) {
+				printf("Error with source pointer %u\n", i);
+				return -1;
+			}
+			if (completed_dst[i] != dsts[i]) {
+				printf("Error with dest pointer %u\n", i);
+				return -1;
+			}
+
+			src_data = rte_pktmbuf_mtod(srcs[i], char *);
+			dst_data = rte_pktmbuf_mtod(dsts[i], char *);
+			for (j = 0; j < length; j++)
+				if (src_data[j] != dst_data[j]) {
+					printf("Error with copy of packet %u, byte %u\n",
+							i, j);
+					return -1;
+				}
+			rte_pktmbuf_free(srcs[i]);
+			rte_pktmbuf_free(dsts[i]);
+		}
+
+	} while (0);
+
+	return 0;
+}
+
+static int
+test_ring_full(int dev_id)
+{
+	uintptr_t src_hdls[64], dst_hdls[64];
+	struct rte_mbuf *src, *dst;
+	unsigned int i, n = 0;
+
+	src = rte_pktmbuf_alloc(pool);
+	dst = rte_pktmbuf_alloc(pool);
+
+	/* the ring holds one copy less than its size */
+	for (i = 0; i < SWCOPY_TEST_RINGSIZE; i++)
+		n += rte_swcopy_enqueue_copy(dev_id,
+				rte_pktmbuf_iova(src), rte_pktmbuf_iova(dst),
+				64, i, i, 0);
+	if (n != SWCOPY_TEST_RINGSIZE - 1) {
+		printf("Error, %u copies enqueued on a ring of %d\n",
+				n, SWCOPY_TEST_RINGSIZE);
+		return -1;
+	}
+	rte_swcopy_do_copies(dev_id);
+
+	for (i = 0; i < n; i += RTE_DIM(src_hdls)) {
+		unsigned int j, burst = RTE_MIN(n - i, RTE_DIM(src_hdls));
+
+		if (wait_completed_copies(dev_id, burst, src_hdls,
+				dst_hdls) != (int)burst) {
+			printf("Error with rte_swcopy_completed_copies\n");
+			return -1;
+		}
+		for (j = 0; j < burst; j++)
+			if (src_hdls[j] != i + j || dst_hdls[j] != i + j) {
+				printf("Error, copy %u completed out of order\n",
+						i + j);
+				return -1;
+			}
+	}
+
+	rte_pktmbuf_free(src);
+	rte_pktmbuf_free(dst);
+	return 0;
+}
+
+/*
+ * Compare the cost, on the application lcore, of copying a burst inline
+ * with handing it to the copy engine running on a service lcore.
+ */
+static int
+test_copy_perf(int dev_id)
+{
+	static const unsigned int lengths[] = { 64, 256, 1024, 2048 };
+	const unsigned int nb_copies = 8192, burst = 32, max_len = 2048;
+	uintptr_t src_hdls[32], dst_hdls[32];
+	unsigned int lcore, i, j, k, done;
+	uint64_t start, inline_cycles, offload_cycles;
+	rte_iova_t src_iova, dst_iova;
+	uint8_t *src, *dst;
+	int ret = -1;
+
+	lcore = rte_get_next_lcore(-1, 1, 0);
+	if (lcore >= RTE_MAX_LCORE) {
+		printf("No spare lcore for the copy engine, skipping perf test\n");
+		return 0;
+	}
+
+	src = rte_malloc(NULL, (size_t)burst * max_len, RTE_CACHE_LINE_SIZE);
+	dst = rte_malloc(NULL, (size_t)burst * max_len, RTE_CACHE_LINE_SIZE);
+	if (src == NULL || dst == NULL) {
+		printf("Error allocating copy buffers\n");
+		goto out;
+	}
+	src_iova = rte_malloc_virt2iova(src);
+	dst_iova = rte_malloc_virt2iova(dst);
+
+	if (rte_service_lcore_add(lcore) != 0 ||
+			rte_service_map_lcore_set(service_id, lcore, 1) != 0 ||
+			rte_service_lcore_start(lcore) != 0) {
+		printf("Error starting service lcore %u\n", lcore);
+		goto out_lcore;
+	}
+
+	for (k = 0; k < RTE_DIM(lengths); k++) {
+		unsigned int len = lengths[k];
+
+		start = rte_rdtsc_precise();
+		for (i = 0; i < nb_copies; i += burst)
+			for (j = 0; j < burst; j++)
+				rte_memcpy(dst + j * max_len,
+						src + j * max_len, len);
+		inline_cycles = rte_rdtsc_precise() - start;
+
+		start = rte_rdtsc_precise();
+		for (i = 0, done = 0; i < nb_copies; i += burst) {
+			for (j = 0; j < burst; j++)
+				while (rte_swcopy_enqueue_copy(dev_id,
+						src_iova + j * max_len,
+						dst_iova + j * max_len,
+						len, 0, 0, 0) != 1) {
+					rte_swcopy_do_copies(dev_id);
+					done += rte_swcopy_completed_copies(
+						dev_id, burst, src_hdls,
+						dst_hdls);
+				}
+			rte_swcopy_do_copies(dev_id);
+			done += rte_swcopy_completed_copies(dev_id, burst,
+					src_hdls, dst_hdls);
+		}
+		while (done < nb_copies)
+			done += rte_swcopy_completed_copies(dev_id, burst,
+					src_hdls, dst_hdls);
+		offload_cycles = rte_rdtsc_precise() - start;
+
+		printf("%4u B copies: inline %6.1f, offloaded %6.1f cycles/copy on the application lcore\n",
+				len, (double)inline_cycles / nb_copies,
+				(double)offload_cycles / nb_copies);
+	}
+	ret = 0;
+
+out_lcore:
+	rte_service_map_lcore_set(service_id, lcore, 0);
+	rte_service_lcore_stop(lcore);
+	rte_eal_wait_lcore(lcore);
+	rte_service_lcore_del(lcore);
+out:
+	rte_free(src);
+	rte_free(dst);
+	return ret;
+}
+
+int
+swcopy_rawdev_test(uint16_t dev_id)
+{
+	struct rte_swcopy_rawdev_config p = { .ring_size = -1 };
+	struct rte_rawdev_info info = { .dev_private = &p };
+	struct rte_rawdev_xstats_name *snames = NULL;
+	uint64_t *stats = NULL;
+	unsigned int *ids = NULL;
+	unsigned int nb_xstats;
+	unsigned int i;
+
+	p.ring_size = SWCOPY_TEST_RINGSIZE;
+	p.nt_threshold = 16;
+	if (rte_rawdev_configure(dev_id, &info) == 0) {
+		printf("Error, nt threshold %u accepted\n", p.nt_threshold);
+		return -1;
+	}
+
+	p.nt_threshold = SWCOPY_TEST_NT_THRESHOLD;
+	if (rte_rawdev_configure(dev_id, &info) != 0) {
+		printf("Error with rte_rawdev_configure()\n");
+		return -1;
+	}
+	rte_rawdev_info_get(dev_id, &info);
+	if (p.ring_size != SWCOPY_TEST_RINGSIZE ||
+			p.nt_threshold != SWCOPY_TEST_NT_THRESHOLD) {
+		printf("Error, ring size %d, nt threshold %u not as configured\n",
+				(int)p.ring_size, p.nt_threshold);
+		return -1;
+	}
+	service_id = p.service_id;
+
+	/* the copy engine is run on this lcore by the functional tests */
+	rte_service_runstate_set(service_id, 1);
+	rte_service_set_runstate_mapped_check(service_id, 0);
+
+	if (rte_rawdev_start(dev_id) != 0) {
+		printf("Error with rte_rawdev_start()\n");
+		return -1;
+	}
+
+	pool = rte_pktmbuf_pool_create("TEST_SWCOPY_POOL",
+			256, /* n == num elements */
+			32,  /* cache size */
+			0,   /* priv size */
+			2048, /* data room size */
+			info.socket_id);
+	if (pool == NULL) {
+		printf("Error with mempool creation\n");
+		goto err;
+	}
+
+	/* allocate memory for xstats names and values */
+	nb_xstats = rte_rawdev_xstats_names_get(dev_id, NULL, 0);
+
+	snames = malloc(sizeof(*snames) * nb_xstats);
+	if (snames == NULL) {
+		printf("Error allocating xstat names memory\n");
+		goto err;
+	}
+	rte_rawdev_xstats_names_get(dev_id, snames, nb_xstats);
+
+	ids = malloc(sizeof(*ids) * nb_xstats);
+	if (ids == NULL) {
+		printf("Error allocating xstat ids memory\n");
+		goto err;
+	}
+	for (i = 0; i < nb_xstats; i++)
+		ids[i] = i;
+
+	stats = malloc(sizeof(*stats) * nb_xstats);
+	if (stats == NULL) {
+		printf("Error allocating xstat memory\n");
+		goto err;
+	}
+
+	/* run the test cases, with and without non-temporal stores */
+	for (i = 0; i < 100; i++) {
+		unsigned int j;
+
+		if (test_enqueue_copies(dev_id, i & 1 ? 1500 : 60) != 0)
+			goto err;
+
+		rte_rawdev_xstats_get(dev_id, ids, stats, nb_xstats);
+		for (j = 0; j < nb_xstats; j++)
+			printf("%s: %"PRIu64"   ", snames[j].name, stats[j]);
+		printf("\r");
+	}
+	printf("\n");
+
+	if (test_ring_full(dev_id) != 0)
+		goto err;
+
+	rte_service_set_runstate_mapped_check(service_id, 1);
+	if (test_copy_perf(dev_id) != 0)
+		goto err;
+
+	rte_rawdev_stop(dev_id);
+	if (rte_rawdev_xstats_reset(dev_id, NULL, 0) != 0) {
+		printf("Error resetting xstat values\n");
+		goto err;
+	}
+
+	rte_mempool_free(pool);
+	free(snames);
+	free(stats);
+	free(ids);
+	return 0;
+
+err:
+	rte_rawdev_stop(dev_id);
+	rte_rawdev_xstats_reset(dev_id, NULL, 0);
+	rte_mempool_free(pool);
+	free(snames);
+	free(stats);
+	free(ids);
+	return -1;
+}
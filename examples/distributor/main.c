@@ -34,6 +34,7 @@
 
 /* mask of enabled ports */
 static uint32_t enabled_port_mask;
+static int flow_affinity;
 volatile uint8_t quit_signal;
 volatile uint8_t quit_signal_rx;
 volatile uint8_t quit_signal_dist;
@@ -633,8 +634,10 @@ init_power_library(void)
 static void
 print_usage(const char *prgname)
 {
-	printf("%s [EAL options] -- -p PORTMASK\n"
-			"  -p PORTMASK: hexadecimal bitmask of ports to configure\n",
+	printf("%s [EAL options] -- -p PORTMASK [--flow-affinity]\n"
+			"  -p PORTMASK: hexadecimal bitmask of ports to configure\n"
+			"  --flow-affinity: keep flows on a worker while their"
+			" packets are in flight\n",
 			prgname);
 }
 
@@ -664,6 +667,7 @@ parse_args(int argc, char **argv)
 	int option_index;
 	char *prgname = argv[0];
 	static struct option lgopts[] = {
+		{"flow-affinity", 0, &flow_affinity, 1},
 		{NULL, 0, 0, 0}
 	};
 
@@ -683,6 +687,10 @@ parse_args(int argc, char **argv)
 			}
 			break;
 
+		/* long options */
+		case 0:
+			break;
+
 		default:
 			print_usage(prgname);
 			return -1;
@@ -783,6 +791,9 @@ main(int argc, char *argv[])
 			RTE_DIST_ALG_BURST);
 	if (d == NULL)
 		rte_exit(EXIT_FAILURE, "Cannot create distributor\n");
+	if (flow_affinity && rte_distributor_flow_mode_set(d,
+			RTE_DIST_FLOW_AFFINITY) != 0)
+		rte_exit(EXIT_FAILURE, "Cannot set distributor flow mode\n");
 
 	/*
 	 * scheduler ring is read by the transmitter core, and written to
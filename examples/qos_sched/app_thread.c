@@ -58,6 +58,39 @@ get_pkt_sched(struct rte_mbuf *m, uint32_t *subport, uint32_t *pipe,
 	return 0;
 }
 
+/* Push packets to the input ring of their subport */
+static inline void
+app_subport_input(struct thread_conf *conf, struct rte_mbuf **mbufs,
+		uint32_t nb_pkt)
+{
+	struct rte_mbuf *sp_mbufs[MAX_SCHED_SUBPORTS][nb_pkt];
+	uint32_t sp_nb_pkt[MAX_SCHED_SUBPORTS];
+	uint32_t subport, pipe, traffic_class, queue;
+	uint32_t i, n;
+
+	memset(sp_nb_pkt, 0, sizeof(sp_nb_pkt));
+
+	for (i = 0; i < nb_pkt; i++) {
+		rte_sched_port_pkt_read_tree_path(conf->sched_port, mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		sp_mbufs[subport][sp_nb_pkt[subport]++] = mbufs[i];
+	}
+
+	for (subport = 0; subport < conf->n_subports; subport++) {
+		if (sp_nb_pkt[subport] == 0)
+			continue;
+
+		n = rte_sched_subport_input(conf->sched_port, subport,
+				sp_mbufs[subport], sp_nb_pkt[subport]);
+
+		for (i = n; i < sp_nb_pkt[subport]; i++) {
+			rte_pktmbuf_free(sp_mbufs[subport][i]);
+
+			APP_STATS_ADD(conf->stat.nb_drop, 1);
+		}
+	}
+}
+
 void
 app_rx_thread(struct thread_conf **confs)
 {
@@ -89,7 +122,9 @@ app_rx_thread(struct thread_conf **confs)
 						(enum rte_color) color);
 			}
 
-			if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_ring,
+			if (conf->n_subports != 0)
+				app_subport_input(conf, rx_mbufs, nb_rx);
+			else if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_ring,
 					(void **)rx_mbufs, nb_rx, NULL) == 0)) {
 				for(i = 0; i < nb_rx; i++) {
 					rte_pktmbuf_free(rx_mbufs[i]);
@@ -223,6 +258,39 @@ app_worker_thread(struct thread_conf **confs)
 	}
 }
 
+/*
+ * Subport parallel mode: each worker lcore enqueues into and dequeues
+ * from its own subports only, the input rings are filled by RX.
+ */
+void
+app_subport_worker_thread(struct thread_conf **confs)
+{
+	struct rte_mbuf *mbufs[burst_conf.qos_dequeue];
+	struct thread_conf *conf;
+	int conf_idx = 0;
+
+	while ((conf = confs[conf_idx])) {
+		uint32_t i, nb_pkt;
+
+		for (i = 0; i < conf->n_subports; i++) {
+			nb_pkt = rte_sched_subport_dequeue(conf->sched_port,
+					conf->subport_id[i], mbufs,
+					burst_conf.qos_dequeue);
+			if (likely(nb_pkt > 0)) {
+				APP_STATS_ADD(conf->stat.nb_rx, nb_pkt);
+
+				while (rte_ring_mp_enqueue_bulk(conf->tx_ring,
+						(void **)mbufs, nb_pkt, NULL) == 0)
+					; /* empty body */
+			}
+		}
+
+		conf_idx++;
+		if (confs[conf_idx] == NULL)
+			conf_idx = 0;
+	}
+}
+
 
 void
 app_mixed_thread(struct thread_conf **confs)
@@ -66,6 +66,9 @@ static const char usage[] =
 	"           B = TX host threshold (default value is %u)                         \n"
 	"           C = TX write-back threshold (default value is %u)                   \n"
 	"    --cfg FILE : profile configuration to load                                 \n"
+	"    --swt \"LCORE, ...\" : Extra worker lcores for the preceding pfc, which   \n"
+	"           needs a TX LCORE; its subports are spread over its WT LCORE and    \n"
+	"           these lcores, which schedule them in parallel                      \n"
 ;
 
 /* display usage */
@@ -279,6 +282,50 @@ app_parse_flow_conf(const char *conf_str)
 	return 0;
 }
 
+static int
+app_parse_swt_conf(const char *conf_str)
+{
+	int ret, i;
+	uint32_t vals[MAX_SUBPORT_WT_LCORES];
+	struct flow_conf *pconf;
+
+	if (nb_pfc == 0) {
+		RTE_LOG(ERR, APP, "subport worker lcores need a pfc first\n");
+		return -1;
+	}
+
+	pconf = &qos_conf[nb_pfc - 1];
+	if (pconf->n_swt_cores != 0) {
+		RTE_LOG(ERR, APP, "pfc %u: subport worker lcores set already\n",
+				nb_pfc - 1);
+		return -1;
+	}
+	if (pconf->tx_core == pconf->wt_core) {
+		RTE_LOG(ERR, APP, "pfc %u: subport workers need a TX lcore\n",
+				nb_pfc - 1);
+		return -1;
+	}
+
+	ret = app_parse_opt_vals(conf_str, ',', MAX_SUBPORT_WT_LCORES, vals);
+	if (ret < 1)
+		return -1;
+
+	for (i = 0; i < ret; i++) {
+		if (vals[i] == pconf->rx_core || vals[i] == pconf->wt_core ||
+				vals[i] == pconf->tx_core) {
+			RTE_LOG(ERR, APP, "pfc %u: lcore %u is used already\n",
+					nb_pfc - 1, vals[i]);
+			return -1;
+		}
+
+		pconf->swt_core[i] = vals[i];
+		app_used_core_mask |= 1lu << vals[i];
+	}
+	pconf->n_swt_cores = ret;
+
+	return 0;
+}
+
 static int
 app_parse_burst_conf(const char *conf_str)
 {
@@ -308,7 +355,7 @@ app_parse_args(int argc, char **argv)
 	int option_index;
 	const char *optname;
 	char *prgname = argv[0];
-	uint32_t i, nb_lcores;
+	uint32_t i, j, nb_lcores;
 
 	static struct option lgopts[] = {
 		{ "pfc", 1, 0, 0 },
@@ -319,6 +366,7 @@ app_parse_args(int argc, char **argv)
 		{ "rth", 1, 0, 0 },
 		{ "tth", 1, 0, 0 },
 		{ "cfg", 1, 0, 0 },
+		{ "swt", 1, 0, 0 },
 		{ NULL,  0, 0, 0 }
 	};
 
@@ -400,6 +448,14 @@ app_parse_args(int argc, char **argv)
 					cfg_profile = optarg;
 					break;
 				}
+				if (str_is(optname, "swt")) {
+					ret = app_parse_swt_conf(optarg);
+					if (ret) {
+						RTE_LOG(ERR, APP, "Invalid subport worker configuration %s\n", optarg);
+						return -1;
+					}
+					break;
+				}
 				break;
 
 			default:
@@ -445,6 +501,13 @@ app_parse_args(int argc, char **argv)
 					qos_conf[i].wt_core);
 			return -1;
 		}
+		for (j = 0; j < qos_conf[i].n_swt_cores; j++) {
+			if (qos_conf[i].swt_core[j] >= nb_lcores) {
+				RTE_LOG(ERR, APP, "pfc %u: invalid subport WT lcore index %u\n",
+						i + 1, qos_conf[i].swt_core[j]);
+				return -1;
+			}
+		}
 		uint32_t rx_sock = rte_lcore_to_socket_id(qos_conf[i].rx_core);
 		uint32_t wt_sock = rte_lcore_to_socket_id(qos_conf[i].wt_core);
 		if (rx_sock != wt_sock) {
@@ -343,6 +343,34 @@ app_init_sched_port(uint32_t portid, uint32_t socketid)
 	return port;
 }
 
+/* Spread the subports over the WT lcore and the subport WT lcores */
+static void
+app_init_subport_workers(struct flow_conf *conf)
+{
+	uint32_t n_workers = conf->n_swt_cores + 1;
+	uint32_t subport, w;
+	struct thread_conf *thread;
+	int err;
+
+	if (n_workers > port_params.n_subports_per_port)
+		rte_exit(EXIT_FAILURE, "More subport WT lcores than subports\n");
+
+	for (subport = 0; subport < port_params.n_subports_per_port; subport++) {
+		err = rte_sched_subport_input_config(conf->sched_port, subport,
+				ring_conf.ring_size);
+		if (err) {
+			rte_exit(EXIT_FAILURE, "Unable to config sched subport %u input, err=%d\n",
+					subport, err);
+		}
+
+		w = subport % n_workers;
+		thread = (w == 0) ? &conf->wt_thread : &conf->swt_thread[w - 1];
+		thread->subport_id[thread->n_subports++] = subport;
+	}
+
+	conf->rx_thread.n_subports = port_params.n_subports_per_port;
+}
+
 static int
 app_load_cfg_profile(const char *profile)
 {
@@ -387,11 +415,13 @@ int app_init(void)
 		else
 			qos_conf[i].rx_ring = ring;
 
+		/* several subport workers write to the TX ring */
 		snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u", i, qos_conf[i].tx_core);
 		ring = rte_ring_lookup(ring_name);
 		if (ring == NULL)
 			qos_conf[i].tx_ring = rte_ring_create(ring_name, ring_conf.ring_size,
-				socket, RING_F_SP_ENQ | RING_F_SC_DEQ);
+				socket, qos_conf[i].n_swt_cores ?
+				RING_F_SC_DEQ : RING_F_SP_ENQ | RING_F_SC_DEQ);
 		else
 			qos_conf[i].tx_ring = ring;
 
@@ -409,6 +439,8 @@ int app_init(void)
 		app_init_port(qos_conf[i].tx_port, qos_conf[i].mbuf_pool);
 
 		qos_conf[i].sched_port = app_init_sched_port(qos_conf[i].tx_port, socket);
+		if (qos_conf[i].n_swt_cores != 0)
+			app_init_subport_workers(&qos_conf[i]);
 	}
 
 	RTE_LOG(INFO, APP, "time stamp clock running at %" PRIu64 " Hz\n",
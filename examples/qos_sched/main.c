@@ -22,6 +22,7 @@
 #define APP_RX_MODE   1
 #define APP_WT_MODE   2
 #define APP_TX_MODE   4
+#define APP_SWT_MODE  8
 
 uint8_t interactive = APP_INTERACTIVE_DEFAULT;
 uint32_t qavg_period = APP_QAVG_PERIOD;
@@ -32,17 +33,20 @@ static int
 app_main_loop(__rte_unused void *dummy)
 {
 	uint32_t lcore_id;
-	uint32_t i, mode;
+	uint32_t i, j, mode;
 	uint32_t rx_idx = 0;
 	uint32_t wt_idx = 0;
 	uint32_t tx_idx = 0;
+	uint32_t swt_idx = 0;
 	struct thread_conf *rx_confs[MAX_DATA_STREAMS];
 	struct thread_conf *wt_confs[MAX_DATA_STREAMS];
 	struct thread_conf *tx_confs[MAX_DATA_STREAMS];
+	struct thread_conf *swt_confs[MAX_DATA_STREAMS];
 
 	memset(rx_confs, 0, sizeof(rx_confs));
 	memset(wt_confs, 0, sizeof(wt_confs));
 	memset(tx_confs, 0, sizeof(tx_confs));
+	memset(swt_confs, 0, sizeof(swt_confs));
 
 
 	mode = APP_MODE_NONE;
@@ -70,7 +74,14 @@ app_main_loop(__rte_unused void *dummy)
 
 			mode |= APP_TX_MODE;
 		}
-		if (flow->wt_core == lcore_id) {
+		if (flow->wt_core == lcore_id && flow->n_swt_cores != 0) {
+			flow->wt_thread.tx_ring =  flow->tx_ring;
+			flow->wt_thread.sched_port =  flow->sched_port;
+
+			swt_confs[swt_idx++] = &flow->wt_thread;
+
+			mode |= APP_SWT_MODE;
+		} else if (flow->wt_core == lcore_id) {
 			flow->wt_thread.rx_ring =  flow->rx_ring;
 			flow->wt_thread.tx_ring =  flow->tx_ring;
 			flow->wt_thread.tx_port =  flow->tx_port;
@@ -80,6 +91,17 @@ app_main_loop(__rte_unused void *dummy)
 
 			mode |= APP_WT_MODE;
 		}
+		for (j = 0; j < flow->n_swt_cores; j++) {
+			if (flow->swt_core[j] != lcore_id)
+				continue;
+
+			flow->swt_thread[j].tx_ring =  flow->tx_ring;
+			flow->swt_thread[j].sched_port =  flow->sched_port;
+
+			swt_confs[swt_idx++] = &flow->swt_thread[j];
+
+			mode |= APP_SWT_MODE;
+		}
 	}
 
 	if (mode == APP_MODE_NONE) {
@@ -93,6 +115,12 @@ app_main_loop(__rte_unused void *dummy)
 		return -1;
 	}
 
+	if ((mode & APP_SWT_MODE) && mode != APP_SWT_MODE) {
+		RTE_LOG(INFO, APP, "lcore %u was configured for subport WT and other tasks !!!\n",
+				 lcore_id);
+		return -1;
+	}
+
 	RTE_LOG(INFO, APP, "entering main loop on lcore %u\n", lcore_id);
 	/* initialize mbuf memory */
 	if (mode == APP_RX_MODE) {
@@ -139,6 +167,14 @@ app_main_loop(__rte_unused void *dummy)
 
 		app_worker_thread(wt_confs);
 	}
+	else if (mode == APP_SWT_MODE) {
+		for (i = 0; i < swt_idx; i++) {
+			RTE_LOG(INFO, APP, "flow %u lcoreid %u scheduling %u subports\n",
+					i, lcore_id, swt_confs[i]->n_subports);
+		}
+
+		app_subport_worker_thread(swt_confs);
+	}
 
 	return 0;
 }
@@ -146,7 +182,7 @@ app_main_loop(__rte_unused void *dummy)
 void
 app_stat(void)
 {
-	uint32_t i;
+	uint32_t i, j;
 	struct rte_eth_stats stats;
 	static struct rte_eth_stats rx_stats[MAX_DATA_STREAMS];
 	static struct rte_eth_stats tx_stats[MAX_DATA_STREAMS];
@@ -172,6 +208,13 @@ app_stat(void)
 		memcpy(&tx_stats[i], &stats, sizeof(stats));
 
 #if APP_COLLECT_STAT
+		for (j = 0; j < flow->n_swt_cores; j++) {
+			flow->wt_thread.stat.nb_rx +=
+				flow->swt_thread[j].stat.nb_rx;
+			memset(&flow->swt_thread[j].stat, 0,
+				sizeof(struct thread_stat));
+		}
+
 		printf("-------+------------+------------+\n");
 		printf("       |  received  |   dropped  |\n");
 		printf("-------+------------+------------+\n");
@@ -49,6 +49,7 @@ extern "C" {
 
 #define MAX_DATA_STREAMS (APP_MAX_LCORE/2)
 #define MAX_SCHED_SUBPORTS		8
+#define MAX_SUBPORT_WT_LCORES		(MAX_SCHED_SUBPORTS - 1)
 #define MAX_SCHED_PIPES		4096
 #define MAX_SCHED_PIPE_PROFILES		256
 
@@ -86,6 +87,10 @@ struct thread_conf
 	struct rte_ring *tx_ring;
 	struct rte_sched_port *sched_port;
 
+	/* subport parallel mode: subports fed (RX) or scheduled (WT) */
+	uint32_t n_subports;
+	uint32_t subport_id[MAX_SCHED_SUBPORTS];
+
 #if APP_COLLECT_STAT
 	struct thread_stat stat;
 #endif
@@ -109,6 +114,11 @@ struct flow_conf
 	struct thread_conf rx_thread;
 	struct thread_conf wt_thread;
 	struct thread_conf tx_thread;
+
+	/* extra worker lcores, scheduling subports in parallel */
+	uint32_t n_swt_cores;
+	uint32_t swt_core[MAX_SUBPORT_WT_LCORES];
+	struct thread_conf swt_thread[MAX_SUBPORT_WT_LCORES];
 };
 
 
@@ -161,6 +171,7 @@ void prompt(void);
 void app_rx_thread(struct thread_conf **qconf);
 void app_tx_thread(struct thread_conf **qconf);
 void app_worker_thread(struct thread_conf **qconf);
+void app_subport_worker_thread(struct thread_conf **qconf);
 void app_mixed_thread(struct thread_conf **qconf);
 
 void app_stat(void);
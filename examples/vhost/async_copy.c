@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <string.h>
+#include <sys/uio.h>
+
+#include <rte_eal.h>
+#include <rte_log.h>
+#include <rte_memcpy.h>
+#include <rte_vhost.h>
+
+#include "main.h"
+#include "async_copy.h"
+
+/* copy segments done and not reported yet, per device and queue */
+static uint32_t sw_cpl_segs[MAX_VHOST_DEVICE][VIRTIO_QNUM];
+
+static int
+sw_transfer_data_cb(int vid, uint16_t queue_id,
+		struct rte_vhost_async_desc *descs,
+		struct rte_vhost_async_status *opaque_data, uint16_t count)
+{
+	struct rte_vhost_iov_iter *src, *dst;
+	uint32_t n_segs = 0;
+	unsigned long j;
+	uint16_t i;
+
+	if (opaque_data != NULL)
+		return -1;
+
+	/* in IOVA as VA mode the addresses of the segments are virtual */
+	for (i = 0; i < count; i++) {
+		src = descs[i].src;
+		dst = descs[i].dst;
+		for (j = 0; j < src->nr_segs; j++)
+			rte_memcpy(dst->iov[j].iov_base, src->iov[j].iov_base,
+				src->iov[j].iov_len);
+		n_segs += src->nr_segs;
+	}
+
+	sw_cpl_segs[vid][queue_id % VIRTIO_QNUM] += n_segs;
+
+	return count;
+}
+
+static int
+sw_check_completed_copies_cb(int vid, uint16_t queue_id,
+		struct rte_vhost_async_status *opaque_data,
+		uint16_t max_packets __rte_unused)
+{
+	uint32_t *cpl = &sw_cpl_segs[vid][queue_id % VIRTIO_QNUM];
+	uint32_t n_segs = *cpl;
+
+	if (opaque_data != NULL)
+		return -1;
+
+	*cpl = 0;
+
+	return n_segs;
+}
+
+static struct rte_vhost_async_channel_ops sw_channel_ops = {
+	.transfer_data = sw_transfer_data_cb,
+	.check_completed_copies = sw_check_completed_copies_cb,
+};
+
+int
+async_copy_parse_type(const char *type)
+{
+	if (strcmp(type, "sw") != 0) {
+		RTE_LOG(ERR, VHOST_CONFIG, "Unsupported DMA type: %s\n", type);
+		return -1;
+	}
+
+	if (rte_eal_iova_mode() != RTE_IOVA_VA) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"DMA type sw needs the IOVA as VA mode\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+async_copy_register(int vid, uint16_t queue_id)
+{
+	struct rte_vhost_async_features f;
+
+	if (vid >= MAX_VHOST_DEVICE)
+		return -1;
+
+	f.intval = 0;
+	f.async_inorder = 1;
+	f.async_threshold = ASYNC_COPY_THRESHOLD;
+
+	sw_cpl_segs[vid][queue_id % VIRTIO_QNUM] = 0;
+
+	return rte_vhost_async_channel_register(vid, queue_id, f.intval,
+			&sw_channel_ops);
+}
@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#ifndef _ASYNC_COPY_H_
+#define _ASYNC_COPY_H_
+
+#include <rte_vhost.h>
+#include <rte_vhost_async.h>
+
+#define MAX_VHOST_DEVICE 1024
+
+/* packets shorter than this are copied by the vhost library itself */
+#define ASYNC_COPY_THRESHOLD 256
+
+/*
+ * Select the copy engine behind the vhost async channels. Only "sw" is
+ * supported: a stand-in for a DMA engine that copies on the CPU as the
+ * batches are submitted, so the async data path can run without DMA
+ * hardware. It needs the IOVA as VA mode.
+ */
+int async_copy_parse_type(const char *type);
+
+int async_copy_register(int vid, uint16_t queue_id);
+
+#endif /* _ASYNC_COPY_H_ */
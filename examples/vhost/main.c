@@ -26,6 +26,7 @@
 #include <rte_pause.h>
 
 #include "main.h"
+#include "async_copy.h"
 
 #ifndef MAX_QUEUES
 #define MAX_QUEUES 128
@@ -96,6 +97,8 @@ static int dequeue_zero_copy;
 
 static int builtin_net_driver;
 
+static int async_vhost_driver;
+
 /* Specify timeout (in useconds) between retries on RX. */
 static uint32_t burst_rx_delay_time = BURST_RX_WAIT_US;
 /* Specify the number of retries on RX. */
@@ -461,7 +464,8 @@ us_vhost_usage(const char *prgname)
 	"		--tx-csum [0|1] disable/enable TX checksum offload.\n"
 	"		--tso [0|1] disable/enable TCP segment offload.\n"
 	"		--client register a vhost-user socket as client mode.\n"
-	"		--dequeue-zero-copy enables dequeue zero copy\n",
+	"		--dequeue-zero-copy enables dequeue zero copy\n"
+	"		--dma-type sw: offload the vhost copies to the async API, with a CPU stand-in for the DMA engine\n",
 	       prgname);
 }
 
@@ -488,6 +492,7 @@ us_vhost_parse_args(int argc, char **argv)
 		{"client", no_argument, &client_mode, 1},
 		{"dequeue-zero-copy", no_argument, &dequeue_zero_copy, 1},
 		{"builtin-net-driver", no_argument, &builtin_net_driver, 1},
+		{"dma-type", required_argument, NULL, 0},
 		{NULL, 0, 0, 0},
 	};
 
@@ -630,6 +635,16 @@ us_vhost_parse_args(int argc, char **argv)
 				}
 			}
 
+			/* Select the async copy engine. */
+			if (!strncmp(long_option[option_index].name,
+						"dma-type", MAX_LONG_OPT_SZ)) {
+				if (async_copy_parse_type(optarg) == -1) {
+					us_vhost_usage(prgname);
+					return -1;
+				}
+				async_vhost_driver = 1;
+			}
+
 			break;
 
 			/* Invalid option - print options. */
@@ -780,6 +795,29 @@ unlink_vmdq(struct vhost_dev *vdev)
 	}
 }
 
+static inline void
+free_pkts(struct rte_mbuf **pkts, uint16_t n)
+{
+	while (n--)
+		rte_pktmbuf_free(pkts[n]);
+}
+
+/* free the packets the async engine has finished copying to the guest */
+static __rte_always_inline void
+complete_async_pkts(struct vhost_dev *vdev)
+{
+	struct rte_mbuf *p_cpl[MAX_PKT_BURST];
+	uint16_t complete_count;
+
+	complete_count = rte_vhost_poll_enqueue_completed(vdev->vid,
+					VIRTIO_RXQ, p_cpl, MAX_PKT_BURST);
+	if (complete_count) {
+		__atomic_sub_fetch(&vdev->nr_async_pkts, complete_count,
+			__ATOMIC_SEQ_CST);
+		free_pkts(p_cpl, complete_count);
+	}
+}
+
 static __rte_always_inline void
 virtio_xmit(struct vhost_dev *dst_vdev, struct vhost_dev *src_vdev,
 	    struct rte_mbuf *m)
@@ -788,6 +826,17 @@ virtio_xmit(struct vhost_dev *dst_vdev, struct vhost_dev *src_vdev,
 
 	if (builtin_net_driver) {
 		ret = vs_enqueue_pkts(dst_vdev, VIRTIO_RXQ, &m, 1);
+	} else if (async_vhost_driver) {
+		/* the caller frees m, the async copy holds its own reference */
+		rte_mbuf_refcnt_update(m, 1);
+		ret = rte_vhost_submit_enqueue_burst(dst_vdev->vid, VIRTIO_RXQ,
+						&m, 1);
+		if (ret == 0)
+			rte_mbuf_refcnt_update(m, -1);
+		else
+			__atomic_add_fetch(&dst_vdev->nr_async_pkts, ret,
+				__ATOMIC_SEQ_CST);
+		complete_async_pkts(dst_vdev);
 	} else {
 		ret = rte_vhost_enqueue_burst(dst_vdev->vid, VIRTIO_RXQ, &m, 1);
 	}
@@ -903,13 +952,6 @@ static void virtio_tx_offload(struct rte_mbuf *m)
 	tcp_hdr->cksum = get_psd_sum(l3_hdr, m->ol_flags);
 }
 
-static inline void
-free_pkts(struct rte_mbuf **pkts, uint16_t n)
-{
-	while (n--)
-		rte_pktmbuf_free(pkts[n]);
-}
-
 static __rte_always_inline void
 do_drain_mbuf_table(struct mbuf_table *tx_q)
 {
@@ -1068,6 +1110,11 @@ drain_eth_rx(struct vhost_dev *vdev)
 	if (builtin_net_driver) {
 		enqueue_count = vs_enqueue_pkts(vdev, VIRTIO_RXQ,
 						pkts, rx_count);
+	} else if (async_vhost_driver) {
+		enqueue_count = rte_vhost_submit_enqueue_burst(vdev->vid,
+					VIRTIO_RXQ, pkts, rx_count);
+		__atomic_add_fetch(&vdev->nr_async_pkts, enqueue_count,
+			__ATOMIC_SEQ_CST);
 	} else {
 		enqueue_count = rte_vhost_enqueue_burst(vdev->vid, VIRTIO_RXQ,
 						pkts, rx_count);
@@ -1077,7 +1124,10 @@ drain_eth_rx(struct vhost_dev *vdev)
 		rte_atomic64_add(&vdev->stats.rx_atomic, enqueue_count);
 	}
 
-	free_pkts(pkts, rx_count);
+	if (async_vhost_driver)
+		free_pkts(&pkts[enqueue_count], rx_count - enqueue_count);
+	else
+		free_pkts(pkts, rx_count);
 }
 
 static __rte_always_inline void
@@ -1086,10 +1136,15 @@ drain_virtio_tx(struct vhost_dev *vdev)
 	struct rte_mbuf *pkts[MAX_PKT_BURST];
 	uint16_t count;
 	uint16_t i;
+	int nr_inflight;
 
 	if (builtin_net_driver) {
 		count = vs_dequeue_pkts(vdev, VIRTIO_TXQ, mbuf_pool,
 					pkts, MAX_PKT_BURST);
+	} else if (async_vhost_driver) {
+		count = rte_vhost_async_try_dequeue_burst(vdev->vid,
+				VIRTIO_TXQ, mbuf_pool, pkts, MAX_PKT_BURST,
+				&nr_inflight);
 	} else {
 		count = rte_vhost_dequeue_burst(vdev->vid, VIRTIO_TXQ,
 					mbuf_pool, pkts, MAX_PKT_BURST);
@@ -1161,6 +1216,9 @@ switch_worker(void *arg __rte_unused)
 				continue;
 			}
 
+			if (async_vhost_driver)
+				complete_async_pkts(vdev);
+
 			if (likely(vdev->ready == DEVICE_RX))
 				drain_eth_rx(vdev);
 
@@ -1172,6 +1230,31 @@ switch_worker(void *arg __rte_unused)
 	return 0;
 }
 
+/*
+ * Wait for the copies in flight on the device, then detach its async
+ * channels.
+ */
+static void
+async_vhost_drain(struct vhost_dev *vdev)
+{
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	uint16_t count;
+	int nr_inflight;
+
+	while (__atomic_load_n(&vdev->nr_async_pkts, __ATOMIC_SEQ_CST))
+		complete_async_pkts(vdev);
+
+	do {
+		count = rte_vhost_async_try_dequeue_burst(vdev->vid,
+				VIRTIO_TXQ, mbuf_pool, pkts, MAX_PKT_BURST,
+				&nr_inflight);
+		free_pkts(pkts, count);
+	} while (nr_inflight > 0);
+
+	rte_vhost_async_channel_unregister(vdev->vid, VIRTIO_RXQ);
+	rte_vhost_async_channel_unregister(vdev->vid, VIRTIO_TXQ);
+}
+
 /*
  * Remove a device from the specific data core linked list and from the
  * main linked list. Synchonization  occurs through the use of the
@@ -1220,6 +1303,9 @@ destroy_device(int vid)
 
 	lcore_info[vdev->coreid].device_num--;
 
+	if (async_vhost_driver)
+		async_vhost_drain(vdev);
+
 	RTE_LOG(INFO, VHOST_DATA,
 		"(%d) device has been removed from data core\n",
 		vdev->vid);
@@ -1250,6 +1336,16 @@ new_device(int vid)
 	if (builtin_net_driver)
 		vs_vhost_net_setup(vdev);
 
+	if (async_vhost_driver &&
+			(async_copy_register(vid, VIRTIO_RXQ) < 0 ||
+			 async_copy_register(vid, VIRTIO_TXQ) < 0)) {
+		RTE_LOG(INFO, VHOST_DATA,
+			"(%d) couldn't register async channels\n", vid);
+		rte_vhost_async_channel_unregister(vid, VIRTIO_RXQ);
+		rte_free(vdev);
+		return -1;
+	}
+
 	TAILQ_INSERT_TAIL(&vhost_dev_list, vdev, global_vdev_entry);
 	vdev->vmdq_rx_q = vid * queues_per_pool + vmdq_queue_base;
 
@@ -1516,6 +1612,9 @@ main(int argc, char *argv[])
 	if (dequeue_zero_copy)
 		flags |= RTE_VHOST_USER_DEQUEUE_ZERO_COPY;
 
+	if (async_vhost_driver)
+		flags |= RTE_VHOST_USER_ASYNC_COPY;
+
 	/* Register vhost user driver to handle vhost messages. */
 	for (i = 0; i < nb_sockets; i++) {
 		char *file = socket_files + i * PATH_MAX;
@@ -53,6 +53,8 @@ struct vhost_dev {
 	uint16_t nr_vrings;
 	struct rte_vhost_memory *mem;
 	struct device_statistics stats;
+	/**< Packets enqueued to the async engine, not completed yet. */
+	uint64_t nr_async_pkts;
 	TAILQ_ENTRY(vhost_dev) global_vdev_entry;
 	TAILQ_ENTRY(vhost_dev) lcore_vdev_entry;
 
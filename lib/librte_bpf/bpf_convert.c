@@ -0,0 +1,432 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_debug.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+
+#include "bpf_impl.h"
+
+/*
+ * Classic BPF (cBPF) to eBPF translator.
+ * cBPF machine state is mapped onto eBPF one in the following way:
+ * - A (accumulator) is R0, so BPF_ABS/BPF_IND loads update it in place,
+ *   and it is already in place as return value for BPF_RET.
+ * - X (index register) is R7, as it has to survive BPF_ABS/BPF_IND.
+ * - R6 holds the input mbuf, as required by BPF_ABS/BPF_IND.
+ * - R8 is a scratch register for the translator itself.
+ * - M[] (scratch memory) lives at the top of the eBPF stack.
+ * cBPF arithmetic is 32-bit only, so A and X are updated by BPF_ALU
+ * (not EBPF_ALU64) instructions, which keeps them zero-extended and
+ * allows to use 64-bit eBPF conditional jumps for cBPF comparisons.
+ */
+
+#define CBPF_REG_A	EBPF_REG_0
+#define CBPF_REG_X	EBPF_REG_7
+#define CBPF_REG_CTX	EBPF_REG_6
+#define CBPF_REG_TMP	EBPF_REG_8
+
+/* frame pointer offset for M[k] */
+#define CBPF_MEM_OFS(k)	\
+	(-(int32_t)((BPF_MEMWORDS - (k)) * sizeof(uint32_t)))
+
+struct cbpf_conv {
+	const struct cbpf_insn *ins;
+	uint32_t nb_ins;
+	uint32_t *map;        /* cBPF to eBPF instruction index mapping */
+	struct ebpf_insn *out; /* NULL for the first pass */
+	uint32_t idx;         /* current eBPF instruction index */
+};
+
+static void
+conv_emit(struct cbpf_conv *cv, uint8_t code, uint8_t dst, uint8_t src,
+	int16_t off, int32_t imm)
+{
+	struct ebpf_insn *ins;
+
+	if (cv->out != NULL) {
+		ins = cv->out + cv->idx;
+		ins->code = code;
+		ins->dst_reg = dst;
+		ins->src_reg = src;
+		ins->off = off;
+		ins->imm = imm;
+	}
+
+	cv->idx++;
+}
+
+/*
+ * emit jump to the first eBPF instruction of cBPF instruction *tgt*.
+ * as cBPF allows forward jumps only, on the first pass
+ * target position is not known yet and zero offset is used.
+ */
+static int
+conv_emit_jmp(struct cbpf_conv *cv, uint8_t code, uint8_t src, int32_t imm,
+	uint32_t tgt)
+{
+	int64_t ofs;
+
+	ofs = 0;
+	if (cv->out != NULL) {
+		ofs = (int64_t)cv->map[tgt] - (cv->idx + 1);
+		if (ofs > INT16_MAX)
+			return -ERANGE;
+	}
+
+	conv_emit(cv, code, CBPF_REG_A, src, ofs, imm);
+	return 0;
+}
+
+/* opposite condition, if eBPF has one */
+static uint8_t
+conv_jcc_inv(uint8_t op)
+{
+	switch (op) {
+	case BPF_JEQ:
+		return EBPF_JNE;
+	case BPF_JGT:
+		return EBPF_JLE;
+	case BPF_JGE:
+		return EBPF_JLT;
+	default:
+		return UINT8_MAX;
+	}
+}
+
+/*
+ * cBPF conditional jump: if (A op K/X) goto jt; else goto jf;
+ */
+static int
+conv_jcc(struct cbpf_conv *cv, uint32_t pc, const struct cbpf_insn *ins)
+{
+	int32_t imm, rc;
+	uint8_t op, inv, src, sx;
+	uint32_t jf, jt;
+
+	op = BPF_OP(ins->code);
+	jt = pc + 1 + ins->jt;
+	jf = pc + 1 + ins->jf;
+
+	if (jt >= cv->nb_ins || jf >= cv->nb_ins)
+		return -EINVAL;
+
+	/* both branches go to the same place */
+	if (jt == jf)
+		return (jt == pc + 1) ? 0 :
+			conv_emit_jmp(cv, BPF_JMP | BPF_JA, 0, 0, jt);
+
+	/*
+	 * eBPF sign-extends 32-bit immediate, while cBPF compares
+	 * unsigned 32-bit values, so load such constants into a register.
+	 */
+	sx = BPF_SRC(ins->code);
+	if (sx == BPF_X)
+		src = CBPF_REG_X;
+	else if ((int32_t)ins->k < 0) {
+		conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_K, CBPF_REG_TMP, 0, 0,
+			ins->k);
+		src = CBPF_REG_TMP;
+		sx = BPF_X;
+	} else
+		src = 0;
+
+	/* register forms require zero immediate */
+	imm = (sx == BPF_X) ? 0 : (int32_t)ins->k;
+
+	/* fall-through into true branch, jump on opposite condition */
+	inv = conv_jcc_inv(op);
+	if (jt == pc + 1 && inv != UINT8_MAX)
+		return conv_emit_jmp(cv, BPF_JMP | inv | sx, src, imm, jf);
+
+	rc = conv_emit_jmp(cv, BPF_JMP | op | sx, src, imm, jt);
+	if (rc == 0 && jf != pc + 1)
+		rc = conv_emit_jmp(cv, BPF_JMP | BPF_JA, 0, 0, jf);
+	return rc;
+}
+
+static int
+conv_alu(struct cbpf_conv *cv, const struct cbpf_insn *ins)
+{
+	uint8_t op;
+
+	op = BPF_OP(ins->code);
+
+	switch (op) {
+	case BPF_NEG:
+		conv_emit(cv, BPF_ALU | BPF_NEG, CBPF_REG_A, 0, 0, 0);
+		return 0;
+	case BPF_LSH:
+	case BPF_RSH:
+		if (BPF_SRC(ins->code) == BPF_K && ins->k >= sizeof(uint32_t) *
+				CHAR_BIT)
+			return -EINVAL;
+		break;
+	case BPF_DIV:
+	case BPF_MOD:
+		if (BPF_SRC(ins->code) == BPF_K && ins->k == 0)
+			return -EINVAL;
+		break;
+	case BPF_ADD:
+	case BPF_SUB:
+	case BPF_MUL:
+	case BPF_OR:
+	case BPF_AND:
+	case BPF_XOR:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (BPF_SRC(ins->code) == BPF_X)
+		conv_emit(cv, BPF_ALU | op | BPF_X, CBPF_REG_A, CBPF_REG_X,
+			0, 0);
+	else
+		conv_emit(cv, BPF_ALU | op | BPF_K, CBPF_REG_A, 0, 0, ins->k);
+	return 0;
+}
+
+/*
+ * load into A (BPF_LD) or X (BPF_LDX) register.
+ */
+static int
+conv_ld(struct cbpf_conv *cv, const struct cbpf_insn *ins)
+{
+	uint8_t dst, mode, sz;
+
+	dst = (BPF_CLASS(ins->code) == BPF_LD) ? CBPF_REG_A : CBPF_REG_X;
+	mode = BPF_MODE(ins->code);
+	sz = BPF_SIZE(ins->code);
+
+	/* packet data loads, A only */
+	if (dst == CBPF_REG_A && (mode == BPF_ABS || mode == BPF_IND)) {
+
+		if (sz == EBPF_DW)
+			return -EINVAL;
+
+		/* linux specific ancillary data is not supported */
+		if (mode == BPF_ABS && (int32_t)ins->k < 0)
+			return -ENOTSUP;
+
+		conv_emit(cv, BPF_LD | mode | sz, 0,
+			(mode == BPF_IND) ? CBPF_REG_X : 0, 0, ins->k);
+		return 0;
+	}
+
+	/* X = 4 * (P[k] & 0xf), have to preserve A */
+	if (dst == CBPF_REG_X && mode == BPF_MSH) {
+
+		if (sz != BPF_B)
+			return -EINVAL;
+
+		conv_emit(cv, EBPF_ALU64 | EBPF_MOV | BPF_X, CBPF_REG_TMP,
+			CBPF_REG_A, 0, 0);
+		conv_emit(cv, BPF_LD | BPF_ABS | BPF_B, 0, 0, 0, ins->k);
+		conv_emit(cv, BPF_ALU | BPF_AND | BPF_K, CBPF_REG_A, 0, 0, 0xf);
+		conv_emit(cv, BPF_ALU | BPF_LSH | BPF_K, CBPF_REG_A, 0, 0, 2);
+		conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_X, CBPF_REG_X,
+			CBPF_REG_A, 0, 0);
+		conv_emit(cv, EBPF_ALU64 | EBPF_MOV | BPF_X, CBPF_REG_A,
+			CBPF_REG_TMP, 0, 0);
+		return 0;
+	}
+
+	if (sz != BPF_W)
+		return -EINVAL;
+
+	switch (mode) {
+	case BPF_IMM:
+		conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_K, dst, 0, 0, ins->k);
+		return 0;
+	case BPF_MEM:
+		if (ins->k >= BPF_MEMWORDS)
+			return -EINVAL;
+		conv_emit(cv, BPF_LDX | BPF_MEM | BPF_W, dst, EBPF_REG_10,
+			CBPF_MEM_OFS(ins->k), 0);
+		return 0;
+	case BPF_LEN:
+		conv_emit(cv, BPF_LDX | BPF_MEM | BPF_W, dst, CBPF_REG_CTX,
+			offsetof(struct rte_mbuf, pkt_len), 0);
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+static int
+conv_insn(struct cbpf_conv *cv, uint32_t pc)
+{
+	uint32_t tgt;
+	uint8_t src;
+	const struct cbpf_insn *ins;
+
+	ins = cv->ins + pc;
+
+	/* eBPF opcodes are 8-bit, so are all valid cBPF ones */
+	if (ins->code > UINT8_MAX)
+		return -EINVAL;
+
+	switch (BPF_CLASS(ins->code)) {
+	case BPF_LD:
+	case BPF_LDX:
+		return conv_ld(cv, ins);
+	case BPF_ST:
+	case BPF_STX:
+		if (ins->k >= BPF_MEMWORDS)
+			return -EINVAL;
+		src = (BPF_CLASS(ins->code) == BPF_ST) ?
+			CBPF_REG_A : CBPF_REG_X;
+		conv_emit(cv, BPF_STX | BPF_MEM | BPF_W, EBPF_REG_10, src,
+			CBPF_MEM_OFS(ins->k), 0);
+		return 0;
+	case BPF_ALU:
+		return conv_alu(cv, ins);
+	case BPF_JMP:
+		if (BPF_OP(ins->code) == BPF_JA) {
+			tgt = pc + 1 + ins->k;
+			if (tgt >= cv->nb_ins || tgt < pc)
+				return -EINVAL;
+			return (tgt == pc + 1) ? 0 :
+				conv_emit_jmp(cv, BPF_JMP | BPF_JA, 0, 0, tgt);
+		} else if (BPF_OP(ins->code) == BPF_JEQ ||
+				BPF_OP(ins->code) == BPF_JGT ||
+				BPF_OP(ins->code) == BPF_JGE ||
+				BPF_OP(ins->code) == BPF_JSET)
+			return conv_jcc(cv, pc, ins);
+		return -EINVAL;
+	case BPF_RET:
+		if (BPF_RVAL(ins->code) == BPF_K)
+			conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_K, CBPF_REG_A,
+				0, 0, ins->k);
+		else if (BPF_RVAL(ins->code) == BPF_X)
+			conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_X, CBPF_REG_A,
+				CBPF_REG_X, 0, 0);
+		else if (BPF_RVAL(ins->code) != BPF_A)
+			return -EINVAL;
+		conv_emit(cv, BPF_JMP | EBPF_EXIT, 0, 0, 0, 0);
+		return 0;
+	case BPF_MISC:
+		if (BPF_MISCOP(ins->code) == BPF_TAX)
+			conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_X, CBPF_REG_X,
+				CBPF_REG_A, 0, 0);
+		else if (BPF_MISCOP(ins->code) == BPF_TXA)
+			conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_X, CBPF_REG_A,
+				CBPF_REG_X, 0, 0);
+		else
+			return -EINVAL;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+/*
+ * Walk through cBPF code and translate it into eBPF one.
+ */
+static int
+conv_prog(struct cbpf_conv *cv)
+{
+	int32_t rc;
+	uint32_t i;
+
+	cv->idx = 0;
+
+	/* R6 = ctx, A = 0, X = 0 */
+	conv_emit(cv, EBPF_ALU64 | EBPF_MOV | BPF_X, CBPF_REG_CTX, EBPF_REG_1,
+		0, 0);
+	conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_K, CBPF_REG_A, 0, 0, 0);
+	conv_emit(cv, BPF_ALU | EBPF_MOV | BPF_K, CBPF_REG_X, 0, 0, 0);
+
+	for (i = 0; i != cv->nb_ins; i++) {
+		cv->map[i] = cv->idx;
+		rc = conv_insn(cv, i);
+		if (rc != 0) {
+			RTE_BPF_LOG(ERR, "%s: can't convert cBPF instruction "
+				"{.code=%#x, .jt=%u, .jf=%u, .k=%#x} "
+				"at pc: %u, error code: %d;\n",
+				__func__, cv->ins[i].code, cv->ins[i].jt,
+				cv->ins[i].jf, cv->ins[i].k, i, rc);
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+struct rte_bpf_prm *
+rte_bpf_convert(const struct cbpf_insn *ins, uint32_t nb_ins)
+{
+	int32_t rc;
+	size_t sz;
+	struct cbpf_conv cv;
+	struct rte_bpf_prm *prm;
+
+	if (ins == NULL || nb_ins == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* cBPF program is not allowed to fall off its end */
+	if (BPF_CLASS(ins[nb_ins - 1].code) != BPF_RET) {
+		RTE_BPF_LOG(ERR, "%s: last cBPF instruction is not BPF_RET;\n",
+			__func__);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	memset(&cv, 0, sizeof(cv));
+	cv.ins = ins;
+	cv.nb_ins = nb_ins;
+	cv.map = malloc(nb_ins * sizeof(cv.map[0]));
+	if (cv.map == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* first pass to find out eBPF code size and jump targets */
+	rc = conv_prog(&cv);
+	if (rc != 0) {
+		free(cv.map);
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	sz = sizeof(*prm) + cv.idx * sizeof(cv.out[0]);
+	prm = rte_zmalloc(__func__, sz, 0);
+	if (prm == NULL) {
+		free(cv.map);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* second pass to generate eBPF code */
+	cv.out = (struct ebpf_insn *)(prm + 1);
+	rc = conv_prog(&cv);
+	free(cv.map);
+
+	if (rc != 0) {
+		rte_free(prm);
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	prm->ins = cv.out;
+	prm->nb_ins = cv.idx;
+	prm->prog_arg.type = RTE_BPF_ARG_PTR_MBUF;
+	prm->prog_arg.size = sizeof(struct rte_mbuf);
+	prm->prog_arg.buf_size = RTE_MBUF_DEFAULT_BUF_SIZE;
+
+	return prm;
+}
@@ -102,6 +102,18 @@ extern "C" {
 #define EBPF_TO_LE	0x00  /* convert to little-endian */
 #define EBPF_TO_BE	0x08  /* convert to big-endian */
 
+/* ret - BPF_K and BPF_X also apply */
+#define BPF_RVAL(code)	((code) & 0x18)
+#define	BPF_A		0x10
+
+/* misc */
+#define BPF_MISCOP(code) ((code) & 0xf8)
+#define	BPF_TAX		0x00
+#define	BPF_TXA		0x80
+
+/* number of cBPF scratch memory words */
+#define	BPF_MEMWORDS	16
+
 /*
  * eBPF registers
  */
@@ -139,6 +151,17 @@ struct ebpf_insn {
 	int32_t imm;
 };
 
+/*
+ * cBPF instruction format,
+ * same layout as struct bpf_insn from <pcap/bpf.h>.
+ */
+struct cbpf_insn {
+	uint16_t code;
+	uint8_t jt;
+	uint8_t jf;
+	uint32_t k;
+};
+
 /*
  * eBPF allows functions with R1-R5 as arguments.
  */
@@ -14,15 +14,32 @@ extern "C" {
 
 #define MAX_BPF_STACK_SIZE	0x200
 
+/*
+ * Per instruction information, collected by the validator over
+ * all possible execution paths and used by the optimizer and JIT.
+ */
+#define	BPF_INS_JCC_TAKEN	0x1 /* conditional jump is always taken */
+#define	BPF_INS_JCC_FALL	0x2 /* conditional jump is never taken */
+#define	BPF_INS_CONST		0x4 /* result (or BPF_IND offset) is imm */
+#define	BPF_INS_NZ_SRC		0x8 /* divisor is never zero */
+
+struct bpf_ins_info {
+	uint32_t flags;
+	int32_t imm;
+};
+
 struct rte_bpf {
 	struct rte_bpf_prm prm;
 	struct rte_bpf_jit jit;
 	size_t sz;
 	uint32_t stack_sz;
+	struct bpf_ins_info *ins_info;
 };
 
 extern int bpf_validate(struct rte_bpf *bpf);
 
+extern int bpf_optimize(struct rte_bpf *bpf);
+
 extern int bpf_jit(struct rte_bpf *bpf);
 
 extern int bpf_jit_x86(struct rte_bpf *);
@@ -1089,6 +1089,164 @@ emit_branch(struct a64_jit_ctx *ctx, uint8_t op, uint32_t i, int16_t off)
 	emit_b_cond(ctx, ebpf_to_a64_cond(op), jump_offset_get(ctx, i, off));
 }
 
+/*
+ * offsets for the code parts of BPF_ABS/BPF_IND load,
+ * used by emit_ld_mbuf() to calculate jump targets.
+ */
+enum {
+	LDMB_FSP_OFS, /* fast-path */
+	LDMB_SLP_OFS, /* slow-path */
+	LDMB_FIN_OFS, /* final part */
+	LDMB_OFS_NUM
+};
+
+/*
+ * helper function, used by emit_ld_mbuf().
+ * generates code for 'fast_path':
+ * calculate load offset and check is it inside first packet segment.
+ */
+static void
+emit_ldmb_fast_path(struct a64_jit_ctx *ctx, const uint8_t rg[EBPF_REG_7],
+	uint8_t tmp, uint8_t src, uint8_t mode, uint32_t sz, int32_t imm,
+	const int32_t ofs[LDMB_OFS_NUM])
+{
+	/* make R2 contain *off* value, 32-bit as for the interpreter */
+	if (mode == BPF_IND) {
+		emit_mov_imm(ctx, 0, tmp, imm);
+		emit_mov(ctx, 0, rg[EBPF_REG_2], src);
+		emit_add(ctx, 0, rg[EBPF_REG_2], tmp);
+	} else
+		emit_mov_imm(ctx, 0, rg[EBPF_REG_2], imm);
+
+	/* R3 = mbuf->data_len */
+	emit_mov_imm(ctx, 1, tmp, offsetof(struct rte_mbuf, data_len));
+	emit_ldr(ctx, BPF_H, rg[EBPF_REG_3], rg[EBPF_REG_6], tmp);
+
+	/* R3 = R3 - R2 */
+	emit_sub(ctx, 1, rg[EBPF_REG_3], rg[EBPF_REG_2]);
+
+	/* JSLT R3, <sz> <slow_path> */
+	emit_mov_imm(ctx, 1, tmp, sz);
+	emit_cmp(ctx, 1, rg[EBPF_REG_3], tmp);
+	emit_b_cond(ctx, A64_LT, ofs[LDMB_SLP_OFS] - ctx->idx);
+
+	/* R3 = mbuf->data_off */
+	emit_mov_imm(ctx, 1, tmp, offsetof(struct rte_mbuf, data_off));
+	emit_ldr(ctx, BPF_H, rg[EBPF_REG_3], rg[EBPF_REG_6], tmp);
+
+	/* R0 = mbuf->buf_addr */
+	emit_mov_imm(ctx, 1, tmp, offsetof(struct rte_mbuf, buf_addr));
+	emit_ldr(ctx, EBPF_DW, rg[EBPF_REG_0], rg[EBPF_REG_6], tmp);
+
+	/* R0 = R0 + R3 + R2 */
+	emit_add(ctx, 1, rg[EBPF_REG_0], rg[EBPF_REG_3]);
+	emit_add(ctx, 1, rg[EBPF_REG_0], rg[EBPF_REG_2]);
+
+	/* JMP <fin_part> */
+	emit_b(ctx, ofs[LDMB_FIN_OFS] - ctx->idx);
+}
+
+/*
+ * helper function, used by emit_ld_mbuf().
+ * generates code for 'slow_path':
+ * call __rte_pktmbuf_read() and check return value.
+ */
+static void
+emit_ldmb_slow_path(struct a64_jit_ctx *ctx, const uint8_t rg[EBPF_REG_7],
+	uint8_t tmp, uint32_t sz, uint32_t stack_ofs)
+{
+	uint8_t fp;
+
+	fp = ebpf_to_a64_reg(ctx, EBPF_FP);
+
+	/* make R3 contain *len* value (1/2/4) */
+	emit_mov_imm(ctx, 1, rg[EBPF_REG_3], sz);
+
+	/* make R4 contain (EBPF_FP - stack_ofs) */
+	emit_mov_imm(ctx, 1, tmp, stack_ofs);
+	emit_mov_64(ctx, rg[EBPF_REG_4], fp);
+	emit_sub(ctx, 1, rg[EBPF_REG_4], tmp);
+
+	/* make R1 contain mbuf ptr */
+	emit_mov_64(ctx, rg[EBPF_REG_1], rg[EBPF_REG_6]);
+
+	/* call rte_pktmbuf_read */
+	emit_call(ctx, tmp, __rte_pktmbuf_read);
+
+	/* check that return value (R0) is not zero */
+	emit_return_zero_if_src_zero(ctx, 1, rg[EBPF_REG_0]);
+}
+
+/*
+ * helper function, used by emit_ld_mbuf().
+ * generates final part of code for BPF_ABS/BPF_IND load:
+ * perform data load and endianness conversion.
+ * expects R0 to contain valid data pointer.
+ */
+static void
+emit_ldmb_fin(struct a64_jit_ctx *ctx, const uint8_t rg[EBPF_REG_7],
+	uint8_t opsz, uint32_t sz)
+{
+	emit_ldr(ctx, opsz, rg[EBPF_REG_0], rg[EBPF_REG_0], A64_ZR);
+	if (sz != sizeof(uint8_t))
+		emit_be(ctx, rg[EBPF_REG_0], sz * CHAR_BIT);
+}
+
+/*
+ * emit code for BPF_ABS/BPF_IND load.
+ * generates the following construction:
+ * fast_path:
+ *   off = ins->sreg + ins->imm
+ *   if (mbuf->data_len - off < ins->opsz)
+ *      goto slow_path;
+ *   ptr = mbuf->buf_addr + mbuf->data_off + off;
+ *   goto fin_part;
+ * slow_path:
+ *   typeof(ins->opsz) buf; //allocate space on the stack
+ *   ptr = __rte_pktmbuf_read(mbuf, off, ins->opsz, &buf);
+ *   if (ptr == NULL)
+ *      goto exit_label;
+ * fin_part:
+ *   res = *(typeof(ins->opsz))ptr;
+ *   res = bswap(res);
+ */
+static void
+emit_ld_mbuf(struct a64_jit_ctx *ctx, uint8_t op, uint8_t tmp, uint8_t src,
+	int32_t imm, uint32_t stack_ofs)
+{
+	uint32_t i, sz;
+	uint8_t mode, opsz;
+	uint8_t rg[EBPF_REG_7];
+	int32_t ofs[LDMB_OFS_NUM];
+
+	mode = BPF_MODE(op);
+	opsz = BPF_SIZE(op);
+	sz = bpf_size(opsz);
+
+	for (i = 0; i != RTE_DIM(rg); i++)
+		rg[i] = ebpf_to_a64_reg(ctx, i);
+
+	/* fill with fake offsets */
+	for (i = 0; i != RTE_DIM(ofs); i++)
+		ofs[i] = ctx->idx;
+
+	/* dry run first to calculate jump offsets */
+
+	ofs[LDMB_FSP_OFS] = ctx->idx;
+	emit_ldmb_fast_path(ctx, rg, tmp, src, mode, sz, imm, ofs);
+	ofs[LDMB_SLP_OFS] = ctx->idx;
+	emit_ldmb_slow_path(ctx, rg, tmp, sz, stack_ofs);
+	ofs[LDMB_FIN_OFS] = ctx->idx;
+	emit_ldmb_fin(ctx, rg, opsz, sz);
+
+	/* reset dry-run code and do a proper run */
+
+	ctx->idx = ofs[LDMB_FSP_OFS];
+	emit_ldmb_fast_path(ctx, rg, tmp, src, mode, sz, imm, ofs);
+	emit_ldmb_slow_path(ctx, rg, tmp, sz, stack_ofs);
+	emit_ldmb_fin(ctx, rg, opsz, sz);
+}
+
 static void
 check_program_has_call(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 {
@@ -1103,6 +1261,13 @@ check_program_has_call(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 		switch (op) {
 		/* Call imm */
 		case (BPF_JMP | EBPF_CALL):
+		/* BPF_ABS/BPF_IND may call __rte_pktmbuf_read() */
+		case (BPF_LD | BPF_ABS | BPF_B):
+		case (BPF_LD | BPF_ABS | BPF_H):
+		case (BPF_LD | BPF_ABS | BPF_W):
+		case (BPF_LD | BPF_IND | BPF_B):
+		case (BPF_LD | BPF_IND | BPF_H):
+		case (BPF_LD | BPF_IND | BPF_W):
 			ctx->foundcall = 1;
 			return;
 		}
@@ -1193,7 +1358,8 @@ emit(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 		/* dst /= src */
 		case (BPF_ALU | BPF_DIV | BPF_X):
 		case (EBPF_ALU64 | BPF_DIV | BPF_X):
-			emit_return_zero_if_src_zero(ctx, is64, src);
+			if ((bpf->ins_info[i].flags & BPF_INS_NZ_SRC) == 0)
+				emit_return_zero_if_src_zero(ctx, is64, src);
 			emit_div(ctx, is64, dst, src);
 			break;
 		/* dst /= imm */
@@ -1205,7 +1371,8 @@ emit(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 		/* dst %= src */
 		case (BPF_ALU | BPF_MOD | BPF_X):
 		case (EBPF_ALU64 | BPF_MOD | BPF_X):
-			emit_return_zero_if_src_zero(ctx, is64, src);
+			if ((bpf->ins_info[i].flags & BPF_INS_NZ_SRC) == 0)
+				emit_return_zero_if_src_zero(ctx, is64, src);
 			emit_mod(ctx, is64, tmp1, dst, src);
 			break;
 		/* dst %= imm */
@@ -1298,6 +1465,15 @@ emit(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 			emit_mov_imm(ctx, 1, tmp1, off);
 			emit_ldr(ctx, BPF_SIZE(op), dst, src, tmp1);
 			break;
+		/* R0 = ntoh(*(size *)(mbuf data + src + imm)) */
+		case (BPF_LD | BPF_ABS | BPF_B):
+		case (BPF_LD | BPF_ABS | BPF_H):
+		case (BPF_LD | BPF_ABS | BPF_W):
+		case (BPF_LD | BPF_IND | BPF_B):
+		case (BPF_LD | BPF_IND | BPF_H):
+		case (BPF_LD | BPF_IND | BPF_W):
+			emit_ld_mbuf(ctx, op, tmp1, src, imm, bpf->stack_sz);
+			break;
 		/* dst = imm64 */
 		case (BPF_LD | BPF_IMM | EBPF_DW):
 			u64 = ((uint64_t)ins[1].imm << 32) | (uint32_t)imm;
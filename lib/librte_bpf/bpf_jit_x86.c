@@ -101,6 +101,21 @@ enum {
  */
 static const uint32_t save_regs[] = {RBX, R12, R13, R14, R15, RBP};
 
+/*
+ * burst version of the code keeps its loop state on the stack
+ * (above the BPF stack, addressed through RBP), while R12
+ * (not used by BPF code) points to the current element of ctx[].
+ */
+enum {
+	BURST_RC_OFS = 0,  /* pointer to the current rc[] element */
+	BURST_END_OFS = 8, /* pointer to the end of ctx[] */
+	BURST_NUM_OFS = 16, /* number of elements in ctx[] */
+	BURST_SAVE_OFS = 24, /* callee saved registers */
+	BURST_FRAME_SZ = BURST_SAVE_OFS + RTE_DIM(save_regs) * sizeof(uint64_t),
+};
+
+#define	REG_BURST_CTX	R12
+
 struct bpf_jit_state {
 	uint32_t idx;
 	size_t sz;
@@ -111,6 +126,15 @@ struct bpf_jit_state {
 	struct {
 		uint32_t stack_ofs;
 	} ldmb;
+	struct {
+		uint32_t gen;    /* generating burst version of the code */
+		uint32_t reguse;
+		int32_t exit;
+		int32_t loop;    /* start of the loop over input contexts */
+		int32_t fin;     /* burst version epilog */
+		size_t ofs;      /* burst version entry point */
+		int32_t *off;
+	} burst;
 	uint32_t reguse;
 	int32_t *off;
 	uint8_t *ins;
@@ -289,6 +313,23 @@ emit_movzwl(struct bpf_jit_state *st, uint32_t sreg, uint32_t dreg)
 	emit_modregrm(st, MOD_DIRECT, sreg, dreg);
 }
 
+/*
+ * emit prefetcht0 (%<sreg>)
+ */
+static void
+emit_prefetch(struct bpf_jit_state *st, uint32_t sreg)
+{
+	static const uint8_t ops[] = {0x0F, 0x18};
+	const uint8_t mods = 1;
+
+	emit_rex(st, BPF_ALU, 0, sreg);
+	emit_bytes(st, ops, sizeof(ops));
+	emit_modregrm(st, MOD_IDISP8, mods, sreg);
+	if (sreg == RSP || sreg == R12)
+		emit_sib(st, SIB_SCALE_1, sreg, sreg);
+	emit_imm(st, 0, sizeof(uint8_t));
+}
+
 /*
  * emit ror <imm8>, %<dreg>
  */
@@ -979,17 +1020,18 @@ emit_jcc_reg(struct bpf_jit_state *st, uint32_t op, uint32_t sreg,
  *   mov %rdx, %<dreg>
  * mov %r11, %rax
  * mov %r10, %rdx
+ * check for zero divisor is omitted when validator proved it is not zero.
  */
 static void
 emit_div(struct bpf_jit_state *st, uint32_t op, uint32_t sreg, uint32_t dreg,
-	uint32_t imm)
+	uint32_t imm, uint32_t nz)
 {
 	uint32_t sr;
 
 	const uint8_t ops = 0xF7;
 	const uint8_t mods = 6;
 
-	if (BPF_SRC(op) == BPF_X) {
+	if (BPF_SRC(op) == BPF_X && nz == 0) {
 
 		/* check that src divisor is not zero */
 		emit_tst_reg(st, BPF_CLASS(op), sreg, sreg);
@@ -1239,6 +1281,9 @@ emit_ret(struct bpf_jit_state *st)
 	emit_bytes(st, &ops, sizeof(ops));
 }
 
+static void
+emit_burst_epilog(struct bpf_jit_state *st);
+
 static void
 emit_epilog(struct bpf_jit_state *st)
 {
@@ -1254,6 +1299,11 @@ emit_epilog(struct bpf_jit_state *st)
 	/* store offset of epilog block */
 	st->exit.off = st->sz;
 
+	if (st->burst.gen != 0) {
+		emit_burst_epilog(st);
+		return;
+	}
+
 	spil = 0;
 	for (i = 0; i != RTE_DIM(save_regs); i++)
 		spil += INUSE(st->reguse, save_regs[i]);
@@ -1280,22 +1330,172 @@ emit_epilog(struct bpf_jit_state *st)
 	emit_ret(st);
 }
 
+/*
+ * emit prefetch for the data of the next input context (if any):
+ * mov %r12, %r11
+ * add $8, %r11
+ * mov BURST_END_OFS(%rbp), %r10
+ * cmp %r10, %r11
+ * cmovae %r12, %r11
+ * mov (%r11), %r11
+ * for mbuf input:
+ *   mov <buf_addr>(%r11), %r10
+ *   movzw <data_off>(%r11), %r11
+ *   add %r10, %r11
+ * prefetcht0 (%r11)
+ */
+static void
+emit_burst_prefetch(struct bpf_jit_state *st, enum rte_bpf_arg_type type)
+{
+	if (RTE_BPF_ARG_PTR_TYPE(type) == 0)
+		return;
+
+	emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X, REG_BURST_CTX,
+		REG_TMP0);
+	emit_alu_imm(st, EBPF_ALU64 | BPF_ADD | BPF_K, REG_TMP0,
+		sizeof(uint64_t));
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, RBP, REG_TMP1,
+		BURST_END_OFS);
+	emit_cmp_reg(st, EBPF_ALU64, REG_TMP1, REG_TMP0);
+	emit_movcc_reg(st, EBPF_ALU64 | BPF_JGE, REG_BURST_CTX, REG_TMP0);
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, REG_TMP0, REG_TMP0, 0);
+
+	if (type == RTE_BPF_ARG_PTR_MBUF) {
+		emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, REG_TMP0,
+			REG_TMP1, offsetof(struct rte_mbuf, buf_addr));
+		emit_ld_reg(st, BPF_LDX | BPF_MEM | BPF_H, REG_TMP0,
+			REG_TMP0, offsetof(struct rte_mbuf, data_off));
+		emit_alu_reg(st, EBPF_ALU64 | BPF_ADD | BPF_X, REG_TMP1,
+			REG_TMP0);
+	}
+
+	emit_prefetch(st, REG_TMP0);
+}
+
+/*
+ * prolog for the burst version of the code:
+ * uint32_t func_burst(void *ctx[], uint64_t rc[], uint32_t num).
+ * all callee saved registers are stored unconditionally,
+ * as the cost is amortized over the whole burst.
+ */
+static void
+emit_burst_prolog(struct bpf_jit_state *st, const struct rte_bpf *bpf)
+{
+	uint32_t i;
+	int32_t ofs;
+
+	emit_alu_imm(st, EBPF_ALU64 | BPF_SUB | BPF_K, RSP, BURST_FRAME_SZ);
+
+	ofs = BURST_SAVE_OFS;
+	for (i = 0; i != RTE_DIM(save_regs); i++) {
+		emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, save_regs[i], RSP,
+			ofs);
+		ofs += sizeof(uint64_t);
+	}
+
+	/* store rc[] and num, calculate end of ctx[] */
+	emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, RSI, RSP, BURST_RC_OFS);
+	emit_st_reg(st, BPF_STX | BPF_MEM | BPF_W, RDX, RSP, BURST_NUM_OFS);
+	emit_mov_reg(st, BPF_ALU | EBPF_MOV | BPF_X, RDX, RDX);
+	emit_shift_imm(st, EBPF_ALU64 | BPF_LSH | BPF_K, RDX, 3);
+	emit_alu_reg(st, EBPF_ALU64 | BPF_ADD | BPF_X, RDI, RDX);
+	emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, RDX, RSP, BURST_END_OFS);
+	emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X, RDI, REG_BURST_CTX);
+
+	emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X, RSP, RBP);
+	if (bpf->stack_sz != 0)
+		emit_alu_imm(st, EBPF_ALU64 | BPF_SUB | BPF_K, RSP,
+			bpf->stack_sz);
+
+	/* nothing to do for an empty burst */
+	emit_cmp_reg(st, EBPF_ALU64, RDX, REG_BURST_CTX);
+	emit_abs_jcc(st, BPF_JMP | BPF_JGE | BPF_K, st->burst.fin);
+
+	/* loop: R1 = *ctx */
+	st->burst.loop = st->sz;
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, REG_BURST_CTX,
+		ebpf2x86[EBPF_REG_1], 0);
+	emit_burst_prefetch(st, bpf->prm.prog_arg.type);
+}
+
+/*
+ * epilog for the burst version of the code:
+ * store R0 into rc[], move to the next input context and go to the start
+ * of the loop, when all input contexts are processed return num.
+ */
+static void
+emit_burst_epilog(struct bpf_jit_state *st)
+{
+	uint32_t i;
+	int32_t ofs;
+
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, RBP, REG_TMP0,
+		BURST_RC_OFS);
+	emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, ebpf2x86[EBPF_REG_0],
+		REG_TMP0, 0);
+	emit_alu_imm(st, EBPF_ALU64 | BPF_ADD | BPF_K, REG_TMP0,
+		sizeof(uint64_t));
+	emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, REG_TMP0, RBP,
+		BURST_RC_OFS);
+
+	emit_alu_imm(st, EBPF_ALU64 | BPF_ADD | BPF_K, REG_BURST_CTX,
+		sizeof(uint64_t));
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, RBP, REG_TMP1,
+		BURST_END_OFS);
+	emit_cmp_reg(st, EBPF_ALU64, REG_TMP1, REG_BURST_CTX);
+	emit_abs_jcc(st, BPF_JMP | EBPF_JLT | BPF_K, st->burst.loop);
+
+	st->burst.fin = st->sz;
+
+	emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X, RBP, RSP);
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | BPF_W, RSP, RAX, BURST_NUM_OFS);
+
+	ofs = BURST_SAVE_OFS;
+	for (i = 0; i != RTE_DIM(save_regs); i++) {
+		emit_ld_reg(st, BPF_LDX | BPF_MEM | EBPF_DW, RSP, save_regs[i],
+			ofs);
+		ofs += sizeof(uint64_t);
+	}
+
+	emit_alu_imm(st, EBPF_ALU64 | BPF_ADD | BPF_K, RSP, BURST_FRAME_SZ);
+	emit_ret(st);
+}
+
+/*
+ * switch state between single and burst versions of the code.
+ */
+static void
+burst_swap(struct bpf_jit_state *st)
+{
+	int32_t *off;
+	int32_t ofs;
+	uint32_t ru;
+
+	off = st->off;
+	st->off = st->burst.off;
+	st->burst.off = off;
+
+	ofs = st->exit.off;
+	st->exit.off = st->burst.exit;
+	st->burst.exit = ofs;
+
+	ru = st->reguse;
+	st->reguse = st->burst.reguse;
+	st->burst.reguse = ru;
+
+	st->exit.num = 0;
+	st->burst.gen ^= 1;
+}
+
 /*
  * walk through bpf code and translate them x86_64 one.
  */
 static int
-emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
+emit_ins(struct bpf_jit_state *st, const struct rte_bpf *bpf)
 {
 	uint32_t i, dr, op, sr;
 	const struct ebpf_insn *ins;
 
-	/* reset state fields */
-	st->sz = 0;
-	st->exit.num = 0;
-	st->ldmb.stack_ofs = bpf->stack_sz;
-
-	emit_prolog(st, bpf->stack_sz);
-
 	for (i = 0; i != bpf->prm.nb_ins; i++) {
 
 		st->idx = i;
@@ -1398,7 +1598,8 @@ emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
 		case (EBPF_ALU64 | BPF_MOD | BPF_K):
 		case (EBPF_ALU64 | BPF_DIV | BPF_X):
 		case (EBPF_ALU64 | BPF_MOD | BPF_X):
-			emit_div(st, op, sr, dr, ins->imm);
+			emit_div(st, op, sr, dr, ins->imm,
+				bpf->ins_info[i].flags & BPF_INS_NZ_SRC);
 			break;
 		/* load instructions */
 		case (BPF_LDX | BPF_MEM | BPF_B):
@@ -1491,6 +1692,35 @@ emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
 	return 0;
 }
 
+/*
+ * generate both single and burst versions of the code,
+ * the latter one is placed right after the former one.
+ */
+static int
+emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
+{
+	int32_t rc;
+
+	/* reset state fields */
+	st->sz = 0;
+	st->exit.num = 0;
+	st->ldmb.stack_ofs = bpf->stack_sz;
+
+	emit_prolog(st, bpf->stack_sz);
+	rc = emit_ins(st, bpf);
+	if (rc != 0)
+		return rc;
+
+	st->burst.ofs = st->sz;
+
+	burst_swap(st);
+	emit_burst_prolog(st, bpf);
+	rc = emit_ins(st, bpf);
+	burst_swap(st);
+
+	return rc;
+}
+
 /*
  * produce a native ISA version of the given BPF code.
  */
@@ -1504,13 +1734,16 @@ bpf_jit_x86(struct rte_bpf *bpf)
 
 	/* init state */
 	memset(&st, 0, sizeof(st));
-	st.off = malloc(bpf->prm.nb_ins * sizeof(st.off[0]));
+	st.off = malloc(2 * bpf->prm.nb_ins * sizeof(st.off[0]));
 	if (st.off == NULL)
 		return -ENOMEM;
+	st.burst.off = st.off + bpf->prm.nb_ins;
 
 	/* fill with fake offsets */
 	st.exit.off = INT32_MAX;
-	for (i = 0; i != bpf->prm.nb_ins; i++)
+	st.burst.exit = INT32_MAX;
+	st.burst.fin = INT32_MAX;
+	for (i = 0; i != 2 * bpf->prm.nb_ins; i++)
 		st.off[i] = INT32_MAX;
 
 	/*
@@ -1541,6 +1774,7 @@ bpf_jit_x86(struct rte_bpf *bpf)
 		munmap(st.ins, st.sz);
 	else {
 		bpf->jit.func = (void *)st.ins;
+		bpf->jit.func_burst = (void *)(st.ins + st.burst.ofs);
 		bpf->jit.sz = st.sz;
 	}
 
@@ -25,12 +25,13 @@ bpf_load(const struct rte_bpf_prm *prm)
 {
 	uint8_t *buf;
 	struct rte_bpf *bpf;
-	size_t sz, bsz, insz, xsz;
+	size_t sz, bsz, insz, xsz, infsz;
 
 	xsz =  prm->nb_xsym * sizeof(prm->xsym[0]);
 	insz = prm->nb_ins * sizeof(prm->ins[0]);
+	infsz = prm->nb_ins * sizeof(bpf->ins_info[0]);
 	bsz = sizeof(bpf[0]);
-	sz = insz + xsz + bsz;
+	sz = insz + xsz + bsz + infsz;
 
 	buf = mmap(NULL, sz, PROT_READ | PROT_WRITE,
 		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -47,6 +48,7 @@ bpf_load(const struct rte_bpf_prm *prm)
 
 	bpf->prm.xsym = (void *)(buf + bsz);
 	bpf->prm.ins = (void *)(buf + bsz + xsz);
+	bpf->ins_info = (void *)(buf + bsz + xsz + insz);
 
 	return bpf;
 }
@@ -116,6 +118,8 @@ rte_bpf_load(const struct rte_bpf_prm *prm)
 	}
 
 	rc = bpf_validate(bpf);
+	if (rc == 0)
+		rc = bpf_optimize(bpf);
 	if (rc == 0) {
 		bpf_jit(bpf);
 		if (mprotect(bpf, bpf->sz, PROT_READ) != 0)
@@ -0,0 +1,252 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 agent
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_debug.h>
+
+#include "bpf_impl.h"
+
+/*
+ * Simple eBPF code optimizer, relies on the information
+ * collected by the validator (see bpf_ins_info):
+ * - instructions with constant result are replaced with 'mov dst, imm';
+ * - BPF_IND loads with constant offset are replaced with BPF_ABS ones;
+ * - always taken conditional jumps are replaced with unconditional ones;
+ * - never taken conditional jumps, jumps to the next instruction and
+ *   instructions that became unreachable are removed.
+ * Both interpreter and JIT benefit from it.
+ */
+
+static int
+ins_is_jcc(const struct ebpf_insn *ins)
+{
+	return BPF_CLASS(ins->code) == BPF_JMP &&
+		BPF_OP(ins->code) != BPF_JA &&
+		BPF_OP(ins->code) != EBPF_CALL &&
+		BPF_OP(ins->code) != EBPF_EXIT;
+}
+
+static int
+ins_is_jmp(const struct ebpf_insn *ins)
+{
+	return ins->code == (BPF_JMP | BPF_JA) || ins_is_jcc(ins);
+}
+
+/*
+ * apply info collected by validator to the instructions.
+ * returns number of modified instructions, never taken jumps
+ * are marked in *del*.
+ */
+static uint32_t
+opt_fold(struct rte_bpf *bpf, uint8_t del[])
+{
+	uint32_t i, n;
+	struct ebpf_insn *ins;
+	const struct bpf_ins_info *inf;
+
+	n = 0;
+	for (i = 0; i != bpf->prm.nb_ins; i++) {
+
+		ins = (struct ebpf_insn *)(uintptr_t)(bpf->prm.ins + i);
+		inf = bpf->ins_info + i;
+
+		if ((inf->flags & BPF_INS_CONST) != 0) {
+			if (BPF_CLASS(ins->code) == BPF_LD)
+				ins->code = BPF_LD | BPF_ABS |
+					BPF_SIZE(ins->code);
+			else
+				ins->code = BPF_CLASS(ins->code) |
+					EBPF_MOV | BPF_K;
+			ins->src_reg = 0;
+			ins->off = 0;
+			ins->imm = inf->imm;
+			n++;
+		} else if ((inf->flags & BPF_INS_JCC_TAKEN) != 0) {
+			ins->code = BPF_JMP | BPF_JA;
+			ins->dst_reg = 0;
+			ins->src_reg = 0;
+			ins->imm = 0;
+			n++;
+		} else if ((inf->flags & BPF_INS_JCC_FALL) != 0) {
+			del[i] = 1;
+			n++;
+		}
+	}
+
+	return n;
+}
+
+/*
+ * mark instructions that are not reachable any more.
+ */
+static int
+opt_mark_unreachable(const struct rte_bpf *bpf, uint8_t del[])
+{
+	uint32_t i, n, sp;
+	uint32_t *stack;
+	uint8_t *live;
+	const struct ebpf_insn *ins;
+
+	n = bpf->prm.nb_ins;
+	stack = malloc(n * sizeof(stack[0]));
+	live = calloc(n, sizeof(live[0]));
+	if (stack == NULL || live == NULL) {
+		free(stack);
+		free(live);
+		return -ENOMEM;
+	}
+
+	/* program is already validated, so no out of bounds jumps */
+	sp = 0;
+	stack[sp++] = 0;
+	live[0] = 1;
+
+	while (sp != 0) {
+
+		i = stack[--sp];
+		ins = bpf->prm.ins + i;
+
+#define	OPT_PUSH(x)	do { \
+	if (live[(x)] == 0) { \
+		live[(x)] = 1; \
+		stack[sp++] = (x); \
+	} \
+} while (0)
+
+		if (del[i] != 0)
+			OPT_PUSH(i + 1);
+		else if (ins->code == (BPF_JMP | EBPF_EXIT))
+			;
+		else if (ins->code == (BPF_JMP | BPF_JA))
+			OPT_PUSH(i + ins->off + 1);
+		else if (ins_is_jcc(ins)) {
+			OPT_PUSH(i + ins->off + 1);
+			OPT_PUSH(i + 1);
+		} else if (ins->code == (BPF_LD | BPF_IMM | EBPF_DW)) {
+			live[i + 1] = 1;
+			OPT_PUSH(i + 2);
+		} else
+			OPT_PUSH(i + 1);
+
+#undef OPT_PUSH
+	}
+
+	for (i = 0; i != n; i++)
+		del[i] |= (live[i] == 0);
+
+	free(stack);
+	free(live);
+	return 0;
+}
+
+/*
+ * calculate new positions for the remaining instructions,
+ * remove jumps to the next remaining instruction.
+ */
+static void
+opt_remap(const struct rte_bpf *bpf, uint8_t del[], uint32_t map[])
+{
+	uint32_t i, k, n, tgt;
+	int32_t change;
+	const struct ebpf_insn *ins;
+
+	n = bpf->prm.nb_ins;
+
+	do {
+		k = 0;
+		for (i = 0; i != n; i++) {
+			map[i] = k;
+			k += (del[i] == 0);
+		}
+		map[n] = k;
+
+		change = 0;
+		for (i = 0; i != n; i++) {
+			ins = bpf->prm.ins + i;
+			if (del[i] == 0 && ins->code == (BPF_JMP | BPF_JA)) {
+				tgt = i + ins->off + 1;
+				if (map[tgt] == map[i] + 1) {
+					del[i] = 1;
+					change = 1;
+				}
+			}
+		}
+	} while (change != 0);
+}
+
+static void
+opt_compact(struct rte_bpf *bpf, const uint8_t del[], const uint32_t map[])
+{
+	uint32_t i, j, n;
+	struct ebpf_insn *ins, tins;
+
+	n = bpf->prm.nb_ins;
+	ins = (struct ebpf_insn *)(uintptr_t)bpf->prm.ins;
+
+	/* instructions only move backward, so can be done in place */
+	for (i = 0; i != n; i++) {
+
+		if (del[i] != 0)
+			continue;
+
+		j = map[i];
+		tins = ins[i];
+		if (ins_is_jmp(&tins))
+			tins.off = map[i + tins.off + 1] - j - 1;
+
+		ins[j] = tins;
+		bpf->ins_info[j] = bpf->ins_info[i];
+	}
+
+	bpf->prm.nb_ins = map[n];
+}
+
+int
+bpf_optimize(struct rte_bpf *bpf)
+{
+	int32_t rc;
+	uint32_t n, nf;
+	uint8_t *del;
+	uint32_t *map;
+
+	if (bpf->ins_info == NULL)
+		return 0;
+
+	n = bpf->prm.nb_ins;
+	del = calloc(n, sizeof(del[0]));
+	map = malloc((n + 1) * sizeof(map[0]));
+	if (del == NULL || map == NULL) {
+		free(del);
+		free(map);
+		return -ENOMEM;
+	}
+
+	nf = opt_fold(bpf, del);
+
+	rc = 0;
+	if (nf != 0) {
+		rc = opt_mark_unreachable(bpf, del);
+		if (rc == 0) {
+			opt_remap(bpf, del, map);
+			opt_compact(bpf, del, map);
+		}
+	}
+
+	RTE_BPF_LOG(DEBUG, "%s(%p): %u instructions modified, "
+		"%u instructions removed, error code: %d;\n",
+		__func__, bpf, nf, n - bpf->prm.nb_ins, rc);
+
+	free(del);
+	free(map);
+	return rc;
+}
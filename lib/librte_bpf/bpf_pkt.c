@@ -222,14 +222,22 @@ pkt_filter_jit(const struct rte_bpf_jit *jit, struct rte_mbuf *mb[],
 	uint32_t num, uint32_t drop)
 {
 	uint32_t i, n;
-	void *dp;
+	void *dp[num];
 	uint64_t rc[num];
 
+	for (i = 0; i != num; i++)
+		dp[i] = rte_pktmbuf_mtod(mb[i], void *);
+
 	n = 0;
-	for (i = 0; i != num; i++) {
-		dp = rte_pktmbuf_mtod(mb[i], void *);
-		rc[i] = jit->func(dp);
-		n += (rc[i] == 0);
+	if (jit->func_burst != NULL) {
+		jit->func_burst(dp, rc, num);
+		for (i = 0; i != num; i++)
+			n += (rc[i] == 0);
+	} else {
+		for (i = 0; i != num; i++) {
+			rc[i] = jit->func(dp[i]);
+			n += (rc[i] == 0);
+		}
 	}
 
 	if (n != 0)
@@ -256,9 +264,15 @@ pkt_filter_mb_jit(const struct rte_bpf_jit *jit, struct rte_mbuf *mb[],
 	uint64_t rc[num];
 
 	n = 0;
-	for (i = 0; i != num; i++) {
-		rc[i] = jit->func(mb[i]);
-		n += (rc[i] == 0);
+	if (jit->func_burst != NULL) {
+		jit->func_burst((void **)mb, rc, num);
+		for (i = 0; i != num; i++)
+			n += (rc[i] == 0);
+	} else {
+		for (i = 0; i != num; i++) {
+			rc[i] = jit->func(mb[i]);
+			n += (rc[i] == 0);
+		}
 	}
 
 	if (n != 0)
@@ -502,8 +516,13 @@ rte_bpf_eth_tx_unload(uint16_t port, uint16_t queue)
 	rte_spinlock_unlock(&cbh->lock);
 }
 
+/*
+ * load BPF program and install it as port/queue callback.
+ * if fname is NULL, prm->ins contains the program itself,
+ * otherwise it is loaded from the ELF file.
+ */
 static int
-bpf_eth_elf_load(struct bpf_eth_cbh *cbh, uint16_t port, uint16_t queue,
+bpf_eth_load(struct bpf_eth_cbh *cbh, uint16_t port, uint16_t queue,
 	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
 	uint32_t flags)
 {
@@ -532,7 +551,10 @@ bpf_eth_elf_load(struct bpf_eth_cbh *cbh, uint16_t port, uint16_t queue,
 		return -EINVAL;
 	}
 
-	bpf = rte_bpf_elf_load(prm, fname, sname);
+	if (fname == NULL)
+		bpf = rte_bpf_load(prm);
+	else
+		bpf = rte_bpf_elf_load(prm, fname, sname);
 	if (bpf == NULL)
 		return -rte_errno;
 
@@ -582,7 +604,7 @@ rte_bpf_eth_rx_elf_load(uint16_t port, uint16_t queue,
 
 	cbh = &rx_cbh;
 	rte_spinlock_lock(&cbh->lock);
-	rc = bpf_eth_elf_load(cbh, port, queue, prm, fname, sname, flags);
+	rc = bpf_eth_load(cbh, port, queue, prm, fname, sname, flags);
 	rte_spinlock_unlock(&cbh->lock);
 
 	return rc;
@@ -598,7 +620,37 @@ rte_bpf_eth_tx_elf_load(uint16_t port, uint16_t queue,
 
 	cbh = &tx_cbh;
 	rte_spinlock_lock(&cbh->lock);
-	rc = bpf_eth_elf_load(cbh, port, queue, prm, fname, sname, flags);
+	rc = bpf_eth_load(cbh, port, queue, prm, fname, sname, flags);
+	rte_spinlock_unlock(&cbh->lock);
+
+	return rc;
+}
+
+int
+rte_bpf_eth_rx_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, uint32_t flags)
+{
+	int32_t rc;
+	struct bpf_eth_cbh *cbh;
+
+	cbh = &rx_cbh;
+	rte_spinlock_lock(&cbh->lock);
+	rc = bpf_eth_load(cbh, port, queue, prm, NULL, NULL, flags);
+	rte_spinlock_unlock(&cbh->lock);
+
+	return rc;
+}
+
+int
+rte_bpf_eth_tx_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, uint32_t flags)
+{
+	int32_t rc;
+	struct bpf_eth_cbh *cbh;
+
+	cbh = &tx_cbh;
+	rte_spinlock_lock(&cbh->lock);
+	rc = bpf_eth_load(cbh, port, queue, prm, NULL, NULL, flags);
 	rte_spinlock_unlock(&cbh->lock);
 
 	return rc;
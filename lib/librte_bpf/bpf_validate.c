@@ -30,9 +30,21 @@ struct bpf_reg_val {
 	} u;
 };
 
+/*
+ * register value range, tracked for the optimizer.
+ * Unlike bpf_reg_val it is always exact (but less precise):
+ * only values derived from immediates and comparisons with them
+ * are known, everything else (pointers, stack, etc.) is any value.
+ */
+struct bpf_opt_val {
+	uint64_t min;
+	uint64_t max;
+};
+
 struct bpf_eval_state {
 	struct bpf_reg_val rv[EBPF_REG_NUM];
 	struct bpf_reg_val sv[MAX_BPF_STACK_SIZE / sizeof(uint64_t)];
+	struct bpf_opt_val ov[EBPF_REG_NUM];
 };
 
 /* possible instruction node colour */
@@ -54,13 +66,23 @@ enum {
 
 #define	MAX_EDGES	2
 
+/* optimizer info for the node, collected over all evaluated paths */
+#define	OPT_EVAL	0x1	/* node was evaluated */
+#define	OPT_JCC_TAKEN	0x2	/* conditional jump can be taken */
+#define	OPT_JCC_FALL	0x4	/* conditional jump can fall through */
+#define	OPT_CONST	0x8	/* result was a constant (opt_val) */
+#define	OPT_VAR		0x10	/* result can vary */
+#define	OPT_ZERO_SRC	0x20	/* divisor can be zero */
+
 struct inst_node {
 	uint8_t colour;
 	uint8_t nb_edge:4;
 	uint8_t cur_edge:4;
 	uint8_t edge_type[MAX_EDGES];
+	uint8_t opt;
 	uint32_t edge_dest[MAX_EDGES];
 	uint32_t prev_node;
+	uint64_t opt_val;
 	struct bpf_eval_state *evst;
 };
 
@@ -1123,6 +1145,441 @@ eval_jcc(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 	return NULL;
 }
 
+/*
+ * Collect information for the optimizer.
+ * Each instruction is evaluated once per each possible path,
+ * so the info is merged over all of them for every node.
+ */
+
+static void
+opt_any(struct bpf_opt_val *ov, uint64_t mask)
+{
+	ov->min = 0;
+	ov->max = mask;
+}
+
+static int
+opt_is_const(const struct bpf_opt_val *ov)
+{
+	return ov->min == ov->max;
+}
+
+/* merge constant result with the ones from other paths */
+static void
+opt_set_const(struct inst_node *node, uint64_t v)
+{
+	if ((node->opt & OPT_CONST) == 0) {
+		node->opt |= OPT_CONST;
+		node->opt_val = v;
+	} else if (node->opt_val != v)
+		node->opt |= OPT_VAR;
+}
+
+/* truncate register value range to 32 bits */
+static void
+opt_trunc32(struct bpf_opt_val *ov)
+{
+	if (opt_is_const(ov)) {
+		ov->min = (uint32_t)ov->min;
+		ov->max = ov->min;
+	} else if (ov->max > UINT32_MAX)
+		opt_any(ov, UINT32_MAX);
+}
+
+/*
+ * calculate result of ALU operation with constant operands,
+ * same way as interpreter does.
+ * Returns zero on success, or non-zero when result is not well defined.
+ */
+static int
+opt_alu_const(uint32_t op, size_t opsz, uint64_t d, uint64_t s, uint64_t *r)
+{
+	uint64_t msk;
+
+	msk = RTE_LEN2MASK(opsz, uint64_t);
+	d &= msk;
+	s &= msk;
+
+	switch (op) {
+	case BPF_ADD:
+		*r = d + s;
+		break;
+	case BPF_SUB:
+		*r = d - s;
+		break;
+	case BPF_MUL:
+		*r = d * s;
+		break;
+	case BPF_DIV:
+		if (s == 0)
+			return -EINVAL;
+		*r = d / s;
+		break;
+	case BPF_MOD:
+		if (s == 0)
+			return -EINVAL;
+		*r = d % s;
+		break;
+	case BPF_OR:
+		*r = d | s;
+		break;
+	case BPF_AND:
+		*r = d & s;
+		break;
+	case BPF_XOR:
+		*r = d ^ s;
+		break;
+	case BPF_LSH:
+		if (s >= opsz)
+			return -EINVAL;
+		*r = d << s;
+		break;
+	case BPF_RSH:
+		if (s >= opsz)
+			return -EINVAL;
+		*r = d >> s;
+		break;
+	case EBPF_ARSH:
+		if (s >= opsz || opsz != sizeof(uint64_t) * CHAR_BIT)
+			return -EINVAL;
+		*r = (int64_t)d >> s;
+		break;
+	case BPF_NEG:
+		*r = -d;
+		break;
+	case EBPF_MOV:
+		*r = s;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	*r &= msk;
+	return 0;
+}
+
+static void
+opt_eval_alu(struct bpf_eval_state *st, struct inst_node *node,
+	const struct ebpf_insn *ins)
+{
+	int32_t rc;
+	uint32_t op;
+	size_t opsz;
+	uint64_t msk, v;
+	struct bpf_opt_val *rd, rs;
+
+	op = BPF_OP(ins->code);
+	opsz = (BPF_CLASS(ins->code) == BPF_ALU) ?
+		sizeof(uint32_t) : sizeof(uint64_t);
+	opsz = opsz * CHAR_BIT;
+	msk = RTE_LEN2MASK(opsz, uint64_t);
+
+	rd = st->ov + ins->dst_reg;
+
+	if (BPF_SRC(ins->code) == BPF_X)
+		rs = st->ov[ins->src_reg];
+	else {
+		rs.min = (int64_t)ins->imm;
+		rs.max = rs.min;
+	}
+
+	if (msk != UINT64_MAX) {
+		opt_trunc32(rd);
+		opt_trunc32(&rs);
+	}
+
+	if ((op == BPF_DIV || op == BPF_MOD) && rs.min == 0)
+		node->opt |= OPT_ZERO_SRC;
+
+	/* byte swap is not tracked */
+	if (op == EBPF_END) {
+		opt_any(rd, UINT64_MAX);
+		node->opt |= OPT_VAR;
+		return;
+	}
+
+	/* constant operands */
+	if ((op == BPF_NEG || opt_is_const(&rs)) &&
+			(op == EBPF_MOV || opt_is_const(rd))) {
+		rc = opt_alu_const(op, opsz, rd->min, rs.min, &v);
+		if (rc == 0) {
+			opt_set_const(node, v);
+			rd->min = v;
+			rd->max = v;
+			return;
+		}
+	}
+
+	node->opt |= OPT_VAR;
+
+	/* ranges for some of the most common cases */
+	if (op == EBPF_MOV)
+		*rd = rs;
+	else if (op == BPF_AND)
+		opt_any(rd, RTE_MIN(rd->max, rs.max));
+	else if (op == BPF_RSH && opt_is_const(&rs) && rs.min < opsz) {
+		rd->min >>= rs.min;
+		rd->max >>= rs.min;
+	} else if (op == BPF_ADD && rd->max <= msk - rs.max) {
+		rd->min += rs.min;
+		rd->max += rs.max;
+	} else
+		opt_any(rd, msk);
+}
+
+/*
+ * returns possible outcomes (OPT_JCC_TAKEN and/or OPT_JCC_FALL)
+ * for conditional jump with given operands.
+ */
+static uint32_t
+opt_jcc_res(uint32_t op, const struct bpf_opt_val *rd,
+	const struct bpf_opt_val *rs)
+{
+	const uint32_t any = OPT_JCC_TAKEN | OPT_JCC_FALL;
+
+	/* signed comparisons, handle only non-negative values */
+	if (op == EBPF_JSGT || op == EBPF_JSGE || op == EBPF_JSLT ||
+			op == EBPF_JSLE) {
+		if (rd->max > INT64_MAX || rs->max > INT64_MAX)
+			return any;
+		if (op == EBPF_JSGT)
+			op = BPF_JGT;
+		else if (op == EBPF_JSGE)
+			op = BPF_JGE;
+		else if (op == EBPF_JSLT)
+			op = EBPF_JLT;
+		else
+			op = EBPF_JLE;
+	}
+
+	switch (op) {
+	case BPF_JEQ:
+	case EBPF_JNE:
+		if (opt_is_const(rd) && opt_is_const(rs) && rd->min == rs->min)
+			return (op == BPF_JEQ) ? OPT_JCC_TAKEN : OPT_JCC_FALL;
+		if (rd->max < rs->min || rd->min > rs->max)
+			return (op == BPF_JEQ) ? OPT_JCC_FALL : OPT_JCC_TAKEN;
+		break;
+	case BPF_JGT:
+		if (rd->min > rs->max)
+			return OPT_JCC_TAKEN;
+		if (rd->max <= rs->min)
+			return OPT_JCC_FALL;
+		break;
+	case BPF_JGE:
+		if (rd->min >= rs->max)
+			return OPT_JCC_TAKEN;
+		if (rd->max < rs->min)
+			return OPT_JCC_FALL;
+		break;
+	case EBPF_JLT:
+		if (rd->max < rs->min)
+			return OPT_JCC_TAKEN;
+		if (rd->min >= rs->max)
+			return OPT_JCC_FALL;
+		break;
+	case EBPF_JLE:
+		if (rd->max <= rs->min)
+			return OPT_JCC_TAKEN;
+		if (rd->min > rs->max)
+			return OPT_JCC_FALL;
+		break;
+	case BPF_JSET:
+		if (opt_is_const(rd) && opt_is_const(rs))
+			return ((rd->min & rs->min) != 0) ?
+				OPT_JCC_TAKEN : OPT_JCC_FALL;
+		if (rd->max == 0 || rs->max == 0)
+			return OPT_JCC_FALL;
+		break;
+	}
+
+	return any;
+}
+
+/*
+ * narrow dst register range for both branches of conditional jump,
+ * when it is compared with the constant.
+ */
+static void
+opt_jcc_narrow(uint32_t op, struct bpf_opt_val *trd, struct bpf_opt_val *frd,
+	uint64_t v)
+{
+	switch (op) {
+	case BPF_JEQ:
+		trd->min = v;
+		trd->max = v;
+		break;
+	case EBPF_JNE:
+		frd->min = v;
+		frd->max = v;
+		break;
+	case BPF_JGT:
+		if (v != UINT64_MAX)
+			trd->min = RTE_MAX(trd->min, v + 1);
+		frd->max = RTE_MIN(frd->max, v);
+		break;
+	case BPF_JGE:
+		trd->min = RTE_MAX(trd->min, v);
+		if (v != 0)
+			frd->max = RTE_MIN(frd->max, v - 1);
+		break;
+	case EBPF_JLT:
+		if (v != 0)
+			trd->max = RTE_MIN(trd->max, v - 1);
+		frd->min = RTE_MAX(frd->min, v);
+		break;
+	case EBPF_JLE:
+		trd->max = RTE_MIN(trd->max, v);
+		if (v != UINT64_MAX)
+			frd->min = RTE_MAX(frd->min, v + 1);
+		break;
+	}
+}
+
+static void
+opt_eval_jcc(struct bpf_verifier *bvf, struct inst_node *node,
+	const struct ebpf_insn *ins)
+{
+	uint32_t op;
+	struct bpf_opt_val rd, rs;
+
+	op = BPF_OP(ins->code);
+	rd = bvf->evst->ov[ins->dst_reg];
+
+	if (BPF_SRC(ins->code) == BPF_X)
+		rs = bvf->evst->ov[ins->src_reg];
+	else {
+		rs.min = (int64_t)ins->imm;
+		rs.max = rs.min;
+	}
+
+	node->opt |= opt_jcc_res(op, &rd, &rs);
+
+	/*
+	 * first edge (jump target) is evaluated with the current state,
+	 * second one (fall-through) - with the state saved for the node.
+	 */
+	if (opt_is_const(&rs) && node->evst != NULL)
+		opt_jcc_narrow(op, bvf->evst->ov + ins->dst_reg,
+			node->evst->ov + ins->dst_reg, rs.min);
+}
+
+static void
+opt_eval(struct bpf_verifier *bvf, struct inst_node *node,
+	const struct ebpf_insn *ins)
+{
+	uint32_t i;
+	struct bpf_eval_state *st;
+
+	st = bvf->evst;
+	node->opt |= OPT_EVAL;
+
+	switch (BPF_CLASS(ins->code)) {
+	case BPF_ALU:
+	case EBPF_ALU64:
+		opt_eval_alu(st, node, ins);
+		break;
+	case BPF_LDX:
+		opt_any(st->ov + ins->dst_reg, RTE_LEN2MASK(
+			bpf_size(BPF_SIZE(ins->code)) * CHAR_BIT, uint64_t));
+		break;
+	case BPF_LD:
+		/* load 64 bit immediate value */
+		if (ins->code == (BPF_LD | BPF_IMM | EBPF_DW)) {
+			opt_any(st->ov + ins->dst_reg, UINT64_MAX);
+			break;
+		}
+		/* BPF_IND with constant offset */
+		if (BPF_MODE(ins->code) == BPF_IND) {
+			if (opt_is_const(st->ov + ins->src_reg))
+				opt_set_const(node,
+					(uint32_t)(st->ov[ins->src_reg].min +
+					ins->imm));
+			else
+				node->opt |= OPT_VAR;
+		}
+		/* BPF_ABS/BPF_IND, R1-R5 are scratched */
+		for (i = EBPF_REG_1; i != EBPF_REG_6; i++)
+			opt_any(st->ov + i, UINT64_MAX);
+		opt_any(st->ov + EBPF_REG_0, RTE_LEN2MASK(
+			bpf_size(BPF_SIZE(ins->code)) * CHAR_BIT, uint64_t));
+		break;
+	case BPF_JMP:
+		if (ins->code == (BPF_JMP | EBPF_CALL)) {
+			for (i = EBPF_REG_0; i != EBPF_REG_6; i++)
+				opt_any(st->ov + i, UINT64_MAX);
+		} else if (node->nb_edge > 1)
+			opt_eval_jcc(bvf, node, ins);
+		break;
+	}
+}
+
+/*
+ * fill per instruction info with facts that are true for all paths.
+ */
+static void
+opt_fill_info(const struct bpf_verifier *bvf, struct bpf_ins_info *info)
+{
+	uint32_t i, op, opt;
+	uint64_t v;
+	const struct ebpf_insn *ins;
+
+	for (i = 0; i != bvf->prm->nb_ins; i++) {
+
+		ins = bvf->prm->ins + i;
+		opt = bvf->in[i].opt;
+		info[i].flags = 0;
+		info[i].imm = 0;
+
+		if ((opt & OPT_EVAL) == 0)
+			continue;
+
+		op = ins->code;
+
+		switch (BPF_CLASS(op)) {
+		case BPF_JMP:
+			opt &= OPT_JCC_TAKEN | OPT_JCC_FALL;
+			if (bvf->in[i].nb_edge < 2)
+				break;
+			if (opt == OPT_JCC_TAKEN)
+				info[i].flags |= BPF_INS_JCC_TAKEN;
+			else if (opt == OPT_JCC_FALL)
+				info[i].flags |= BPF_INS_JCC_FALL;
+			break;
+		case BPF_ALU:
+		case EBPF_ALU64:
+			if ((BPF_OP(op) == BPF_DIV || BPF_OP(op) == BPF_MOD) &&
+					BPF_SRC(op) == BPF_X &&
+					(opt & OPT_ZERO_SRC) == 0)
+				info[i].flags |= BPF_INS_NZ_SRC;
+
+			if ((opt & (OPT_CONST | OPT_VAR)) != OPT_CONST ||
+					op == (BPF_CLASS(op) | EBPF_MOV | BPF_K))
+				break;
+
+			/* make sure result fits into mov imm */
+			v = bvf->in[i].opt_val;
+			if (BPF_CLASS(op) == EBPF_ALU64 &&
+					(int64_t)v != (int32_t)v)
+				break;
+
+			info[i].flags |= BPF_INS_CONST;
+			info[i].imm = v;
+			break;
+		case BPF_LD:
+			/* BPF_IND with constant offset */
+			v = bvf->in[i].opt_val;
+			if (BPF_MODE(op) == BPF_IND &&
+					(opt & (OPT_CONST | OPT_VAR)) ==
+					OPT_CONST && v <= INT32_MAX) {
+				info[i].flags |= BPF_INS_CONST;
+				info[i].imm = v;
+			}
+			break;
+		}
+	}
+}
+
 /*
  * validate parameters for each instruction type.
  */
@@ -2234,6 +2691,9 @@ evaluate(struct bpf_verifier *bvf)
 
 	bvf->evst->rv[EBPF_REG_10] = rvfp;
 
+	for (idx = 0; idx != RTE_DIM(bvf->evst->ov); idx++)
+		opt_any(bvf->evst->ov + idx, UINT64_MAX);
+
 	ins = bvf->prm->ins;
 	node = bvf->in;
 	next = node;
@@ -2255,6 +2715,9 @@ evaluate(struct bpf_verifier *bvf)
 			if (node->nb_edge > 1)
 				rc |= save_eval_state(bvf, node);
 
+			if (rc == 0)
+				opt_eval(bvf, node, ins + idx);
+
 			if (ins_chk[op].eval != NULL && rc == 0) {
 				err = ins_chk[op].eval(bvf, ins + idx);
 				if (err != NULL) {
@@ -2326,17 +2789,19 @@ bpf_validate(struct rte_bpf *bpf)
 		evst_pool_fini(&bvf);
 	}
 
-	free(bvf.in);
-
 	/* copy collected info */
 	if (rc == 0) {
 		bpf->stack_sz = bvf.stack_sz;
 
+		if (bpf->ins_info != NULL)
+			opt_fill_info(&bvf, bpf->ins_info);
+
 		/* for LD_ABS/LD_IND, we'll need extra space on the stack */
 		if (bvf.nb_ldmb_nodes != 0)
 			bpf->stack_sz = RTE_ALIGN_CEIL(bpf->stack_sz +
 				sizeof(uint64_t), sizeof(uint64_t));
 	}
 
+	free(bvf.in);
 	return rc;
 }
@@ -107,6 +107,13 @@ struct rte_bpf_prm {
 struct rte_bpf_jit {
 	uint64_t (*func)(void *); /**< JIT-ed native code */
 	size_t sz;                /**< size of JIT-ed code */
+	uint32_t (*func_burst)(void *ctx[], uint64_t rc[], uint32_t num);
+	/**<
+	 * JIT-ed native code to process a set of input contexts
+	 * (same semantics as rte_bpf_exec_burst()).
+	 * NULL if not supported for given platform (i.e. arm64),
+	 * callers have to fall back to *func* then.
+	 */
 };
 
 struct rte_bpf;
@@ -194,6 +201,35 @@ uint32_t
 rte_bpf_exec_burst(const struct rte_bpf *bpf, void *ctx[], uint64_t rc[],
 		uint32_t num);
 
+/**
+ * Convert classic BPF (cBPF) program into eBPF one.
+ * Allows to load filters produced by pcap_compile() (i.e. tcpdump style
+ * filter expressions), struct bpf_insn from <pcap/bpf.h> has the same
+ * layout as struct cbpf_insn.
+ * Resulting eBPF program expects pointer to rte_mbuf as an input argument
+ * and returns the value of cBPF BPF_RET instruction, i.e. zero for
+ * packets that do not match the filter.
+ * Linux specific cBPF extensions (ancillary data loads) are not supported.
+ *
+ * @param ins
+ *   array of cBPF instructions.
+ * @param nb_ins
+ *   number of elements in ins.
+ * @return
+ *   Parameters to pass to rte_bpf_load() (or rte_bpf_eth_rx_load())
+ *   to create BPF execution context for the converted program,
+ *   should be freed with rte_free() after use,
+ *   or NULL on error, with error code set in rte_errno.
+ *   Possible rte_errno errors include:
+ *   - EINVAL - invalid parameter or malformed cBPF program
+ *   - ENOTSUP - cBPF program uses unsupported extensions
+ *   - ERANGE - cBPF program is too big to be converted
+ *   - ENOMEM - can't reserve enough memory
+ */
+__rte_experimental
+struct rte_bpf_prm *
+rte_bpf_convert(const struct cbpf_insn *ins, uint32_t nb_ins);
+
 /**
  * Provide information about natively compiled code for given BPF handle.
  *
@@ -201,6 +237,8 @@ rte_bpf_exec_burst(const struct rte_bpf *bpf, void *ctx[], uint64_t rc[],
  *   handle for the BPF code.
  * @param jit
  *   pointer to the rte_bpf_jit structure to be filled with related data.
+ *   Any of its function pointers could be NULL, if the JIT doesn't
+ *   support it (or the whole program) for given platform.
  * @return
  *   - -EINVAL if the parameters are invalid.
  *   - Zero if operation completed successfully.
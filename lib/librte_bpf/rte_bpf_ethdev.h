@@ -114,6 +114,50 @@ rte_bpf_eth_tx_elf_load(uint16_t port, uint16_t queue,
 	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
 	uint32_t flags);
 
+/**
+ * Load BPF program (i.e. one produced by rte_bpf_convert())
+ * and install callback to execute it on given RX port/queue.
+ *
+ * @param port
+ *   The identifier of the ethernet port
+ * @param queue
+ *   The identifier of the RX queue on the given port
+ * @param prm
+ *  Parameters used to create and initialise the BPF execution context,
+ *  including the program itself.
+ * @param flags
+ *  Flags that define expected behavior of the loaded filter
+ *  (i.e. jited/non-jited version to use).
+ * @return
+ *   Zero on successful completion or negative error code otherwise.
+ */
+__rte_experimental
+int
+rte_bpf_eth_rx_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, uint32_t flags);
+
+/**
+ * Load BPF program (i.e. one produced by rte_bpf_convert())
+ * and install callback to execute it on given TX port/queue.
+ *
+ * @param port
+ *   The identifier of the ethernet port
+ * @param queue
+ *   The identifier of the TX queue on the given port
+ * @param prm
+ *  Parameters used to create and initialise the BPF execution context,
+ *  including the program itself.
+ * @param flags
+ *  Flags that define expected behavior of the loaded filter
+ *  (i.e. jited/non-jited version to use).
+ * @return
+ *   Zero on successful completion or negative error code otherwise.
+ */
+__rte_experimental
+int
+rte_bpf_eth_tx_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, uint32_t flags);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,7 @@ extern "C" {
 #define RTE_DISTRIB_GET_BUF (1)    /**< worker requests a buffer, returns old */
 #define RTE_DISTRIB_RETURN_BUF (2) /**< worker returns a buffer, no request */
 #define RTE_DISTRIB_VALID_BUF (4)  /**< set if bufptr contains ptr */
+#define RTE_DISTRIB_WORKER_EXIT (8) /**< worker returns its buffers and stops */
 
 #define RTE_DISTRIB_BACKLOG_SIZE 8
 #define RTE_DISTRIB_BACKLOG_MASK (RTE_DISTRIB_BACKLOG_SIZE - 1)
@@ -101,6 +102,27 @@ struct rte_distributor_single {
 	struct rte_distributor_returned_pkts returns;
 };
 
+/*
+ * Flow table of the flow affinity mode, the tags are hashed to buckets
+ * which are assigned to the workers.
+ */
+#define RTE_DIST_FLOW_TABLE_BITS 12
+#define RTE_DIST_FLOW_TABLE_SIZE (1 << RTE_DIST_FLOW_TABLE_BITS)
+
+/*
+ * Packets taken back from the workers which stopped, waiting to be sent to
+ * another worker. There is room for the bursts and backlogs of all workers.
+ */
+#define RTE_DIST_FLOW_RESEND_SIZE \
+	(RTE_DISTRIB_MAX_WORKERS * RTE_DIST_BURST_SIZE * 4)
+#define RTE_DIST_FLOW_RESEND_MASK (RTE_DIST_FLOW_RESEND_SIZE - 1)
+
+struct rte_distributor_flow_resend {
+	unsigned int start;
+	unsigned int count;
+	struct rte_mbuf *mbufs[RTE_DIST_FLOW_RESEND_SIZE];
+};
+
 /* All different signature compare functions */
 enum rte_distributor_match_function {
 	RTE_DIST_MATCH_SCALAR = 0,
@@ -155,6 +177,19 @@ struct rte_distributor {
 	enum rte_distributor_match_function dist_match_fn;
 
 	struct rte_distributor_single *d_single;
+
+	unsigned int flow_mode;       /**< enum rte_distributor_flow_mode */
+	unsigned int flow_idle_wkr;   /**< Next worker checked for idleness */
+	unsigned int flow_next_wkr;   /**< Next worker a bucket is moved to */
+	unsigned int flow_nb_active;  /**< Number of workers not stopped */
+	uint8_t flow_active[RTE_DISTRIB_MAX_WORKERS];
+		/**< Set if the worker did not stop with rte_distributor_return_pkt */
+	struct rte_distributor_flow_resend flow_resend;
+		/**< Packets taken back from the stopped workers */
+	uint8_t flow_table[RTE_DIST_FLOW_TABLE_SIZE] __rte_cache_aligned;
+		/**< Worker each bucket of flows is assigned to */
+	uint8_t flow_inflight[RTE_DIST_FLOW_TABLE_SIZE] __rte_cache_aligned;
+		/**< Packets of each bucket in the backlogs or in flight */
 };
 
 void
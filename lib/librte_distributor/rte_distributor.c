@@ -179,11 +179,13 @@ rte_distributor_return_pkt(struct rte_distributor *d,
 		buf->retptr64[i] = (((int64_t)(uintptr_t)oldpkt[i]) <<
 			RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_RETURN_BUF;
 
-	/* set the GET_BUF but even if we got no returns.
+	/* set the GET_BUF but even if we got no returns, with WORKER_EXIT
+	 * as no packet is requested anymore.
 	 * Sync with distributor on GET_BUF flag. Release retptrs.
 	 */
 	__atomic_store_n(&(buf->retptr64[0]),
-		buf->retptr64[0] | RTE_DISTRIB_GET_BUF, __ATOMIC_RELEASE);
+		buf->retptr64[0] | RTE_DISTRIB_GET_BUF |
+		RTE_DISTRIB_WORKER_EXIT, __ATOMIC_RELEASE);
 
 	return 0;
 }
@@ -254,6 +256,61 @@ find_match_scalar(struct rte_distributor *d,
 }
 
 
+/* bucket of the flow table a tag belongs to, bit 0 of the tags is always set */
+static inline unsigned int
+flow_bucket(uint16_t tag)
+{
+	return ((uint32_t)(tag >> 1) * 2654435761U) >>
+			(32 - RTE_DIST_FLOW_TABLE_BITS);
+}
+
+/*
+ * Flow affinity mode: a worker stopped, take back the burst it did not
+ * take and its backlog, in front of the packets waiting to be resent as
+ * they are older. The buckets of the worker are moved when their next
+ * packet is assigned.
+ */
+static void
+flow_wkr_exit(struct rte_distributor *d, unsigned int wkr)
+{
+	struct rte_distributor_buffer *buf = &(d->bufs[wkr]);
+	struct rte_distributor_backlog *bl = &d->backlog[wkr];
+	struct rte_distributor_flow_resend *rs = &d->flow_resend;
+	struct rte_mbuf *mbufs[RTE_DIST_BURST_SIZE * 2];
+	unsigned int i, n = 0;
+
+	if (!(__atomic_load_n(&(buf->bufptr64[0]), __ATOMIC_ACQUIRE)
+			& RTE_DISTRIB_GET_BUF)) {
+		for (i = 0; i < RTE_DIST_BURST_SIZE; i++)
+			if (buf->bufptr64[i] & RTE_DISTRIB_VALID_BUF)
+				mbufs[n++] = (struct rte_mbuf *)((uintptr_t)
+					(buf->bufptr64[i] >>
+					RTE_DISTRIB_FLAG_BITS));
+	}
+	for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
+		buf->bufptr64[i] = RTE_DISTRIB_GET_BUF;
+		if (d->in_flight_tags[wkr][i])
+			d->flow_inflight[flow_bucket(
+				d->in_flight_tags[wkr][i])]--;
+		d->in_flight_tags[wkr][i] = 0;
+	}
+	buf->count = 0;
+
+	for (i = 0; i < bl->count; i++) {
+		mbufs[n++] = (struct rte_mbuf *)((uintptr_t)
+			(bl->pkts[i] >> RTE_DISTRIB_FLAG_BITS));
+		d->flow_inflight[flow_bucket(bl->tags[i])]--;
+		bl->tags[i] = 0;
+	}
+	bl->count = 0;
+
+	rs->start -= n;
+	for (i = 0; i < n; i++)
+		rs->mbufs[(rs->start + i) & RTE_DIST_FLOW_RESEND_MASK] =
+				mbufs[i];
+	rs->count += n;
+}
+
 /*
  * When the handshake bits indicate that there are packets coming
  * back from the worker, this function is called to copy and store
@@ -284,6 +341,21 @@ handle_returns(struct rte_distributor *d, unsigned int wkr)
 		}
 		d->returns.start = ret_start;
 		d->returns.count = ret_count;
+		/* a worker stops with rte_distributor_return_pkt and starts
+		 * again with its next request, before the worker is let go.
+		 */
+		if (d->flow_mode == RTE_DIST_FLOW_AFFINITY) {
+			if (buf->retptr64[0] & RTE_DISTRIB_WORKER_EXIT) {
+				if (d->flow_active[wkr]) {
+					d->flow_active[wkr] = 0;
+					d->flow_nb_active--;
+					flow_wkr_exit(d, wkr);
+				}
+			} else if (!d->flow_active[wkr]) {
+				d->flow_active[wkr] = 1;
+				d->flow_nb_active++;
+			}
+		}
 		/* Clear for the worker to populate with more returns.
 		 * Sync with distributor on GET_BUF flag. Release retptrs.
 		 */
@@ -309,13 +381,28 @@ release(struct rte_distributor *d, unsigned int wkr)
 
 	/* Sync with worker on GET_BUF flag */
 	while (!(__atomic_load_n(&(d->bufs[wkr].bufptr64[0]), __ATOMIC_ACQUIRE)
-		& RTE_DISTRIB_GET_BUF))
+		& RTE_DISTRIB_GET_BUF)) {
+		/* a stopped worker never takes its burst */
+		if (d->flow_mode == RTE_DIST_FLOW_AFFINITY) {
+			handle_returns(d, wkr);
+			if (!d->flow_active[wkr])
+				return 0;
+		}
 		rte_pause();
+	}
 
 	handle_returns(d, wkr);
 
 	buf->count = 0;
 
+	/* the burst in flight is replaced, its flows are done */
+	if (d->flow_mode == RTE_DIST_FLOW_AFFINITY) {
+		for (i = 0; i < RTE_DIST_BURST_SIZE; i++)
+			if (d->in_flight_tags[wkr][i])
+				d->flow_inflight[flow_bucket(
+					d->in_flight_tags[wkr][i])]--;
+	}
+
 	for (i = 0; i < d->backlog[wkr].count; i++) {
 		d->bufs[wkr].bufptr64[i] = d->backlog[wkr].pkts[i] |
 				RTE_DISTRIB_GET_BUF | RTE_DISTRIB_VALID_BUF;
@@ -339,6 +426,191 @@ release(struct rte_distributor *d, unsigned int wkr)
 }
 
 
+/* worker took its last burst and has nothing in its backlog */
+static inline int
+flow_wkr_idle(struct rte_distributor *d, unsigned int wkr)
+{
+	return d->flow_active[wkr] && d->backlog[wkr].count == 0 &&
+		(__atomic_load_n(&(d->bufs[wkr].bufptr64[0]),
+			__ATOMIC_ACQUIRE) & RTE_DISTRIB_GET_BUF);
+}
+
+/* worker did not take its last burst yet and has a full backlog */
+static inline int
+flow_wkr_overloaded(struct rte_distributor *d, unsigned int wkr)
+{
+	return d->backlog[wkr].count == RTE_DIST_BURST_SIZE &&
+		!(__atomic_load_n(&(d->bufs[wkr].bufptr64[0]),
+			__ATOMIC_ACQUIRE) & RTE_DISTRIB_GET_BUF);
+}
+
+/* look for an idle worker, in turn, returns num_workers if there is none */
+static unsigned int
+flow_find_idle_wkr(struct rte_distributor *d)
+{
+	unsigned int i, wkr = d->flow_idle_wkr;
+
+	for (i = 0; i < d->num_workers; i++) {
+		if (++wkr >= d->num_workers)
+			wkr = 0;
+		if (flow_wkr_idle(d, wkr)) {
+			d->flow_idle_wkr = wkr;
+			return wkr;
+		}
+	}
+
+	return d->num_workers;
+}
+
+/* look for a worker which did not stop, in turn */
+static unsigned int
+flow_next_active_wkr(struct rte_distributor *d)
+{
+	unsigned int wkr = d->flow_next_wkr;
+
+	do {
+		if (++wkr >= d->num_workers)
+			wkr = 0;
+	} while (!d->flow_active[wkr]);
+
+	d->flow_next_wkr = wkr;
+	return wkr;
+}
+
+/* wait for a worker to request packets when all of them stopped */
+static void
+flow_wait_active_wkr(struct rte_distributor *d)
+{
+	unsigned int wkr;
+
+	while (unlikely(d->flow_nb_active == 0)) {
+		for (wkr = 0; wkr < d->num_workers; wkr++)
+			handle_returns(d, wkr);
+		rte_pause();
+	}
+}
+
+/* put a packet back at position pos of the packets to resend */
+static void
+flow_resend_insert(struct rte_distributor *d, struct rte_mbuf *mb,
+		unsigned int pos)
+{
+	struct rte_distributor_flow_resend *rs = &d->flow_resend;
+	unsigned int i;
+
+	rs->start--;
+	for (i = 0; i < pos; i++)
+		rs->mbufs[(rs->start + i) & RTE_DIST_FLOW_RESEND_MASK] =
+			rs->mbufs[(rs->start + i + 1) &
+				RTE_DIST_FLOW_RESEND_MASK];
+	rs->mbufs[(rs->start + pos) & RTE_DIST_FLOW_RESEND_MASK] = mb;
+	rs->count++;
+}
+
+/*
+ * Assign a packet to the backlog of the worker of its flow. There must be
+ * a worker which did not stop.
+ */
+static void
+flow_assign(struct rte_distributor *d, struct rte_mbuf *mb)
+{
+	struct rte_distributor_backlog *bl;
+	unsigned int b, idx, wkr, wid, pending;
+	uint16_t tag;
+
+	/* flows MUST be non-zero */
+	tag = (uint16_t)(mb->hash.usr) | 1;
+	b = flow_bucket(tag);
+	wkr = d->flow_table[b];
+
+	/* nothing of a stopped worker is in flight, its buckets are free */
+	if (unlikely(!d->flow_active[wkr])) {
+		wkr = flow_next_active_wkr(d);
+		d->flow_table[b] = wkr;
+	}
+
+	if (d->flow_inflight[b] == 0 &&
+			unlikely(flow_wkr_overloaded(d, wkr))) {
+		wid = flow_find_idle_wkr(d);
+		if (wid < d->num_workers) {
+			d->flow_table[b] = wid;
+			wkr = wid;
+		}
+	}
+
+	bl = &d->backlog[wkr];
+	if (unlikely(bl->count == RTE_DIST_BURST_SIZE)) {
+		pending = d->flow_resend.count;
+		release(d, wkr);
+		/* the worker stopped, the packets it had are older */
+		if (unlikely(!d->flow_active[wkr])) {
+			flow_resend_insert(d, mb,
+					d->flow_resend.count - pending);
+			return;
+		}
+	}
+
+	idx = bl->count++;
+	bl->tags[idx] = tag;
+	bl->pkts[idx] = (((int64_t)(uintptr_t)mb) << RTE_DISTRIB_FLAG_BITS);
+	d->flow_inflight[b]++;
+}
+
+/*
+ * Assign the packets taken back from the stopped workers while a worker
+ * is active, returns the number of packets still waiting.
+ */
+static unsigned int
+flow_resend_drain(struct rte_distributor *d)
+{
+	struct rte_distributor_flow_resend *rs = &d->flow_resend;
+	struct rte_mbuf *mb;
+
+	while (rs->count > 0 && d->flow_nb_active > 0) {
+		mb = rs->mbufs[rs->start & RTE_DIST_FLOW_RESEND_MASK];
+		rs->start++;
+		rs->count--;
+		flow_assign(d, mb);
+	}
+
+	return rs->count;
+}
+
+/*
+ * Flow affinity mode: the worker of each packet is looked up in the flow
+ * table. A bucket of flows with no packet in flight is free to move, it is
+ * moved to an idle worker when its worker is overloaded, and to another
+ * worker when its worker stopped with rte_distributor_return_pkt.
+ */
+static int
+process_flow_affinity(struct rte_distributor *d,
+		struct rte_mbuf **mbufs, unsigned int num_mbufs)
+{
+	unsigned int i, wid;
+
+	for (wid = 0; wid < d->num_workers; wid++)
+		handle_returns(d, wid);
+
+	for (i = 0; i < num_mbufs; i++) {
+		/* the packets taken back go first */
+		do {
+			flow_wait_active_wkr(d);
+		} while (flow_resend_drain(d) > 0);
+
+		flow_assign(d, mbufs[i]);
+	}
+	flow_resend_drain(d);
+
+	/* Flush out all non-full cache-lines to workers. */
+	for (wid = 0 ; wid < d->num_workers; wid++)
+		/* Sync with worker on GET_BUF flag. */
+		if ((__atomic_load_n(&(d->bufs[wid].bufptr64[0]),
+			__ATOMIC_ACQUIRE) & RTE_DISTRIB_GET_BUF))
+			release(d, wid);
+
+	return num_mbufs;
+}
+
 /* process a set of packets to distribute them to workers */
 int
 rte_distributor_process(struct rte_distributor *d,
@@ -358,6 +630,9 @@ rte_distributor_process(struct rte_distributor *d,
 			mbufs, num_mbufs);
 	}
 
+	if (d->flow_mode == RTE_DIST_FLOW_AFFINITY)
+		return process_flow_affinity(d, mbufs, num_mbufs);
+
 	if (unlikely(num_mbufs == 0)) {
 		/* Flush out all non-full cache-lines to workers. */
 		for (wid = 0 ; wid < d->num_workers; wid++) {
@@ -513,7 +788,8 @@ rte_distributor_returned_pkts(struct rte_distributor *d,
 
 /*
  * Return the number of packets in-flight in a distributor, i.e. packets
- * being worked on or queued up in a backlog.
+ * being worked on or queued up in a backlog. The packets taken back from
+ * stopped workers count as long as a worker is there to take them.
  */
 static inline unsigned int
 total_outstanding(const struct rte_distributor *d)
@@ -523,9 +799,63 @@ total_outstanding(const struct rte_distributor *d)
 	for (wkr = 0; wkr < d->num_workers; wkr++)
 		total_outstanding += d->backlog[wkr].count;
 
+	if (d->flow_mode == RTE_DIST_FLOW_AFFINITY && d->flow_nb_active > 0)
+		total_outstanding += d->flow_resend.count;
+
 	return total_outstanding;
 }
 
+int
+rte_distributor_flow_mode_set(struct rte_distributor *d,
+		enum rte_distributor_flow_mode mode)
+{
+	unsigned int b, i, wkr;
+	uint16_t tag;
+
+	if (d == NULL || (mode != RTE_DIST_FLOW_MATCH &&
+			mode != RTE_DIST_FLOW_AFFINITY))
+		return -EINVAL;
+
+	if (d->alg_type != RTE_DIST_ALG_BURST)
+		return -ENOTSUP;
+
+	if (d->num_workers == 0)
+		return -EINVAL;
+
+	if (total_outstanding(d) != 0 || d->flow_resend.count != 0)
+		return -EBUSY;
+
+	if (mode == RTE_DIST_FLOW_AFFINITY) {
+		/* spread the buckets across the workers */
+		for (b = 0; b < RTE_DIST_FLOW_TABLE_SIZE; b++) {
+			d->flow_table[b] = b % d->num_workers;
+			d->flow_inflight[b] = 0;
+		}
+
+		/* keep the flows of the bursts in flight on their worker */
+		for (wkr = 0; wkr < d->num_workers; wkr++) {
+			for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
+				tag = d->in_flight_tags[wkr][i];
+				if (tag == 0)
+					continue;
+				b = flow_bucket(tag);
+				d->flow_table[b] = wkr;
+				d->flow_inflight[b]++;
+			}
+		}
+		d->flow_idle_wkr = 0;
+
+		/* the workers are running until they return their packets */
+		for (wkr = 0; wkr < d->num_workers; wkr++)
+			d->flow_active[wkr] = 1;
+		d->flow_nb_active = d->num_workers;
+		d->flow_next_wkr = 0;
+	}
+
+	d->flow_mode = mode;
+	return 0;
+}
+
 /*
  * Flush the distributor, so that there are no outstanding packets in flight or
  * queued up.
@@ -634,6 +964,8 @@ rte_distributor_create(const char *name,
 	d->num_workers = num_workers;
 	d->alg_type = alg_type;
 
+	d->flow_mode = RTE_DIST_FLOW_MATCH;
+
 	d->dist_match_fn = RTE_DIST_MATCH_SCALAR;
 #if defined(RTE_ARCH_X86)
 	d->dist_match_fn = RTE_DIST_MATCH_VECTOR;
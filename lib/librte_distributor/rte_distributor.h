@@ -17,6 +17,8 @@
 extern "C" {
 #endif
 
+#include <rte_compat.h>
+
 /* Type of distribution (burst/single) */
 enum rte_distributor_alg_type {
 	RTE_DIST_ALG_BURST = 0,
@@ -24,6 +26,19 @@ enum rte_distributor_alg_type {
 	RTE_DIST_NUM_ALG_TYPES
 };
 
+/* Assignment of flows to workers in burst mode */
+enum rte_distributor_flow_mode {
+	RTE_DIST_FLOW_MATCH = 0,
+	/**< Match the tags against the tags in flight on every worker,
+	 * unmatched flows go to the workers in turn. This is the default.
+	 */
+	RTE_DIST_FLOW_AFFINITY,
+	/**< Look the tags up in a hashed flow table, each bucket of flows
+	 * being assigned to one worker. A bucket with no packet in flight is
+	 * moved to an idle worker when its worker is overloaded.
+	 */
+};
+
 struct rte_distributor;
 struct rte_mbuf;
 
@@ -52,6 +67,41 @@ rte_distributor_create(const char *name, unsigned int socket_id,
 		unsigned int num_workers,
 		unsigned int alg_type);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set how a burst mode distributor assigns flows to workers.
+ *
+ * In RTE_DIST_FLOW_AFFINITY mode the cost of assigning a packet to a
+ * worker does not depend on the number of workers, the flows are spread
+ * across the workers like RSS does across queues and only move when a
+ * worker falls behind while another one has nothing to do. Flows are kept
+ * atomic the same way as in the default mode. A worker which stops with
+ * rte_distributor_return_pkt() gives back the packets it did not take, and
+ * its flows move to the other workers until it requests packets again.
+ * While all workers are stopped, rte_distributor_process() waits for one
+ * of them to request packets.
+ *
+ * This should only be called on the same lcore as rte_distributor_process(),
+ * when there are no packets in flight, e.g. right after creation or after
+ * rte_distributor_flush().
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param mode
+ *   The flow assignment mode
+ * @return
+ *   - 0: Success
+ *   - -EINVAL: invalid parameters
+ *   - -ENOTSUP: the distributor is not in burst mode
+ *   - -EBUSY: packets are in flight
+ */
+__rte_experimental
+int
+rte_distributor_flow_mode_set(struct rte_distributor *d,
+		enum rte_distributor_flow_mode mode);
+
 /*  *** APIS to be called on the distributor lcore ***  */
 /*
  * The following APIs are the public APIs which are designed for use on a
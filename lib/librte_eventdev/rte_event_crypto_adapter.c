@@ -6,6 +6,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_dev.h>
 #include <rte_errno.h>
 #include <rte_cryptodev.h>
@@ -67,6 +68,14 @@ struct rte_event_crypto_adapter {
 	uint16_t nb_qps;
 	/* Adapter mode */
 	enum rte_event_crypto_adapter_mode mode;
+	/* No. of crypto ops per queue pair enqueue burst */
+	uint16_t max_burst;
+	/* Set if the batching policy has been configured */
+	uint8_t batch_conf;
+	/* No. of queue pairs with buffered crypto ops */
+	uint32_t nb_pending_qps;
+	/* Max time a crypto op is buffered, in timer cycles */
+	uint64_t max_latency_cycles;
 } __rte_cache_aligned;
 
 /* Per crypto device information */
@@ -96,7 +105,11 @@ struct crypto_queue_pair_info {
 	/* Pointer to hold rte_crypto_ops for batching */
 	struct rte_crypto_op **op_buffer;
 	/* No of crypto ops accumulated */
-	uint8_t len;
+	uint16_t len;
+	/* No of crypto ops enqueued to the queue pair and not dequeued yet */
+	uint32_t inflight;
+	/* Timestamp of the oldest crypto op accumulated */
+	uint64_t ts;
 } __rte_cache_aligned;
 
 static struct rte_event_crypto_adapter **event_crypto_adapter;
@@ -158,6 +171,7 @@ eca_default_config_cb(uint8_t id, uint8_t dev_id,
 	int started;
 	int ret;
 	struct rte_event_port_conf *port_conf = arg;
+	struct rte_event_port_conf pc;
 	struct rte_event_crypto_adapter *adapter = eca_id_to_adapter(id);
 
 	if (adapter == NULL)
@@ -181,7 +195,12 @@ eca_default_config_cb(uint8_t id, uint8_t dev_id,
 		return ret;
 	}
 
-	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	/* completions are enqueued as OP_FORWARD when the device allows
+	 * disabling implicit release, so the port has to be set up that way
+	 */
+	pc = *port_conf;
+	pc.disable_implicit_release = !!adapter->implicit_release_disabled;
+	ret = rte_event_port_setup(dev_id, port_id, &pc);
 	if (ret) {
 		RTE_EDEV_LOG_ERR("failed to setup event port %u\n", port_id);
 		return ret;
@@ -251,6 +270,7 @@ rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
 	adapter->conf_cb = conf_cb;
 	adapter->conf_arg = conf_arg;
 	adapter->mode = mode;
+	adapter->max_burst = BATCH_SIZE;
 	strcpy(adapter->mem_name, mem_name);
 	adapter->cdevs = rte_zmalloc_socket(adapter->mem_name,
 					rte_cryptodev_count() *
@@ -327,6 +347,40 @@ rte_event_crypto_adapter_free(uint8_t id)
 	return 0;
 }
 
+/* Enqueue the buffered crypto ops of a queue pair, the ops it does not
+ * take are kept at the head of the buffer and retried by the next flush.
+ * Returns the number of ops enqueued.
+ */
+static inline unsigned int
+eca_crypto_qp_flush(struct rte_event_crypto_adapter *adapter,
+		    uint8_t cdev_id, uint16_t qp_id,
+		    struct crypto_queue_pair_info *qp_info)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	struct rte_crypto_op **op_buffer = qp_info->op_buffer;
+	uint16_t ret;
+
+	if (qp_info->len == 0)
+		return 0;
+
+	ret = rte_cryptodev_enqueue_burst(cdev_id, qp_id, op_buffer,
+					  qp_info->len);
+	stats->crypto_enq_count += ret;
+	qp_info->inflight += ret;
+
+	if (ret < qp_info->len) {
+		qp_info->len -= ret;
+		memmove(op_buffer, &op_buffer[ret],
+			qp_info->len * sizeof(op_buffer[0]));
+		return ret;
+	}
+
+	qp_info->len = 0;
+	adapter->nb_pending_qps--;
+
+	return ret;
+}
+
 static inline unsigned int
 eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 		 struct rte_event *ev, unsigned int cnt)
@@ -336,11 +390,9 @@ eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 	struct crypto_queue_pair_info *qp_info = NULL;
 	struct rte_crypto_op *crypto_op;
 	unsigned int i, n;
-	uint16_t qp_id, len, ret;
+	uint16_t qp_id;
 	uint8_t cdev_id;
 
-	len = 0;
-	ret = 0;
 	n = 0;
 	stats->event_deq_count += cnt;
 
@@ -348,120 +400,102 @@ eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 		crypto_op = ev[i].event_ptr;
 		if (crypto_op == NULL)
 			continue;
-		if (crypto_op->sess_type == RTE_CRYPTO_OP_WITH_SESSION) {
+		if (crypto_op->sess_type == RTE_CRYPTO_OP_WITH_SESSION)
 			m_data = rte_cryptodev_sym_session_get_user_data(
 					crypto_op->sym->session);
-			if (m_data == NULL) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (!qp_info->qp_enabled) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
-		} else if (crypto_op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
-				crypto_op->private_data_offset) {
+		else if (crypto_op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
+				crypto_op->private_data_offset)
 			m_data = (union rte_event_crypto_metadata *)
 				 ((uint8_t *)crypto_op +
 					crypto_op->private_data_offset);
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (!qp_info->qp_enabled) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
-		} else {
+		else
+			m_data = NULL;
+
+		if (m_data == NULL) {
 			rte_pktmbuf_free(crypto_op->sym->m_src);
 			rte_crypto_op_free(crypto_op);
 			continue;
 		}
 
-		if (len == BATCH_SIZE) {
-			struct rte_crypto_op **op_buffer = qp_info->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp_id,
-							  op_buffer,
-							  BATCH_SIZE);
-
-			stats->crypto_enq_count += ret;
+		cdev_id = m_data->request_info.cdev_id;
+		qp_id = m_data->request_info.queue_pair_id;
+		qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
+		if (!qp_info->qp_enabled) {
+			rte_pktmbuf_free(crypto_op->sym->m_src);
+			rte_crypto_op_free(crypto_op);
+			continue;
+		}
 
-			while (ret < len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
+		/* the queue pair has not taken the ops of previous bursts */
+		if (qp_info->len == RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST) {
+			n += eca_crypto_qp_flush(adapter, cdev_id, qp_id,
+						 qp_info);
+			if (qp_info->len == RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST) {
 				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
+				rte_pktmbuf_free(crypto_op->sym->m_src);
+				rte_crypto_op_free(crypto_op);
+				continue;
 			}
+		}
 
-			len = 0;
+		/* aggregate the crypto ops of all events destined to the
+		 * same queue pair into a single enqueue burst
+		 */
+		if (qp_info->len == 0) {
+			adapter->nb_pending_qps++;
+			if (adapter->batch_conf)
+				qp_info->ts = rte_get_timer_cycles();
 		}
+		qp_info->op_buffer[qp_info->len++] = crypto_op;
 
-		if (qp_info)
-			qp_info->len = len;
-		n += ret;
+		if (qp_info->len >= adapter->max_burst)
+			n += eca_crypto_qp_flush(adapter, cdev_id, qp_id,
+						 qp_info);
 	}
 
 	return n;
 }
 
+/* Flush the enqueue buffers of all queue pairs if all is set, else only
+ * those whose oldest crypto op has used up the latency budget and, if
+ * the event port has been drained, those of idle queue pairs.
+ */
 static unsigned int
-eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter)
+eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter, bool all,
+		     bool drained)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
 	struct crypto_device_info *curr_dev;
 	struct crypto_queue_pair_info *curr_queue;
-	struct rte_crypto_op **op_buffer;
 	struct rte_cryptodev *dev;
+	uint64_t now;
 	uint8_t cdev_id;
 	uint16_t qp;
-	uint16_t ret;
+	unsigned int n;
 	uint16_t num_cdev = rte_cryptodev_count();
 
-	ret = 0;
+	n = 0;
+	now = all ? 0 : rte_get_timer_cycles();
 	for (cdev_id = 0; cdev_id < num_cdev; cdev_id++) {
 		curr_dev = &adapter->cdevs[cdev_id];
 		dev = curr_dev->dev;
-		if (dev == NULL)
+		if (dev == NULL || curr_dev->qpairs == NULL)
 			continue;
 		for (qp = 0; qp < dev->data->nb_queue_pairs; qp++) {
+			if (adapter->nb_pending_qps == 0)
+				return n;
 
 			curr_queue = &curr_dev->qpairs[qp];
-			if (!curr_queue->qp_enabled)
+			if (!curr_queue->qp_enabled || curr_queue->len == 0)
 				continue;
 
-			op_buffer = curr_queue->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp,
-							  op_buffer,
-							  curr_queue->len);
-			stats->crypto_enq_count += ret;
-
-			while (ret < curr_queue->len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
-			curr_queue->len = 0;
+			if (all || (drained && curr_queue->inflight == 0) ||
+			    now - curr_queue->ts >= adapter->max_latency_cycles)
+				n += eca_crypto_qp_flush(adapter, cdev_id, qp,
+							 curr_queue);
 		}
 	}
 
-	return ret;
+	return n;
 }
 
 static int
@@ -492,7 +526,10 @@ eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
 
 	if ((++adapter->transmit_loop_count &
 		(CRYPTO_ENQ_FLUSH_THRESHOLD - 1)) == 0) {
-		nb_enqueued += eca_crypto_enq_flush(adapter);
+		nb_enqueued += eca_crypto_enq_flush(adapter, true, true);
+	} else if (adapter->batch_conf && adapter->nb_pending_qps) {
+		nb_enqueued += eca_crypto_enq_flush(adapter, false,
+						    nb_enq < max_enq);
 	}
 
 	return nb_enqueued;
@@ -536,7 +573,9 @@ eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 		rte_memcpy(ev, &m_data->response_info, sizeof(*ev));
 		ev->event_ptr = ops[i];
 		ev->event_type = RTE_EVENT_TYPE_CRYPTODEV;
-		if (adapter->implicit_release_disabled)
+		/* only OP_FORWARD mode holds dequeued events to complete */
+		if (adapter->implicit_release_disabled &&
+		    adapter->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
 			ev->op = RTE_EVENT_OP_FORWARD;
 		else
 			ev->op = RTE_EVENT_OP_NEW;
@@ -562,9 +601,12 @@ eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 	stats->event_enq_retry_count += retry - 1;
 }
 
+/* Dequeue completions from the queue pairs with at least min_inflight
+ * crypto ops in flight, min_inflight of zero polls all queue pairs.
+ */
 static inline unsigned int
-eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
-			unsigned int max_deq)
+eca_crypto_adapter_deq_qps(struct rte_event_crypto_adapter *adapter,
+			unsigned int max_deq, uint32_t min_inflight)
 {
 	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
 	struct crypto_device_info *curr_dev;
@@ -586,7 +628,7 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 			cdev_id < num_cdev; cdev_id++) {
 			curr_dev = &adapter->cdevs[cdev_id];
 			dev = curr_dev->dev;
-			if (dev == NULL)
+			if (dev == NULL || curr_dev->qpairs == NULL)
 				continue;
 			dev_qps = dev->data->nb_queue_pairs;
 
@@ -595,7 +637,8 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 				queues++) {
 
 				curr_queue = &curr_dev->qpairs[qp];
-				if (!curr_queue->qp_enabled)
+				if (!curr_queue->qp_enabled ||
+				    curr_queue->inflight < min_inflight)
 					continue;
 
 				n = rte_cryptodev_dequeue_burst(cdev_id, qp,
@@ -603,6 +646,8 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 				if (!n)
 					continue;
 
+				curr_queue->inflight -= RTE_MIN(n,
+						curr_queue->inflight);
 				done = false;
 				stats->crypto_deq_count += n;
 				eca_ops_enqueue_burst(adapter, ops, n);
@@ -625,6 +670,29 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 	return nb_deq;
 }
 
+static inline unsigned int
+eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
+			unsigned int max_deq)
+{
+	unsigned int nb_deq;
+
+	/* In OP_FORWARD mode all crypto ops on the queue pairs have been
+	 * enqueued by the adapter, so the inflight counts are exact: serve
+	 * the queue pairs with a full burst in flight first and skip the
+	 * idle ones.
+	 */
+	if (!adapter->batch_conf ||
+	    adapter->mode != RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+		return eca_crypto_adapter_deq_qps(adapter, max_deq, 0);
+
+	nb_deq = eca_crypto_adapter_deq_qps(adapter, max_deq, BATCH_SIZE);
+	if (nb_deq < max_deq)
+		nb_deq += eca_crypto_adapter_deq_qps(adapter,
+						     max_deq - nb_deq, 1);
+
+	return nb_deq;
+}
+
 static void
 eca_crypto_adapter_run(struct rte_event_crypto_adapter *adapter,
 			unsigned int max_ops)
@@ -704,6 +772,7 @@ eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
 			uint8_t add)
 {
 	struct crypto_queue_pair_info *qp_info;
+	struct rte_crypto_op *op;
 	int enabled;
 	uint16_t i;
 
@@ -719,14 +788,39 @@ eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
 		if (add) {
 			adapter->nb_qps += !enabled;
 			dev_info->num_qpairs += !enabled;
+			if (!enabled)
+				qp_info->inflight = 0;
 		} else {
 			adapter->nb_qps -= enabled;
 			dev_info->num_qpairs -= enabled;
+			/* drop the crypto ops still buffered */
+			for (i = 0; i < qp_info->len; i++) {
+				op = qp_info->op_buffer[i];
+				rte_pktmbuf_free(op->sym->m_src);
+				rte_crypto_op_free(op);
+			}
+			if (qp_info->len)
+				adapter->nb_pending_qps--;
+			qp_info->len = 0;
 		}
 		qp_info->qp_enabled = !!add;
 	}
 }
 
+static void
+eca_free_qpairs(struct crypto_device_info *dev_info)
+{
+	uint16_t i;
+
+	if (dev_info->qpairs == NULL)
+		return;
+
+	for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++)
+		rte_free(dev_info->qpairs[i].op_buffer);
+	rte_free(dev_info->qpairs);
+	dev_info->qpairs = NULL;
+}
+
 static int
 eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 		uint8_t cdev_id,
@@ -746,13 +840,16 @@ eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 			return -ENOMEM;
 
 		qpairs = dev_info->qpairs;
-		qpairs->op_buffer = rte_zmalloc_socket(adapter->mem_name,
-					BATCH_SIZE *
+		for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++) {
+			qpairs[i].op_buffer = rte_zmalloc_socket(
+					adapter->mem_name,
+					RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST *
 					sizeof(struct rte_crypto_op *),
 					0, adapter->socket_id);
-		if (!qpairs->op_buffer) {
-			rte_free(qpairs);
-			return -ENOMEM;
+			if (qpairs[i].op_buffer == NULL) {
+				eca_free_qpairs(dev_info);
+				return -ENOMEM;
+			}
 		}
 	}
 
@@ -935,10 +1032,8 @@ rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
 					&adapter->cdevs[cdev_id],
 					queue_pair_id,
 					0);
-			if (dev_info->num_qpairs == 0) {
-				rte_free(dev_info->qpairs);
-				dev_info->qpairs = NULL;
-			}
+			if (dev_info->num_qpairs == 0)
+				eca_free_qpairs(dev_info);
 		}
 	} else {
 		if (adapter->nb_qps == 0)
@@ -955,10 +1050,8 @@ rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
 						(uint16_t)queue_pair_id, 0);
 		}
 
-		if (dev_info->num_qpairs == 0) {
-			rte_free(dev_info->qpairs);
-			dev_info->qpairs = NULL;
-		}
+		if (dev_info->num_qpairs == 0)
+			eca_free_qpairs(dev_info);
 
 		rte_spinlock_unlock(&adapter->lock);
 		rte_service_component_runstate_set(adapter->service_id,
@@ -1138,3 +1231,32 @@ rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
 
 	return 0;
 }
+
+int
+rte_event_crypto_adapter_batch_conf_set(uint8_t id,
+			const struct rte_event_crypto_adapter_batch_conf *conf)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL || conf == NULL)
+		return -EINVAL;
+
+	if (conf->max_burst > RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST) {
+		RTE_EDEV_LOG_ERR("Invalid max_burst %" PRIu16 ", max %u",
+				 conf->max_burst,
+				 RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST);
+		return -EINVAL;
+	}
+
+	rte_spinlock_lock(&adapter->lock);
+	adapter->max_burst = conf->max_burst ? conf->max_burst : BATCH_SIZE;
+	adapter->max_latency_cycles = conf->max_latency_us *
+		rte_get_timer_hz() / US_PER_S;
+	adapter->batch_conf = 1;
+	rte_spinlock_unlock(&adapter->lock);
+
+	return 0;
+}
@@ -138,6 +138,7 @@
  *  - rte_event_crypto_adapter_stop()
  *  - rte_event_crypto_adapter_stats_get()
  *  - rte_event_crypto_adapter_stats_reset()
+ *  - rte_event_crypto_adapter_batch_conf_set()
 
  * The application creates an instance using rte_event_crypto_adapter_create()
  * or rte_event_crypto_adapter_create_ext().
@@ -157,6 +158,12 @@
  * The RTE_EVENT_CRYPTO_ADAPTER_CAP_SESSION_PRIVATE_DATA capability indicates
  * whether HW or SW supports this feature.
  *
+ * The SW adapter accumulates the crypto operations of the events destined to
+ * the same queue pair and enqueues them to the cryptodev in bursts. The
+ * rte_event_crypto_adapter_batch_conf_set() function sets the burst size and
+ * bounds the time a crypto operation may be held back waiting for a burst to
+ * fill.
+ *
  * For session-less mode, the adapter gets the private data information placed
  * along with the ``struct rte_crypto_op``.
  * The rte_crypto_op::private_data_offset provides an offset to locate the
@@ -290,7 +297,10 @@ struct rte_event_crypto_adapter_stats {
 	uint64_t crypto_enq_count;
 	/**< Cryptodev enqueue count */
 	uint64_t crypto_enq_fail;
-	/**< Cryptodev enqueue failed count */
+	/**< Cryptodev enqueue failed count, the ops refused by the cryptodev
+	 * are retried, only those dropped as their queue pair buffer is full
+	 * are counted.
+	 */
 	uint64_t crypto_deq_count;
 	/**< Cryptodev dequeue count */
 	uint64_t event_enq_count;
@@ -301,6 +311,34 @@ struct rte_event_crypto_adapter_stats {
 	/**< Event enqueue fail count */
 };
 
+#define RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST 128
+/**< Max number of crypto operations the SW adapter enqueues to a queue pair
+ * in a single burst.
+ * @see rte_event_crypto_adapter_batch_conf::max_burst
+ */
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice
+ *
+ * Batching policy of the SW adapter.
+ * @see rte_event_crypto_adapter_batch_conf_set()
+ */
+struct rte_event_crypto_adapter_batch_conf {
+	uint16_t max_burst;
+	/**< Number of crypto operations accumulated per queue pair before
+	 * they are enqueued to the cryptodev. Zero selects the default of 32.
+	 * Must not exceed RTE_EVENT_CRYPTO_ADAPTER_MAX_BURST.
+	 */
+	uint32_t max_latency_us;
+	/**< Upper bound for the time in microseconds a crypto operation is
+	 * held back in the adapter waiting for its burst to fill. Zero flushes
+	 * partial bursts in every service function call. A partial burst is
+	 * also enqueued as soon as the adapter's event port has no more events
+	 * and the queue pair has no crypto operations in flight.
+	 */
+};
+
 /**
  * Create a new event crypto adapter with the specified identifier.
  *
@@ -522,6 +560,37 @@ rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id);
 int
 rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the batching policy of the SW adapter.
+ *
+ * Without a batching policy, the adapter enqueues crypto operations to a
+ * queue pair once 32 of them have accumulated and flushes partial bursts
+ * periodically. Once a policy is set, partial bursts are flushed according
+ * to rte_event_crypto_adapter_batch_conf::max_latency_us and, in
+ * RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode, completions are dequeued first
+ * from the queue pairs with a full burst of crypto operations in flight,
+ * while queue pairs with none in flight are not polled. The latter requires
+ * that, in this mode, crypto operations are enqueued to the queue pairs by
+ * the adapter only.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param conf
+ *  Batching policy.
+ *
+ * @return
+ *  - 0: Success
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int
+rte_event_crypto_adapter_batch_conf_set(uint8_t id,
+		const struct rte_event_crypto_adapter_batch_conf *conf);
+
 #ifdef __cplusplus
 }
 #endif
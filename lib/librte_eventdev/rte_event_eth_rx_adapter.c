@@ -35,6 +35,12 @@
 #define ETH_BRIDGE_INTR_THREAD_EXIT	1
 /* Sentinel value to detect initialized file handle */
 #define INIT_FD		-1
+/* Idle backoff steps spent spinning before the service starts to sleep */
+#define RXA_IDLE_PAUSE_STEPS	10
+/* Idle backoff steps spent doubling the sleep time */
+#define RXA_IDLE_SLEEP_STEPS	20
+/* Size of the event array used to wait for Rx interrupts when idle */
+#define RXA_IDLE_EPOLL_EVENTS	16
 
 /*
  * Used to store port and queue ID of interrupting Rx queue
@@ -142,6 +148,22 @@ struct rte_event_eth_rx_adapter {
 	uint8_t rxa_started;
 	/* Adapter ID */
 	uint8_t id;
+	/* Idle policy of the service function */
+	struct rte_event_eth_rx_adapter_idle_conf idle_conf;
+	/* Count of consecutive service function calls without packets */
+	uint32_t idle_polls;
+	/* Backoff step, incremented while the adapter stays idle */
+	uint32_t idle_step;
+	/* epoll fd used to wait for Rx interrupts of polled queues
+	 * when idle
+	 */
+	int idle_epd;
+	/* Num of polled queues added to idle_epd */
+	uint32_t num_idle_intr;
+	/* Set if polled queues need to be added to idle_epd */
+	int idle_intr_stale;
+	/* Idle stats */
+	struct rte_event_eth_rx_adapter_idle_stats idle_stats;
 } __rte_cache_aligned;
 
 /* Per eth device */
@@ -198,6 +220,7 @@ struct eth_device_info {
 struct eth_rx_queue_info {
 	int queue_enabled;	/* True if added */
 	int intr_enabled;
+	int idle_intr;		/* True if added to the adapter idle_epd */
 	uint16_t wt;		/* Polling weight */
 	uint32_t flow_id_mask;	/* Set to ~0 if app provides flow id else 0 */
 	uint64_t event;
@@ -1135,11 +1158,233 @@ rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 	return nb_rx;
 }
 
+static int
+rxa_epoll_create1(void);
+
+/* Add polled queues that have their own Rx interrupt vector to the idle
+ * epoll fd, queues sharing a vector are left out since the vector may be
+ * in use by interrupt mode queues.
+ */
+static void
+rxa_idle_intr_add(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	uint32_t i;
+
+	rx_adapter->idle_intr_stale = 0;
+
+	if (rx_adapter->idle_epd == INIT_FD) {
+		rx_adapter->idle_epd = rxa_epoll_create1();
+		if (rx_adapter->idle_epd < 0) {
+			rx_adapter->idle_epd = INIT_FD;
+			return;
+		}
+	}
+
+	for (i = 0; i < rx_adapter->num_rx_polled; i++) {
+		uint16_t port = rx_adapter->eth_rx_poll[i].eth_dev_id;
+		uint16_t queue = rx_adapter->eth_rx_poll[i].eth_rx_qid;
+		struct eth_device_info *dev_info;
+		struct eth_rx_queue_info *queue_info;
+		union queue_data qd;
+
+		dev_info = &rx_adapter->eth_devices[port];
+		queue_info = &dev_info->rx_queue[queue];
+		if (queue_info->idle_intr ||
+			!dev_info->dev->data->dev_conf.intr_conf.rxq ||
+			dev_info->dev->intr_handle == NULL ||
+			rxa_shared_intr(dev_info, queue))
+			continue;
+
+		qd.port = port;
+		qd.queue = queue;
+		if (rte_eth_dev_rx_intr_ctl_q(port, queue,
+					rx_adapter->idle_epd,
+					RTE_INTR_EVENT_ADD, qd.ptr) == 0) {
+			queue_info->idle_intr = 1;
+			rx_adapter->num_idle_intr++;
+		}
+	}
+}
+
+/* Remove Rx queue(s) from the idle epoll fd */
+static void
+rxa_idle_intr_del(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_device_info *dev_info,
+		int32_t rx_queue_id)
+{
+	struct eth_rx_queue_info *queue_info;
+	union queue_data qd;
+
+	if (rx_adapter->num_idle_intr == 0 || dev_info->rx_queue == NULL)
+		return;
+
+	if (rx_queue_id == -1) {
+		uint16_t i;
+
+		for (i = 0; i < dev_info->dev->data->nb_rx_queues; i++)
+			rxa_idle_intr_del(rx_adapter, dev_info, i);
+		return;
+	}
+
+	queue_info = &dev_info->rx_queue[rx_queue_id];
+	if (!queue_info->idle_intr)
+		return;
+
+	qd.port = dev_info->dev->data->port_id;
+	qd.queue = rx_queue_id;
+	/* may be left armed by a service function waiting on idle_epd */
+	rte_eth_dev_rx_intr_disable(qd.port, qd.queue);
+	rte_eth_dev_rx_intr_ctl_q(qd.port, qd.queue, rx_adapter->idle_epd,
+				RTE_INTR_EVENT_DEL, qd.ptr);
+	queue_info->idle_intr = 0;
+	rx_adapter->num_idle_intr--;
+}
+
+static void
+rxa_idle_intr_arm(struct rte_event_eth_rx_adapter *rx_adapter, int enable)
+{
+	uint32_t i;
+
+	for (i = 0; i < rx_adapter->num_rx_polled; i++) {
+		uint16_t port = rx_adapter->eth_rx_poll[i].eth_dev_id;
+		uint16_t queue = rx_adapter->eth_rx_poll[i].eth_rx_qid;
+
+		if (!rx_adapter->eth_devices[port].rx_queue[queue].idle_intr)
+			continue;
+		if (enable)
+			rte_eth_dev_rx_intr_enable(port, queue);
+		else
+			rte_eth_dev_rx_intr_disable(port, queue);
+	}
+}
+
+/* Wait up to timeout_us for an Rx interrupt on the polled queues,
+ * returns -ENOTSUP if none of the polled queues can interrupt.
+ * Called without the rx_lock, that is only held to arm and disarm the
+ * interrupts, so other pollers and control path calls are not stalled.
+ */
+static int
+rxa_idle_intr_wait(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint32_t timeout_us)
+{
+	struct rte_epoll_event events[RXA_IDLE_EPOLL_EVENTS];
+	uint32_t nb_rx;
+	int epd;
+	int n = 0;
+
+	rte_spinlock_lock(&rx_adapter->rx_lock);
+	if (!rx_adapter->rxa_started) {
+		rte_spinlock_unlock(&rx_adapter->rx_lock);
+		return 0;
+	}
+	if (rx_adapter->idle_intr_stale)
+		rxa_idle_intr_add(rx_adapter);
+	if (rx_adapter->num_idle_intr == 0) {
+		rte_spinlock_unlock(&rx_adapter->rx_lock);
+		return -ENOTSUP;
+	}
+
+	rxa_idle_intr_arm(rx_adapter, 1);
+
+	/* Packets may have been received before the interrupts were armed */
+	nb_rx = rxa_poll(rx_adapter);
+	rx_adapter->stats.rx_packets += nb_rx;
+	epd = rx_adapter->idle_epd;
+	rte_spinlock_unlock(&rx_adapter->rx_lock);
+
+	if (nb_rx == 0)
+		n = rte_epoll_wait(epd, events, RTE_DIM(events),
+				(timeout_us + 999) / 1000);
+
+	rte_spinlock_lock(&rx_adapter->rx_lock);
+	if (n > 0)
+		rx_adapter->idle_stats.idle_intr_wakeups++;
+
+	rxa_idle_intr_arm(rx_adapter, 0);
+
+	if (nb_rx != 0 || n > 0) {
+		rx_adapter->idle_polls = 0;
+		rx_adapter->idle_step = 0;
+	}
+	rte_spinlock_unlock(&rx_adapter->rx_lock);
+
+	return 0;
+}
+
+/*
+ * Called with the rx_lock held, returns the backoff step the service
+ * function has to wait for once it has released the lock, or -1 if it
+ * has found packets in any of the last idle_conf.empty_polls calls.
+ */
+static int32_t
+rxa_idle_step(struct rte_event_eth_rx_adapter *rx_adapter, uint32_t nb_rx,
+		struct rte_event_eth_rx_adapter_idle_conf *conf)
+{
+	if (nb_rx != 0 || rx_adapter->event_enqueue_buffer.count != 0) {
+		rx_adapter->idle_polls = 0;
+		rx_adapter->idle_step = 0;
+		return -1;
+	}
+
+	if (rx_adapter->idle_polls < rx_adapter->idle_conf.empty_polls) {
+		rx_adapter->idle_polls++;
+		return -1;
+	}
+
+	*conf = rx_adapter->idle_conf;
+	return rx_adapter->idle_step;
+}
+
+/*
+ * Backs off once the service function has found no packets in
+ * idle_conf.empty_polls consecutive calls: first by spinning on
+ * rte_pause() for an exponentially growing number of iterations, then
+ * by sleeping for an exponentially growing time bounded by
+ * idle_conf.max_sleep_us, or waiting for Rx interrupts with the same
+ * bound if RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR is set.
+ * Called without the rx_lock.
+ */
+static void
+rxa_idle_backoff(struct rte_event_eth_rx_adapter *rx_adapter, uint32_t step,
+		const struct rte_event_eth_rx_adapter_idle_conf *conf)
+{
+	uint64_t start;
+
+	start = rte_get_timer_cycles();
+	if (step < RXA_IDLE_PAUSE_STEPS || conf->max_sleep_us == 0) {
+		uint32_t i;
+		uint32_t n;
+
+		n = 1U << (step < RXA_IDLE_PAUSE_STEPS ?
+				step : RXA_IDLE_PAUSE_STEPS);
+		for (i = 0; i < n; i++)
+			rte_pause();
+	} else {
+		uint32_t us;
+
+		us = 1U << (step - RXA_IDLE_PAUSE_STEPS);
+		us = RTE_MIN(us, conf->max_sleep_us);
+		if (!(conf->flags & RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR) ||
+			rxa_idle_intr_wait(rx_adapter, conf->max_sleep_us))
+			rte_delay_us_sleep(us);
+	}
+
+	rte_spinlock_lock(&rx_adapter->rx_lock);
+	if (rx_adapter->idle_step == step &&
+		step < RXA_IDLE_PAUSE_STEPS + RXA_IDLE_SLEEP_STEPS)
+		rx_adapter->idle_step = step + 1;
+	rx_adapter->idle_stats.idle_cycles += rte_get_timer_cycles() - start;
+	rte_spinlock_unlock(&rx_adapter->rx_lock);
+}
+
 static int
 rxa_service_func(void *args)
 {
 	struct rte_event_eth_rx_adapter *rx_adapter = args;
 	struct rte_event_eth_rx_adapter_stats *stats;
+	struct rte_event_eth_rx_adapter_idle_conf idle_conf;
+	int32_t idle_step;
+	uint32_t nb_rx;
 
 	if (rte_spinlock_trylock(&rx_adapter->rx_lock) == 0)
 		return 0;
@@ -1149,9 +1394,17 @@ rxa_service_func(void *args)
 	}
 
 	stats = &rx_adapter->stats;
-	stats->rx_packets += rxa_intr_ring_dequeue(rx_adapter);
-	stats->rx_packets += rxa_poll(rx_adapter);
+	nb_rx = rxa_intr_ring_dequeue(rx_adapter);
+	nb_rx += rxa_poll(rx_adapter);
+	stats->rx_packets += nb_rx;
+	idle_step = -1;
+	if (rx_adapter->idle_conf.empty_polls != 0)
+		idle_step = rxa_idle_step(rx_adapter, nb_rx, &idle_conf);
 	rte_spinlock_unlock(&rx_adapter->rx_lock);
+
+	/* back off without holding the lock */
+	if (idle_step >= 0)
+		rxa_idle_backoff(rx_adapter, idle_step, &idle_conf);
 	return 0;
 }
 
@@ -1677,6 +1930,7 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	pollq = rxa_polled_queue(dev_info, rx_queue_id);
 	intrq = rxa_intr_queue(dev_info, rx_queue_id);
 	sintrq = rxa_shared_intr(dev_info, rx_queue_id);
+	rxa_idle_intr_del(rx_adapter, dev_info, rx_queue_id);
 	rxa_update_queue(rx_adapter, dev_info, rx_queue_id, 0);
 	rx_adapter->num_rx_polled -= pollq;
 	dev_info->nb_rx_poll -= pollq;
@@ -1810,6 +2064,9 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 		goto err_free_rxqueue;
 
 	if (wt == 0) {
+		/* the queue vector can't be in both epoll fds */
+		rxa_idle_intr_del(rx_adapter, dev_info, rx_queue_id);
+
 		num_intr_vec = rxa_nb_intr_vect(dev_info, rx_queue_id, 1);
 
 		ret = rxa_intr_ring_check_avail(rx_adapter, num_intr_vec);
@@ -1867,6 +2124,7 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 	rx_adapter->wrr_sched = rx_wrr;
 	rx_adapter->wrr_len = nb_wrr;
 	rx_adapter->num_intr_vec += num_intr_vec;
+	rx_adapter->idle_intr_stale = 1;
 	return 0;
 
 err_free_rxqueue:
@@ -1993,6 +2251,7 @@ rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		return -ENOMEM;
 	}
 	rte_spinlock_init(&rx_adapter->rx_lock);
+	rx_adapter->idle_epd = INIT_FD;
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
 		rx_adapter->eth_devices[i].dev = &rte_eth_devices[i];
 
@@ -2044,6 +2303,8 @@ rte_event_eth_rx_adapter_free(uint8_t id)
 		return -EBUSY;
 	}
 
+	if (rx_adapter->idle_epd != INIT_FD)
+		close(rx_adapter->idle_epd);
 	if (rx_adapter->default_cb_arg)
 		rte_free(rx_adapter->conf_arg);
 	rte_free(rx_adapter->eth_devices);
@@ -2355,6 +2616,48 @@ rte_event_eth_rx_adapter_stats_reset(uint8_t id)
 	}
 
 	memset(&rx_adapter->stats, 0, sizeof(rx_adapter->stats));
+	memset(&rx_adapter->idle_stats, 0, sizeof(rx_adapter->idle_stats));
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_idle_conf_set(uint8_t id,
+		const struct rte_event_eth_rx_adapter_idle_conf *conf)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if (rx_adapter == NULL || conf == NULL)
+		return -EINVAL;
+
+	if (conf->flags & ~RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR)
+		return -EINVAL;
+
+	rte_spinlock_lock(&rx_adapter->rx_lock);
+	rx_adapter->idle_conf = *conf;
+	rx_adapter->idle_polls = 0;
+	rx_adapter->idle_step = 0;
+	rx_adapter->idle_intr_stale = 1;
+	rte_spinlock_unlock(&rx_adapter->rx_lock);
+
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_idle_stats_get(uint8_t id,
+		struct rte_event_eth_rx_adapter_idle_stats *stats)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if (rx_adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = rx_adapter->idle_stats;
 	return 0;
 }
 
@@ -37,6 +37,8 @@
  *  - rte_event_eth_rx_adapter_stop()
  *  - rte_event_eth_rx_adapter_stats_get()
  *  - rte_event_eth_rx_adapter_stats_reset()
+ *  - rte_event_eth_rx_adapter_idle_conf_set()
+ *  - rte_event_eth_rx_adapter_idle_stats_get()
  *
  * The application creates an ethernet to event adapter using
  * rte_event_eth_rx_adapter_create_ext() or rte_event_eth_rx_adapter_create()
@@ -77,6 +79,12 @@
  * allows the application to register a callback that selects which packets are
  * enqueued to the event device by the SW adapter. The callback interface is
  * event based so the callback can also modify the event data if it needs to.
+ *
+ * The service function polls its Rx queues continuously by default. The
+ * rte_event_eth_rx_adapter_idle_conf_set() function enables an idle policy
+ * under which the service function backs off after a number of empty polls,
+ * and optionally waits for Rx interrupts of the polled queues, trading a
+ * bounded wake-up latency for lower CPU usage at low load.
  */
 
 #ifdef __cplusplus
@@ -203,6 +211,59 @@ struct rte_event_eth_rx_adapter_stats {
 	/**< Received packet count for interrupt mode Rx queues */
 };
 
+/* struct rte_event_eth_rx_adapter_idle_conf flags definitions */
+#define RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR	0x1
+/**< When idle, wait for Rx interrupts of the polled queues instead of
+ * sleeping. Only applies to queues of ethernet devices configured with
+ * Rx queue interrupts (rte_eth_conf::intr_conf::rxq) that have an
+ * interrupt vector of their own.
+ * @see rte_event_eth_rx_adapter_idle_conf::flags
+ */
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice
+ *
+ * Idle policy of the adapter service function.
+ * @see rte_event_eth_rx_adapter_idle_conf_set()
+ */
+struct rte_event_eth_rx_adapter_idle_conf {
+	uint32_t empty_polls;
+	/**< Number of consecutive service function calls without received
+	 * packets after which the service function backs off, first by
+	 * spinning on rte_pause(), then by sleeping. Zero disables the
+	 * idle policy.
+	 */
+	uint32_t max_sleep_us;
+	/**< Upper bound for the time in microseconds the service function
+	 * sleeps or waits for Rx interrupts in a single call, i.e. the
+	 * worst case wake-up latency once traffic resumes. If zero, the
+	 * service function only spins. Waits for Rx interrupts are rounded
+	 * up to milliseconds.
+	 */
+	uint32_t flags;
+	/**< Flags, see RTE_EVENT_ETH_RX_ADAPTER_IDLE_F_RX_INTR */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice
+ *
+ * A structure used to retrieve the idle statistics of an eth rx adapter
+ * instance.
+ * @see rte_event_eth_rx_adapter_idle_stats_get()
+ */
+struct rte_event_eth_rx_adapter_idle_stats {
+	uint64_t idle_cycles;
+	/**< Cycles for which the service function backed off because no
+	 * packets were received.
+	 */
+	uint64_t idle_intr_wakeups;
+	/**< Number of times the service function was woken up by an Rx
+	 * interrupt of a polled queue while backing off.
+	 */
+};
+
 /**
  *
  * Callback function invoked by the SW adapter before it continues
@@ -450,6 +511,51 @@ int rte_event_eth_rx_adapter_stats_reset(uint8_t id);
  */
 int rte_event_eth_rx_adapter_service_id_get(uint8_t id, uint32_t *service_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the idle policy of the adapter service function. While backing off,
+ * the service function keeps the service core busy (or asleep) for up to
+ * max_sleep_us, delaying other services mapped to the same core.
+ * The cycles spent backing off are reported by
+ * rte_event_eth_rx_adapter_idle_stats_get().
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param conf
+ *  Idle policy, a zero empty_polls disables it.
+ *
+ * @return
+ *  - 0: Success
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int rte_event_eth_rx_adapter_idle_conf_set(uint8_t id,
+		const struct rte_event_eth_rx_adapter_idle_conf *conf);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the idle statistics of an adapter, these are reset along with
+ * the other adapter statistics by rte_event_eth_rx_adapter_stats_reset().
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param [out] stats
+ *  A pointer to structure used to retrieve the idle statistics.
+ *
+ * @return
+ *  - 0: Success, retrieved successfully.
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int rte_event_eth_rx_adapter_idle_stats_get(uint8_t id,
+		struct rte_event_eth_rx_adapter_idle_stats *stats);
+
 /**
  * Register callback to process Rx packets, this is supported for
  * SW based packet transfers.
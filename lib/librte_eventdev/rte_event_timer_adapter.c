@@ -10,6 +10,7 @@
 
 #include <rte_memzone.h>
 #include <rte_memory.h>
+#include <rte_lcore.h>
 #include <rte_dev.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
@@ -17,6 +18,7 @@
 #include <rte_mempool.h>
 #include <rte_common.h>
 #include <rte_timer.h>
+#include <rte_spinlock.h>
 #include <rte_service_component.h>
 #include <rte_cycles.h>
 
@@ -36,6 +38,7 @@ RTE_LOG_REGISTER(evtim_svc_logtype, lib.eventdev.adapter.timer.svc, NOTICE);
 static struct rte_event_timer_adapter adapters[RTE_EVENT_TIMER_ADAPTER_NUM_MAX];
 
 static const struct rte_event_timer_adapter_ops swtim_ops;
+static const struct rte_event_timer_adapter_ops swtim_wheel_ops;
 
 #define EVTIM_LOG(level, logtype, ...) \
 	rte_log(RTE_LOG_ ## level, logtype, \
@@ -212,7 +215,9 @@ rte_event_timer_adapter_create_ext(
 	 * implementation.
 	 */
 	if (adapter->ops == NULL)
-		adapter->ops = &swtim_ops;
+		adapter->ops = (conf->flags &
+				RTE_EVENT_TIMER_ADAPTER_F_TIMER_WHEEL) ?
+			&swtim_wheel_ops : &swtim_ops;
 
 	/* Allow driver to do some setup */
 	FUNC_PTR_OR_NULL_RET_WITH_ERRNO(adapter->ops->init, ENOTSUP);
@@ -531,6 +536,30 @@ event_buffer_flush(struct event_buffer *bufp, uint8_t dev_id, uint8_t port_id,
 /*
  * Software event timer adapter implementation
  */
+
+/* Upper bound on the number of buckets of a timing wheel; longer timeouts
+ * wrap around the wheel and are skipped until their revolution comes.
+ */
+#define SWTIM_WHEEL_SLOTS_MAX 4096
+
+/* Timing wheel entry, takes the place of the rte_timer in wheel mode */
+struct swtim_node {
+	LIST_ENTRY(swtim_node) next;
+	struct rte_event_timer *evtim;
+	/* Adapter tick at which the timer expires */
+	uint64_t expiry;
+};
+
+LIST_HEAD(swtim_slot, swtim_node);
+
+/* Per-lcore timing wheel, shared with the service under the lock */
+struct swtim_wheel {
+	rte_spinlock_t lock;
+	/* Last adapter tick whose bucket has been expired */
+	uint64_t cur_tick;
+	struct swtim_slot *slots;
+} __rte_cache_aligned;
+
 struct swtim {
 	/* Identifier of service executing timer management logic. */
 	uint32_t service_id;
@@ -564,6 +593,12 @@ struct swtim {
 	struct rte_timer *expired_timers[EXP_TIM_BUF_SZ];
 	/* The number of timers that can be returned to a mempool */
 	size_t n_expired_timers;
+	/* Timing wheels indexed by lcore, only allocated in wheel mode */
+	struct swtim_wheel *wheels;
+	/* Length of an adapter tick in timer cycles, in wheel mode */
+	uint64_t wheel_tick_cycles;
+	/* Number of buckets per wheel minus one */
+	uint64_t wheel_mask;
 };
 
 static inline struct swtim *
@@ -757,6 +792,174 @@ swtim_service_func(void *arg)
 	return 0;
 }
 
+/* Expire the buckets of a timing wheel up to now_tick, buffering the expiry
+ * events. If the event buffer fills up, the remaining timers stay in the
+ * wheel and are expired on the next iteration.
+ */
+static void
+swtim_wheel_expire(struct swtim *sw, struct swtim_wheel *wheel,
+		   uint64_t now_tick)
+{
+	struct swtim_node *node, *next;
+	struct swtim_slot *slot;
+	void *nodes[EXP_TIM_BUF_SZ];
+	unsigned int n_nodes = 0;
+	uint64_t tick;
+
+	rte_spinlock_lock(&wheel->lock);
+
+	/* A full revolution visits every bucket once */
+	tick = wheel->cur_tick + 1;
+	if (now_tick - wheel->cur_tick > sw->wheel_mask + 1)
+		tick = now_tick - sw->wheel_mask;
+
+	for (; tick <= now_tick; tick++) {
+		slot = &wheel->slots[tick & sw->wheel_mask];
+		for (node = LIST_FIRST(slot); node != NULL; node = next) {
+			next = LIST_NEXT(node, next);
+			/* Armed for a later revolution of the wheel */
+			if (node->expiry > now_tick)
+				continue;
+
+			if (event_buffer_add(&sw->buffer,
+					     &node->evtim->ev) < 0) {
+				sw->stats.evtim_retry_count++;
+				goto done;
+			}
+
+			LIST_REMOVE(node, next);
+			__atomic_store_n(&node->evtim->state,
+					RTE_EVENT_TIMER_NOT_ARMED,
+					__ATOMIC_RELEASE);
+			sw->stats.evtim_exp_count++;
+
+			nodes[n_nodes++] = node;
+			if (unlikely(n_nodes == EXP_TIM_BUF_SZ)) {
+				rte_mempool_put_bulk(sw->tim_pool, nodes,
+						     n_nodes);
+				n_nodes = 0;
+			}
+		}
+	}
+done:
+	wheel->cur_tick = tick - 1;
+	rte_spinlock_unlock(&wheel->lock);
+
+	rte_mempool_put_bulk(sw->tim_pool, nodes, n_nodes);
+}
+
+/* Enqueue buffered expiry events in bursts until the buffer is empty or the
+ * event device pushes back.
+ */
+static void
+swtim_wheel_flush(struct swtim *sw,
+		  const struct rte_event_timer_adapter *adapter)
+{
+	uint16_t nb_evs_flushed;
+	uint16_t nb_evs_invalid;
+
+	do {
+		nb_evs_flushed = 0;
+		nb_evs_invalid = 0;
+		event_buffer_flush(&sw->buffer,
+				   adapter->data->event_dev_id,
+				   adapter->data->event_port_id,
+				   &nb_evs_flushed,
+				   &nb_evs_invalid);
+
+		sw->stats.ev_enq_count += nb_evs_flushed;
+		sw->stats.ev_inv_count += nb_evs_invalid;
+	} while (nb_evs_flushed + nb_evs_invalid > 0);
+}
+
+static int
+swtim_wheel_service_func(void *arg)
+{
+	struct rte_event_timer_adapter *adapter = arg;
+	struct swtim *sw = swtim_pmd_priv(adapter);
+	struct swtim_wheel *wheel;
+	uint64_t cycles, now_tick;
+	int i, n_lcores;
+
+	cycles = rte_get_timer_cycles();
+	if (cycles >= sw->next_tick_cycles) {
+		now_tick = cycles / sw->wheel_tick_cycles;
+		n_lcores = __atomic_load_n(&sw->n_poll_lcores,
+					   __ATOMIC_RELAXED);
+		for (i = 0; i < n_lcores; i++) {
+			wheel = &sw->wheels[__atomic_load_n(
+					&sw->poll_lcores[i], __ATOMIC_RELAXED)];
+			swtim_wheel_expire(sw, wheel, now_tick);
+			if (event_buffer_batch_ready(&sw->buffer))
+				swtim_wheel_flush(sw, adapter);
+		}
+
+		sw->next_tick_cycles = (now_tick + 1) * sw->wheel_tick_cycles;
+		sw->stats.adapter_tick_count++;
+	}
+
+	swtim_wheel_flush(sw, adapter);
+
+	return 0;
+}
+
+static void
+swtim_wheel_free(struct swtim *sw)
+{
+	int i;
+
+	if (sw->wheels == NULL)
+		return;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		rte_free(sw->wheels[i].slots);
+	rte_free(sw->wheels);
+	sw->wheels = NULL;
+}
+
+static int
+swtim_wheel_init(struct swtim *sw, int socket_id)
+{
+	struct swtim_wheel *wheel;
+	uint64_t n_slots, now_tick;
+	unsigned int i;
+
+	sw->wheel_tick_cycles = sw->timer_tick_ns *
+			(rte_get_timer_hz() / NSECPERSEC);
+	if (sw->wheel_tick_cycles == 0)
+		sw->wheel_tick_cycles = 1;
+
+	n_slots = rte_align64pow2(sw->max_tmo_ns / sw->timer_tick_ns + 1);
+	n_slots = RTE_MIN(n_slots, (uint64_t)SWTIM_WHEEL_SLOTS_MAX);
+	sw->wheel_mask = n_slots - 1;
+
+	sw->wheels = rte_zmalloc_socket("swtim_wheels",
+			sizeof(struct swtim_wheel) * RTE_MAX_LCORE,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (sw->wheels == NULL)
+		return -ENOMEM;
+
+	now_tick = rte_get_timer_cycles() / sw->wheel_tick_cycles;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		/* Non-EAL threads share the wheel of the highest lcore */
+		if (!rte_lcore_is_enabled(i) && i != RTE_MAX_LCORE - 1)
+			continue;
+
+		wheel = &sw->wheels[i];
+		rte_spinlock_init(&wheel->lock);
+		wheel->cur_tick = now_tick;
+		wheel->slots = rte_zmalloc_socket("swtim_wheel_slots",
+				sizeof(struct swtim_slot) * n_slots,
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (wheel->slots == NULL) {
+			swtim_wheel_free(sw);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
 /* The adapter initialization function rounds the mempool size up to the next
  * power of 2, so we can take the difference between that value and what the
  * user requested, and use the space for caches.  This avoids a scenario where a
@@ -794,6 +997,8 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 	struct swtim *sw;
 	unsigned int flags;
 	struct rte_service_spec service;
+	bool wheel_mode = !!(adapter->data->conf.flags &
+			     RTE_EVENT_TIMER_ADAPTER_F_TIMER_WHEEL);
 
 	/* Allocate storage for private data area */
 #define SWTIM_NAMESIZE 32
@@ -826,7 +1031,9 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 				adapter->data->conf.nb_timers, nb_timers);
 	flags = 0; /* pool is multi-producer, multi-consumer */
 	sw->tim_pool = rte_mempool_create(pool_name, pool_size,
-			sizeof(struct rte_timer), cache_size, 0, NULL, NULL,
+			wheel_mode ? sizeof(struct swtim_node) :
+				     sizeof(struct rte_timer),
+			cache_size, 0, NULL, NULL,
 			NULL, NULL, adapter->data->socket_id, flags);
 	if (sw->tim_pool == NULL) {
 		EVTIM_LOG_ERR("failed to create timer object mempool");
@@ -838,21 +1045,34 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 	for (i = 0; i < RTE_MAX_LCORE; i++)
 		sw->in_use[i].v = 0;
 
-	/* Initialize the timer subsystem and allocate timer data instance */
-	ret = rte_timer_subsystem_init();
-	if (ret < 0) {
-		if (ret != -EALREADY) {
-			EVTIM_LOG_ERR("failed to initialize timer subsystem");
+	if (wheel_mode) {
+		ret = swtim_wheel_init(sw, adapter->data->socket_id);
+		if (ret < 0) {
+			EVTIM_LOG_ERR("failed to allocate timing wheels");
 			rte_errno = -ret;
 			goto free_mempool;
 		}
-	}
+	} else {
+		/* Initialize the timer subsystem and allocate timer data
+		 * instance
+		 */
+		ret = rte_timer_subsystem_init();
+		if (ret < 0) {
+			if (ret != -EALREADY) {
+				EVTIM_LOG_ERR("failed to initialize timer "
+					      "subsystem");
+				rte_errno = -ret;
+				goto free_mempool;
+			}
+		}
 
-	ret = rte_timer_data_alloc(&sw->timer_data_id);
-	if (ret < 0) {
-		EVTIM_LOG_ERR("failed to allocate timer data instance");
-		rte_errno = -ret;
-		goto free_mempool;
+		ret = rte_timer_data_alloc(&sw->timer_data_id);
+		if (ret < 0) {
+			EVTIM_LOG_ERR("failed to allocate timer data "
+				      "instance");
+			rte_errno = -ret;
+			goto free_mempool;
+		}
 	}
 
 	/* Initialize timer event buffer */
@@ -865,7 +1085,8 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 	snprintf(service.name, RTE_SERVICE_NAME_MAX,
 		 "swtim_svc_%"PRIu8, adapter->data->id);
 	service.socket_id = adapter->data->socket_id;
-	service.callback = swtim_service_func;
+	service.callback = wheel_mode ? swtim_wheel_service_func :
+					swtim_service_func;
 	service.callback_userdata = adapter;
 	service.capabilities &= ~(RTE_SERVICE_CAP_MT_SAFE);
 	ret = rte_service_component_register(&service, &sw->service_id);
@@ -875,7 +1096,7 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 			      ret);
 
 		rte_errno = ENOSPC;
-		goto free_mempool;
+		goto free_wheels;
 	}
 
 	EVTIM_LOG_DBG("registered service %s with id %"PRIu32, service.name,
@@ -885,6 +1106,8 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 	adapter->data->service_inited = 1;
 
 	return 0;
+free_wheels:
+	swtim_wheel_free(sw);
 free_mempool:
 	rte_mempool_free(sw->tim_pool);
 free_alloc:
@@ -900,6 +1123,27 @@ swtim_free_tim(struct rte_timer *tim, void *arg)
 	rte_mempool_put(sw->tim_pool, tim);
 }
 
+static void
+swtim_wheel_stop_all(struct swtim *sw)
+{
+	struct swtim_slot *slots;
+	struct swtim_node *node;
+	uint64_t i;
+	int lcore;
+
+	for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++) {
+		slots = sw->wheels[lcore].slots;
+		if (slots == NULL)
+			continue;
+		for (i = 0; i <= sw->wheel_mask; i++) {
+			while ((node = LIST_FIRST(&slots[i])) != NULL) {
+				LIST_REMOVE(node, next);
+				rte_mempool_put(sw->tim_pool, node);
+			}
+		}
+	}
+}
+
 /* Traverse the list of outstanding timers and put them back in the mempool
  * before freeing the adapter to avoid leaking the memory.
  */
@@ -910,11 +1154,14 @@ swtim_uninit(struct rte_event_timer_adapter *adapter)
 	struct swtim *sw = swtim_pmd_priv(adapter);
 
 	/* Free outstanding timers */
-	rte_timer_stop_all(sw->timer_data_id,
-			   sw->poll_lcores,
-			   sw->n_poll_lcores,
-			   swtim_free_tim,
-			   sw);
+	if (sw->wheels != NULL)
+		swtim_wheel_stop_all(sw);
+	else
+		rte_timer_stop_all(sw->timer_data_id,
+				   sw->poll_lcores,
+				   sw->n_poll_lcores,
+				   swtim_free_tim,
+				   sw);
 
 	ret = rte_service_component_unregister(sw->service_id);
 	if (ret < 0) {
@@ -922,6 +1169,7 @@ swtim_uninit(struct rte_event_timer_adapter *adapter)
 		return ret;
 	}
 
+	swtim_wheel_free(sw);
 	rte_mempool_free(sw->tim_pool);
 	rte_free(sw);
 	adapter->data->adapter_priv = NULL;
@@ -1008,6 +1256,74 @@ swtim_stats_reset(const struct rte_event_timer_adapter *adapter)
 	return 0;
 }
 
+/* If this is the first time we're arming an event timer on this lcore,
+ * mark this lcore as "in use"; this will cause the service
+ * function to process the timer list that corresponds to this lcore.
+ * The atomic compare-and-swap operation can prevent the race condition
+ * on in_use flag between multiple non-EAL threads.
+ */
+static __rte_always_inline void
+swtim_poll_lcore_add(struct swtim *sw, uint32_t lcore_id)
+{
+	/* Timer list for this lcore is not in use. */
+	uint16_t exp_state = 0;
+	int n_lcores;
+
+	if (unlikely(__atomic_compare_exchange_n(&sw->in_use[lcore_id].v,
+			&exp_state, 1, 0,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED))) {
+		EVTIM_LOG_DBG("Adding lcore id = %u to list of lcores to poll",
+			      lcore_id);
+		n_lcores = __atomic_fetch_add(&sw->n_poll_lcores, 1,
+					     __ATOMIC_RELAXED);
+		__atomic_store_n(&sw->poll_lcores[n_lcores], lcore_id,
+				__ATOMIC_RELAXED);
+	}
+}
+
+/* Check that an event timer can be armed, and set its state and rte_errno
+ * if not.
+ */
+static __rte_always_inline int
+swtim_arm_check(struct rte_event_timer *evtim,
+		const struct rte_event_timer_adapter *adapter)
+{
+	enum rte_event_timer_state n_state;
+	int ret;
+
+	n_state = __atomic_load_n(&evtim->state, __ATOMIC_ACQUIRE);
+	if (n_state == RTE_EVENT_TIMER_ARMED) {
+		rte_errno = EALREADY;
+		return -1;
+	} else if (!(n_state == RTE_EVENT_TIMER_NOT_ARMED ||
+		     n_state == RTE_EVENT_TIMER_CANCELED)) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	ret = check_timeout(evtim, adapter);
+	if (unlikely(ret == -1)) {
+		__atomic_store_n(&evtim->state, RTE_EVENT_TIMER_ERROR_TOOLATE,
+				__ATOMIC_RELAXED);
+		rte_errno = EINVAL;
+		return -1;
+	} else if (unlikely(ret == -2)) {
+		__atomic_store_n(&evtim->state, RTE_EVENT_TIMER_ERROR_TOOEARLY,
+				__ATOMIC_RELAXED);
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	if (unlikely(check_destination_event_queue(evtim, adapter) < 0)) {
+		__atomic_store_n(&evtim->state, RTE_EVENT_TIMER_ERROR,
+				__ATOMIC_RELAXED);
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
 static uint16_t
 __swtim_arm_burst(const struct rte_event_timer_adapter *adapter,
 		struct rte_event_timer **evtims,
@@ -1018,10 +1334,6 @@ __swtim_arm_burst(const struct rte_event_timer_adapter *adapter,
 	uint32_t lcore_id = rte_lcore_id();
 	struct rte_timer *tim, *tims[nb_evtims];
 	uint64_t cycles;
-	int n_lcores;
-	/* Timer list for this lcore is not in use. */
-	uint16_t exp_state = 0;
-	enum rte_event_timer_state n_state;
 
 #ifdef RTE_LIBRTE_EVENTDEV_DEBUG
 	/* Check that the service is running. */
@@ -1037,22 +1349,7 @@ __swtim_arm_burst(const struct rte_event_timer_adapter *adapter,
 	if (lcore_id == LCORE_ID_ANY)
 		lcore_id = RTE_MAX_LCORE - 1;
 
-	/* If this is the first time we're arming an event timer on this lcore,
-	 * mark this lcore as "in use"; this will cause the service
-	 * function to process the timer list that corresponds to this lcore.
-	 * The atomic compare-and-swap operation can prevent the race condition
-	 * on in_use flag between multiple non-EAL threads.
-	 */
-	if (unlikely(__atomic_compare_exchange_n(&sw->in_use[lcore_id].v,
-			&exp_state, 1, 0,
-			__ATOMIC_RELAXED, __ATOMIC_RELAXED))) {
-		EVTIM_LOG_DBG("Adding lcore id = %u to list of lcores to poll",
-			      lcore_id);
-		n_lcores = __atomic_fetch_add(&sw->n_poll_lcores, 1,
-					     __ATOMIC_RELAXED);
-		__atomic_store_n(&sw->poll_lcores[n_lcores], lcore_id,
-				__ATOMIC_RELAXED);
-	}
+	swtim_poll_lcore_add(sw, lcore_id);
 
 	ret = rte_mempool_get_bulk(sw->tim_pool, (void **)tims,
 				   nb_evtims);
@@ -1062,39 +1359,8 @@ __swtim_arm_burst(const struct rte_event_timer_adapter *adapter,
 	}
 
 	for (i = 0; i < nb_evtims; i++) {
-		n_state = __atomic_load_n(&evtims[i]->state, __ATOMIC_ACQUIRE);
-		if (n_state == RTE_EVENT_TIMER_ARMED) {
-			rte_errno = EALREADY;
-			break;
-		} else if (!(n_state == RTE_EVENT_TIMER_NOT_ARMED ||
-			     n_state == RTE_EVENT_TIMER_CANCELED)) {
-			rte_errno = EINVAL;
-			break;
-		}
-
-		ret = check_timeout(evtims[i], adapter);
-		if (unlikely(ret == -1)) {
-			__atomic_store_n(&evtims[i]->state,
-					RTE_EVENT_TIMER_ERROR_TOOLATE,
-					__ATOMIC_RELAXED);
-			rte_errno = EINVAL;
+		if (swtim_arm_check(evtims[i], adapter) < 0)
 			break;
-		} else if (unlikely(ret == -2)) {
-			__atomic_store_n(&evtims[i]->state,
-					RTE_EVENT_TIMER_ERROR_TOOEARLY,
-					__ATOMIC_RELAXED);
-			rte_errno = EINVAL;
-			break;
-		}
-
-		if (unlikely(check_destination_event_queue(evtims[i],
-							   adapter) < 0)) {
-			__atomic_store_n(&evtims[i]->state,
-					RTE_EVENT_TIMER_ERROR,
-					__ATOMIC_RELAXED);
-			rte_errno = EINVAL;
-			break;
-		}
 
 		tim = tims[i];
 		rte_timer_init(tim);
@@ -1207,6 +1473,171 @@ swtim_arm_tmo_tick_burst(const struct rte_event_timer_adapter *adapter,
 	return __swtim_arm_burst(adapter, evtims, nb_evtims);
 }
 
+static uint16_t
+__swtim_wheel_arm_burst(const struct rte_event_timer_adapter *adapter,
+			struct rte_event_timer **evtims,
+			uint16_t nb_evtims)
+{
+	int i;
+	struct swtim *sw = swtim_pmd_priv(adapter);
+	uint32_t lcore_id = rte_lcore_id();
+	struct swtim_node *node, *nodes[nb_evtims];
+	struct swtim_wheel *wheel;
+	uint64_t cycles, base_tick, slot_tick;
+
+#ifdef RTE_LIBRTE_EVENTDEV_DEBUG
+	/* Check that the service is running. */
+	if (rte_service_runstate_get(adapter->data->service_id) != 1) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+#endif
+
+	/* Non-EAL threads, and lcores which were not enabled when the adapter
+	 * was created, share the wheel of the highest lcore.
+	 */
+	if (lcore_id == LCORE_ID_ANY || sw->wheels[lcore_id].slots == NULL)
+		lcore_id = RTE_MAX_LCORE - 1;
+	wheel = &sw->wheels[lcore_id];
+
+	swtim_poll_lcore_add(sw, lcore_id);
+
+	if (rte_mempool_get_bulk(sw->tim_pool, (void **)nodes,
+				 nb_evtims) < 0) {
+		rte_errno = ENOSPC;
+		return 0;
+	}
+
+	/* Count the timeout from the next tick boundary so that no timer
+	 * expires early.
+	 */
+	cycles = rte_get_timer_cycles();
+	base_tick = cycles / sw->wheel_tick_cycles +
+		(cycles % sw->wheel_tick_cycles != 0);
+
+	rte_spinlock_lock(&wheel->lock);
+	for (i = 0; i < nb_evtims; i++) {
+		if (swtim_arm_check(evtims[i], adapter) < 0)
+			break;
+
+		node = nodes[i];
+		node->evtim = evtims[i];
+		node->expiry = base_tick + evtims[i]->timeout_ticks;
+		/* Never hash behind the buckets the service already walked */
+		slot_tick = RTE_MAX(node->expiry, wheel->cur_tick + 1);
+		LIST_INSERT_HEAD(&wheel->slots[slot_tick & sw->wheel_mask],
+				 node, next);
+
+		evtims[i]->impl_opaque[0] = (uintptr_t)node;
+		evtims[i]->impl_opaque[1] = (uintptr_t)wheel;
+
+		EVTIM_LOG_DBG("armed an event timer");
+		/* RELEASE ordering guarantees the adapter specific value
+		 * changes observed before the update of state.
+		 */
+		__atomic_store_n(&evtims[i]->state, RTE_EVENT_TIMER_ARMED,
+				__ATOMIC_RELEASE);
+	}
+	rte_spinlock_unlock(&wheel->lock);
+
+	if (i < nb_evtims)
+		rte_mempool_put_bulk(sw->tim_pool,
+				     (void **)&nodes[i], nb_evtims - i);
+
+	return i;
+}
+
+static uint16_t
+swtim_wheel_arm_burst(const struct rte_event_timer_adapter *adapter,
+		      struct rte_event_timer **evtims,
+		      uint16_t nb_evtims)
+{
+	return __swtim_wheel_arm_burst(adapter, evtims, nb_evtims);
+}
+
+static uint16_t
+swtim_wheel_arm_tmo_tick_burst(const struct rte_event_timer_adapter *adapter,
+			       struct rte_event_timer **evtims,
+			       uint64_t timeout_ticks,
+			       uint16_t nb_evtims)
+{
+	int i;
+
+	for (i = 0; i < nb_evtims; i++)
+		evtims[i]->timeout_ticks = timeout_ticks;
+
+	return __swtim_wheel_arm_burst(adapter, evtims, nb_evtims);
+}
+
+static uint16_t
+swtim_wheel_cancel_burst(const struct rte_event_timer_adapter *adapter,
+			 struct rte_event_timer **evtims,
+			 uint16_t nb_evtims)
+{
+	int i;
+	struct swtim *sw = swtim_pmd_priv(adapter);
+	struct swtim_wheel *wheel, *locked = NULL;
+	struct swtim_node *nodes[nb_evtims];
+	enum rte_event_timer_state n_state;
+
+#ifdef RTE_LIBRTE_EVENTDEV_DEBUG
+	/* Check that the service is running. */
+	if (rte_service_runstate_get(adapter->data->service_id) != 1) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+#endif
+
+	for (i = 0; i < nb_evtims; i++) {
+		/* ACQUIRE ordering guarantees the access of implementation
+		 * specific opaque data under the correct state.
+		 */
+		n_state = __atomic_load_n(&evtims[i]->state, __ATOMIC_ACQUIRE);
+		if (n_state == RTE_EVENT_TIMER_CANCELED) {
+			rte_errno = EALREADY;
+			break;
+		} else if (n_state != RTE_EVENT_TIMER_ARMED) {
+			rte_errno = EINVAL;
+			break;
+		}
+
+		/* Timers armed on the same lcore share the lock */
+		wheel = (struct swtim_wheel *)(uintptr_t)
+				evtims[i]->impl_opaque[1];
+		if (wheel != locked) {
+			if (locked != NULL)
+				rte_spinlock_unlock(&locked->lock);
+			rte_spinlock_lock(&wheel->lock);
+			locked = wheel;
+		}
+
+		/* The service may have expired the timer in the meantime */
+		if (__atomic_load_n(&evtims[i]->state, __ATOMIC_RELAXED) !=
+				RTE_EVENT_TIMER_ARMED) {
+			rte_errno = EINVAL;
+			break;
+		}
+
+		nodes[i] = (struct swtim_node *)(uintptr_t)
+				evtims[i]->impl_opaque[0];
+		LIST_REMOVE(nodes[i], next);
+
+		/* The RELEASE ordering here pairs with atomic ordering
+		 * to make sure the state update data observed between
+		 * threads.
+		 */
+		__atomic_store_n(&evtims[i]->state, RTE_EVENT_TIMER_CANCELED,
+				__ATOMIC_RELEASE);
+	}
+
+	if (locked != NULL)
+		rte_spinlock_unlock(&locked->lock);
+
+	rte_mempool_put_bulk(sw->tim_pool, (void **)nodes, i);
+
+	return i;
+}
+
 static const struct rte_event_timer_adapter_ops swtim_ops = {
 	.init			= swtim_init,
 	.uninit			= swtim_uninit,
@@ -1219,3 +1650,16 @@ static const struct rte_event_timer_adapter_ops swtim_ops = {
 	.arm_tmo_tick_burst	= swtim_arm_tmo_tick_burst,
 	.cancel_burst		= swtim_cancel_burst,
 };
+
+static const struct rte_event_timer_adapter_ops swtim_wheel_ops = {
+	.init			= swtim_init,
+	.uninit			= swtim_uninit,
+	.start			= swtim_start,
+	.stop			= swtim_stop,
+	.get_info		= swtim_get_info,
+	.stats_get		= swtim_stats_get,
+	.stats_reset		= swtim_stats_reset,
+	.arm_burst		= swtim_wheel_arm_burst,
+	.arm_tmo_tick_burst	= swtim_wheel_arm_tmo_tick_burst,
+	.cancel_burst		= swtim_wheel_cancel_burst,
+};
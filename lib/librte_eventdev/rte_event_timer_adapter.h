@@ -150,6 +150,16 @@ enum rte_event_timer_adapter_clk_src {
  *
  * @see struct rte_event_timer_adapter_conf::flags
  */
+#define RTE_EVENT_TIMER_ADAPTER_F_TIMER_WHEEL	(1ULL << 2)
+/**< When the event device has no timer adapter of its own, use the software
+ * implementation based on per-lcore timing wheels instead of rte_timer
+ * lists. Timers are hashed by expiry tick into the wheel of the arming lcore
+ * and a whole bucket is expired at once, which makes arm and cancel
+ * constant time operations. Timeouts longer than the wheel span cost one
+ * extra bucket visit per revolution of the wheel.
+ *
+ * @see struct rte_event_timer_adapter_conf::flags
+ */
 
 /**
  * Timer adapter configuration structure
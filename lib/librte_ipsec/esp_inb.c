@@ -215,6 +215,27 @@ inb_get_sqn(const struct rte_ipsec_sa *sa, const struct replay_sqn *rsn,
 	return rc;
 }
 
+/*
+ * same as inb_get_sqn(), but for SA with lock-free replay window,
+ * *top* is the highest accepted SQN.
+ */
+static inline int
+inb_mt_get_sqn(const struct rte_ipsec_sa *sa, uint64_t top,
+	struct rte_mbuf *mb, uint32_t hlen, rte_be64_t *sqc)
+{
+	uint64_t sqn;
+	struct rte_esp_hdr *esph;
+
+	esph = rte_pktmbuf_mtod_offset(mb, struct rte_esp_hdr *, hlen);
+
+	sqn = rte_be_to_cpu_32(esph->seq);
+	if (IS_ESN(sa))
+		sqn = reconstruct_esn(top, sqn, sa->replay.win_sz);
+	*sqc = rte_cpu_to_be_64(sqn);
+
+	return esn_inb_mt_check_sqn(sa, top, sqn);
+}
+
 /* prepare packet for upcoming processing */
 static inline int32_t
 inb_prepare(const struct rte_ipsec_sa *sa, struct rte_mbuf *mb,
@@ -280,24 +301,82 @@ inb_prepare(const struct rte_ipsec_sa *sa, struct rte_mbuf *mb,
 }
 
 static inline int32_t
-inb_pkt_prepare(const struct rte_ipsec_sa *sa, const struct replay_sqn *rsn,
+inb_pkt_prepare(const struct rte_ipsec_sa *sa, rte_be64_t sqc,
 	struct rte_mbuf *mb, uint32_t hlen, union sym_op_data *icv)
 {
-	int rc;
-	rte_be64_t sqn;
-
-	rc = inb_get_sqn(sa, rsn, mb, hlen, &sqn);
-	if (rc != 0)
-		return rc;
+	int32_t rc;
 
 	rc = inb_prepare(sa, mb, hlen, icv);
 	if (rc < 0)
 		return rc;
 
-	inb_pkt_xprepare(sa, sqn, icv);
+	inb_pkt_xprepare(sa, sqc, icv);
 	return rc;
 }
 
+/*
+ * Prefetch stage for a group of ESP inbound packets.
+ * Bring in mbufs second cache line (L2/L3 lengths) first,
+ * then ESP header and packet trailer (ESP tail, ICV) for the whole group.
+ * For multi-segment packets data is not prefetched, as trailer location
+ * is not known until mbuf_get_seg_ofs() walks through the segments.
+ * Also fills ESP header offsets for all packets.
+ */
+static inline void
+inb_pkt_prefetch(struct rte_mbuf *mb[], uint32_t hl[], uint32_t tlen,
+	uint32_t num)
+{
+	uint32_t i;
+	const uint8_t *p;
+
+	for (i = 0; i != num; i++)
+		rte_mbuf_prefetch_part2(mb[i]);
+
+	for (i = 0; i != num; i++) {
+		hl[i] = mb[i]->l2_len + mb[i]->l3_len;
+		if (mb[i]->nb_segs == 1) {
+			p = rte_pktmbuf_mtod(mb[i], const uint8_t *);
+			rte_prefetch0(p + hl[i]);
+			rte_prefetch0(p + mb[i]->pkt_len - tlen);
+		}
+	}
+}
+
+/*
+ * Retrieve and check SQN for a group of ESP inbound packets.
+ * Done as a separate stage, so RSN is acquired only once per group
+ * and held for as short as possible.
+ * ESP header offsets are re-read from mbufs metadata, that is already
+ * in cache after the prefetch stage.
+ */
+static inline void
+inb_pkt_sqn_check(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+	rte_be64_t sqc[], int32_t rc[], uint32_t num)
+{
+	uint32_t hl, i;
+	uint64_t top;
+	struct replay_sqn *rsn;
+
+	/* lock-free replay window, nothing to acquire */
+	if (SQN_MT(sa)) {
+		top = (sa->replay.win_sz == 0) ? 0 : rsn_mt_sqn(sa);
+		for (i = 0; i != num; i++) {
+			hl = mb[i]->l2_len + mb[i]->l3_len;
+			rc[i] = inb_mt_get_sqn(sa, top, mb[i], hl, sqc + i);
+		}
+		return;
+	}
+
+	rsn = rsn_acquire(sa);
+
+	for (i = 0; i != num; i++) {
+		hl = mb[i]->l2_len + mb[i]->l3_len;
+		rc[i] = inb_get_sqn(sa, rsn, mb[i], hl, sqc + i);
+	}
+
+	rsn_release(sa, rsn);
+}
+
 /*
  * setup/update packets and crypto ops for ESP inbound case.
  */
@@ -305,34 +384,42 @@ uint16_t
 esp_inb_pkt_prepare(const struct rte_ipsec_session *ss, struct rte_mbuf *mb[],
 	struct rte_crypto_op *cop[], uint16_t num)
 {
-	int32_t rc;
-	uint32_t i, k, hl;
+	uint32_t i, k;
 	struct rte_ipsec_sa *sa;
 	struct rte_cryptodev_sym_session *cs;
-	struct replay_sqn *rsn;
 	union sym_op_data icv;
+	int32_t rc[num];
 	uint32_t dr[num];
+	uint32_t hl[num];
+	rte_be64_t sqc[num];
 
 	sa = ss->sa;
 	cs = ss->crypto.ses;
-	rsn = rsn_acquire(sa);
+
+	/* prefetch ESP headers and ICVs for the whole group */
+	inb_pkt_prefetch(mb, hl, sa->icv_len, num);
+
+	/* retrieve and check SQNs */
+	inb_pkt_sqn_check(sa, mb, sqc, rc, num);
 
 	k = 0;
 	for (i = 0; i != num; i++) {
 
-		hl = mb[i]->l2_len + mb[i]->l3_len;
-		rc = inb_pkt_prepare(sa, rsn, mb[i], hl, &icv);
-		if (rc >= 0) {
-			lksd_none_cop_prepare(cop[k], cs, mb[i]);
-			inb_cop_prepare(cop[k], sa, mb[i], &icv, hl, rc);
-			k++;
-		} else {
-			dr[i - k] = i;
-			rte_errno = -rc;
+		/* prepare packets that passed SQN check */
+		if (rc[i] == 0) {
+			rc[i] = inb_pkt_prepare(sa, sqc[i], mb[i], hl[i], &icv);
+			if (rc[i] >= 0) {
+				lksd_none_cop_prepare(cop[k], cs, mb[i]);
+				inb_cop_prepare(cop[k], sa, mb[i], &icv, hl[i],
+					rc[i]);
+				k++;
+				continue;
+			}
 		}
-	}
 
-	rsn_release(sa, rsn);
+		dr[i - k] = i;
+		rte_errno = -rc[i];
+	}
 
 	/* copy not prepared mbufs beyond good ones */
 	if (k != num && k != 0)
@@ -347,18 +434,16 @@ esp_inb_pkt_prepare(const struct rte_ipsec_session *ss, struct rte_mbuf *mb[],
  * Extract information that will be needed later from mbuf metadata and
  * actual packet data:
  * - mbuf for packet's last segment
- * - length of the L2/L3 headers
  * - esp tail structure
  */
 static inline void
 process_step1(struct rte_mbuf *mb, uint32_t tlen, struct rte_mbuf **ml,
-	struct rte_esp_tail *espt, uint32_t *hlen, uint32_t *tofs)
+	struct rte_esp_tail *espt, uint32_t *tofs)
 {
 	const struct rte_esp_tail *pt;
 	uint32_t ofs;
 
 	ofs = mb->pkt_len - tlen;
-	hlen[0] = mb->l2_len + mb->l3_len;
 	ml[0] = mbuf_get_seg_ofs(mb, &ofs);
 	pt = rte_pktmbuf_mtod_offset(ml[0], const struct rte_esp_tail *, ofs);
 	tofs[0] = ofs;
@@ -532,10 +617,12 @@ tun_process(const struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
 
 	/*
 	 * to minimize stalls due to load latency,
-	 * read mbufs metadata and esp tail first.
+	 * prefetch ESP headers and trailers for the whole group,
+	 * then read mbufs metadata and esp tail first.
 	 */
+	inb_pkt_prefetch(mb, hl, tlen, num);
 	for (i = 0; i != num; i++)
-		process_step1(mb[i], tlen, &ml[i], &espt[i], &hl[i], &to[i]);
+		process_step1(mb[i], tlen, &ml[i], &espt[i], &to[i]);
 
 	k = 0;
 	for (i = 0; i != num; i++) {
@@ -590,10 +677,12 @@ trs_process(const struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
 
 	/*
 	 * to minimize stalls due to load latency,
-	 * read mbufs metadata and esp tail first.
+	 * prefetch ESP headers and trailers for the whole group,
+	 * then read mbufs metadata and esp tail first.
 	 */
+	inb_pkt_prefetch(mb, hl, tlen, num);
 	for (i = 0; i != num; i++)
-		process_step1(mb[i], tlen, &ml[i], &espt[i], &hl[i], &to[i]);
+		process_step1(mb[i], tlen, &ml[i], &espt[i], &to[i]);
 
 	k = 0;
 	for (i = 0; i != num; i++) {
@@ -628,23 +717,19 @@ static inline uint16_t
 esp_inb_rsn_update(struct rte_ipsec_sa *sa, const uint32_t sqn[],
 	uint32_t dr[], uint16_t num)
 {
-	uint32_t i, k;
+	uint32_t k;
 	struct replay_sqn *rsn;
 
 	/* replay not enabled */
 	if (sa->replay.win_sz == 0)
 		return num;
 
-	rsn = rsn_update_start(sa);
-
-	k = 0;
-	for (i = 0; i != num; i++) {
-		if (esn_inb_update_sqn(rsn, sa, rte_be_to_cpu_32(sqn[i])) == 0)
-			k++;
-		else
-			dr[i - k] = i;
-	}
+	/* lock-free replay window */
+	if (SQN_MT(sa))
+		return esn_inb_mt_update_sqn_bulk(sa, sqn, dr, num);
 
+	rsn = rsn_update_start(sa);
+	k = esn_inb_update_sqn_bulk(rsn, sa, sqn, dr, num);
 	rsn_update_finish(sa, rsn);
 	return k;
 }
@@ -688,49 +773,51 @@ uint16_t
 cpu_inb_pkt_prepare(const struct rte_ipsec_session *ss,
 	struct rte_mbuf *mb[], uint16_t num)
 {
-	int32_t rc;
 	uint32_t i, k;
 	struct rte_ipsec_sa *sa;
-	struct replay_sqn *rsn;
 	union sym_op_data icv;
 	void *iv[num];
 	void *aad[num];
 	void *dgst[num];
+	int32_t rc[num];
 	uint32_t dr[num];
+	uint32_t hl[num];
 	uint32_t l4ofs[num];
 	uint32_t clen[num];
+	rte_be64_t sqc[num];
 	uint64_t ivbuf[num][IPSEC_MAX_IV_QWORD];
 
 	sa = ss->sa;
 
-	/* grab rsn lock */
-	rsn = rsn_acquire(sa);
+	/* prefetch ESP headers and ICVs for the whole group */
+	inb_pkt_prefetch(mb, hl, sa->icv_len, num);
+
+	/* retrieve and check SQNs */
+	inb_pkt_sqn_check(sa, mb, sqc, rc, num);
 
 	/* do preparation for all packets */
 	for (i = 0, k = 0; i != num; i++) {
 
-		/* calculate ESP header offset */
-		l4ofs[k] = mb[i]->l2_len + mb[i]->l3_len;
-
-		/* prepare ESP packet for processing */
-		rc = inb_pkt_prepare(sa, rsn, mb[i], l4ofs[k], &icv);
-		if (rc >= 0) {
-			/* get encrypted data offset and length */
-			clen[k] = inb_cpu_crypto_prepare(sa, mb[i],
-				l4ofs + k, rc, ivbuf[k]);
-
-			/* fill iv, digest and aad */
-			iv[k] = ivbuf[k];
-			aad[k] = icv.va + sa->icv_len;
-			dgst[k++] = icv.va;
-		} else {
-			dr[i - k] = i;
-			rte_errno = -rc;
+		/* prepare ESP packets that passed SQN check */
+		if (rc[i] == 0) {
+			rc[i] = inb_pkt_prepare(sa, sqc[i], mb[i], hl[i], &icv);
+			if (rc[i] >= 0) {
+				/* get encrypted data offset and length */
+				l4ofs[k] = hl[i];
+				clen[k] = inb_cpu_crypto_prepare(sa, mb[i],
+					l4ofs + k, rc[i], ivbuf[k]);
+
+				/* fill iv, digest and aad */
+				iv[k] = ivbuf[k];
+				aad[k] = icv.va + sa->icv_len;
+				dgst[k++] = icv.va;
+				continue;
+			}
 		}
-	}
 
-	/* release rsn lock */
-	rsn_release(sa, rsn);
+		dr[i - k] = i;
+		rte_errno = -rc[i];
+	}
 
 	/* copy not prepared mbufs beyond good ones */
 	if (k != num && k != 0)
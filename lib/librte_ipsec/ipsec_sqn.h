@@ -16,6 +16,14 @@
 #define IS_ESN(sa)	((sa)->sqn_mask == UINT64_MAX)
 
 #define	SQN_ATOMIC(sa)	((sa)->type & RTE_IPSEC_SATP_SQN_ATOM)
+#define	SQN_MT(sa)	((sa)->type & RTE_IPSEC_SATP_SQN_MT_ENABLE)
+
+/* lock-free replay window relies on 128-bit CAS */
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+#define IPSEC_SQN_MT_SUPPORTED	1
+#else
+#define IPSEC_SQN_MT_SUPPORTED	0
+#endif
 
 /*
  * gets SQN.hi32 bits, SQN supposed to be in network byte order.
@@ -127,7 +135,7 @@ esn_outb_update_sqn(struct rte_ipsec_sa *sa, uint32_t *num)
 	uint64_t n, s, sqn;
 
 	n = *num;
-	if (SQN_ATOMIC(sa))
+	if (SQN_ATOMIC(sa) || SQN_MT(sa))
 		sqn = __atomic_add_fetch(&sa->sqn.outb, n, __ATOMIC_RELAXED);
 	else {
 		sqn = sa->sqn.outb + n;
@@ -150,7 +158,8 @@ static inline int32_t
 esn_inb_update_sqn(struct replay_sqn *rsn, const struct rte_ipsec_sa *sa,
 	uint64_t sqn)
 {
-	uint32_t bit, bucket, last_bucket, new_bucket, diff, i;
+	uint32_t bucket, last_bucket, new_bucket, diff, i;
+	uint64_t bit;
 
 	/* handle ESN */
 	if (IS_ESN(sa))
@@ -190,6 +199,272 @@ esn_inb_update_sqn(struct replay_sqn *rsn, const struct rte_ipsec_sa *sa,
 	return 0;
 }
 
+/**
+ * For inbound SA perform the sequence number and replay window update
+ * for a group of packets at once.
+ * First pass reconstructs (for ESN) and checks all SQNs against the window
+ * lower bound, tracking the highest SQN the same way as per packet update
+ * would do. Second pass slides the window just once and marks all SQNs
+ * as seen, rejecting duplicates.
+ * That is equivalent to per packet update as long as all accepted SQNs
+ * stay within the final window, otherwise fall back to per packet update.
+ * Returns number of accepted SQNs, indexes of rejected ones are stored
+ * in dr[].
+ */
+static inline uint32_t
+esn_inb_update_sqn_bulk(struct replay_sqn *rsn, const struct rte_ipsec_sa *sa,
+	const rte_be32_t sqn[], uint32_t dr[], uint32_t num)
+{
+	uint32_t i, k;
+	uint64_t bit, bucket, diff, last_bucket, top, v;
+	uint64_t sq[num];
+
+	/* reconstruct SQNs and find new window position */
+	top = rsn->sqn;
+	for (i = 0; i != num; i++) {
+		v = rte_be_to_cpu_32(sqn[i]);
+		if (IS_ESN(sa))
+			v = reconstruct_esn(top, v, sa->replay.win_sz);
+
+		/* seq is outside window, zero SQN is never accepted */
+		if (v == 0 || v + sa->replay.win_sz < top)
+			v = 0;
+		else if (v > top)
+			top = v;
+		sq[i] = v;
+	}
+
+	/* some SQNs would be pushed out of the window, do it one by one */
+	last_bucket = top >> WINDOW_BUCKET_BITS;
+	for (i = 0; i != num; i++) {
+		if (sq[i] != 0 && (sq[i] >> WINDOW_BUCKET_BITS) +
+				sa->replay.nb_bucket <= last_bucket)
+			break;
+	}
+
+	if (i != num) {
+		k = 0;
+		for (i = 0; i != num; i++) {
+			if (esn_inb_update_sqn(rsn, sa,
+					rte_be_to_cpu_32(sqn[i])) == 0)
+				k++;
+			else
+				dr[i - k] = i;
+		}
+		return k;
+	}
+
+	/* slide the window once */
+	if (top > rsn->sqn) {
+		bucket = rsn->sqn >> WINDOW_BUCKET_BITS;
+		diff = last_bucket - bucket;
+		if (diff > sa->replay.nb_bucket)
+			diff = sa->replay.nb_bucket;
+
+		for (i = 0; i != diff; i++)
+			rsn->window[(i + bucket + 1) &
+				sa->replay.bucket_index_mask] = 0;
+		rsn->sqn = top;
+	}
+
+	/* mark SQNs as seen */
+	k = 0;
+	for (i = 0; i != num; i++) {
+
+		bucket = (sq[i] >> WINDOW_BUCKET_BITS) &
+			sa->replay.bucket_index_mask;
+		bit = (uint64_t)1 << (sq[i] & WINDOW_BIT_LOC_MASK);
+
+		/* outside window or already seen packet */
+		if (sq[i] == 0 || (rsn->window[bucket] & bit) != 0)
+			dr[i - k] = i;
+		else {
+			rsn->window[bucket] |= bit;
+			k++;
+		}
+	}
+
+	return k;
+}
+
+/**
+ * Lock-free replay window for SA that can be processed by multiple
+ * threads concurrently (see struct replay_sqn_mt).
+ * Highest accepted SQN is kept separately from the window itself and
+ * is updated only once per group of packets, so it can lag behind.
+ * That only relaxes lower window bound a bit, duplicates are still
+ * detected precisely, as slot bucket number never goes backwards.
+ */
+
+/**
+ * Get the highest accepted SQN.
+ */
+static inline uint64_t
+rsn_mt_sqn(const struct rte_ipsec_sa *sa)
+{
+	return __atomic_load_n(&sa->sqn.inb_mt->sqn, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Move the highest accepted SQN forward, if needed.
+ */
+static inline void
+rsn_mt_sqn_update(struct rte_ipsec_sa *sa, uint64_t sqn)
+{
+	uint64_t top;
+	struct replay_sqn_mt *rsn;
+
+	rsn = sa->sqn.inb_mt;
+	top = __atomic_load_n(&rsn->sqn, __ATOMIC_RELAXED);
+
+	while (sqn > top && __atomic_compare_exchange_n(&rsn->sqn, &top, sqn,
+			0, __ATOMIC_RELEASE, __ATOMIC_RELAXED) == 0)
+		;
+}
+
+/**
+ * Find window slot, bucket number and bit for given SQN.
+ */
+static inline struct replay_slot *
+rsn_mt_slot(const struct rte_ipsec_sa *sa, uint64_t sqn, uint64_t *bucket,
+	uint64_t *bit)
+{
+	uint32_t shard;
+	uint64_t n;
+
+	shard = sqn & (REPLAY_SHARD_NUM - 1);
+	n = sqn >> REPLAY_SHARD_BITS;
+
+	*bucket = n >> WINDOW_BUCKET_BITS;
+	*bit = (uint64_t)1 << (n & WINDOW_BIT_LOC_MASK);
+
+	return sa->sqn.inb_mt->slot +
+		shard * REPLAY_SHARD_STRIDE(sa->replay.nb_bucket) +
+		(*bucket & sa->replay.bucket_index_mask);
+}
+
+/**
+ * Lock-free version of esn_inb_check_sqn().
+ * Note that slot can be updated by other threads concurrently,
+ * so the check is a best effort one, final decision is made by
+ * esn_inb_mt_update_sqn().
+ */
+static inline int32_t
+esn_inb_mt_check_sqn(const struct rte_ipsec_sa *sa, uint64_t top,
+	uint64_t sqn)
+{
+	uint64_t b1, b2, bit, bits, bucket;
+	const struct replay_slot *slot;
+
+	/* replay not enabled */
+	if (sa->replay.win_sz == 0)
+		return 0;
+
+	/* seq is larger than lastseq */
+	if (sqn > top)
+		return 0;
+
+	/* seq is outside window */
+	if (sqn == 0 || sqn + sa->replay.win_sz < top)
+		return -EINVAL;
+
+	slot = rsn_mt_slot(sa, sqn, &bucket, &bit);
+
+	b1 = __atomic_load_n(&slot->bucket, __ATOMIC_ACQUIRE);
+	bits = __atomic_load_n(&slot->bits, __ATOMIC_ACQUIRE);
+	b2 = __atomic_load_n(&slot->bucket, __ATOMIC_RELAXED);
+
+	/* slot was updated while we were reading it */
+	if (b1 != b2)
+		return 0;
+
+	/* slot reused by newer SQNs or already seen packet */
+	if (b1 > bucket || (b1 == bucket && (bits & bit) != 0))
+		return -EINVAL;
+
+	return 0;
+}
+
+/**
+ * Lock-free update of the window slot for given SQN.
+ */
+static inline int32_t
+esn_inb_mt_update_sqn(struct rte_ipsec_sa *sa, uint64_t sqn)
+{
+#if IPSEC_SQN_MT_SUPPORTED
+	uint64_t bit, bucket;
+	struct replay_slot *slot;
+	rte_int128_t ov, nv;
+
+	slot = rsn_mt_slot(sa, sqn, &bucket, &bit);
+
+	ov.val[0] = __atomic_load_n(&slot->bucket, __ATOMIC_RELAXED);
+	ov.val[1] = __atomic_load_n(&slot->bits, __ATOMIC_RELAXED);
+
+	do {
+		/* slot already reused by newer SQNs */
+		if (ov.val[0] > bucket)
+			return -EINVAL;
+
+		if (ov.val[0] == bucket) {
+			/* already seen packet */
+			if ((ov.val[1] & bit) != 0)
+				return -EINVAL;
+			nv.val[1] = ov.val[1] | bit;
+		} else
+			nv.val[1] = bit;
+
+		nv.val[0] = bucket;
+
+	} while (rte_atomic128_cmp_exchange((rte_int128_t *)slot, &ov, &nv,
+			0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == 0);
+
+	return 0;
+#else
+	RTE_SET_USED(sa);
+	RTE_SET_USED(sqn);
+	return -ENOTSUP;
+#endif
+}
+
+/**
+ * For inbound SA with lock-free replay window perform the sequence number
+ * and replay window update for a group of packets.
+ * Can be invoked by multiple threads for the same SA simultaneously.
+ * Returns number of accepted SQNs, indexes of rejected ones are stored
+ * in dr[].
+ */
+static inline uint32_t
+esn_inb_mt_update_sqn_bulk(struct rte_ipsec_sa *sa, const rte_be32_t sqn[],
+	uint32_t dr[], uint32_t num)
+{
+	uint32_t i, k;
+	uint64_t top, v;
+
+	top = rsn_mt_sqn(sa);
+
+	k = 0;
+	for (i = 0; i != num; i++) {
+
+		v = rte_be_to_cpu_32(sqn[i]);
+		if (IS_ESN(sa))
+			v = reconstruct_esn(top, v, sa->replay.win_sz);
+
+		/* seq is outside window or already seen */
+		if (v == 0 || v + sa->replay.win_sz < top ||
+				esn_inb_mt_update_sqn(sa, v) != 0)
+			dr[i - k] = i;
+		else {
+			top = RTE_MAX(top, v);
+			k++;
+		}
+	}
+
+	/* publish new window position */
+	rsn_mt_sqn_update(sa, top);
+	return k;
+}
+
 /**
  * To achieve ability to do multiple readers single writer for
  * SA replay window information and sequence number (RSN)
@@ -70,6 +70,19 @@ struct rte_ipsec_sa_prm {
  */
 #define	RTE_IPSEC_SAFLAG_SQN_ATOM	(1ULL << 0)
 
+/**
+ * Indicates that SA sequence number and replay window can be accessed
+ * by multiple threads simultaneously, without any serialization.
+ * For inbound SA that means rte_ipsec_pkt_crypto_prepare() and
+ * rte_ipsec_pkt_process() can be invoked for the same SA by several
+ * threads at once, and packets can come in any order.
+ * Lock-free replay window is used for such SA, split into several
+ * shards by SQN, so concurrent updates mostly touch different cache lines.
+ * For outbound SA it has the same effect as RTE_IPSEC_SAFLAG_SQN_ATOM.
+ * Currently supported on x86-64 and aarch64 platforms only.
+ */
+#define	RTE_IPSEC_SAFLAG_SQN_MT		(1ULL << 1)
+
 /**
  * SA type is an 64-bit value that contain the following information:
  * - IP version (IPv4/IPv6)
@@ -79,6 +92,9 @@ struct rte_ipsec_sa_prm {
  * - for TUNNEL outer IP version (IPv4/IPv6)
  * - are SA SQN operations 'atomic'
  * - ESN enabled/disabled
+ * - ECN enabled/disabled
+ * - DSCP enabled/disabled
+ * - are SA SQN operations multi-thread safe
  * ...
  */
 
@@ -91,6 +107,7 @@ enum {
 	RTE_SATP_LOG2_ESN,
 	RTE_SATP_LOG2_ECN,
 	RTE_SATP_LOG2_DSCP,
+	RTE_SATP_LOG2_SQN_MT,
 	RTE_SATP_LOG2_NUM
 };
 
@@ -127,6 +144,10 @@ enum {
 #define RTE_IPSEC_SATP_DSCP_DISABLE	(0ULL << RTE_SATP_LOG2_DSCP)
 #define RTE_IPSEC_SATP_DSCP_ENABLE	(1ULL << RTE_SATP_LOG2_DSCP)
 
+#define RTE_IPSEC_SATP_SQN_MT_MASK	(1ULL << RTE_SATP_LOG2_SQN_MT)
+#define RTE_IPSEC_SATP_SQN_MT_DISABLE	(0ULL << RTE_SATP_LOG2_SQN_MT)
+#define RTE_IPSEC_SATP_SQN_MT_ENABLE	(1ULL << RTE_SATP_LOG2_SQN_MT)
+
 /**
  * get type of given SA
  * @return
@@ -143,6 +164,7 @@ rte_ipsec_sa_type(const struct rte_ipsec_sa *sa);
  * @return
  *   - Actual size required for SA with given parameters.
  *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if requested SA flags are not supported on that platform.
  */
 __rte_experimental
 int
@@ -113,6 +113,33 @@ replay_num_bucket(uint32_t wsz)
 	return nb;
 }
 
+/*
+ * Same as rsn_size(), but for lock-free replay window.
+ */
+static size_t
+rsn_mt_size(uint32_t nb_bucket)
+{
+	size_t sz;
+	struct replay_sqn_mt *rsn;
+
+	sz = sizeof(*rsn) + REPLAY_SHARD_NUM *
+		REPLAY_SHARD_STRIDE(nb_bucket) * sizeof(rsn->slot[0]);
+	sz = RTE_ALIGN_CEIL(sz, RTE_CACHE_LINE_SIZE);
+	return sz;
+}
+
+/*
+ * for given size, calculate required number of buckets per shard
+ * for lock-free replay window. One extra bucket is reserved
+ * for the partially filled one.
+ */
+static uint32_t
+replay_mt_num_bucket(uint32_t wsz)
+{
+	wsz = RTE_ALIGN_MUL_CEIL(wsz, REPLAY_SHARD_NUM) / REPLAY_SHARD_NUM;
+	return replay_num_bucket(wsz + WINDOW_BUCKET_SIZE);
+}
+
 static int32_t
 ipsec_sa_size(uint64_t type, uint32_t *wnd_sz, uint32_t *nb_bucket)
 {
@@ -121,6 +148,11 @@ ipsec_sa_size(uint64_t type, uint32_t *wnd_sz, uint32_t *nb_bucket)
 	wsz = *wnd_sz;
 	n = 0;
 
+	if ((type & RTE_IPSEC_SATP_SQN_MT_MASK) ==
+			RTE_IPSEC_SATP_SQN_MT_ENABLE &&
+			IPSEC_SQN_MT_SUPPORTED == 0)
+		return -ENOTSUP;
+
 	if ((type & RTE_IPSEC_SATP_DIR_MASK) == RTE_IPSEC_SATP_DIR_IB) {
 
 		/*
@@ -131,7 +163,10 @@ ipsec_sa_size(uint64_t type, uint32_t *wnd_sz, uint32_t *nb_bucket)
 		wsz = ((type & RTE_IPSEC_SATP_ESN_MASK) ==
 			RTE_IPSEC_SATP_ESN_DISABLE) ?
 			wsz : RTE_MAX(wsz, (uint32_t)WINDOW_BUCKET_SIZE);
-		if (wsz != 0)
+		if (wsz != 0 && (type & RTE_IPSEC_SATP_SQN_MT_MASK) ==
+				RTE_IPSEC_SATP_SQN_MT_ENABLE)
+			n = replay_mt_num_bucket(wsz);
+		else if (wsz != 0)
 			n = replay_num_bucket(wsz);
 	}
 
@@ -141,9 +176,15 @@ ipsec_sa_size(uint64_t type, uint32_t *wnd_sz, uint32_t *nb_bucket)
 	*wnd_sz = wsz;
 	*nb_bucket = n;
 
-	sz = rsn_size(n);
-	if ((type & RTE_IPSEC_SATP_SQN_MASK) == RTE_IPSEC_SATP_SQN_ATOM)
-		sz *= REPLAY_SQN_NUM;
+	if ((type & RTE_IPSEC_SATP_SQN_MT_MASK) ==
+			RTE_IPSEC_SATP_SQN_MT_ENABLE && n != 0)
+		sz = rsn_mt_size(n);
+	else {
+		sz = rsn_size(n);
+		if ((type & RTE_IPSEC_SATP_SQN_MASK) ==
+				RTE_IPSEC_SATP_SQN_ATOM)
+			sz *= REPLAY_SQN_NUM;
+	}
 
 	sz += sizeof(struct rte_ipsec_sa);
 	return sz;
@@ -232,6 +273,11 @@ fill_sa_type(const struct rte_ipsec_sa_prm *prm, uint64_t *type)
 	else
 		tp |= RTE_IPSEC_SATP_SQN_RAW;
 
+	if (prm->flags & RTE_IPSEC_SAFLAG_SQN_MT)
+		tp |= RTE_IPSEC_SATP_SQN_MT_ENABLE;
+	else
+		tp |= RTE_IPSEC_SATP_SQN_MT_DISABLE;
+
 	*type = tp;
 	return 0;
 }
@@ -452,6 +498,13 @@ fill_sa_replay(struct rte_ipsec_sa *sa, uint32_t wnd_sz, uint32_t nb_bucket)
 	sa->replay.win_sz = wnd_sz;
 	sa->replay.nb_bucket = nb_bucket;
 	sa->replay.bucket_index_mask = nb_bucket - 1;
+
+	if ((sa->type & RTE_IPSEC_SATP_SQN_MT_MASK) ==
+			RTE_IPSEC_SATP_SQN_MT_ENABLE) {
+		sa->sqn.inb_mt = (struct replay_sqn_mt *)(sa + 1);
+		return;
+	}
+
 	sa->sqn.inb.rsn[0] = (struct replay_sqn *)(sa + 1);
 	if ((sa->type & RTE_IPSEC_SATP_SQN_MASK) == RTE_IPSEC_SATP_SQN_ATOM)
 		sa->sqn.inb.rsn[1] = (struct replay_sqn *)
@@ -60,6 +60,30 @@ struct replay_sqn {
 	__extension__ uint64_t window[0];
 };
 
+/*
+ * Lock-free replay window (RTE_IPSEC_SATP_SQN_MT_ENABLE).
+ * SQN space is split into REPLAY_SHARD_NUM shards by SQN low bits,
+ * each shard has its own window of nb_bucket slots, starting at
+ * a separate cache line.
+ * Each slot keeps window bucket number together with its bitmap,
+ * so both can be updated with one 128-bit CAS.
+ */
+#define REPLAY_SHARD_BITS	3
+#define REPLAY_SHARD_NUM	(1 << REPLAY_SHARD_BITS)
+
+struct replay_slot {
+	uint64_t bucket;
+	uint64_t bits;
+} __rte_aligned(sizeof(rte_int128_t));
+
+#define REPLAY_SHARD_STRIDE(nb)	RTE_MAX((uint32_t)(nb), \
+	(uint32_t)(RTE_CACHE_LINE_SIZE / sizeof(struct replay_slot)))
+
+struct replay_sqn_mt {
+	uint64_t sqn; /* highest accepted SQN */
+	__extension__ struct replay_slot slot[0] __rte_cache_aligned;
+};
+
 /*IPSEC SA supported algorithms */
 enum sa_algo_type	{
 	ALGO_TYPE_NULL = 0,
@@ -125,6 +149,7 @@ struct rte_ipsec_sa {
 			uint32_t wridx; /* write index */
 			struct replay_sqn *rsn[REPLAY_SQN_NUM];
 		} inb;
+		struct replay_sqn_mt *inb_mt;
 	} sqn;
 
 } __rte_cache_aligned;
@@ -9,6 +9,8 @@
 #include <rte_common.h>
 #include <rte_log.h>
 #include <rte_cycles.h>
+#include <rte_prefetch.h>
+#include <rte_vect.h>
 #include <rte_function_versioning.h>
 
 #include "rte_meter.h"
@@ -227,3 +229,547 @@ rte_meter_trtcm_rfc4115_config_e(struct rte_meter_trtcm_rfc4115 *m,
 	return __rte_meter_trtcm_rfc4115_config(m, p);
 }
 VERSION_SYMBOL_EXPERIMENTAL(rte_meter_trtcm_rfc4115_config, _e);
+
+/*
+ * Bulk run-time methods
+ *
+ * The packets are processed in chunks. The token buckets of the meter of each
+ * run of consecutive packets using the same meter are refreshed first, several
+ * meters at a time where the CPU allows it, then the packets are colored with
+ * the bucket state kept in registers along each run. A refresh at the same
+ * time stamp is a no-op, so a meter showing up in several runs of a chunk is
+ * refreshed once.
+ */
+#define METER_BULK_CHUNK	64
+
+static inline void
+meter_srtcm_refresh(struct rte_meter_srtcm *m,
+	struct rte_meter_srtcm_profile *p,
+	uint64_t time)
+{
+	uint64_t n_periods, tc, te;
+
+	n_periods = (time - m->time) / p->cir_period;
+	m->time += n_periods * p->cir_period;
+
+	/* Put the tokens overflowing from tc into te bucket */
+	tc = m->tc + n_periods * p->cir_bytes_per_period;
+	te = m->te;
+	if (tc > p->cbs) {
+		te += (tc - p->cbs);
+		if (te > p->ebs)
+			te = p->ebs;
+		tc = p->cbs;
+	}
+
+	m->tc = tc;
+	m->te = te;
+}
+
+static inline void
+meter_trtcm_refresh(struct rte_meter_trtcm *m,
+	struct rte_meter_trtcm_profile *p,
+	uint64_t time)
+{
+	uint64_t n_periods_tc, n_periods_tp, tc, tp;
+
+	n_periods_tc = (time - m->time_tc) / p->cir_period;
+	n_periods_tp = (time - m->time_tp) / p->pir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_tp += n_periods_tp * p->pir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	tp = m->tp + n_periods_tp * p->pir_bytes_per_period;
+	if (tp > p->pbs)
+		tp = p->pbs;
+
+	m->tc = tc;
+	m->tp = tp;
+}
+
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+
+#define METER_REFRESH_LANES	4
+
+/* Values below 2^51 go through doubles exactly */
+#define METER_X4_LIMIT		(~((1LL << 51) - 1))
+
+static inline __m256d
+meter_x4_to_pd(__m256i v)
+{
+	const __m256i two52 = _mm256_set1_epi64x(0x4330000000000000LL);
+
+	return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, two52)),
+		_mm256_castsi256_pd(two52));
+}
+
+static inline __m256i
+meter_x4_from_pd(__m256d v)
+{
+	const __m256i two52 = _mm256_set1_epi64x(0x4330000000000000LL);
+
+	return _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(v,
+		_mm256_castsi256_pd(two52))), two52);
+}
+
+static inline __m256i
+meter_x4_min(__m256i a, __m256i b)
+{
+	return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+/*
+ * Bucket refresh of 4 meters: n = elapsed / period with the division done on
+ * doubles. Gives n * period and min(n * bytes, size), or returns 0 when some
+ * value is out of the exact range of the doubles.
+ */
+static inline int
+meter_x4_periods(__m256i elapsed, __m256i period, __m256i bytes,
+	__m256i size, __m256i *used, __m256i *added)
+{
+	__m256d elapsed_d, period_d, n_d, used_d, over;
+
+	if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(elapsed,
+			period), _mm256_or_si256(bytes, size)),
+			_mm256_set1_epi64x(METER_X4_LIMIT)))
+		return 0;
+
+	/* The rounded quotient is at most one period too large */
+	elapsed_d = meter_x4_to_pd(elapsed);
+	period_d = meter_x4_to_pd(period);
+	n_d = _mm256_floor_pd(_mm256_div_pd(elapsed_d, period_d));
+	used_d = _mm256_mul_pd(n_d, period_d);
+	over = _mm256_cmp_pd(used_d, elapsed_d, _CMP_GT_OQ);
+	n_d = _mm256_sub_pd(n_d, _mm256_and_pd(over, _mm256_set1_pd(1.0)));
+	used_d = _mm256_sub_pd(used_d, _mm256_and_pd(over, period_d));
+
+	*used = meter_x4_from_pd(used_d);
+	*added = meter_x4_from_pd(_mm256_min_pd(_mm256_mul_pd(n_d,
+		meter_x4_to_pd(bytes)), meter_x4_to_pd(size)));
+	return 1;
+}
+
+#define METER_X4_LOAD(m, field) \
+	_mm256_set_epi64x((m)[3]->field, (m)[2]->field, \
+		(m)[1]->field, (m)[0]->field)
+
+static inline void
+meter_srtcm_refresh_lanes(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time)
+{
+	uint64_t last[4], tc[4], te[4];
+	__m256i cbs, ebs, x, tc_v, te_v, used, added;
+	uint32_t i;
+
+	cbs = METER_X4_LOAD(p, cbs);
+	ebs = METER_X4_LOAD(p, ebs);
+	x = METER_X4_LOAD(m, time);
+
+	if (!meter_x4_periods(_mm256_sub_epi64(_mm256_set1_epi64x(time), x),
+			METER_X4_LOAD(p, cir_period),
+			METER_X4_LOAD(p, cir_bytes_per_period),
+			_mm256_add_epi64(cbs, ebs), &used, &added)) {
+		for (i = 0; i < 4; i++)
+			meter_srtcm_refresh(m[i], p[i], time);
+		return;
+	}
+	_mm256_storeu_si256((__m256i *)last, _mm256_add_epi64(x, used));
+
+	/* The tokens overflowing from tc go into te */
+	x = meter_x4_min(_mm256_add_epi64(METER_X4_LOAD(m, tc), added),
+		_mm256_add_epi64(cbs, ebs));
+	tc_v = meter_x4_min(x, cbs);
+	te_v = meter_x4_min(_mm256_add_epi64(METER_X4_LOAD(m, te),
+		_mm256_sub_epi64(x, tc_v)), ebs);
+	_mm256_storeu_si256((__m256i *)tc, tc_v);
+	_mm256_storeu_si256((__m256i *)te, te_v);
+
+	for (i = 0; i < 4; i++) {
+		m[i]->time = last[i];
+		m[i]->tc = tc[i];
+		m[i]->te = te[i];
+	}
+}
+
+static inline void
+meter_trtcm_refresh_lanes(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time)
+{
+	uint64_t last_tc[4], last_tp[4], tc[4], tp[4];
+	__m256i cbs, pbs, x_tc, x_tp, used_tc, used_tp, added_tc, added_tp;
+	__m256i now = _mm256_set1_epi64x(time);
+	uint32_t i;
+
+	cbs = METER_X4_LOAD(p, cbs);
+	pbs = METER_X4_LOAD(p, pbs);
+	x_tc = METER_X4_LOAD(m, time_tc);
+	x_tp = METER_X4_LOAD(m, time_tp);
+
+	if (!meter_x4_periods(_mm256_sub_epi64(now, x_tc),
+			METER_X4_LOAD(p, cir_period),
+			METER_X4_LOAD(p, cir_bytes_per_period),
+			cbs, &used_tc, &added_tc) ||
+		!meter_x4_periods(_mm256_sub_epi64(now, x_tp),
+			METER_X4_LOAD(p, pir_period),
+			METER_X4_LOAD(p, pir_bytes_per_period),
+			pbs, &used_tp, &added_tp)) {
+		for (i = 0; i < 4; i++)
+			meter_trtcm_refresh(m[i], p[i], time);
+		return;
+	}
+
+	_mm256_storeu_si256((__m256i *)last_tc, _mm256_add_epi64(x_tc,
+		used_tc));
+	_mm256_storeu_si256((__m256i *)last_tp, _mm256_add_epi64(x_tp,
+		used_tp));
+	_mm256_storeu_si256((__m256i *)tc, meter_x4_min(_mm256_add_epi64(
+		METER_X4_LOAD(m, tc), added_tc), cbs));
+	_mm256_storeu_si256((__m256i *)tp, meter_x4_min(_mm256_add_epi64(
+		METER_X4_LOAD(m, tp), added_tp), pbs));
+
+	for (i = 0; i < 4; i++) {
+		m[i]->time_tc = last_tc[i];
+		m[i]->time_tp = last_tp[i];
+		m[i]->tc = tc[i];
+		m[i]->tp = tp[i];
+	}
+}
+
+#elif defined(RTE_ARCH_ARM64)
+
+#define METER_REFRESH_LANES	2
+
+/*
+ * Bucket refresh of 2 meters: n = elapsed / period with the division done on
+ * doubles. Gives n * period and min(n * bytes, size), or returns 0 when some
+ * value is out of the exact range of the doubles.
+ */
+static inline int
+meter_x2_periods(uint64x2_t elapsed, uint64x2_t period, uint64x2_t bytes,
+	uint64x2_t size, uint64x2_t *used, uint64x2_t *added)
+{
+	float64x2_t elapsed_d, period_d, n_d, used_d;
+	uint64x2_t over;
+
+	if (vmaxvq_u32(vreinterpretq_u32_u64(vshrq_n_u64(vorrq_u64(
+			vorrq_u64(elapsed, period),
+			vorrq_u64(bytes, size)), 51))) != 0)
+		return 0;
+
+	/* The rounded quotient is at most one period too large */
+	elapsed_d = vcvtq_f64_u64(elapsed);
+	period_d = vcvtq_f64_u64(period);
+	n_d = vrndmq_f64(vdivq_f64(elapsed_d, period_d));
+	used_d = vmulq_f64(n_d, period_d);
+	over = vcgtq_f64(used_d, elapsed_d);
+	n_d = vsubq_f64(n_d, vreinterpretq_f64_u64(vandq_u64(over,
+		vreinterpretq_u64_f64(vdupq_n_f64(1.0)))));
+	used_d = vsubq_f64(used_d, vreinterpretq_f64_u64(vandq_u64(over,
+		vreinterpretq_u64_f64(period_d))));
+
+	*used = vcvtq_u64_f64(used_d);
+	*added = vcvtq_u64_f64(vminq_f64(vmulq_f64(n_d,
+		vcvtq_f64_u64(bytes)), vcvtq_f64_u64(size)));
+	return 1;
+}
+
+static inline uint64x2_t
+meter_x2_min(uint64x2_t a, uint64x2_t b)
+{
+	return vbslq_u64(vcgtq_u64(a, b), b, a);
+}
+
+#define METER_X2_LOAD(m, field) \
+	vcombine_u64(vcreate_u64((m)[0]->field), vcreate_u64((m)[1]->field))
+
+static inline void
+meter_srtcm_refresh_lanes(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time)
+{
+	uint64x2_t cbs, ebs, x, tc, te, used, added;
+	uint32_t i;
+
+	cbs = METER_X2_LOAD(p, cbs);
+	ebs = METER_X2_LOAD(p, ebs);
+	x = METER_X2_LOAD(m, time);
+
+	if (!meter_x2_periods(vsubq_u64(vdupq_n_u64(time), x),
+			METER_X2_LOAD(p, cir_period),
+			METER_X2_LOAD(p, cir_bytes_per_period),
+			vaddq_u64(cbs, ebs), &used, &added)) {
+		for (i = 0; i < 2; i++)
+			meter_srtcm_refresh(m[i], p[i], time);
+		return;
+	}
+	x = vaddq_u64(x, used);
+	m[0]->time = vgetq_lane_u64(x, 0);
+	m[1]->time = vgetq_lane_u64(x, 1);
+
+	/* The tokens overflowing from tc go into te */
+	x = meter_x2_min(vaddq_u64(METER_X2_LOAD(m, tc), added),
+		vaddq_u64(cbs, ebs));
+	tc = meter_x2_min(x, cbs);
+	te = meter_x2_min(vaddq_u64(METER_X2_LOAD(m, te), vsubq_u64(x, tc)),
+		ebs);
+	m[0]->tc = vgetq_lane_u64(tc, 0);
+	m[1]->tc = vgetq_lane_u64(tc, 1);
+	m[0]->te = vgetq_lane_u64(te, 0);
+	m[1]->te = vgetq_lane_u64(te, 1);
+}
+
+static inline void
+meter_trtcm_refresh_lanes(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time)
+{
+	uint64x2_t cbs, pbs, x_tc, x_tp, used_tc, used_tp, added_tc, added_tp;
+	uint64x2_t now = vdupq_n_u64(time), tc, tp;
+	uint32_t i;
+
+	cbs = METER_X2_LOAD(p, cbs);
+	pbs = METER_X2_LOAD(p, pbs);
+	x_tc = METER_X2_LOAD(m, time_tc);
+	x_tp = METER_X2_LOAD(m, time_tp);
+
+	if (!meter_x2_periods(vsubq_u64(now, x_tc),
+			METER_X2_LOAD(p, cir_period),
+			METER_X2_LOAD(p, cir_bytes_per_period),
+			cbs, &used_tc, &added_tc) ||
+		!meter_x2_periods(vsubq_u64(now, x_tp),
+			METER_X2_LOAD(p, pir_period),
+			METER_X2_LOAD(p, pir_bytes_per_period),
+			pbs, &used_tp, &added_tp)) {
+		for (i = 0; i < 2; i++)
+			meter_trtcm_refresh(m[i], p[i], time);
+		return;
+	}
+
+	x_tc = vaddq_u64(x_tc, used_tc);
+	x_tp = vaddq_u64(x_tp, used_tp);
+	tc = meter_x2_min(vaddq_u64(METER_X2_LOAD(m, tc), added_tc), cbs);
+	tp = meter_x2_min(vaddq_u64(METER_X2_LOAD(m, tp), added_tp), pbs);
+
+	m[0]->time_tc = vgetq_lane_u64(x_tc, 0);
+	m[1]->time_tc = vgetq_lane_u64(x_tc, 1);
+	m[0]->time_tp = vgetq_lane_u64(x_tp, 0);
+	m[1]->time_tp = vgetq_lane_u64(x_tp, 1);
+	m[0]->tc = vgetq_lane_u64(tc, 0);
+	m[1]->tc = vgetq_lane_u64(tc, 1);
+	m[0]->tp = vgetq_lane_u64(tp, 0);
+	m[1]->tp = vgetq_lane_u64(tp, 1);
+}
+
+#else
+
+#define METER_REFRESH_LANES	1
+
+static inline void
+meter_srtcm_refresh_lanes(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time)
+{
+	meter_srtcm_refresh(m[0], p[0], time);
+}
+
+static inline void
+meter_trtcm_refresh_lanes(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time)
+{
+	meter_trtcm_refresh(m[0], p[0], time);
+}
+
+#endif
+
+/*
+ * Collect the meter of each run of packets in [i, end), returns the number of
+ * runs. The meters are prefetched for the refresh.
+ */
+static inline uint32_t
+meter_bulk_runs(void * const *m, void * const *p, uint32_t i, uint32_t end,
+	void **run_m, void **run_p)
+{
+	uint32_t n_runs = 0;
+
+	for ( ; i < end; i++) {
+		if ((n_runs != 0) && (m[i] == run_m[n_runs - 1]))
+			continue;
+
+		rte_prefetch0(m[i]);
+		run_m[n_runs] = m[i];
+		run_p[n_runs++] = p[i];
+	}
+
+	return n_runs;
+}
+
+static inline void
+meter_srtcm_check_bulk(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts,
+	int color_aware)
+{
+	struct rte_meter_srtcm *run_m[METER_BULK_CHUNK];
+	struct rte_meter_srtcm_profile *run_p[METER_BULK_CHUNK];
+	struct rte_meter_srtcm *sm = NULL;
+	uint64_t tc = 0, te = 0;
+	uint32_t i, j, end, n_runs;
+
+	for (i = 0; i < n_pkts; i = end) {
+		end = RTE_MIN(n_pkts, i + METER_BULK_CHUNK);
+		n_runs = meter_bulk_runs((void * const *)m, (void * const *)p,
+			i, end, (void **)run_m, (void **)run_p);
+
+		/* Bucket update */
+		for (j = 0; j + METER_REFRESH_LANES <= n_runs;
+				j += METER_REFRESH_LANES)
+			meter_srtcm_refresh_lanes(&run_m[j], &run_p[j], time);
+		for ( ; j < n_runs; j++)
+			meter_srtcm_refresh(run_m[j], run_p[j], time);
+
+		/* Color logic */
+		for (j = i; j < end; j++) {
+			enum rte_color color = color_aware ?
+				pkt_color[j] : RTE_COLOR_GREEN;
+			uint32_t len = pkt_len[j];
+
+			if (m[j] != sm) {
+				if (sm != NULL) {
+					sm->tc = tc;
+					sm->te = te;
+				}
+				sm = m[j];
+				tc = sm->tc;
+				te = sm->te;
+			}
+
+			if ((color == RTE_COLOR_GREEN) && (tc >= len)) {
+				tc -= len;
+				pkt_color[j] = RTE_COLOR_GREEN;
+			} else if ((color != RTE_COLOR_RED) && (te >= len)) {
+				te -= len;
+				pkt_color[j] = RTE_COLOR_YELLOW;
+			} else {
+				pkt_color[j] = RTE_COLOR_RED;
+			}
+		}
+
+		sm->tc = tc;
+		sm->te = te;
+		sm = NULL;
+	}
+}
+
+void
+rte_meter_srtcm_color_blind_check_bulk(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts)
+{
+	meter_srtcm_check_bulk(m, p, time, pkt_len, pkt_color, n_pkts, 0);
+}
+
+void
+rte_meter_srtcm_color_aware_check_bulk(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts)
+{
+	meter_srtcm_check_bulk(m, p, time, pkt_len, pkt_color, n_pkts, 1);
+}
+
+static inline void
+meter_trtcm_check_bulk(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts,
+	int color_aware)
+{
+	struct rte_meter_trtcm *run_m[METER_BULK_CHUNK];
+	struct rte_meter_trtcm_profile *run_p[METER_BULK_CHUNK];
+	struct rte_meter_trtcm *tm = NULL;
+	uint64_t tc = 0, tp = 0;
+	uint32_t i, j, end, n_runs;
+
+	for (i = 0; i < n_pkts; i = end) {
+		end = RTE_MIN(n_pkts, i + METER_BULK_CHUNK);
+		n_runs = meter_bulk_runs((void * const *)m, (void * const *)p,
+			i, end, (void **)run_m, (void **)run_p);
+
+		/* Bucket update */
+		for (j = 0; j + METER_REFRESH_LANES <= n_runs;
+				j += METER_REFRESH_LANES)
+			meter_trtcm_refresh_lanes(&run_m[j], &run_p[j], time);
+		for ( ; j < n_runs; j++)
+			meter_trtcm_refresh(run_m[j], run_p[j], time);
+
+		/* Color logic */
+		for (j = i; j < end; j++) {
+			enum rte_color color = color_aware ?
+				pkt_color[j] : RTE_COLOR_GREEN;
+			uint32_t len = pkt_len[j];
+
+			if (m[j] != tm) {
+				if (tm != NULL) {
+					tm->tc = tc;
+					tm->tp = tp;
+				}
+				tm = m[j];
+				tc = tm->tc;
+				tp = tm->tp;
+			}
+
+			if ((color == RTE_COLOR_RED) || (tp < len)) {
+				pkt_color[j] = RTE_COLOR_RED;
+			} else if ((color == RTE_COLOR_YELLOW) || (tc < len)) {
+				tp -= len;
+				pkt_color[j] = RTE_COLOR_YELLOW;
+			} else {
+				tc -= len;
+				tp -= len;
+				pkt_color[j] = RTE_COLOR_GREEN;
+			}
+		}
+
+		tm->tc = tc;
+		tm->tp = tp;
+		tm = NULL;
+	}
+}
+
+void
+rte_meter_trtcm_color_blind_check_bulk(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts)
+{
+	meter_trtcm_check_bulk(m, p, time, pkt_len, pkt_color, n_pkts, 0);
+}
+
+void
+rte_meter_trtcm_color_aware_check_bulk(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts)
+{
+	meter_trtcm_check_bulk(m, p, time, pkt_len, pkt_color, n_pkts, 1);
+}
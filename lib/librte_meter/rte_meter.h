@@ -327,6 +327,139 @@ rte_meter_trtcm_rfc4115_color_aware_check(
 	uint32_t pkt_len,
 	enum rte_color pkt_color);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM color blind traffic metering of a burst of packets
+ *
+ * Gives the same colors as calling rte_meter_srtcm_color_blind_check() for
+ * each packet in order. The token buckets of a meter are refreshed once per
+ * run of consecutive packets using it, and the refresh of different meters
+ * is vectorized when the CPU allows it, so packets of the same flow are best
+ * passed next to each other.
+ *
+ * @param m
+ *    Array of handles to the srTCM instance of each packet
+ * @param p
+ *    Array of srTCM profiles of each packet, specified at srTCM object
+ *    creation time
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of lengths of the IP packets (measured in bytes)
+ * @param pkt_color
+ *    Array where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets
+ */
+__rte_experimental
+void
+rte_meter_srtcm_color_blind_check_bulk(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM color aware traffic metering of a burst of packets
+ *
+ * Gives the same colors as calling rte_meter_srtcm_color_aware_check() for
+ * each packet in order, see rte_meter_srtcm_color_blind_check_bulk().
+ *
+ * @param m
+ *    Array of handles to the srTCM instance of each packet
+ * @param p
+ *    Array of srTCM profiles of each packet, specified at srTCM object
+ *    creation time
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of lengths of the IP packets (measured in bytes)
+ * @param pkt_color
+ *    Array of input colors of the packets, overwritten with the color
+ *    assigned to each packet
+ * @param n_pkts
+ *    Number of packets
+ */
+__rte_experimental
+void
+rte_meter_srtcm_color_aware_check_bulk(struct rte_meter_srtcm **m,
+	struct rte_meter_srtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM color blind traffic metering of a burst of packets
+ *
+ * Gives the same colors as calling rte_meter_trtcm_color_blind_check() for
+ * each packet in order, see rte_meter_srtcm_color_blind_check_bulk().
+ *
+ * @param m
+ *    Array of handles to the trTCM instance of each packet
+ * @param p
+ *    Array of trTCM profiles of each packet, specified at trTCM object
+ *    creation time
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of lengths of the IP packets (measured in bytes)
+ * @param pkt_color
+ *    Array where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets
+ */
+__rte_experimental
+void
+rte_meter_trtcm_color_blind_check_bulk(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM color aware traffic metering of a burst of packets
+ *
+ * Gives the same colors as calling rte_meter_trtcm_color_aware_check() for
+ * each packet in order, see rte_meter_srtcm_color_blind_check_bulk().
+ *
+ * @param m
+ *    Array of handles to the trTCM instance of each packet
+ * @param p
+ *    Array of trTCM profiles of each packet, specified at trTCM object
+ *    creation time
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of lengths of the IP packets (measured in bytes)
+ * @param pkt_color
+ *    Array of input colors of the packets, overwritten with the color
+ *    assigned to each packet
+ * @param n_pkts
+ *    Number of packets
+ */
+__rte_experimental
+void
+rte_meter_trtcm_color_aware_check_bulk(struct rte_meter_trtcm **m,
+	struct rte_meter_trtcm_profile **p,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_color *pkt_color,
+	uint32_t n_pkts);
+
 /*
  * Inline implementation of run-time methods
  *
@@ -15,6 +15,7 @@
 #include <rte_mbuf.h>
 #include <rte_bitmap.h>
 #include <rte_reciprocal.h>
+#include <rte_ring.h>
 
 #include "rte_sched.h"
 #include "rte_sched_common.h"
@@ -47,6 +48,9 @@
  */
 #define RTE_SCHED_TIME_SHIFT		      8
 
+/* Number of packets moved from the subport input ring at a time */
+#define RTE_SCHED_SUBPORT_INPUT_BURST	      64
+
 struct rte_sched_pipe_profile {
 	/* Token bucket (TB) */
 	uint64_t tb_period;
@@ -195,6 +199,16 @@ struct rte_sched_subport {
 	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
 	uint32_t qsize_sum;
 
+	/* Dequeue context */
+	uint64_t time;            /* Port time seen by the subport grinders */
+	uint64_t time_cpu_cycles; /* CPU time in CPU cycles (parallel mode) */
+	uint64_t time_cpu_bytes;  /* CPU time in bytes (parallel mode) */
+	struct rte_mbuf **pkts_out;
+	uint32_t n_pkts_out;
+
+	/* Input ring, filled by rte_sched_subport_input() */
+	struct rte_ring *input;
+
 	struct rte_sched_pipe *pipe;
 	struct rte_sched_queue *queue;
 	struct rte_sched_queue_extra *queue_extra;
@@ -225,8 +239,6 @@ struct rte_sched_port {
 	uint64_t cycles_per_byte;
 
 	/* Grinders */
-	struct rte_mbuf **pkts_out;
-	uint32_t n_pkts_out;
 	uint32_t subport_id;
 
 	/* Large data structures */
@@ -856,8 +868,6 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->cycles_per_byte = cycles_per_byte;
 
 	/* Grinders */
-	port->pkts_out = NULL;
-	port->n_pkts_out = 0;
 	port->subport_id = 0;
 
 	return port;
@@ -890,6 +900,15 @@ rte_sched_subport_free(struct rte_sched_port *port,
 		}
 	}
 
+	/* Free mbufs still waiting in the input ring */
+	if (subport->input != NULL) {
+		struct rte_mbuf *pkt;
+
+		while (rte_ring_sc_dequeue(subport->input, (void **)&pkt) == 0)
+			rte_pktmbuf_free(pkt);
+		rte_free(subport->input);
+	}
+
 	rte_free(subport);
 }
 
@@ -1051,6 +1070,11 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		if (params->qsize[i])
 			s->tc_credits[i] = s->tc_credits_per_period[i];
 
+	/* Dequeue context */
+	s->time = port->time;
+	s->time_cpu_cycles = port->time_cpu_cycles;
+	s->time_cpu_bytes = port->time_cpu_bytes;
+
 	/* compile time checks */
 	RTE_BUILD_BUG_ON(RTE_SCHED_PORT_N_GRINDERS == 0);
 	RTE_BUILD_BUG_ON(RTE_SCHED_PORT_N_GRINDERS &
@@ -1605,13 +1629,13 @@ rte_sched_port_red_drop(struct rte_sched_port *port,
 }
 
 static inline void
-rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port,
+rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port __rte_unused,
 	struct rte_sched_subport *subport, uint32_t qindex)
 {
 	struct rte_sched_queue_extra *qe = subport->queue_extra + qindex;
 	struct rte_red *red = &qe->red;
 
-	rte_red_mark_queue_empty(red, port->time);
+	rte_red_mark_queue_empty(red, subport->time);
 }
 
 #else
@@ -1966,7 +1990,7 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
 #ifndef RTE_SCHED_SUBPORT_TC_OV
 
 static inline void
-grinder_credits_update(struct rte_sched_port *port,
+grinder_credits_update(struct rte_sched_port *port __rte_unused,
 	struct rte_sched_subport *subport, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
@@ -1976,31 +2000,31 @@ grinder_credits_update(struct rte_sched_port *port,
 	uint32_t i;
 
 	/* Subport TB */
-	n_periods = (port->time - subport->tb_time) / subport->tb_period;
+	n_periods = (subport->time - subport->tb_time) / subport->tb_period;
 	subport->tb_credits += n_periods * subport->tb_credits_per_period;
 	subport->tb_credits = RTE_MIN(subport->tb_credits, subport->tb_size);
 	subport->tb_time += n_periods * subport->tb_period;
 
 	/* Pipe TB */
-	n_periods = (port->time - pipe->tb_time) / params->tb_period;
+	n_periods = (subport->time - pipe->tb_time) / params->tb_period;
 	pipe->tb_credits += n_periods * params->tb_credits_per_period;
 	pipe->tb_credits = RTE_MIN(pipe->tb_credits, params->tb_size);
 	pipe->tb_time += n_periods * params->tb_period;
 
 	/* Subport TCs */
-	if (unlikely(port->time >= subport->tc_time)) {
+	if (unlikely(subport->time >= subport->tc_time)) {
 		for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 			subport->tc_credits[i] = subport->tc_credits_per_period[i];
 
-		subport->tc_time = port->time + subport->tc_period;
+		subport->tc_time = subport->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
-	if (unlikely(port->time >= pipe->tc_time)) {
+	if (unlikely(subport->time >= pipe->tc_time)) {
 		for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 			pipe->tc_credits[i] = params->tc_credits_per_period[i];
 
-		pipe->tc_time = port->time + params->tc_period;
+		pipe->tc_time = subport->time + params->tc_period;
 	}
 }
 
@@ -2059,33 +2083,33 @@ grinder_credits_update(struct rte_sched_port *port,
 	uint32_t i;
 
 	/* Subport TB */
-	n_periods = (port->time - subport->tb_time) / subport->tb_period;
+	n_periods = (subport->time - subport->tb_time) / subport->tb_period;
 	subport->tb_credits += n_periods * subport->tb_credits_per_period;
 	subport->tb_credits = RTE_MIN(subport->tb_credits, subport->tb_size);
 	subport->tb_time += n_periods * subport->tb_period;
 
 	/* Pipe TB */
-	n_periods = (port->time - pipe->tb_time) / params->tb_period;
+	n_periods = (subport->time - pipe->tb_time) / params->tb_period;
 	pipe->tb_credits += n_periods * params->tb_credits_per_period;
 	pipe->tb_credits = RTE_MIN(pipe->tb_credits, params->tb_size);
 	pipe->tb_time += n_periods * params->tb_period;
 
 	/* Subport TCs */
-	if (unlikely(port->time >= subport->tc_time)) {
+	if (unlikely(subport->time >= subport->tc_time)) {
 		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, subport);
 
 		for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 			subport->tc_credits[i] = subport->tc_credits_per_period[i];
 
-		subport->tc_time = port->time + subport->tc_period;
+		subport->tc_time = subport->time + subport->tc_period;
 		subport->tc_ov_period_id++;
 	}
 
 	/* Pipe TCs */
-	if (unlikely(port->time >= pipe->tc_time)) {
+	if (unlikely(subport->time >= pipe->tc_time)) {
 		for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 			pipe->tc_credits[i] = params->tc_credits_per_period[i];
-		pipe->tc_time = port->time + params->tc_period;
+		pipe->tc_time = subport->time + params->tc_period;
 	}
 
 	/* Pipe TCs - Oversubscription */
@@ -2199,10 +2223,10 @@ grinder_schedule(struct rte_sched_port *port,
 		return 0;
 
 	/* Advance port time */
-	port->time += pkt_len;
+	subport->time += pkt_len;
 
 	/* Send packet */
-	port->pkts_out[port->n_pkts_out++] = pkt;
+	subport->pkts_out[subport->n_pkts_out++] = pkt;
 	queue->qr++;
 
 	be_tc_active = (grinder->tc_index == RTE_SCHED_TRAFFIC_CLASS_BE) ? ~0x0 : 0x0;
@@ -2714,6 +2738,15 @@ rte_sched_port_exceptions(struct rte_sched_subport *subport, int second_pass)
 	return exceptions;
 }
 
+static inline void
+rte_sched_subport_dequeue_ctx_set(struct rte_sched_subport *subport,
+	uint64_t time, struct rte_mbuf **pkts, uint32_t n_pkts_out)
+{
+	subport->time = time;
+	subport->pkts_out = pkts;
+	subport->n_pkts_out = n_pkts_out;
+}
+
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
 {
@@ -2721,19 +2754,18 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 	uint32_t subport_id = port->subport_id;
 	uint32_t i, n_subports = 0, count;
 
-	port->pkts_out = pkts;
-	port->n_pkts_out = 0;
-
 	rte_sched_port_time_resync(port);
 
+	subport = port->subports[subport_id];
+	rte_sched_subport_dequeue_ctx_set(subport, port->time, pkts, 0);
+
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i++)  {
-		subport = port->subports[subport_id];
-
 		count += grinder_handle(port, subport,
 				i & (RTE_SCHED_PORT_N_GRINDERS - 1));
 
 		if (count == n_pkts) {
+			port->time = subport->time;
 			subport_id++;
 
 			if (subport_id == port->n_subports_per_port)
@@ -2744,19 +2776,189 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 		}
 
 		if (rte_sched_port_exceptions(subport, i >= RTE_SCHED_PORT_N_GRINDERS)) {
+			port->time = subport->time;
 			i = 0;
 			subport_id++;
 			n_subports++;
+
+			if (subport_id == port->n_subports_per_port)
+				subport_id = 0;
+
+			if (n_subports == port->n_subports_per_port) {
+				port->subport_id = subport_id;
+				break;
+			}
+
+			subport = port->subports[subport_id];
+			rte_sched_subport_dequeue_ctx_set(subport, port->time,
+				pkts, count);
 		}
+	}
 
-		if (subport_id == port->n_subports_per_port)
-			subport_id = 0;
+	return count;
+}
 
-		if (n_subports == port->n_subports_per_port) {
-			port->subport_id = subport_id;
+int
+rte_sched_subport_input_config(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t ring_size)
+{
+	struct rte_sched_subport *s;
+	struct rte_ring *r;
+	ssize_t size;
+
+	/* Check user parameters */
+	if (port == NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for parameter port\n", __func__);
+		return -EINVAL;
+	}
+
+	if (subport_id >= port->n_subports_per_port ||
+	    port->subports[subport_id] == NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for parameter subport id\n", __func__);
+		return -EINVAL;
+	}
+
+	s = port->subports[subport_id];
+	if (s->input != NULL && !rte_ring_empty(s->input)) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Subport input ring is not empty\n", __func__);
+		return -EBUSY;
+	}
+
+	size = rte_ring_get_memsize(ring_size);
+	if (size < 0) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for parameter ring size\n", __func__);
+		return -EINVAL;
+	}
+
+	r = rte_zmalloc_socket("subport_input", size, RTE_CACHE_LINE_SIZE,
+		port->socket);
+	if (r == NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Memory allocation fails\n", __func__);
+		return -ENOMEM;
+	}
+
+	rte_ring_init(r, "sched_subport_input", ring_size,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+
+	rte_free(s->input);
+	s->input = r;
+
+	return 0;
+}
+
+int
+rte_sched_subport_input(struct rte_sched_port *port, uint32_t subport_id,
+	struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	struct rte_sched_subport *subport = port->subports[subport_id];
+	uint32_t subport_shift = port->n_pipes_per_subport_log2 + 4;
+	uint32_t i;
+
+	/* Stop at the first packet that belongs to another subport */
+	for (i = 0; i < n_pkts; i++)
+		if ((rte_mbuf_sched_queue_get(pkts[i]) >> subport_shift) !=
+		    subport_id)
+			break;
+
+	return rte_ring_sp_enqueue_burst(subport->input, (void **)pkts, i,
+		NULL);
+}
+
+static inline void
+rte_sched_subport_time_resync(struct rte_sched_port *port,
+	struct rte_sched_subport *subport)
+{
+	uint64_t cycles = rte_get_tsc_cycles();
+	uint64_t cycles_diff;
+	uint64_t bytes_diff;
+	uint64_t time;
+
+	if (cycles < subport->time_cpu_cycles)
+		subport->time_cpu_cycles = 0;
+
+	cycles_diff = cycles - subport->time_cpu_cycles;
+	/* Compute elapsed time in bytes */
+	bytes_diff = rte_reciprocal_divide(cycles_diff << RTE_SCHED_TIME_SHIFT,
+					   port->inv_cycles_per_byte);
+
+	/* Advance subport CPU time */
+	subport->time_cpu_cycles +=
+		(bytes_diff * port->cycles_per_byte) >> RTE_SCHED_TIME_SHIFT;
+	subport->time_cpu_bytes += bytes_diff;
+
+	/* Port time is shared by all the subports and never goes back */
+	time = __atomic_load_n(&port->time, __ATOMIC_RELAXED);
+	while (time < subport->time_cpu_bytes &&
+	       !__atomic_compare_exchange_n(&port->time, &time,
+			subport->time_cpu_bytes, 0,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	subport->time = RTE_MAX(time, subport->time_cpu_bytes);
+
+	/* Reset pipe loop detection */
+	subport->pipe_loop = RTE_SCHED_PIPE_INVALID;
+}
+
+static inline void
+rte_sched_subport_input_drain(struct rte_sched_port *port,
+	struct rte_sched_subport *subport)
+{
+	struct rte_mbuf *pkts[RTE_SCHED_SUBPORT_INPUT_BURST];
+	uint32_t capacity = rte_ring_get_capacity(subport->input);
+	uint32_t n, n_total = 0;
+
+	/* Bounded, so a busy producer cannot starve the grinders */
+	do {
+		n = rte_ring_sc_dequeue_burst(subport->input, (void **)pkts,
+			RTE_SCHED_SUBPORT_INPUT_BURST, NULL);
+		if (n == 0)
+			break;
+
+		rte_sched_port_enqueue(port, pkts, n);
+		n_total += n;
+	} while (n == RTE_SCHED_SUBPORT_INPUT_BURST && n_total < capacity);
+}
+
+int
+rte_sched_subport_dequeue(struct rte_sched_port *port, uint32_t subport_id,
+	struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	struct rte_sched_subport *subport = port->subports[subport_id];
+	uint64_t time;
+	uint32_t i, count;
+
+	rte_sched_subport_time_resync(port, subport);
+	time = subport->time;
+
+	if (subport->input != NULL)
+		rte_sched_subport_input_drain(port, subport);
+
+	if (n_pkts == 0)
+		return 0;
+
+	rte_sched_subport_dequeue_ctx_set(subport, time, pkts, 0);
+
+	/* Take each queue in the grinder one step further */
+	for (i = 0, count = 0; ; i++) {
+		count += grinder_handle(port, subport,
+				i & (RTE_SCHED_PORT_N_GRINDERS - 1));
+
+		if (count == n_pkts ||
+		    rte_sched_port_exceptions(subport,
+				i >= RTE_SCHED_PORT_N_GRINDERS))
 			break;
-		}
 	}
 
+	/* Merge the bytes sent by this subport into the port time */
+	__atomic_fetch_add(&port->time, subport->time - time,
+		__ATOMIC_RELAXED);
+
 	return count;
 }
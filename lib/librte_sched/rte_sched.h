@@ -507,6 +507,86 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler subport input configuration. Creates the
+ * single producer single consumer input ring of the subport, which
+ * is filled by rte_sched_subport_input() and drained into the
+ * subport queues by rte_sched_subport_dequeue().
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param ring_size
+ *   Size of the input ring, needs to be a power of 2
+ * @return
+ *   0 upon success, error code otherwise
+ */
+__rte_experimental
+int
+rte_sched_subport_input_config(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t ring_size);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler subport input. Writes up to n_pkts to the
+ * input ring of the subport and returns the number of packets actually
+ * written. Writing stops at the first packet whose hierarchy path
+ * belongs to another subport; the caller keeps the packets that are
+ * not written. Only one lcore at a time may write to a given subport.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID, with its input ring configured
+ * @param pkts
+ *   Array storing the packet descriptor handles
+ * @param n_pkts
+ *   Number of packets to write from the pkts array
+ * @return
+ *   Number of packets successfully written
+ */
+__rte_experimental
+int
+rte_sched_subport_input(struct rte_sched_port *port, uint32_t subport_id,
+	struct rte_mbuf **pkts, uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler subport dequeue. Moves the packets waiting
+ * in the subport input ring (if any) into the subport queues, then
+ * reads up to n_pkts from the subport and stores them in the pkts
+ * array. Different subports of the same port can be dequeued from
+ * different lcores in parallel; the bytes sent by each of them are
+ * merged into the port time, which drives the credit updates of all
+ * the subports. A port is either run through this function or through
+ * rte_sched_port_enqueue() and rte_sched_port_dequeue(), not both.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param pkts
+ *   Pre-allocated packet descriptor array where the packets dequeued
+ *   from the subport should be stored
+ * @param n_pkts
+ *   Number of packets to dequeue from the subport
+ * @return
+ *   Number of packets successfully dequeued and placed in the pkts array
+ */
+__rte_experimental
+int
+rte_sched_subport_dequeue(struct rte_sched_port *port, uint32_t subport_id,
+	struct rte_mbuf **pkts, uint32_t n_pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -101,6 +101,11 @@ struct rte_vhost_async_features {
 /**
  * register a async channel for vhost
  *
+ * Both split and packed rings are supported. A channel registered on an
+ * even queue id (host to guest) is used by rte_vhost_submit_enqueue_burst(),
+ * one registered on an odd queue id (guest to host) is used by
+ * rte_vhost_async_try_dequeue_burst().
+ *
  * @param vid
  *  vhost device id async channel to be attached to
  * @param queue_id
@@ -173,4 +178,33 @@ __rte_experimental
 uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
 		struct rte_mbuf **pkts, uint16_t count);
 
+/**
+ * This function submits the packets the guest has made available on a
+ * queue to the async engine, and returns the packets whose copies have
+ * completed. Packets are returned in the order the guest sent them, and
+ * their descriptors are given back to the guest in that order once the
+ * copies are done. If no async channel is registered on the queue, the
+ * packets are dequeued as rte_vhost_dequeue_burst() does.
+ *
+ * @param vid
+ *  id of vhost device to dequeue data
+ * @param queue_id
+ *  queue id to dequeue data
+ * @param mbuf_pool
+ *  mbuf pool the packets are copied into
+ * @param pkts
+ *  blank array to get return packet pointer
+ * @param count
+ *  size of the packet array
+ * @param nr_inflight
+ *  set to the number of packets still in flight in the async engine, or
+ *  -1 if the queue could not be accessed
+ * @return
+ *  num of packets returned
+ */
+__rte_experimental
+uint16_t rte_vhost_async_try_dequeue_burst(int vid, uint16_t queue_id,
+	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count,
+	int *nr_inflight);
+
 #endif /* _RTE_VHOST_ASYNC_H_ */
@@ -329,13 +329,12 @@ free_vq(struct virtio_net *dev, struct vhost_virtqueue *vq)
 {
 	if (vq_is_packed(dev))
 		rte_free(vq->shadow_used_packed);
-	else {
+	else
 		rte_free(vq->shadow_used_split);
-		if (vq->async_pkts_pending)
-			rte_free(vq->async_pkts_pending);
-		if (vq->async_pending_info)
-			rte_free(vq->async_pending_info);
-	}
+	rte_free(vq->async_pkts_pending);
+	rte_free(vq->async_pending_info);
+	rte_free(vq->async_pkts_info);
+	rte_free(vq->async_buffers_packed);
 	rte_free(vq->batch_copy_elems);
 	rte_mempool_free(vq->iotlb_pool);
 	rte_free(vq);
@@ -1522,6 +1521,8 @@ int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
 	struct vhost_virtqueue *vq;
 	struct virtio_net *dev = get_device(vid);
 	struct rte_vhost_async_features f;
+	bool pkt_info, used_info;
+	int ret = -1;
 
 	if (dev == NULL || ops == NULL)
 		return -1;
@@ -1533,10 +1534,9 @@ int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
 	if (unlikely(vq == NULL || !dev->async_copy))
 		return -1;
 
-	/* packed queue is not supported */
-	if (unlikely(vq_is_packed(dev) || !f.async_inorder)) {
+	if (unlikely(!f.async_inorder)) {
 		VHOST_LOG_CONFIG(ERR,
-			"async copy is not supported on packed queue or non-inorder mode "
+			"async copy is not supported on non-inorder mode "
 			"(vid %d, qid: %d)\n", vid, queue_id);
 		return -1;
 	}
@@ -1560,12 +1560,28 @@ int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
 	vq->async_pending_info = rte_malloc(NULL,
 			vq->size * sizeof(uint64_t),
 			RTE_CACHE_LINE_SIZE);
-	if (!vq->async_pkts_pending || !vq->async_pending_info) {
-		if (vq->async_pkts_pending)
-			rte_free(vq->async_pkts_pending);
-
-		if (vq->async_pending_info)
-			rte_free(vq->async_pending_info);
+	/* packed ring and dequeue (odd queue id) track each packet */
+	pkt_info = vq_is_packed(dev) || (queue_id & 1);
+	used_info = vq_is_packed(dev) && !(queue_id & 1);
+	if (pkt_info)
+		vq->async_pkts_info = rte_malloc(NULL,
+				vq->size * sizeof(struct async_inflight_info),
+				RTE_CACHE_LINE_SIZE);
+	if (used_info)
+		vq->async_buffers_packed = rte_malloc(NULL,
+				vq->size * sizeof(struct vring_used_elem_packed),
+				RTE_CACHE_LINE_SIZE);
+	if (!vq->async_pkts_pending || !vq->async_pending_info ||
+			(pkt_info && !vq->async_pkts_info) ||
+			(used_info && !vq->async_buffers_packed)) {
+		rte_free(vq->async_pkts_pending);
+		vq->async_pkts_pending = NULL;
+		rte_free(vq->async_pending_info);
+		vq->async_pending_info = NULL;
+		rte_free(vq->async_pkts_info);
+		vq->async_pkts_info = NULL;
+		rte_free(vq->async_buffers_packed);
+		vq->async_buffers_packed = NULL;
 
 		VHOST_LOG_CONFIG(ERR,
 				"async register failed: cannot allocate memory for vq data "
@@ -1578,13 +1594,18 @@ int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
 
 	vq->async_inorder = f.async_inorder;
 	vq->async_threshold = f.async_threshold;
+	vq->async_pkts_idx = 0;
+	vq->async_pkts_inflight_n = 0;
+	vq->async_buffer_idx = 0;
+	vq->async_last_buffer_idx = 0;
 
 	vq->async_registered = true;
+	ret = 0;
 
 reg_out:
 	rte_spinlock_unlock(&vq->access_lock);
 
-	return 0;
+	return ret;
 }
 
 int rte_vhost_async_channel_unregister(int vid, uint16_t queue_id)
@@ -1624,6 +1645,11 @@ int rte_vhost_async_channel_unregister(int vid, uint16_t queue_id)
 		vq->async_pending_info = NULL;
 	}
 
+	rte_free(vq->async_pkts_info);
+	vq->async_pkts_info = NULL;
+	rte_free(vq->async_buffers_packed);
+	vq->async_buffers_packed = NULL;
+
 	vq->async_ops.transfer_data = NULL;
 	vq->async_ops.check_completed_copies = NULL;
 	vq->async_registered = false;
@@ -131,6 +131,24 @@ struct vring_used_elem_packed {
 	uint32_t count;
 };
 
+/*
+ * Per packet state of the async copies in flight on a packed ring or in
+ * the dequeue direction, kept in submission order.
+ */
+struct async_inflight_info {
+	/* descriptors (packed ring) or avail entries (split ring) used */
+	uint16_t descs;
+	/* used ring elements, packed ring enqueue only */
+	uint16_t nr_buffers;
+	/* copy segments not completed yet */
+	uint16_t nr_segs;
+	/* dequeue only: head descriptor index (split) or buffer id (packed) */
+	uint16_t desc_idx;
+	/* dequeue only: offload header, applied once the copy completes */
+	struct virtio_net_hdr nethdr;
+	bool has_hdr;
+};
+
 /**
  * Structure contains variables relevant to RX/TX virtqueues.
  */
@@ -225,6 +243,10 @@ struct vhost_virtqueue {
 	uint64_t	*async_pending_info;
 	uint16_t	async_pkts_idx;
 	uint16_t	async_pkts_inflight_n;
+	struct async_inflight_info *async_pkts_info;
+	struct vring_used_elem_packed *async_buffers_packed;
+	uint16_t	async_buffer_idx;
+	uint16_t	async_last_buffer_idx;
 
 	/* vq async features */
 	bool		async_inorder;
@@ -443,6 +465,17 @@ vq_inc_last_avail_packed(struct vhost_virtqueue *vq, uint16_t num)
 	}
 }
 
+static inline void
+vq_dec_last_avail_packed(struct vhost_virtqueue *vq, uint16_t num)
+{
+	if (vq->last_avail_idx >= num) {
+		vq->last_avail_idx -= num;
+	} else {
+		vq->avail_wrap_counter ^= 1;
+		vq->last_avail_idx += vq->size - num;
+	}
+}
+
 void __vhost_log_cache_write(struct virtio_net *dev,
 		struct vhost_virtqueue *vq,
 		uint64_t addr, uint64_t len);
@@ -968,7 +968,7 @@ async_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			uint16_t nr_vec, uint16_t num_buffers,
 			struct iovec *src_iovec, struct iovec *dst_iovec,
 			struct rte_vhost_iov_iter *src_it,
-			struct rte_vhost_iov_iter *dst_it)
+			struct rte_vhost_iov_iter *dst_it, int max_segs)
 {
 	uint32_t vec_idx = 0;
 	uint32_t mbuf_offset, mbuf_avail;
@@ -1072,7 +1072,8 @@ async_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 
 		cpy_len = RTE_MIN(buf_avail, mbuf_avail);
 
-		if (unlikely(cpy_len >= cpy_threshold)) {
+		/* iovec pool exhausted: the CPU copies the rest */
+		if (unlikely(cpy_len >= cpy_threshold && tvec_idx < max_segs)) {
 			hpa = (void *)(uintptr_t)gpa_to_hpa(dev,
 					buf_iova + buf_offset, cpy_len);
 
@@ -1464,6 +1465,53 @@ virtio_dev_rx_async_get_info_idx(uint16_t pkts_idx,
 		(vq_size - n_inflight + pkts_idx) & (vq_size - 1);
 }
 
+static __rte_always_inline uint16_t
+async_ring_add(struct vhost_virtqueue *vq, uint16_t idx, uint16_t n)
+{
+	uint32_t i = (uint32_t)idx + n;
+
+	return i >= vq->size ? i - vq->size : i;
+}
+
+static __rte_always_inline uint16_t
+async_ring_sub(struct vhost_virtqueue *vq, uint16_t idx, uint16_t n)
+{
+	return idx >= n ? (uint32_t)idx - n : vq->size - n + idx;
+}
+
+/* slot of the oldest packet in flight, packed ring and dequeue */
+static __rte_always_inline uint16_t
+async_inflight_head(struct vhost_virtqueue *vq)
+{
+	return async_ring_sub(vq, vq->async_pkts_idx,
+			vq->async_pkts_inflight_n);
+}
+
+/*
+ * Account n_segs completed copy segments to the packets in flight, in
+ * submission order, and return how many packets from the oldest one on
+ * have all their copies done.
+ */
+static __rte_always_inline uint16_t
+async_inflight_complete(struct vhost_virtqueue *vq, uint32_t n_segs)
+{
+	struct async_inflight_info *info = vq->async_pkts_info;
+	uint16_t slot_idx = async_inflight_head(vq);
+	uint16_t n;
+
+	for (n = 0; n < vq->async_pkts_inflight_n; n++) {
+		if (info[slot_idx].nr_segs > n_segs) {
+			info[slot_idx].nr_segs -= n_segs;
+			break;
+		}
+		n_segs -= info[slot_idx].nr_segs;
+		info[slot_idx].nr_segs = 0;
+		slot_idx = async_ring_add(vq, slot_idx, 1);
+	}
+
+	return n;
+}
+
 static __rte_always_inline void
 virtio_dev_rx_async_submit_split_err(struct virtio_net *dev,
 	struct vhost_virtqueue *vq, uint16_t queue_id,
@@ -1547,7 +1595,9 @@ virtio_dev_rx_async_submit_split(struct virtio_net *dev,
 
 		if (async_mbuf_to_desc(dev, vq, pkts[pkt_idx],
 				buf_vec, nr_vec, num_buffers,
-				src_iovec, dst_iovec, src_it, dst_it) < 0) {
+				src_iovec, dst_iovec, src_it, dst_it,
+				vec_pool + (VHOST_MAX_ASYNC_VEC >> 1) -
+				src_iovec) < 0) {
 			vq->shadow_used_idx -= num_buffers;
 			break;
 		}
@@ -1626,6 +1676,182 @@ virtio_dev_rx_async_submit_split(struct virtio_net *dev,
 	return pkt_idx;
 }
 
+static __rte_always_inline int
+vhost_async_enqueue_single_packed(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, struct rte_mbuf *pkt,
+	struct buf_vector *buf_vec, struct async_inflight_info *info,
+	struct iovec *src_iovec, struct iovec *dst_iovec,
+	struct rte_vhost_iov_iter *src_it, struct rte_vhost_iov_iter *dst_it,
+	int max_segs)
+{
+	uint16_t nr_vec = 0;
+	uint16_t avail_idx = vq->last_avail_idx;
+	uint16_t buf_idx = vq->async_buffer_idx;
+	uint16_t max_tries, tries = 0;
+	uint16_t buf_id = 0;
+	uint32_t len = 0;
+	uint16_t desc_count;
+	uint32_t size = pkt->pkt_len + dev->vhost_hlen;
+	uint16_t num_buffers = 0;
+	uint16_t nr_descs = 0;
+
+	if (rxvq_is_mergeable(dev))
+		max_tries = vq->size - 1;
+	else
+		max_tries = 1;
+
+	while (size > 0) {
+		if (unlikely(++tries > max_tries))
+			return -1;
+
+		if (unlikely(fill_vec_buf_packed(dev, vq,
+						avail_idx, &desc_count,
+						buf_vec, &nr_vec,
+						&buf_id, &len,
+						VHOST_ACCESS_RW) < 0))
+			return -1;
+
+		len = RTE_MIN(len, size);
+		size -= len;
+
+		/* used elements are written when the copies complete */
+		vq->async_buffers_packed[buf_idx].id = buf_id;
+		vq->async_buffers_packed[buf_idx].len = len;
+		vq->async_buffers_packed[buf_idx].count = desc_count;
+		buf_idx = async_ring_add(vq, buf_idx, 1);
+		num_buffers += 1;
+
+		nr_descs += desc_count;
+		avail_idx += desc_count;
+		if (avail_idx >= vq->size)
+			avail_idx -= vq->size;
+	}
+
+	if (async_mbuf_to_desc(dev, vq, pkt, buf_vec, nr_vec, num_buffers,
+			src_iovec, dst_iovec, src_it, dst_it, max_segs) < 0)
+		return -1;
+
+	info->descs = nr_descs;
+	info->nr_buffers = num_buffers;
+	info->nr_segs = src_it->nr_segs;
+
+	return 0;
+}
+
+static __rte_noinline uint32_t
+virtio_dev_rx_async_submit_packed(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint32_t count)
+{
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	struct rte_vhost_async_desc tdes[MAX_PKT_BURST];
+	uint16_t tdes_pkt[MAX_PKT_BURST];
+	struct iovec *src_iovec = vq->vec_pool;
+	struct iovec *dst_iovec = vq->vec_pool + (VHOST_MAX_ASYNC_VEC >> 1);
+	struct rte_vhost_iov_iter *src_it = vq->it_pool;
+	struct rte_vhost_iov_iter *dst_it = vq->it_pool + 1;
+	int vec_left = VHOST_MAX_ASYNC_VEC >> 1;
+	uint16_t slot_idx = vq->async_pkts_idx;
+	struct async_inflight_info *info;
+	uint32_t pkt_idx, n_keep, n_xfer = 0;
+	int n;
+
+	count = RTE_MIN(count, (uint32_t)vq->size - vq->async_pkts_inflight_n);
+
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		info = &vq->async_pkts_info[slot_idx];
+
+		if (unlikely(vhost_async_enqueue_single_packed(dev, vq,
+				pkts[pkt_idx], buf_vec, info,
+				src_iovec, dst_iovec, src_it, dst_it,
+				vec_left) < 0)) {
+			VHOST_LOG_DATA(DEBUG,
+				"(%d) failed to get enough desc from vring\n",
+				dev->vid);
+			break;
+		}
+
+		if (src_it->count) {
+			async_fill_desc(&tdes[n_xfer], src_it, dst_it);
+			tdes_pkt[n_xfer++] = pkt_idx;
+			src_iovec += src_it->nr_segs;
+			dst_iovec += dst_it->nr_segs;
+			vec_left -= src_it->nr_segs;
+			src_it += 2;
+			dst_it += 2;
+		}
+
+		vq->async_pkts_pending[slot_idx] = (uintptr_t *)pkts[pkt_idx];
+		vq->async_buffer_idx = async_ring_add(vq, vq->async_buffer_idx,
+				info->nr_buffers);
+		vq_inc_last_avail_packed(vq, info->descs);
+		slot_idx = async_ring_add(vq, slot_idx, 1);
+	}
+
+	do_data_copy_enqueue(dev, vq);
+
+	if (n_xfer) {
+		n = vq->async_ops.transfer_data(dev->vid, queue_id, tdes, 0,
+				n_xfer);
+		if (unlikely(n < (int)n_xfer)) {
+			/* give back the descriptors from the first refused one */
+			n_keep = tdes_pkt[RTE_MAX(n, 0)];
+			for (; pkt_idx > n_keep; pkt_idx--) {
+				slot_idx = async_ring_sub(vq, slot_idx, 1);
+				info = &vq->async_pkts_info[slot_idx];
+				vq->async_buffer_idx = async_ring_sub(vq,
+					vq->async_buffer_idx, info->nr_buffers);
+				vq_dec_last_avail_packed(vq, info->descs);
+			}
+		}
+	}
+
+	vq->async_pkts_idx = slot_idx;
+	vq->async_pkts_inflight_n += pkt_idx;
+
+	return pkt_idx;
+}
+
+static __rte_always_inline uint16_t
+virtio_dev_rx_async_poll_packed(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct async_inflight_info *info;
+	uint16_t slot_idx, buf_idx, n_pkts, i, j;
+	int n_segs;
+
+	n_segs = vq->async_ops.check_completed_copies(dev->vid, queue_id,
+			0, count);
+	n_pkts = async_inflight_complete(vq, n_segs > 0 ? n_segs : 0);
+	n_pkts = RTE_MIN(n_pkts, count);
+	if (n_pkts == 0)
+		return 0;
+
+	/* the copies must land before the guest sees the descriptors */
+	rte_smp_wmb();
+
+	slot_idx = async_inflight_head(vq);
+	buf_idx = vq->async_last_buffer_idx;
+	for (i = 0; i < n_pkts; i++) {
+		info = &vq->async_pkts_info[slot_idx];
+		for (j = 0; j < info->nr_buffers; j++) {
+			vq->shadow_used_packed[vq->shadow_used_idx++] =
+				vq->async_buffers_packed[buf_idx];
+			buf_idx = async_ring_add(vq, buf_idx, 1);
+		}
+		pkts[i] = (struct rte_mbuf *)vq->async_pkts_pending[slot_idx];
+		slot_idx = async_ring_add(vq, slot_idx, 1);
+	}
+	vq->async_last_buffer_idx = buf_idx;
+	vq->async_pkts_inflight_n -= n_pkts;
+
+	vhost_flush_enqueue_shadow_packed(dev, vq);
+	vhost_vring_call_packed(dev, vq);
+
+	return n_pkts;
+}
+
 uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
 		struct rte_mbuf **pkts, uint16_t count)
 {
@@ -1646,6 +1872,13 @@ uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
 
 	rte_spinlock_lock(&vq->access_lock);
 
+	if (vq_is_packed(dev)) {
+		n_pkts_put = virtio_dev_rx_async_poll_packed(dev, vq, queue_id,
+				pkts, count);
+		rte_spinlock_unlock(&vq->access_lock);
+		return n_pkts_put;
+	}
+
 	pkts_idx = vq->async_pkts_idx;
 	async_pending_info = vq->async_pending_info;
 	vq_size = vq->size;
@@ -1744,9 +1977,9 @@ virtio_dev_rx_async_submit(struct virtio_net *dev, uint16_t queue_id,
 	if (count == 0)
 		goto out;
 
-	/* TODO: packed queue not implemented */
 	if (vq_is_packed(dev))
-		nb_tx = 0;
+		nb_tx = virtio_dev_rx_async_submit_packed(dev,
+				vq, queue_id, pkts, count);
 	else
 		nb_tx = virtio_dev_rx_async_submit_split(dev,
 				vq, queue_id, pkts, count);
@@ -2849,3 +3082,469 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 
 	return count;
 }
+
+static __rte_always_inline int
+async_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		  struct buf_vector *buf_vec, uint16_t nr_vec,
+		  struct rte_mbuf *m, struct rte_mempool *mbuf_pool,
+		  struct async_inflight_info *info,
+		  struct iovec *src_iovec, struct iovec *dst_iovec,
+		  struct rte_vhost_iov_iter *src_it,
+		  struct rte_vhost_iov_iter *dst_it, int max_segs)
+{
+	uint32_t buf_avail, buf_offset;
+	uint64_t buf_addr, buf_iova, buf_len;
+	uint32_t mbuf_avail, mbuf_offset;
+	uint32_t cpy_len, cpy_threshold;
+	struct rte_mbuf *cur = m, *prev = m;
+	/* A counter to avoid desc dead loop chain */
+	uint16_t vec_idx = 0;
+	struct batch_copy_elem *batch_copy = vq->batch_copy_elems;
+	uint32_t tlen = 0;
+	int tvec_idx = 0;
+	int error = 0;
+	void *hpa;
+
+	cpy_threshold = vq->async_threshold;
+
+	buf_addr = buf_vec[vec_idx].buf_addr;
+	buf_iova = buf_vec[vec_idx].buf_iova;
+	buf_len = buf_vec[vec_idx].buf_len;
+
+	if (unlikely(buf_len < dev->vhost_hlen && nr_vec <= 1)) {
+		error = -1;
+		goto out;
+	}
+
+	/* the offloads are parsed once the copy completes, keep the header */
+	info->has_hdr = virtio_net_with_host_offload(dev);
+	if (info->has_hdr) {
+		if (unlikely(buf_len < sizeof(struct virtio_net_hdr)))
+			copy_vnet_hdr_from_desc(&info->nethdr, buf_vec);
+		else
+			rte_memcpy(&info->nethdr, (void *)(uintptr_t)buf_addr,
+				sizeof(struct virtio_net_hdr));
+	}
+
+	if (unlikely(buf_len < dev->vhost_hlen)) {
+		buf_offset = dev->vhost_hlen - buf_len;
+		vec_idx++;
+		buf_addr = buf_vec[vec_idx].buf_addr;
+		buf_iova = buf_vec[vec_idx].buf_iova;
+		buf_len = buf_vec[vec_idx].buf_len;
+		buf_avail  = buf_len - buf_offset;
+	} else if (buf_len == dev->vhost_hlen) {
+		if (unlikely(++vec_idx >= nr_vec))
+			goto out;
+		buf_addr = buf_vec[vec_idx].buf_addr;
+		buf_iova = buf_vec[vec_idx].buf_iova;
+		buf_len = buf_vec[vec_idx].buf_len;
+
+		buf_offset = 0;
+		buf_avail = buf_len;
+	} else {
+		buf_offset = dev->vhost_hlen;
+		buf_avail = buf_vec[vec_idx].buf_len - dev->vhost_hlen;
+	}
+
+	mbuf_offset = 0;
+	mbuf_avail  = m->buf_len - RTE_PKTMBUF_HEADROOM;
+	while (1) {
+		cpy_len = RTE_MIN(buf_avail, mbuf_avail);
+
+		/*
+		 * Short copies, a full iovec pool, or a desc buf across two
+		 * host physical pages that are not continuous are left to
+		 * the CPU.
+		 */
+		hpa = NULL;
+		if (cpy_len >= cpy_threshold && tvec_idx < max_segs)
+			hpa = (void *)(uintptr_t)gpa_to_hpa(dev,
+					buf_iova + buf_offset, cpy_len);
+
+		if (hpa) {
+			async_fill_vec(src_iovec + tvec_idx, hpa, cpy_len);
+			async_fill_vec(dst_iovec + tvec_idx,
+				(void *)(uintptr_t)rte_pktmbuf_iova_offset(cur,
+						mbuf_offset), cpy_len);
+			tlen += cpy_len;
+			tvec_idx++;
+		} else if (cpy_len > MAX_BATCH_LEN ||
+				vq->batch_copy_nb_elems >= vq->size) {
+			rte_memcpy(rte_pktmbuf_mtod_offset(cur, void *,
+							   mbuf_offset),
+				   (void *)((uintptr_t)(buf_addr +
+						   buf_offset)),
+				   cpy_len);
+		} else {
+			batch_copy[vq->batch_copy_nb_elems].dst =
+				rte_pktmbuf_mtod_offset(cur, void *,
+							mbuf_offset);
+			batch_copy[vq->batch_copy_nb_elems].src =
+				(void *)((uintptr_t)(buf_addr + buf_offset));
+			batch_copy[vq->batch_copy_nb_elems].len = cpy_len;
+			vq->batch_copy_nb_elems++;
+		}
+
+		mbuf_avail  -= cpy_len;
+		mbuf_offset += cpy_len;
+		buf_avail -= cpy_len;
+		buf_offset += cpy_len;
+
+		/* This buf reaches to its end, get the next one */
+		if (buf_avail == 0) {
+			if (++vec_idx >= nr_vec)
+				break;
+
+			buf_addr = buf_vec[vec_idx].buf_addr;
+			buf_iova = buf_vec[vec_idx].buf_iova;
+			buf_len = buf_vec[vec_idx].buf_len;
+
+			buf_offset = 0;
+			buf_avail  = buf_len;
+		}
+
+		/*
+		 * This mbuf reaches to its end, get a new one
+		 * to hold more data.
+		 */
+		if (mbuf_avail == 0) {
+			cur = rte_pktmbuf_alloc(mbuf_pool);
+			if (unlikely(cur == NULL)) {
+				VHOST_LOG_DATA(ERR, "Failed to "
+					"allocate memory for mbuf.\n");
+				error = -1;
+				goto out;
+			}
+
+			prev->next = cur;
+			prev->data_len = mbuf_offset;
+			m->nb_segs += 1;
+			m->pkt_len += mbuf_offset;
+			prev = cur;
+
+			mbuf_offset = 0;
+			mbuf_avail  = cur->buf_len - RTE_PKTMBUF_HEADROOM;
+		}
+	}
+
+	prev->data_len = mbuf_offset;
+	m->pkt_len    += mbuf_offset;
+
+out:
+	async_fill_iter(src_it, tlen, src_iovec, tvec_idx);
+	async_fill_iter(dst_it, tlen, dst_iovec, tvec_idx);
+
+	return error;
+}
+
+/*
+ * Set up the copy of one guest buffer into a new mbuf. As in the sync
+ * path, a buffer that cannot be copied is dropped but still consumed.
+ */
+static __rte_always_inline struct rte_mbuf *
+virtio_dev_tx_async_pkt(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	struct rte_mempool *mbuf_pool, struct buf_vector *buf_vec,
+	uint16_t nr_vec, uint32_t buf_len, struct async_inflight_info *info,
+	struct iovec *src_iovec, struct iovec *dst_iovec,
+	struct rte_vhost_iov_iter *src_it, struct rte_vhost_iov_iter *dst_it,
+	int max_segs)
+{
+	uint16_t batch_idx = vq->batch_copy_nb_elems;
+	static bool allocerr_warned;
+	struct rte_mbuf *m;
+
+	info->nr_segs = 0;
+	info->has_hdr = false;
+	async_fill_iter(src_it, 0, src_iovec, 0);
+	async_fill_iter(dst_it, 0, dst_iovec, 0);
+
+	m = virtio_dev_pktmbuf_alloc(dev, mbuf_pool, buf_len);
+	if (unlikely(m == NULL)) {
+		if (!allocerr_warned) {
+			VHOST_LOG_DATA(ERR,
+				"Failed mbuf alloc of size %d from %s on %s.\n",
+				buf_len, mbuf_pool->name, dev->ifname);
+			allocerr_warned = true;
+		}
+		return NULL;
+	}
+
+	if (unlikely(async_desc_to_mbuf(dev, vq, buf_vec, nr_vec, m,
+			mbuf_pool, info, src_iovec, dst_iovec,
+			src_it, dst_it, max_segs) < 0)) {
+		if (!allocerr_warned) {
+			VHOST_LOG_DATA(ERR,
+				"Failed to copy desc to mbuf on %s.\n",
+				dev->ifname);
+			allocerr_warned = true;
+		}
+		/* drop the CPU copies into the mbuf as well */
+		vq->batch_copy_nb_elems = batch_idx;
+		async_fill_iter(src_it, 0, src_iovec, 0);
+		async_fill_iter(dst_it, 0, dst_iovec, 0);
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	info->nr_segs = src_it->nr_segs;
+
+	return m;
+}
+
+static __rte_noinline void
+virtio_dev_tx_async_submit(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mempool *mbuf_pool, uint16_t count)
+{
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	struct rte_vhost_async_desc tdes[MAX_PKT_BURST];
+	uint16_t tdes_pkt[MAX_PKT_BURST];
+	struct iovec *src_iovec = vq->vec_pool;
+	struct iovec *dst_iovec = vq->vec_pool + (VHOST_MAX_ASYNC_VEC >> 1);
+	struct rte_vhost_iov_iter *src_it = vq->it_pool;
+	struct rte_vhost_iov_iter *dst_it = vq->it_pool + 1;
+	int vec_left = VHOST_MAX_ASYNC_VEC >> 1;
+	uint16_t slot_idx = vq->async_pkts_idx;
+	struct async_inflight_info *info;
+	uint16_t pkt_idx, n_keep, n_xfer = 0;
+	uint16_t free_entries;
+	int n;
+
+	if (!vq_is_packed(dev)) {
+		free_entries = __atomic_load_n(&vq->avail->idx,
+				__ATOMIC_ACQUIRE) - vq->last_avail_idx;
+		if (free_entries == 0)
+			return;
+
+		rte_prefetch0(&vq->avail->ring[vq->last_avail_idx &
+				(vq->size - 1)]);
+		count = RTE_MIN(count, free_entries);
+	}
+
+	count = RTE_MIN(count, MAX_PKT_BURST);
+	count = RTE_MIN(count, vq->size - vq->async_pkts_inflight_n);
+
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		uint16_t nr_vec = 0;
+		uint32_t buf_len;
+
+		info = &vq->async_pkts_info[slot_idx];
+
+		if (vq_is_packed(dev)) {
+			if (unlikely(fill_vec_buf_packed(dev, vq,
+						vq->last_avail_idx,
+						&info->descs, buf_vec, &nr_vec,
+						&info->desc_idx, &buf_len,
+						VHOST_ACCESS_RO) < 0))
+				break;
+			vq_inc_last_avail_packed(vq, info->descs);
+		} else {
+			if (unlikely(fill_vec_buf_split(dev, vq,
+						vq->last_avail_idx,
+						&nr_vec, buf_vec,
+						&info->desc_idx, &buf_len,
+						VHOST_ACCESS_RO) < 0))
+				break;
+			info->descs = 1;
+			vq->last_avail_idx++;
+		}
+
+		vq->async_pkts_pending[slot_idx] =
+			(uintptr_t *)virtio_dev_tx_async_pkt(dev, vq,
+				mbuf_pool, buf_vec, nr_vec, buf_len, info,
+				src_iovec, dst_iovec, src_it, dst_it,
+				vec_left);
+
+		if (src_it->count) {
+			async_fill_desc(&tdes[n_xfer], src_it, dst_it);
+			tdes_pkt[n_xfer++] = pkt_idx;
+			src_iovec += src_it->nr_segs;
+			dst_iovec += dst_it->nr_segs;
+			vec_left -= src_it->nr_segs;
+			src_it += 2;
+			dst_it += 2;
+		}
+
+		slot_idx = async_ring_add(vq, slot_idx, 1);
+	}
+
+	do_data_copy_dequeue(vq);
+
+	if (n_xfer) {
+		n = vq->async_ops.transfer_data(dev->vid, queue_id, tdes, 0,
+				n_xfer);
+		if (unlikely(n < (int)n_xfer)) {
+			/* give back the descriptors from the first refused one */
+			n_keep = tdes_pkt[RTE_MAX(n, 0)];
+			for (; pkt_idx > n_keep; pkt_idx--) {
+				slot_idx = async_ring_sub(vq, slot_idx, 1);
+				info = &vq->async_pkts_info[slot_idx];
+				rte_pktmbuf_free((struct rte_mbuf *)
+					vq->async_pkts_pending[slot_idx]);
+				if (vq_is_packed(dev))
+					vq_dec_last_avail_packed(vq,
+							info->descs);
+				else
+					vq->last_avail_idx--;
+			}
+		}
+	}
+
+	vq->async_pkts_idx = slot_idx;
+	vq->async_pkts_inflight_n += pkt_idx;
+}
+
+static __rte_noinline uint16_t
+virtio_dev_tx_async_poll(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct async_inflight_info *info;
+	uint16_t slot_idx, n_cpl, n_pkts = 0, i;
+	struct rte_mbuf *m;
+	int n_segs;
+
+	n_segs = vq->async_ops.check_completed_copies(dev->vid, queue_id,
+			0, count);
+	n_cpl = async_inflight_complete(vq, n_segs > 0 ? n_segs : 0);
+	n_cpl = RTE_MIN(n_cpl, count);
+	if (n_cpl == 0)
+		return 0;
+
+	/* the copied data must be seen before the mbufs are handed out */
+	rte_smp_rmb();
+
+	slot_idx = async_inflight_head(vq);
+	for (i = 0; i < n_cpl; i++) {
+		info = &vq->async_pkts_info[slot_idx];
+
+		if (vq_is_packed(dev)) {
+			vq->shadow_used_packed[i].id = info->desc_idx;
+			vq->shadow_used_packed[i].len = 0;
+			vq->shadow_used_packed[i].count = info->descs;
+		} else {
+			update_shadow_used_ring_split(vq, info->desc_idx, 0);
+		}
+
+		m = (struct rte_mbuf *)vq->async_pkts_pending[slot_idx];
+		if (likely(m != NULL)) {
+			if (info->has_hdr)
+				vhost_dequeue_offload(&info->nethdr, m);
+			pkts[n_pkts++] = m;
+		}
+
+		slot_idx = async_ring_add(vq, slot_idx, 1);
+	}
+	vq->async_pkts_inflight_n -= n_cpl;
+
+	/* the buffers go back to the guest in the order it made them */
+	if (vq_is_packed(dev)) {
+		vq->shadow_used_idx = n_cpl;
+		vhost_flush_enqueue_shadow_packed(dev, vq);
+		vhost_vring_call_packed(dev, vq);
+	} else {
+		flush_shadow_used_ring_split(dev, vq);
+		vhost_vring_call_split(dev, vq);
+	}
+
+	return n_pkts;
+}
+
+uint16_t
+rte_vhost_async_try_dequeue_burst(int vid, uint16_t queue_id,
+	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count,
+	int *nr_inflight)
+{
+	struct virtio_net *dev;
+	struct rte_mbuf *rarp_mbuf = NULL;
+	struct vhost_virtqueue *vq;
+	int16_t success = 1;
+	bool drawback = false;
+
+	*nr_inflight = -1;
+
+	dev = get_device(vid);
+	if (!dev)
+		return 0;
+
+	if (unlikely(!(dev->flags & VIRTIO_DEV_BUILTIN_VIRTIO_NET))) {
+		VHOST_LOG_DATA(ERR,
+			"(%d) %s: built-in vhost net backend is disabled.\n",
+			dev->vid, __func__);
+		return 0;
+	}
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 1, dev->nr_vring))) {
+		VHOST_LOG_DATA(ERR,
+			"(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	if (unlikely(rte_spinlock_trylock(&vq->access_lock) == 0))
+		return 0;
+
+	if (unlikely(vq->enabled == 0)) {
+		count = 0;
+		goto out_access_unlock;
+	}
+
+	if (unlikely(!vq->async_registered || dev->dequeue_zero_copy)) {
+		*nr_inflight = 0;
+		drawback = true;
+		goto out_access_unlock;
+	}
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	if (unlikely(vq->access_ok == 0))
+		if (unlikely(vring_translate(dev, vq) < 0)) {
+			count = 0;
+			goto out;
+		}
+
+	/* See rte_vhost_dequeue_burst() */
+	if (unlikely(__atomic_load_n(&dev->broadcast_rarp, __ATOMIC_ACQUIRE) &&
+			__atomic_compare_exchange_n(&dev->broadcast_rarp,
+			&success, 0, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))) {
+
+		rarp_mbuf = rte_net_make_rarp_packet(mbuf_pool, &dev->mac);
+		if (rarp_mbuf == NULL) {
+			VHOST_LOG_DATA(ERR, "Failed to make RARP packet.\n");
+			count = 0;
+			goto out;
+		}
+		count -= 1;
+	}
+
+	virtio_dev_tx_async_submit(dev, vq, queue_id, mbuf_pool, count);
+	count = virtio_dev_tx_async_poll(dev, vq, queue_id, pkts, count);
+	*nr_inflight = vq->async_pkts_inflight_n;
+
+out:
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+out_access_unlock:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	if (drawback)
+		return rte_vhost_dequeue_burst(vid, queue_id, mbuf_pool, pkts,
+				count);
+
+	if (unlikely(rarp_mbuf != NULL)) {
+		/*
+		 * Inject it to the head of "pkts" array, so that switch's mac
+		 * learning table will get updated first.
+		 */
+		memmove(&pkts[1], pkts, count * sizeof(struct rte_mbuf *));
+		pkts[0] = rarp_mbuf;
+		count += 1;
+	}
+
+	return count;
+}